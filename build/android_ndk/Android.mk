@@ -102,11 +102,13 @@ LOCAL_SRC_FILES += \
 	libopenmpt/libopenmpt_cxx.cpp \
 	libopenmpt/libopenmpt_impl.cpp \
 	libopenmpt/libopenmpt_ext_impl.cpp \
+	misc/mptCPU.cpp \
 	soundlib/AudioCriticalSection.cpp \
 	soundlib/ContainerMMCMP.cpp \
 	soundlib/ContainerPP20.cpp \
 	soundlib/ContainerUMX.cpp \
 	soundlib/ContainerXPK.cpp \
+	soundlib/DeferredSamples.cpp \
 	soundlib/Dlsbank.cpp \
 	soundlib/Fastmix.cpp \
 	soundlib/InstrumentExtensions.cpp \
@@ -156,6 +158,7 @@ LOCAL_SRC_FILES += \
 	soundlib/MIDIMacros.cpp \
 	soundlib/MixerLoops.cpp \
 	soundlib/MixerSettings.cpp \
+	soundlib/MixerThreads.cpp \
 	soundlib/MixFuncTable.cpp \
 	soundlib/ModChannel.cpp \
 	soundlib/modcommand.cpp \
@@ -172,6 +175,7 @@ LOCAL_SRC_FILES += \
 	soundlib/pattern.cpp \
 	soundlib/RowVisitor.cpp \
 	soundlib/S3MTools.cpp \
+	soundlib/SampleDecodeQueue.cpp \
 	soundlib/SampleFormats.cpp \
 	soundlib/SampleFormatBRR.cpp \
 	soundlib/SampleFormatFLAC.cpp \
@@ -181,6 +185,7 @@ LOCAL_SRC_FILES += \
 	soundlib/SampleFormatSFZ.cpp \
 	soundlib/SampleFormatVorbis.cpp \
 	soundlib/SampleIO.cpp \
+	soundlib/SamplePool.cpp \
 	soundlib/Sndfile.cpp \
 	soundlib/Snd_flt.cpp \
 	soundlib/Snd_fx.cpp \
@@ -209,6 +214,7 @@ LOCAL_SRC_FILES += \
 	soundlib/plugins/dmo/ParamEq.cpp \
 	soundlib/plugins/dmo/WavesReverb.cpp \
 	soundlib/plugins/LFOPlugin.cpp \
+	soundlib/plugins/PluginGraph.cpp \
 	soundlib/plugins/PluginManager.cpp \
 	soundlib/plugins/PlugInterface.cpp \
 	soundlib/plugins/SymMODEcho.cpp \
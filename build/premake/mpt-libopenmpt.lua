@@ -33,6 +33,8 @@
    "../../src/openmpt/**.hpp",
    "../../common/*.cpp",
    "../../common/*.h",
+   "../../misc/mptCPU.cpp",
+   "../../misc/mptCPU.h",
    "../../soundlib/*.cpp",
    "../../soundlib/*.h",
    "../../soundlib/plugins/*.cpp",
@@ -284,6 +284,9 @@
 // (HACK) Define to build without any plugin support
 //#define NO_PLUGINS
 
+// Disable render profiling (only used by libopenmpt)
+#define NO_RENDER_PROFILING
+
 #endif // MODPLUG_TRACKER
 
 
@@ -316,8 +319,8 @@
 #else
 //#define MPT_ENABLE_CHARSET_LOCALE
 #endif
-// Do not use architecture-specifid intrinsics in library builds. There is just about no codepath which would use it anyway.
-//#define MPT_ENABLE_ARCH_INTRINSICS
+// Use architecture-specific intrinsics. The sample mixer selects vectorized code paths at runtime.
+#define MPT_ENABLE_ARCH_INTRINSICS
 #if defined(MPT_BUILD_HACK_ARCHIVE_SUPPORT)
 //#define NO_ARCHIVE_SUPPORT
 #else
@@ -328,6 +331,7 @@
 #define NO_EQ
 #define NO_AGC
 //#define NO_PLUGINS
+//#define NO_RENDER_PROFILING
 
 #endif // LIBOPENMPT_BUILD
 
@@ -414,6 +418,20 @@
 #define MPT_ENABLE_ARCH_INTRINSICS_SSE
 #define MPT_ENABLE_ARCH_INTRINSICS_SSE2
 
+#elif (MPT_COMPILER_GCC || MPT_COMPILER_CLANG) && defined(__i386__) && defined(__SSE2__)
+
+#define MPT_ENABLE_ARCH_X86
+
+#define MPT_ENABLE_ARCH_INTRINSICS_SSE
+#define MPT_ENABLE_ARCH_INTRINSICS_SSE2
+
+#elif (MPT_COMPILER_GCC || MPT_COMPILER_CLANG) && defined(__x86_64__)
+
+#define MPT_ENABLE_ARCH_AMD64
+
+#define MPT_ENABLE_ARCH_INTRINSICS_SSE
+#define MPT_ENABLE_ARCH_INTRINSICS_SSE2
+
 #endif // arch
 #endif // MPT_ENABLE_ARCH_INTRINSICS
 
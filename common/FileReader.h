@@ -199,6 +199,19 @@ public:
 		return;
 	}
 
+public:
+
+	// Returns true if copies of this file reader can be read from several threads at once,
+	// which is the case if the whole file is (or can be made) available in memory.
+	bool PrepareConcurrentReads() const
+	{
+		if(!this->DataContainer().HasPinnedView())
+			return false;
+		// Makes unseekable streams cache their remaining data
+		this->DataContainer().GetRawData();
+		return true;
+	}
+
 public:
 
 	template <typename T>
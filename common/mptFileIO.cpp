@@ -14,6 +14,7 @@
 #if defined(MPT_ENABLE_FILEIO)
 #include "mpt/io/io.hpp"
 #include "mpt/io/io_stdstream.hpp"
+#include "mpt/io_read/filedata_mmap.hpp"
 #if defined(MODPLUG_TRACKER) && MPT_OS_WINDOWS
 #include "mpt/system_error/system_error.hpp"
 #include "FileReader.h"
@@ -33,6 +34,10 @@
 #include <stdio.h>
 #include <tchar.h>
 #endif // MPT_COMPILER_MSVC
+#if MPT_IO_READ_FILEDATA_MMAP
+#include <fcntl.h>
+#include <unistd.h>
+#endif // MPT_IO_READ_FILEDATA_MMAP
 #endif // MPT_ENABLE_FILEIO
 
 
@@ -392,7 +397,24 @@ bool InputFile::Open(const mpt::PathString &filename, bool allowWholeFileCaching
 	m_IsCached = false;
 	m_Cache.resize(0);
 	m_Cache.shrink_to_fit();
+	m_Mapping = nullptr;
 	m_Filename = filename;
+#if MPT_IO_READ_FILEDATA_MMAP
+	{
+		int fd = ::open(m_Filename.AsNative().c_str(), O_RDONLY | O_CLOEXEC);
+		if(fd >= 0)
+		{
+			// Pipes, devices and empty files cannot be mapped, they take the stream path below.
+			m_Mapping = mpt::IO::FileDataMapped::Map(fd);
+			::close(fd);
+		}
+		if(m_Mapping)
+		{
+			m_IsValid = true;
+			return true;
+		}
+	}
+#endif // MPT_IO_READ_FILEDATA_MMAP
 	m_File.open(m_Filename, std::ios::binary | std::ios::in);
 	if(allowWholeFileCaching)
 	{
@@ -436,7 +458,7 @@ bool InputFile::Open(const mpt::PathString &filename, bool allowWholeFileCaching
 
 bool InputFile::IsValid() const
 {
-	return m_IsValid && m_File.good();
+	return m_IsValid && (m_Mapping || m_File.good());
 }
 
 
@@ -446,6 +468,12 @@ bool InputFile::IsCached() const
 }
 
 
+bool InputFile::IsMapped() const
+{
+	return m_Mapping != nullptr;
+}
+
+
 mpt::PathString InputFile::GetFilename() const
 {
 	return m_Filename;
@@ -455,6 +483,7 @@ mpt::PathString InputFile::GetFilename() const
 std::istream& InputFile::GetStream()
 {
 	MPT_ASSERT(!m_IsCached);
+	MPT_ASSERT(!m_Mapping);
 	return m_File;
 }
 
@@ -466,6 +495,13 @@ mpt::const_byte_span InputFile::GetCache()
 }
 
 
+std::shared_ptr<const mpt::IO::IFileData> InputFile::GetMapping() const
+{
+	MPT_ASSERT(m_Mapping);
+	return m_Mapping;
+}
+
+
 
 #if defined(MODPLUG_TRACKER) && MPT_OS_WINDOWS
 
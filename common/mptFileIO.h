@@ -305,14 +305,18 @@ private:
 	bool m_IsValid;
 	bool m_IsCached;
 	std::vector<std::byte> m_Cache;
+	std::shared_ptr<const mpt::IO::IFileData> m_Mapping;
 public:
 	InputFile(const mpt::PathString &filename, bool allowWholeFileCaching = false);
 	~InputFile();
 	bool IsValid() const;
 	bool IsCached() const;
+	// Regular files are memory-mapped where supported, so that loading does not copy the whole file through stream buffers.
+	bool IsMapped() const;
 	mpt::PathString GetFilename() const;
 	std::istream& GetStream();
 	mpt::const_byte_span GetCache();
+	std::shared_ptr<const mpt::IO::IFileData> GetMapping() const;
 private:
 	bool Open(const mpt::PathString &filename, bool allowWholeFileCaching = false);
 };
@@ -340,7 +344,10 @@ inline FileCursor make_FileCursor(TInputFile &file)
 	{
 		return FileCursor();
 	}
-	if(file.IsCached())
+	if(file.IsMapped())
+	{
+		return FileCursor(file.GetMapping(), std::make_shared<mpt::PathString>(file.GetFilename()));
+	} else if(file.IsCached())
 	{
 		return mpt::IO::make_FileCursor<mpt::PathString>(file.GetCache(), std::make_shared<mpt::PathString>(file.GetFilename()));
 	} else
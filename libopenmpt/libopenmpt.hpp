@@ -386,6 +386,8 @@ LIBOPENMPT_CXX_API int probe_file_header( std::uint64_t flags, std::istream & st
 
 class module_impl;
 
+class module_info_impl;
+
 class module_ext;
 
 namespace detail {
@@ -1058,6 +1060,26 @@ public:
 	  \sa openmpt::module::format_pattern_row_channel
 	*/
 	std::string highlight_pattern_row_channel( std::int32_t pattern, std::int32_t row, std::int32_t channel, std::size_t width = 0, bool pad = true ) const;
+	//! Get formatted (human-readable) pattern content and highlighting information for multiple rows and channels at once
+	/*!
+	  \param pattern The pattern whose data should be retrieved.
+	  \param first_row The first row from which the data should be retrieved.
+	  \param num_rows The number of rows to retrieve.
+	  \param first_channel The first channel from which the data should be retrieved.
+	  \param num_channels The number of channels to retrieve.
+	  \param width The number of characters of each cell. Must not be 0.
+	  \param text Buffer receiving the formatted pattern data. May be nullptr.
+	  \param highlight Buffer receiving the highlighting information. May be nullptr.
+	  \param size The size of each of the buffers in characters. Must be at least num_rows * num_channels * width.
+	  \return The number of characters written to each buffer, or 0 if the buffers are too small or any of the sizes is 0.
+	  \remarks This function writes the cells as formatted by openmpt::module::format_pattern_row_channel and openmpt::module::highlight_pattern_row_channel with pad = true into the buffers, row by row and channel by channel, without any separators or terminating null characters.
+	           Cells outside of the pattern or channel range are filled with spaces.
+	  \remarks Unlike openmpt::module::format_pattern_row_channel, this function does not allocate any memory (unless a note name of an MPTM instrument with custom tuning needs to be formatted), so it is suitable for updating pattern visualizations on every frame.
+	  \sa openmpt::module::format_pattern_row_channel
+	  \sa openmpt::module::highlight_pattern_row_channel
+	  \since 0.7.0
+	*/
+	std::size_t format_pattern_block( std::int32_t pattern, std::int32_t first_row, std::int32_t num_rows, std::int32_t first_channel, std::int32_t num_channels, std::size_t width, char * text, char * highlight, std::size_t size ) const;
 
 	//! Retrieve supported ctl keys
 	/*!
@@ -1067,7 +1089,14 @@ public:
 	           - load.skip_patterns (boolean): Set to "1" to avoid loading patterns into memory
 	           - load.skip_plugins (boolean): Set to "1" to avoid loading plugins
 	           - load.skip_subsongs_init (boolean): Set to "1" to avoid pre-initializing sub-songs. Skipping results in faster module loading but slower seeking.
+	           - load.lazy_samples (boolean): Set to "1" to not decode sample data while loading, but only when a sample is played for the first time. This makes loading faster, e.g. when only previewing a module or determining its duration. Until a sample is decoded, a copy of its encoded data is kept in memory instead, which is smaller than the decoded sample only for compressed samples. Only some formats (currently IT, MPTM and MO3, except for MP3 and Ogg samples) support this, all other formats always decode samples while loading. Setting it to "0" after loading decodes all remaining samples.
+	           - load.share_samples (boolean): Set to "1" to share the sample data of the module with identical samples of other modules loaded with the same setting in the same process. Only one copy of the sample data is kept in memory for all of these modules, which reduces memory usage if many modules with identical samples (e.g. remixes or song packs) are kept open at the same time. Samples that are decoded after loading (see load.lazy_samples) are not shared. Has no effect after loading.
+	           - load.threads (integer): Number of threads that compressed samples are decoded on while loading. "1" decodes on the calling thread only. This is the default. "0" uses one thread per hardware thread. Only some formats (currently IT, MPTM and MO3) support this, and only if the module is read from memory or from a memory-mapped file. The loaded sample data is identical regardless of the number of threads. The sub-songs of modules with several sequences are also searched on this many threads, with identical results. Has no effect on platforms without thread support.
+	           - load.subsongs_cache_directory (text): Path of an existing directory used to cache sub-song information and durations across module instances. Records are keyed by a hash of the file contents, so loading an unchanged file again does not need to evaluate the whole song. Empty (the default) disables the cache. Only has an effect when passed to the constructor.
+	           - load.resampler_tables_file (text): Path of a file holding precomputed resampler tables. If the file is missing or was written by a different libopenmpt version or build, the tables are computed and the file is written. Otherwise, the tables are read from the file instead of being computed, which speeds up the first module construction in new processes. The tables are shared by all modules in a process, so only the first module constructed with this ctl looks at the file. Empty (the default) disables the file. Only has an effect when passed to the constructor.
 	           - seek.sync_samples (boolean): Set to "0" to not sync sample playback when using openmpt::module::set_position_seconds or openmpt::module::set_position_order_row.
+	           - seek.checkpoint_interval (floatingpoint): Song time in seconds between snapshots of the playback state that are recorded when using openmpt::module::set_position_seconds or openmpt::module::set_position_order_row. Later seeks resume from the nearest earlier snapshot, which makes seeking in long modules faster. "0.0" disables snapshots. This is the default. Seeking forward always continues from the position where the previous seek by time ended, regardless of this setting.
+	           - seek.checkpoint_memory_limit (integer): Approximate maximum amount of memory in bytes used for seek snapshots. If the limit is exceeded, every other snapshot is discarded. The default is 67108864.
 	           - subsong (integer): The current subsong. Setting it has identical semantics as openmpt::module::select_subsong(), getting it returns the currently selected subsong.
 	           - play.at_end (text): Chooses the behaviour when the end of song is reached:
 	                          - "fadeout": Fades the module out for a short while. Subsequent reads after the fadeout will return 0 rendered frames.
@@ -1082,6 +1111,7 @@ public:
 	                     - "a1200": Amiga A1200 filter.
 	                     - "unfiltered": BLEP synthesis without model-specific filters. The LED filter is ignored by this setting. This filter mode is considered to be experimental and might change in the future.
 	           - render.opl.volume_factor (floatingpoint): Set volume factor applied to synthesized OPL sounds, relative to the default OPL volume.
+	           - render.mixer.threads (integer): Number of threads that sample channels are mixed on. Plugins that do not depend on each other are rendered on the same threads. "1" mixes on the calling thread only. This is the default. "0" uses one thread per hardware thread. The rendered output is identical regardless of the number of threads. Has no effect on platforms without thread support, where it always reads back as "1".
 	           - dither (integer): Set the dither algorithm that is used for the 16 bit versions of openmpt::module::read. Supported values are:
 	                     - 0: No dithering.
 	                     - 1: Default mode. Chosen by OpenMPT code, might change.
@@ -1183,6 +1213,96 @@ public:
 
 }; // class module
 
+//! Module metadata
+/*!
+  openmpt::module_info only reads the metadata of a module, without loading any pattern, sample or plugin data and without preparing the module for playback.
+  This is much faster than constructing an openmpt::module, e.g. when scanning a large collection of module files.
+  To make reading the metadata of many modules faster, libopenmpt keeps up to 4 of the internal objects that were used for reading metadata for reuse until the process exits, which takes about 1.4 MB of memory per object.
+  \sa openmpt::module::get_metadata
+  \since 0.7.0
+*/
+class LIBOPENMPT_CXX_API module_info {
+
+private:
+	module_info_impl * impl;
+private:
+	// non-copyable
+	module_info( const module_info & );
+	void operator = ( const module_info & );
+public:
+	//! Construct an openmpt::module_info
+	/*!
+	  \param stream Input stream from which the module metadata is read.
+	  \param log Log where any warnings or errors are printed to. It is only used by the constructor.
+	  \throws openmpt::exception Throws an exception derived from openmpt::exception in case the provided file cannot be opened.
+	*/
+	module_info( std::istream & stream, std::ostream & log = std::clog );
+	/*!
+	  \param data Data to read the module metadata from.
+	  \param log Log where any warnings or errors are printed to. It is only used by the constructor.
+	  \throws openmpt::exception Throws an exception derived from openmpt::exception in case the provided file cannot be opened.
+	*/
+	module_info( const std::vector<std::byte> & data, std::ostream & log = std::clog );
+	/*!
+	  \param data Data to read the module metadata from.
+	  \param size Amount of data available.
+	  \param log Log where any warnings or errors are printed to. It is only used by the constructor.
+	  \throws openmpt::exception Throws an exception derived from openmpt::exception in case the provided file cannot be opened.
+	*/
+	module_info( const std::byte * data, std::size_t size, std::ostream & log = std::clog );
+	/*!
+	  \param data Data to read the module metadata from.
+	  \param log Log where any warnings or errors are printed to. It is only used by the constructor.
+	  \throws openmpt::exception Throws an exception derived from openmpt::exception in case the provided file cannot be opened.
+	*/
+	module_info( const std::vector<std::uint8_t> & data, std::ostream & log = std::clog );
+	/*!
+	  \param data Data to read the module metadata from.
+	  \param size Amount of data available.
+	  \param log Log where any warnings or errors are printed to. It is only used by the constructor.
+	  \throws openmpt::exception Throws an exception derived from openmpt::exception in case the provided file cannot be opened.
+	*/
+	module_info( const std::uint8_t * data, std::size_t size, std::ostream & log = std::clog );
+	/*!
+	  \param data Data to read the module metadata from.
+	  \param log Log where any warnings or errors are printed to. It is only used by the constructor.
+	  \throws openmpt::exception Throws an exception derived from openmpt::exception in case the provided file cannot be opened.
+	*/
+	module_info( const std::vector<char> & data, std::ostream & log = std::clog );
+	/*!
+	  \param data Data to read the module metadata from.
+	  \param size Amount of data available.
+	  \param log Log where any warnings or errors are printed to. It is only used by the constructor.
+	  \throws openmpt::exception Throws an exception derived from openmpt::exception in case the provided file cannot be opened.
+	*/
+	module_info( const char * data, std::size_t size, std::ostream & log = std::clog );
+	/*!
+	  \param data Data to read the module metadata from.
+	  \param size Amount of data available.
+	  \param log Log where any warnings or errors are printed to. It is only used by the constructor.
+	  \throws openmpt::exception Throws an exception derived from openmpt::exception in case the provided file cannot be opened.
+	*/
+	module_info( const void * data, std::size_t size, std::ostream & log = std::clog );
+	~module_info();
+public:
+
+	//! Get the list of supported metadata item keys
+	/*!
+	  \return Metadata item keys supported by openmpt::module_info::get_metadata
+	  \sa openmpt::module_info::get_metadata
+	*/
+	std::vector<std::string> get_metadata_keys() const;
+	//! Get a metadata item value
+	/*!
+	  \param key Metadata item key to query. The keys and their meaning are the same as for openmpt::module::get_metadata.
+	  \return The associated value for key.
+	  \remarks The values are the same as returned by openmpt::module::get_metadata, except for warnings, which only contains the warnings generated while reading the metadata.
+	  \sa openmpt::module_info::get_metadata_keys
+	*/
+	std::string get_metadata( const std::string & key ) const;
+
+}; // class module_info
+
 /*!
   @}
 */
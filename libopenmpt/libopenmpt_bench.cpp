@@ -0,0 +1,653 @@
+/*
+ * libopenmpt_bench.cpp
+ * --------------------
+ * Purpose: libopenmpt benchmark driver
+ * Notes  : Run via "make bench". Without arguments, the modules from test/ are used.
+ *          Every result is printed on its own line as "group.name file key=value ...", so that results can be collected and compared over time.
+ *          "--subsongs-cache DIR" additionally measures loading with the on-disk sub-song cache in DIR.
+ *          Rendering is measured for planar and interleaved float output, at several sample rates and with every interpolation filter, reported in frames per second.
+ *          Generated IT modules are rendered as well: filter envelopes on all channels, many background voices from new note actions, and all DMO plugins.
+ *          The rendering time of each module is broken down into its stages with the profiling extension.
+ *          Seek latency is measured by seeking to different positions of the song.
+ *          Sub-song discovery is timed on modules loaded with "load.skip_subsongs_init", including generated IT modules with long order lists.
+ *          Pattern formatting is measured for the per-cell functions and for format_pattern_block().
+ *          The peak resident set size of the process is reported after each group (on systems providing getrusage).
+ * Authors: OpenMPT Devs
+ * The OpenMPT source code is released under the BSD license. Read LICENSE for more details.
+ */
+
+#include "openmpt/all/BuildSettings.hpp"
+
+#include "libopenmpt.hpp"
+#include "libopenmpt_ext.hpp"
+
+#include "mpt/io_read/filedata_mmap.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <exception>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <iterator>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+
+#if MPT_IO_READ_FILEDATA_MMAP
+#include <fcntl.h>
+#include <unistd.h>
+#endif // MPT_IO_READ_FILEDATA_MMAP
+#if !MPT_OS_WINDOWS && !MPT_OS_DJGPP
+#include <sys/resource.h>
+#endif // !MPT_OS_WINDOWS && !MPT_OS_DJGPP
+
+namespace openmpt_bench {
+
+static double median_milliseconds( const std::function<void()> & f, int iterations ) {
+	std::vector<double> times;
+	times.reserve( iterations );
+	for ( int i = 0; i < iterations; ++i ) {
+		auto start = std::chrono::steady_clock::now();
+		f();
+		auto end = std::chrono::steady_clock::now();
+		times.push_back( std::chrono::duration<double, std::milli>( end - start ).count() );
+	}
+	std::sort( times.begin(), times.end() );
+	return times[ times.size() / 2 ];
+}
+
+static void report( const std::string & group, const std::string & name, const std::string & file, int iterations, double ms ) {
+	std::cout << group << "." << name << " " << file << " iterations=" << iterations << " median_ms=" << std::fixed << std::setprecision( 3 ) << ms << std::endl;
+}
+
+static void report_frames( const std::string & group, const std::string & name, const std::string & file, int iterations, double ms, std::size_t frames ) {
+	std::cout << group << "." << name << " " << file << " iterations=" << iterations << " median_ms=" << std::fixed << std::setprecision( 3 ) << ms << " frames_per_second=" << std::setprecision( 0 ) << ( frames / ( ms / 1000.0 ) ) << std::endl;
+}
+
+// Peak resident set size of the whole process so far, which includes all previous stages.
+static void report_peak_rss( const std::string & stage ) {
+#if !MPT_OS_WINDOWS && !MPT_OS_DJGPP
+	struct rusage usage = {};
+	if ( getrusage( RUSAGE_SELF, &usage ) == 0 ) {
+#if MPT_OS_MACOSX_OR_IOS
+		const long kib = usage.ru_maxrss / 1024;
+#else
+		const long kib = usage.ru_maxrss;
+#endif
+		std::cout << "memory.peak_rss " << stage << " kib=" << kib << std::endl;
+	}
+#else
+	static_cast<void>( stage );
+#endif // !MPT_OS_WINDOWS && !MPT_OS_DJGPP
+}
+
+// Loading through std::istream goes through the buffered seekable stream FileData backend.
+static void load_istream( const std::string & filename, const std::map<std::string, std::string> & ctls = {} ) {
+	std::ifstream stream( filename, std::ios::binary );
+	std::ostringstream log;
+	openmpt::module mod( stream, log, ctls );
+}
+
+// Only reads the metadata, which is what a file browser or media library scanner needs.
+static void load_module_info( const std::string & filename ) {
+	std::ifstream stream( filename, std::ios::binary );
+	std::ostringstream log;
+	openmpt::module_info info( stream, log );
+}
+
+// module_info must report the same metadata as a fully loaded module.
+static void check_module_info( const std::string & filename ) {
+	std::ifstream stream( filename, std::ios::binary );
+	std::ostringstream log;
+	openmpt::module mod( stream, log );
+	stream.clear();
+	stream.seekg( 0 );
+	openmpt::module_info info( stream, log );
+	for ( const auto & key : mod.get_metadata_keys() ) {
+		if ( key != "warnings" && info.get_metadata( key ) != mod.get_metadata( key ) ) {
+			throw std::runtime_error( "module_info metadata mismatch for " + key + " in " + filename );
+		}
+	}
+}
+
+#if MPT_IO_READ_FILEDATA_MMAP
+// Loading from a mapping hands libopenmpt a pinned view of the whole file without any intermediate copy.
+static void load_mmap( const std::string & filename ) {
+	int fd = open( filename.c_str(), O_RDONLY | O_CLOEXEC );
+	if ( fd < 0 ) {
+		throw std::runtime_error( "cannot open " + filename );
+	}
+	std::shared_ptr<const mpt::IO::FileDataMapped> mapping = mpt::IO::FileDataMapped::Map( fd );
+	close( fd );
+	if ( !mapping ) {
+		throw std::runtime_error( "cannot map " + filename );
+	}
+	std::ostringstream log;
+	openmpt::module mod( mapping->GetRawData(), mapping->GetLength(), log );
+}
+#endif // MPT_IO_READ_FILEDATA_MMAP
+
+static void bench_load( const std::vector<std::string> & files, int iterations, const std::string & subsongs_cache ) {
+	for ( const auto & filename : files ) {
+		report( "load", "istream", filename, iterations, median_milliseconds( [&]() { load_istream( filename ); }, iterations ) );
+		check_module_info( filename );
+		report( "load", "module_info", filename, iterations, median_milliseconds( [&]() { load_module_info( filename ); }, iterations ) );
+#if MPT_IO_READ_FILEDATA_MMAP
+		report( "load", "mmap", filename, iterations, median_milliseconds( [&]() { load_mmap( filename ); }, iterations ) );
+#endif // MPT_IO_READ_FILEDATA_MMAP
+		if ( !subsongs_cache.empty() ) {
+			// The first iteration populates the cache, the median is taken from the cached loads.
+			const std::map<std::string, std::string> ctls = { { "load.subsongs_cache_directory", subsongs_cache } };
+			report( "load", "subsongs_cache", filename, iterations, median_milliseconds( [&]() { load_istream( filename, ctls ); }, iterations ) );
+		}
+	}
+}
+
+// Little-endian writer for building modules in memory.
+class module_writer {
+private:
+	std::vector<char> & data;
+public:
+	explicit module_writer( std::vector<char> & data_ ) : data( data_ ) { }
+	std::size_t size() const { return data.size(); }
+	void u8( std::uint32_t value ) { data.push_back( static_cast<char>( value & 0xff ) ); }
+	void u16( std::uint32_t value ) { u8( value ); u8( value >> 8 ); }
+	void u32( std::uint32_t value ) { u16( value ); u16( value >> 16 ); }
+	void bytes( const char * str, std::size_t count ) { data.insert( data.end(), str, str + count ); }
+	void zeros( std::size_t count ) { data.insert( data.end(), count, 0 ); }
+	void patch_u32( std::size_t offset, std::uint32_t value ) {
+		for ( std::size_t i = 0; i < 4; ++i ) {
+			data[ offset + i ] = static_cast<char>( ( value >> ( i * 8 ) ) & 0xff );
+		}
+	}
+};
+
+// Settings for generated IT stress modules.
+// Each channel triggers a note every note_interval rows. Channels start at different rows, so most of them are at different envelope positions.
+struct generated_module {
+	std::string title;
+	std::uint32_t num_channels = 32;
+	std::uint8_t nna = 0;  // New note action of all instruments (0 = cut, 1 = continue, 2 = note off, 3 = note fade)
+	std::uint16_t fadeout = 0;
+	bool filter_envelopes = false;  // Resonant instruments with looping filter envelopes
+	std::uint32_t note_interval = 16;
+	std::vector<std::uint32_t> plugins;  // IDs of DMO plugins. The channels are routed to the plugins round-robin.
+	std::uint32_t num_orders = 1;  // Number of orders playing the pattern
+	std::uint32_t subsong_orders = 0;  // If not 0, every subsong_orders orders are followed by an end-of-song marker, which makes each part a separate sub-song
+	bool pattern_loop = false;  // The first 16 rows of the pattern are played twice (SB0 / SB1 on the first channel)
+};
+
+static const std::uint32_t dmo_magic = 0x44584D4Fu;  // 'DXMO'
+
+static std::vector<char> make_module( const generated_module & settings ) {
+	const std::uint32_t num_channels = settings.num_channels;
+	const std::uint32_t num_instruments = 4;
+	const std::uint32_t num_rows = 64;
+	const std::uint32_t sample_length = 2000;
+	std::vector<std::uint8_t> orders;
+	for ( std::uint32_t ord = 0; ord < settings.num_orders; ++ord ) {
+		if ( settings.subsong_orders && ord && ord % settings.subsong_orders == 0 ) {
+			orders.push_back( 255 );
+		}
+		orders.push_back( 0 );
+	}
+	orders.push_back( 255 );
+	std::vector<char> data;
+	module_writer w( data );
+
+	// Header
+	w.bytes( "IMPM", 4 );
+	w.bytes( settings.title.c_str(), std::min( settings.title.size(), std::size_t( 26 ) ) );
+	w.zeros( 26 - std::min( settings.title.size(), std::size_t( 26 ) ) );
+	w.u16( 0x1004 );  // pattern highlight
+	w.u16( static_cast<std::uint32_t>( orders.size() ) );
+	w.u16( num_instruments );
+	w.u16( 1 );  // samples
+	w.u16( 1 );  // patterns
+	w.u16( 0x0214 );  // created with
+	w.u16( 0x0214 );  // compatible with
+	w.u16( 0x01 | 0x04 | 0x08 );  // stereo, instruments, linear slides
+	w.u16( 0 );  // special
+	w.u8( 128 );  // global volume
+	w.u8( 48 );  // mix volume
+	w.u8( 3 );  // speed
+	w.u8( 200 );  // tempo
+	w.u8( 128 );  // separation
+	w.u8( 0 );  // pitch wheel depth
+	w.u16( 0 );  // message length
+	w.u32( 0 );  // message offset
+	w.u32( 0 );  // reserved
+	for ( std::uint32_t chn = 0; chn < 64; ++chn ) {
+		w.u8( chn < num_channels ? ( chn * 64 / num_channels ) : ( 32 | 128 ) );
+	}
+	for ( std::uint32_t chn = 0; chn < 64; ++chn ) {
+		w.u8( 64 );
+	}
+	for ( const auto ord : orders ) {
+		w.u8( ord );
+	}
+	const std::size_t offsets = w.size();
+	w.zeros( ( num_instruments + 2 ) * 4 );
+
+	// Plugins
+	if ( !settings.plugins.empty() ) {
+		w.bytes( "CHFX", 4 );
+		w.u32( num_channels * 4 );
+		for ( std::uint32_t chn = 0; chn < num_channels; ++chn ) {
+			w.u32( chn % settings.plugins.size() + 1 );
+		}
+		for ( std::size_t plug = 0; plug < settings.plugins.size(); ++plug ) {
+			const char code[] = { 'F', 'X', static_cast<char>( '0' + plug / 10 ), static_cast<char>( '0' + plug % 10 ) };
+			w.bytes( code, 4 );
+			w.u32( 128 + 4 + 4 );
+			w.u32( dmo_magic );
+			w.u32( settings.plugins[ plug ] );
+			w.u8( 0 );  // routing flags
+			w.u8( 0 );  // mix mode
+			w.u8( 10 );  // gain
+			w.u8( 0 );
+			w.u32( 0 );  // output routing
+			w.zeros( 16 + 32 + 64 );
+			w.u32( 0 );  // plugin data: default parameters
+			w.u32( 0 );  // modular data
+		}
+	}
+
+	// Instruments
+	for ( std::uint32_t ins = 0; ins < num_instruments; ++ins ) {
+		w.patch_u32( offsets + ins * 4, static_cast<std::uint32_t>( w.size() ) );
+		w.bytes( "IMPI", 4 );
+		w.zeros( 13 );
+		w.u8( settings.nna );  // NNA
+		w.u8( 0 );  // DCT
+		w.u8( 0 );  // DCA
+		w.u16( settings.fadeout );  // fadeout
+		w.u8( 0 );  // pitch-pan separation
+		w.u8( 60 );  // pitch-pan center
+		w.u8( 128 );  // global volume
+		w.u8( 32 | 128 );  // default pan (off)
+		w.u8( 0 );  // random volume
+		w.u8( 0 );  // random pan
+		w.u16( 0x0214 );  // tracker version
+		w.u8( 1 );  // number of samples
+		w.u8( 0 );
+		w.zeros( 26 );  // name
+		w.u8( settings.filter_envelopes ? ( 0x80 | ( 60 + ins * 16 ) ) : 0 );  // initial filter cutoff
+		w.u8( settings.filter_envelopes ? ( 0x80 | ( 64 + ins * 16 ) ) : 0 );  // initial filter resonance
+		w.u8( 0 );  // MIDI channel
+		w.u8( 0xff );  // MIDI program
+		w.u16( 0xffff );  // MIDI bank
+		for ( std::uint32_t note = 0; note < 120; ++note ) {
+			w.u8( note );
+			w.u8( 1 );
+		}
+		// Volume and panning envelopes are disabled
+		for ( int env = 0; env < 2; ++env ) {
+			w.u8( 0 );
+			w.u8( 2 );
+			w.zeros( 4 );
+			w.u8( env == 0 ? 64 : 0 );
+			w.u16( 0 );
+			w.u8( env == 0 ? 64 : 0 );
+			w.u16( 100 );
+			w.zeros( 82 - 12 );
+		}
+		// Looping filter envelope
+		const std::int8_t values[] = { -32, 32, 0, -24 };
+		w.u8( settings.filter_envelopes ? ( 0x80 | 0x02 | 0x01 ) : 0 );
+		w.u8( 4 );
+		w.u8( 0 );  // loop start
+		w.u8( 3 );  // loop end
+		w.u8( 0 );  // sustain start
+		w.u8( 0 );  // sustain end
+		for ( std::uint32_t node = 0; node < 4; ++node ) {
+			w.u8( static_cast<std::uint8_t>( values[ ( node + ins ) % 4 ] ) );
+			w.u16( node * ( 10 + ins * 7 ) );
+		}
+		w.zeros( 82 - 6 - 4 * 3 );
+		w.zeros( 4 );
+	}
+
+	// Sample header
+	w.patch_u32( offsets + num_instruments * 4, static_cast<std::uint32_t>( w.size() ) );
+	const std::size_t sample_header = w.size();
+	w.bytes( "IMPS", 4 );
+	w.zeros( 13 );
+	w.u8( 64 );  // global volume
+	w.u8( 0x01 | 0x10 );  // sample present, loop
+	w.u8( 64 );  // volume
+	w.zeros( 26 );  // name
+	w.u8( 0x01 );  // signed
+	w.u8( 32 );  // default pan (off)
+	w.u32( sample_length );
+	w.u32( 0 );  // loop start
+	w.u32( sample_length );  // loop end
+	w.u32( 8363 );
+	w.u32( 0 );  // sustain loop start
+	w.u32( 0 );  // sustain loop end
+	w.u32( 0 );  // sample data offset, filled in below
+	w.zeros( 4 );  // vibrato
+
+	// Pattern: every 16 rows, each channel triggers a note
+	w.patch_u32( offsets + ( num_instruments + 1 ) * 4, static_cast<std::uint32_t>( w.size() ) );
+	std::vector<char> packed;
+	module_writer p( packed );
+	for ( std::uint32_t row = 0; row < num_rows; ++row ) {
+		for ( std::uint32_t chn = 0; chn < num_channels; ++chn ) {
+			const bool note = ( chn % settings.note_interval == row % settings.note_interval );
+			const bool loop = ( settings.pattern_loop && chn == 0 && ( row == 0 || row == 15 ) );
+			if ( note || loop ) {
+				p.u8( ( chn + 1 ) | 0x80 );
+				p.u8( ( note ? ( 0x01 | 0x02 ) : 0 ) | ( loop ? 0x08 : 0 ) );  // note, instrument, effect
+				if ( note ) {
+					p.u8( 48 + ( chn * 5 ) % 24 );
+					p.u8( chn % num_instruments + 1 );
+				}
+				if ( loop ) {
+					p.u8( 19 );  // S
+					p.u8( row == 0 ? 0xB0 : 0xB1 );
+				}
+			}
+		}
+		p.u8( 0 );
+	}
+	w.u16( static_cast<std::uint32_t>( packed.size() ) );
+	w.u16( num_rows );
+	w.zeros( 4 );
+	w.bytes( packed.data(), packed.size() );
+
+	// Sample data: noise from a linear congruential generator
+	w.patch_u32( sample_header + 72, static_cast<std::uint32_t>( w.size() ) );
+	std::uint32_t lcg = 12345;
+	for ( std::uint32_t i = 0; i < sample_length; ++i ) {
+		lcg = lcg * 1103515245u + 12345u;
+		w.u8( lcg >> 24 );
+	}
+	return data;
+}
+
+// Stress modules for the parts of the mixer that the test modules barely use
+static std::vector<std::pair<std::string, std::vector<char>>> make_stress_modules() {
+	std::vector<std::pair<std::string, std::vector<char>>> modules;
+	{
+		// 32 channels with resonant filter envelopes
+		generated_module settings;
+		settings.title = "filter envelopes";
+		settings.filter_envelopes = true;
+		modules.emplace_back( "generated:filter_envelopes.it", make_module( settings ) );
+	}
+	{
+		// 64 channels with slowly fading background notes, which keeps all mixing channels busy
+		generated_module settings;
+		settings.title = "new note actions";
+		settings.num_channels = 64;
+		settings.nna = 3;
+		settings.fadeout = 8;
+		settings.note_interval = 4;
+		modules.emplace_back( "generated:nna.it", make_module( settings ) );
+	}
+	{
+		// 18 channels routed to all DMO plugins
+		generated_module settings;
+		settings.title = "dmo plugins";
+		settings.num_channels = 18;
+		settings.note_interval = 8;
+		settings.plugins = {
+			0xEFE6629Cu,  // Chorus
+			0xEF011F79u,  // Compressor
+			0xEF114C90u,  // Distortion
+			0xEF3E932Cu,  // Echo
+			0xEFCA3D92u,  // Flanger
+			0xDAFD8210u,  // Gargle
+			0xEF985E71u,  // I3DL2Reverb
+			0x120CED89u,  // ParamEq
+			0x87FC0268u,  // WavesReverb
+		};
+		modules.emplace_back( "generated:dmo_plugins.it", make_module( settings ) );
+	}
+	{
+		// One very long song
+		generated_module settings;
+		settings.title = "long order list";
+		settings.num_channels = 8;
+		settings.num_orders = 4000;
+		settings.pattern_loop = true;
+		modules.emplace_back( "generated:orders.it", make_module( settings ) );
+	}
+	{
+		// Many short sub-songs, each of them is walked separately when discovering sub-songs
+		generated_module settings;
+		settings.title = "many subsongs";
+		settings.num_channels = 8;
+		settings.num_orders = 4000;
+		settings.subsong_orders = 8;
+		modules.emplace_back( "generated:subsongs.it", make_module( settings ) );
+	}
+	return modules;
+}
+
+static const std::int32_t render_samplerate = 48000;
+static const std::int32_t render_samplerates[] = { 22050, 44100, 96000 };
+static const std::int32_t render_filter_lengths[] = { 1, 2, 4, 8 };  // no interpolation, linear, cubic, windowed sinc
+static const std::size_t render_block_frames = 1024;
+static const double render_seconds = 10.0;
+
+// Each iteration renders the same amount of audio. The module loops, so the amount does not depend on the song length.
+static double render_planar( openmpt::module & mod, std::int32_t samplerate, int iterations, std::size_t & frames_rendered ) {
+	std::vector<float> left( render_block_frames ), right( render_block_frames );
+	const std::size_t render_frames = static_cast<std::size_t>( samplerate * render_seconds );
+	frames_rendered = render_frames;
+	return median_milliseconds( [&]() {
+		for ( std::size_t frames = 0; frames < render_frames; frames += render_block_frames ) {
+			mod.read( samplerate, render_block_frames, left.data(), right.data() );
+		}
+	}, iterations );
+}
+
+static void bench_render( const std::string & filename, const std::vector<char> & data, int iterations ) {
+	std::size_t render_frames = 0;
+	{
+		std::ostringstream log;
+		openmpt::module mod( data, log );
+		mod.set_repeat_count( -1 );
+		const double ms = render_planar( mod, render_samplerate, iterations, render_frames );
+		report_frames( "render", "planar_float", filename, iterations, ms, render_frames );
+	}
+	{
+		std::vector<float> interleaved( render_block_frames * 2 );
+		std::ostringstream log;
+		openmpt::module mod( data, log );
+		mod.set_repeat_count( -1 );
+		report_frames( "render", "interleaved_stereo_float", filename, iterations, median_milliseconds( [&]() {
+			for ( std::size_t frames = 0; frames < render_frames; frames += render_block_frames ) {
+				mod.read_interleaved_stereo( render_samplerate, render_block_frames, interleaved.data() );
+			}
+		}, iterations ), render_frames );
+	}
+	for ( const auto samplerate : render_samplerates ) {
+		std::ostringstream log;
+		openmpt::module mod( data, log );
+		mod.set_repeat_count( -1 );
+		const double ms = render_planar( mod, samplerate, iterations, render_frames );
+		report_frames( "render", "samplerate_" + std::to_string( samplerate ), filename, iterations, ms, render_frames );
+	}
+	for ( const auto filter_length : render_filter_lengths ) {
+		std::ostringstream log;
+		openmpt::module mod( data, log );
+		mod.set_repeat_count( -1 );
+		mod.set_render_param( openmpt::module::RENDER_INTERPOLATIONFILTER_LENGTH, filter_length );
+		const double ms = render_planar( mod, render_samplerate, iterations, render_frames );
+		report_frames( "render", "interpolation_" + std::to_string( filter_length ), filename, iterations, ms, render_frames );
+	}
+}
+
+#ifdef LIBOPENMPT_EXT_INTERFACE_PROFILING
+// Where the rendering time of one iteration goes
+static void bench_profile( const std::string & filename, const std::vector<char> & data ) {
+	std::ostringstream log;
+	openmpt::module_ext mod( data, log );
+	openmpt::ext::profiling * profiling = static_cast<openmpt::ext::profiling *>( mod.get_interface( openmpt::ext::profiling_id ) );
+	if ( !profiling ) {
+		return;
+	}
+	mod.set_repeat_count( -1 );
+	std::vector<float> left( render_block_frames ), right( render_block_frames );
+	const std::size_t render_frames = static_cast<std::size_t>( render_samplerate * render_seconds );
+	profiling->set_profiling_enabled( true );
+	for ( std::size_t frames = 0; frames < render_frames; frames += render_block_frames ) {
+		mod.read( render_samplerate, render_block_frames, left.data(), right.data() );
+	}
+	const openmpt::ext::profiling::snapshot snapshot = profiling->get_profiling_snapshot();
+	static const char * const stage_names[] = { "read_note", "create_stereo_mix", "opl", "reverb", "plugins", "dsp", "output" };
+	static const char * const resampler_names[] = { "nearest", "linear", "cubic", "sinc8_lowpass", "sinc8", "amiga" };
+	std::cout << "profile.stages " << filename << std::fixed << std::setprecision( 3 );
+	for ( std::size_t i = 0; i < openmpt::ext::profiling::num_stages; ++i ) {
+		std::cout << " " << stage_names[i] << "_calls=" << snapshot.stage_calls[i] << " " << stage_names[i] << "_ms=" << ( snapshot.stage_seconds[i] * 1000.0 );
+	}
+	std::cout << std::endl;
+	std::cout << "profile.resampler_frames " << filename;
+	for ( std::size_t i = 0; i < openmpt::ext::profiling::num_resamplers; ++i ) {
+		std::cout << " " << resampler_names[i] << "=" << snapshot.resampler_frames[i];
+	}
+	std::cout << std::endl;
+}
+#endif // LIBOPENMPT_EXT_INTERFACE_PROFILING
+
+// Seeks to a different position in every iteration, so that each seek has to process a different amount of the song.
+static void bench_seek( const std::string & filename, const std::vector<char> & data, int iterations ) {
+	std::ostringstream log;
+	openmpt::module mod( data, log );
+	const double duration = mod.get_duration_seconds();
+	const int positions = 8;
+	int iteration = 0;
+	report( "seek", "position_seconds", filename, iterations, median_milliseconds( [&]() {
+		mod.set_position_seconds( duration * ( ( iteration++ % positions ) + 0.5 ) / positions );
+	}, iterations ) );
+}
+
+// Without initialized sub-songs, every call has to walk through the whole module again.
+static void bench_subsongs( const std::string & filename, const std::vector<char> & data, int iterations ) {
+	std::ostringstream log;
+	openmpt::module mod( data, log, { { "load.skip_subsongs_init", "1" } } );
+	report( "subsongs", "get_subsongs", filename, iterations, median_milliseconds( [&]() { mod.get_num_subsongs(); }, iterations ) );
+}
+
+static void bench_render( const std::vector<std::string> & files, int iterations ) {
+	std::vector<std::pair<std::string, std::vector<char>>> modules;
+	for ( const auto & filename : files ) {
+		std::ifstream stream( filename, std::ios::binary );
+		modules.emplace_back( filename, std::vector<char>( ( std::istreambuf_iterator<char>( stream ) ), std::istreambuf_iterator<char>() ) );
+	}
+	for ( auto & generated : make_stress_modules() ) {
+		modules.push_back( std::move( generated ) );
+	}
+	for ( const auto & [ filename, data ] : modules ) {
+		bench_render( filename, data, iterations );
+#ifdef LIBOPENMPT_EXT_INTERFACE_PROFILING
+		bench_profile( filename, data );
+#endif // LIBOPENMPT_EXT_INTERFACE_PROFILING
+		bench_seek( filename, data, iterations );
+		bench_subsongs( filename, data, iterations );
+	}
+}
+
+static const std::size_t pattern_cell_width = 13;
+
+// Formats all patterns the way a pattern visualization would, once per cell and once per pattern.
+static void bench_pattern_format( const std::string & filename, int iterations ) {
+	std::ifstream stream( filename, std::ios::binary );
+	std::ostringstream log;
+	openmpt::module mod( stream, log );
+	const std::int32_t num_patterns = mod.get_num_patterns();
+	const std::int32_t num_channels = mod.get_num_channels();
+	std::size_t max_cells = 0;
+	for ( std::int32_t p = 0; p < num_patterns; ++p ) {
+		max_cells = std::max( max_cells, static_cast<std::size_t>( mod.get_pattern_num_rows( p ) ) * num_channels );
+	}
+	std::string per_cell_text, per_cell_highlight;
+	std::vector<char> text( max_cells * pattern_cell_width ), highlight( max_cells * pattern_cell_width );
+	report( "pattern_format", "per_cell", filename, iterations, median_milliseconds( [&]() {
+		for ( std::int32_t p = 0; p < num_patterns; ++p ) {
+			per_cell_text.clear();
+			per_cell_highlight.clear();
+			for ( std::int32_t r = 0; r < mod.get_pattern_num_rows( p ); ++r ) {
+				for ( std::int32_t c = 0; c < num_channels; ++c ) {
+					per_cell_text += mod.format_pattern_row_channel( p, r, c, pattern_cell_width, true );
+					per_cell_highlight += mod.highlight_pattern_row_channel( p, r, c, pattern_cell_width, true );
+				}
+			}
+		}
+	}, iterations ) );
+	report( "pattern_format", "block", filename, iterations, median_milliseconds( [&]() {
+		for ( std::int32_t p = 0; p < num_patterns; ++p ) {
+			mod.format_pattern_block( p, 0, mod.get_pattern_num_rows( p ), 0, num_channels, pattern_cell_width, text.data(), highlight.data(), text.size() );
+		}
+	}, iterations ) );
+	// Both variants must produce the same output
+	for ( std::int32_t p = 0; p < num_patterns; ++p ) {
+		per_cell_text.clear();
+		per_cell_highlight.clear();
+		for ( std::int32_t r = 0; r < mod.get_pattern_num_rows( p ); ++r ) {
+			for ( std::int32_t c = 0; c < num_channels; ++c ) {
+				per_cell_text += mod.format_pattern_row_channel( p, r, c, pattern_cell_width, true );
+				per_cell_highlight += mod.highlight_pattern_row_channel( p, r, c, pattern_cell_width, true );
+			}
+		}
+		const std::size_t written = mod.format_pattern_block( p, 0, mod.get_pattern_num_rows( p ), 0, num_channels, pattern_cell_width, text.data(), highlight.data(), text.size() );
+		if ( written != per_cell_text.size() || per_cell_text.compare( 0, written, text.data(), written ) != 0 || per_cell_highlight.compare( 0, written, highlight.data(), written ) != 0 ) {
+			throw std::runtime_error( "pattern block formatting differs from per-cell formatting in " + filename );
+		}
+	}
+}
+
+static void bench_pattern_format( const std::vector<std::string> & files, int iterations ) {
+	for ( const auto & filename : files ) {
+		bench_pattern_format( filename, iterations );
+	}
+}
+
+} // namespace openmpt_bench
+
+int main( int argc, char * argv [] ) {
+	try {
+		int iterations = 20;
+		std::string subsongs_cache;
+		std::vector<std::string> files;
+		for ( int i = 1; i < argc; ++i ) {
+			std::string arg = argv[i];
+			if ( arg == "--iterations" && i + 1 < argc ) {
+				iterations = std::max( 1, std::atoi( argv[++i] ) );
+			} else if ( arg == "--subsongs-cache" && i + 1 < argc ) {
+				subsongs_cache = argv[++i];
+			} else {
+				files.push_back( arg );
+			}
+		}
+		if ( files.empty() ) {
+			files = { "test/test.mptm", "test/test.xm", "test/test.s3m", "test/test.mod" };
+		}
+		openmpt_bench::bench_load( files, iterations, subsongs_cache );
+		openmpt_bench::report_peak_rss( "load" );
+		openmpt_bench::bench_render( files, iterations );
+		openmpt_bench::report_peak_rss( "render" );
+		openmpt_bench::bench_pattern_format( files, iterations );
+		openmpt_bench::report_peak_rss( "pattern_format" );
+	} catch ( const std::exception & e ) {
+		std::cerr << "BENCH ERROR: exception: " << ( e.what() ? e.what() : "" ) << std::endl;
+		return -1;
+	} catch ( ... ) {
+		std::cerr << "BENCH ERROR: unknown exception" << std::endl;
+		return -1;
+	}
+	return 0;
+}
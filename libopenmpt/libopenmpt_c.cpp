@@ -208,6 +208,14 @@ struct openmpt_module_ext {
 	openmpt::module_ext_impl * impl;
 };
 
+struct openmpt_module_info {
+	openmpt_log_func logfunc;
+	void * loguser;
+	openmpt_error_func errfunc;
+	void * erruser;
+	openmpt::module_info_impl * impl;
+};
+
 } // extern "C"
 
 namespace openmpt {
@@ -261,6 +269,10 @@ static void report_exception( const char * const function, openmpt_log_func cons
 	do_report_exception( function, logfunc, loguser, errfunc, erruser, 0, 0, error, error_message );
 }
 
+static void report_exception( const char * const function, openmpt_module_info * info ) {
+	do_report_exception( function, info ? info->logfunc : NULL, info ? info->loguser : NULL, info ? info->errfunc : NULL, info ? info->erruser : NULL );
+}
+
 namespace interface {
 
 template < typename T >
@@ -1281,6 +1293,16 @@ const char * openmpt_module_highlight_pattern_row_channel( openmpt_module * mod,
 	return 0;
 }
 
+size_t openmpt_module_format_pattern_block( openmpt_module * mod, int32_t pattern, int32_t first_row, int32_t num_rows, int32_t first_channel, int32_t num_channels, size_t width, char * text, char * highlight, size_t size ) {
+	try {
+		openmpt::interface::check_soundfile( mod );
+		return mod->impl->format_and_highlight_pattern_block( pattern, first_row, num_rows, first_channel, num_channels, width, text, highlight, size );
+	} catch ( ... ) {
+		openmpt::report_exception( __func__, mod );
+	}
+	return 0;
+}
+
 const char * openmpt_module_get_ctls( openmpt_module * mod ) {
 	try {
 		openmpt::interface::check_soundfile( mod );
@@ -1411,6 +1433,92 @@ int openmpt_module_ctl_set_text( openmpt_module * mod, const char * ctl, const c
 	return 0;
 }
 
+openmpt_module_info * openmpt_module_info_create( openmpt_stream_callbacks stream_callbacks, void * stream, openmpt_log_func logfunc, void * loguser, openmpt_error_func errfunc, void * erruser, int * error, const char * * error_message ) {
+	openmpt_module_info * info = NULL;
+	try {
+		info = (openmpt_module_info*)std::calloc( 1, sizeof( openmpt_module_info ) );
+		if ( !info ) {
+			throw std::bad_alloc();
+		}
+		info->logfunc = logfunc ? logfunc : openmpt_log_func_default;
+		info->loguser = loguser;
+		info->errfunc = errfunc ? errfunc : NULL;
+		info->erruser = erruser;
+		openmpt::callback_stream_wrapper istream = { stream, stream_callbacks.read, stream_callbacks.seek, stream_callbacks.tell };
+		info->impl = new openmpt::module_info_impl( istream, openmpt::helper::make_unique<openmpt::logfunc_logger>( info->logfunc, info->loguser ) );
+		return info;
+	} catch ( ... ) {
+		openmpt::report_exception( __func__, logfunc, loguser, errfunc, erruser, error, error_message );
+	}
+	std::free( (void*)info );
+	return NULL;
+}
+
+openmpt_module_info * openmpt_module_info_create_from_memory( const void * filedata, size_t filesize, openmpt_log_func logfunc, void * loguser, openmpt_error_func errfunc, void * erruser, int * error, const char * * error_message ) {
+	openmpt_module_info * info = NULL;
+	try {
+		info = (openmpt_module_info*)std::calloc( 1, sizeof( openmpt_module_info ) );
+		if ( !info ) {
+			throw std::bad_alloc();
+		}
+		info->logfunc = logfunc ? logfunc : openmpt_log_func_default;
+		info->loguser = loguser;
+		info->errfunc = errfunc ? errfunc : NULL;
+		info->erruser = erruser;
+		info->impl = new openmpt::module_info_impl( filedata, filesize, openmpt::helper::make_unique<openmpt::logfunc_logger>( info->logfunc, info->loguser ) );
+		return info;
+	} catch ( ... ) {
+		openmpt::report_exception( __func__, logfunc, loguser, errfunc, erruser, error, error_message );
+	}
+	std::free( (void*)info );
+	return NULL;
+}
+
+void openmpt_module_info_destroy( openmpt_module_info * info ) {
+	try {
+		openmpt::interface::check_soundfile( info );
+		delete info->impl;
+		info->impl = 0;
+		std::free( (void*)info );
+		info = NULL;
+		return;
+	} catch ( ... ) {
+		openmpt::report_exception( __func__, info );
+	}
+	return;
+}
+
+const char * openmpt_module_info_get_metadata_keys( openmpt_module_info * info ) {
+	try {
+		openmpt::interface::check_soundfile( info );
+		std::string retval;
+		bool first = true;
+		std::vector<std::string> metadata_keys = info->impl->get_metadata_keys();
+		for ( std::vector<std::string>::iterator i = metadata_keys.begin(); i != metadata_keys.end(); ++i ) {
+			if ( first ) {
+				first = false;
+			} else {
+				retval += ";";
+			}
+			retval += *i;
+		}
+		return openmpt::strdup( retval.c_str() );
+	} catch ( ... ) {
+		openmpt::report_exception( __func__, info );
+	}
+	return NULL;
+}
+const char * openmpt_module_info_get_metadata( openmpt_module_info * info, const char * key ) {
+	try {
+		openmpt::interface::check_soundfile( info );
+		openmpt::interface::check_pointer( key );
+		return openmpt::strdup( info->impl->get_metadata( key ).c_str() );
+	} catch ( ... ) {
+		openmpt::report_exception( __func__, info );
+	}
+	return NULL;
+}
+
 openmpt_module_ext * openmpt_module_ext_create( openmpt_stream_callbacks stream_callbacks, void * stream, openmpt_log_func logfunc, void * loguser, openmpt_error_func errfunc, void * erruser, int * error, const char * * error_message, const openmpt_module_initial_ctl * ctls ) {
 	try {
 		openmpt_module_ext * mod_ext = (openmpt_module_ext*)std::calloc( 1, sizeof( openmpt_module_ext ) );
@@ -1808,6 +1916,58 @@ static int set_current_tempo2( openmpt_module_ext * mod_ext, double tempo ) {
 
 
 
+static int set_profiling_enabled( openmpt_module_ext * mod_ext, int enabled ) {
+	try {
+		openmpt::interface::check_soundfile( mod_ext );
+		mod_ext->impl->set_profiling_enabled( enabled ? true : false );
+		return 1;
+	} catch ( ... ) {
+		openmpt::report_exception( __func__, mod_ext ? &mod_ext->mod : NULL );
+	}
+	return 0;
+}
+static int get_profiling_enabled( openmpt_module_ext * mod_ext ) {
+	try {
+		openmpt::interface::check_soundfile( mod_ext );
+		return mod_ext->impl->get_profiling_enabled() ? 1 : 0;
+	} catch ( ... ) {
+		openmpt::report_exception( __func__, mod_ext ? &mod_ext->mod : NULL );
+	}
+	return 0;
+}
+static int reset_profiling( openmpt_module_ext * mod_ext ) {
+	try {
+		openmpt::interface::check_soundfile( mod_ext );
+		mod_ext->impl->reset_profiling();
+		return 1;
+	} catch ( ... ) {
+		openmpt::report_exception( __func__, mod_ext ? &mod_ext->mod : NULL );
+	}
+	return 0;
+}
+static_assert( OPENMPT_MODULE_EXT_INTERFACE_PROFILING_NUM_STAGES == openmpt::ext::profiling::num_stages );
+static_assert( OPENMPT_MODULE_EXT_INTERFACE_PROFILING_NUM_RESAMPLERS == openmpt::ext::profiling::num_resamplers );
+static int get_profiling_snapshot( openmpt_module_ext * mod_ext, openmpt_module_ext_profiling_snapshot * snapshot ) {
+	try {
+		openmpt::interface::check_soundfile( mod_ext );
+		openmpt::interface::check_pointer( snapshot );
+		const openmpt::ext::profiling::snapshot data = mod_ext->impl->get_profiling_snapshot();
+		for ( std::size_t i = 0; i < OPENMPT_MODULE_EXT_INTERFACE_PROFILING_NUM_STAGES; ++i ) {
+			snapshot->stage_calls[i] = data.stage_calls[i];
+			snapshot->stage_seconds[i] = data.stage_seconds[i];
+		}
+		for ( std::size_t i = 0; i < OPENMPT_MODULE_EXT_INTERFACE_PROFILING_NUM_RESAMPLERS; ++i ) {
+			snapshot->resampler_frames[i] = data.resampler_frames[i];
+		}
+		return 1;
+	} catch ( ... ) {
+		openmpt::report_exception( __func__, mod_ext ? &mod_ext->mod : NULL );
+	}
+	return 0;
+}
+
+
+
 /* add stuff here */
 
 
@@ -1873,6 +2033,18 @@ int openmpt_module_ext_get_interface( openmpt_module_ext * mod_ext, const char *
 
 
 
+#ifndef NO_RENDER_PROFILING
+		} else if ( !std::strcmp( interface_id, LIBOPENMPT_EXT_C_INTERFACE_PROFILING ) && ( interface_size == sizeof( openmpt_module_ext_interface_profiling ) ) ) {
+			openmpt_module_ext_interface_profiling * i = static_cast< openmpt_module_ext_interface_profiling * >( interface );
+			i->set_profiling_enabled = &set_profiling_enabled;
+			i->get_profiling_enabled = &get_profiling_enabled;
+			i->reset_profiling = &reset_profiling;
+			i->get_profiling_snapshot = &get_profiling_snapshot;
+			result = 1;
+#endif // NO_RENDER_PROFILING
+
+
+
 /* add stuff here */
 
 
@@ -406,6 +406,9 @@ std::string module::format_pattern_row_channel( std::int32_t pattern, std::int32
 std::string module::highlight_pattern_row_channel( std::int32_t pattern, std::int32_t row, std::int32_t channel, std::size_t width, bool pad ) const {
 	return impl->highlight_pattern_row_channel( pattern, row, channel, width, pad );
 }
+std::size_t module::format_pattern_block( std::int32_t pattern, std::int32_t first_row, std::int32_t num_rows, std::int32_t first_channel, std::int32_t num_channels, std::size_t width, char * text, char * highlight, std::size_t size ) const {
+	return impl->format_and_highlight_pattern_block( pattern, first_row, num_rows, first_channel, num_channels, width, text, highlight, size );
+}
 
 std::vector<std::string> module::get_ctls() const {
 	return impl->get_ctls();
@@ -443,6 +446,60 @@ void module::ctl_set_text( std::string_view ctl, std::string_view value ) {
 	impl->ctl_set_text( ctl, value );
 }
 
+#if defined(_MSC_VER)
+#pragma warning(push)
+#pragma warning(disable:4702) // unreachable code
+#endif // _MSC_VER
+
+module_info::module_info( const module_info & ) : impl(nullptr) {
+	throw exception("openmpt::module_info is non-copyable");
+}
+
+// cppcheck-suppress operatorEqVarError
+void module_info::operator = ( const module_info & ) {
+	throw exception("openmpt::module_info is non-copyable");
+}
+
+#if defined(_MSC_VER)
+#pragma warning(pop)
+#endif // _MSC_VER
+
+module_info::module_info( std::istream & stream, std::ostream & log ) : impl(0) {
+	impl = new module_info_impl( stream, openmpt::helper::make_unique<std_ostream_log>( log ) );
+}
+module_info::module_info( const std::vector<std::byte> & data, std::ostream & log ) : impl(0) {
+	impl = new module_info_impl( data.data(), data.size(), openmpt::helper::make_unique<std_ostream_log>( log ) );
+}
+module_info::module_info( const std::byte * data, std::size_t size, std::ostream & log ) : impl(0) {
+	impl = new module_info_impl( data, size, openmpt::helper::make_unique<std_ostream_log>( log ) );
+}
+module_info::module_info( const std::vector<std::uint8_t> & data, std::ostream & log ) : impl(0) {
+	impl = new module_info_impl( data.data(), data.size(), openmpt::helper::make_unique<std_ostream_log>( log ) );
+}
+module_info::module_info( const std::uint8_t * data, std::size_t size, std::ostream & log ) : impl(0) {
+	impl = new module_info_impl( data, size, openmpt::helper::make_unique<std_ostream_log>( log ) );
+}
+module_info::module_info( const std::vector<char> & data, std::ostream & log ) : impl(0) {
+	impl = new module_info_impl( data.data(), data.size(), openmpt::helper::make_unique<std_ostream_log>( log ) );
+}
+module_info::module_info( const char * data, std::size_t size, std::ostream & log ) : impl(0) {
+	impl = new module_info_impl( data, size, openmpt::helper::make_unique<std_ostream_log>( log ) );
+}
+module_info::module_info( const void * data, std::size_t size, std::ostream & log ) : impl(0) {
+	impl = new module_info_impl( data, size, openmpt::helper::make_unique<std_ostream_log>( log ) );
+}
+module_info::~module_info() {
+	delete impl;
+	impl = 0;
+}
+
+std::vector<std::string> module_info::get_metadata_keys() const {
+	return impl->get_metadata_keys();
+}
+std::string module_info::get_metadata( const std::string & key ) const {
+	return impl->get_metadata( key );
+}
+
 module_ext::module_ext( std::istream & stream, std::ostream & log, const std::map< std::string, std::string > & ctls ) : ext_impl(0) {
 	ext_impl = new module_ext_impl( stream, openmpt::helper::make_unique<std_ostream_log>( log ), ctls );
 	set_impl( ext_impl );
@@ -410,6 +410,80 @@ typedef struct openmpt_module_ext_interface_interactive3 {
 
 
 
+#ifndef LIBOPENMPT_EXT_C_INTERFACE_PROFILING
+#define LIBOPENMPT_EXT_C_INTERFACE_PROFILING "profiling"
+#endif
+
+/*! Rendering stages */
+#define OPENMPT_MODULE_EXT_INTERFACE_PROFILING_STAGE_READ_NOTE          0
+#define OPENMPT_MODULE_EXT_INTERFACE_PROFILING_STAGE_CREATE_STEREO_MIX  1
+#define OPENMPT_MODULE_EXT_INTERFACE_PROFILING_STAGE_OPL                2
+#define OPENMPT_MODULE_EXT_INTERFACE_PROFILING_STAGE_REVERB             3
+#define OPENMPT_MODULE_EXT_INTERFACE_PROFILING_STAGE_PLUGINS            4
+#define OPENMPT_MODULE_EXT_INTERFACE_PROFILING_STAGE_DSP                5
+#define OPENMPT_MODULE_EXT_INTERFACE_PROFILING_STAGE_OUTPUT             6
+#define OPENMPT_MODULE_EXT_INTERFACE_PROFILING_NUM_STAGES               7
+
+/*! Resampling kernels */
+#define OPENMPT_MODULE_EXT_INTERFACE_PROFILING_RESAMPLER_NEAREST        0
+#define OPENMPT_MODULE_EXT_INTERFACE_PROFILING_RESAMPLER_LINEAR         1
+#define OPENMPT_MODULE_EXT_INTERFACE_PROFILING_RESAMPLER_CUBIC          2
+#define OPENMPT_MODULE_EXT_INTERFACE_PROFILING_RESAMPLER_SINC8_LOWPASS  3
+#define OPENMPT_MODULE_EXT_INTERFACE_PROFILING_RESAMPLER_SINC8          4
+#define OPENMPT_MODULE_EXT_INTERFACE_PROFILING_RESAMPLER_AMIGA          5
+#define OPENMPT_MODULE_EXT_INTERFACE_PROFILING_NUM_RESAMPLERS           6
+
+/*! Profiling data collected since the last reset */
+typedef struct openmpt_module_ext_profiling_snapshot {
+	/*! Number of times each stage was executed (see OPENMPT_MODULE_EXT_INTERFACE_PROFILING_STAGE_*) */
+	uint64_t stage_calls[OPENMPT_MODULE_EXT_INTERFACE_PROFILING_NUM_STAGES];
+	/*! Cumulative time in seconds spent in each stage (see OPENMPT_MODULE_EXT_INTERFACE_PROFILING_STAGE_*) */
+	double stage_seconds[OPENMPT_MODULE_EXT_INTERFACE_PROFILING_NUM_STAGES];
+	/*! Number of sample frames rendered by each resampler, summed over all channels (see OPENMPT_MODULE_EXT_INTERFACE_PROFILING_RESAMPLER_*) */
+	uint64_t resampler_frames[OPENMPT_MODULE_EXT_INTERFACE_PROFILING_NUM_RESAMPLERS];
+} openmpt_module_ext_profiling_snapshot;
+
+typedef struct openmpt_module_ext_interface_profiling {
+
+	/*! Enable or disable profiling
+	 *
+	 * \param mod_ext The module handle to work on.
+	 * \param enabled 1 to profile rendering, 0 to stop profiling. Profiling is disabled by default.
+	 * \return 1 on success, 0 on failure.
+	 * \remarks While profiling is disabled, rendering is not slowed down by the profiler.
+	 * \since 0.7.0
+	 */
+	int ( * set_profiling_enabled ) ( openmpt_module_ext * mod_ext, int enabled );
+
+	/*! Check if profiling is enabled
+	 *
+	 * \param mod_ext The module handle to work on.
+	 * \return 1 if rendering is being profiled, 0 otherwise.
+	 * \since 0.7.0
+	 */
+	int ( * get_profiling_enabled ) ( openmpt_module_ext * mod_ext );
+
+	/*! Reset all profiling data to 0
+	 *
+	 * \param mod_ext The module handle to work on.
+	 * \return 1 on success, 0 on failure.
+	 * \since 0.7.0
+	 */
+	int ( * reset_profiling ) ( openmpt_module_ext * mod_ext );
+
+	/*! Get the profiling data collected since the last reset
+	 *
+	 * \param mod_ext The module handle to work on.
+	 * \param snapshot Pointer to a structure receiving the profiling data.
+	 * \return 1 on success, 0 on failure.
+	 * \since 0.7.0
+	 */
+	int ( * get_profiling_snapshot ) ( openmpt_module_ext * mod_ext, openmpt_module_ext_profiling_snapshot * snapshot );
+
+} openmpt_module_ext_interface_profiling;
+
+
+
 /* add stuff here */
 
 
@@ -410,6 +410,77 @@ class interactive3 {
 }; // class interactive3
 
 
+#ifndef LIBOPENMPT_EXT_INTERFACE_PROFILING
+#define LIBOPENMPT_EXT_INTERFACE_PROFILING
+#endif
+
+LIBOPENMPT_DECLARE_EXT_CXX_INTERFACE(profiling)
+
+class profiling {
+
+	LIBOPENMPT_EXT_CXX_INTERFACE(profiling)
+
+	//! Rendering stages
+	enum stage {
+		stage_read_note = 0, //!< Pattern and tick processing
+		stage_create_stereo_mix = 1, //!< Sample mixing
+		stage_opl = 2, //!< OPL synthesis
+		stage_reverb = 3, //!< Built-in reverb
+		stage_plugins = 4, //!< Plugin processing
+		stage_dsp = 5, //!< Built-in DSP effects
+		stage_output = 6, //!< Conversion to the output format
+		num_stages = 7
+	}; // enum stage
+
+	//! Resampling kernels
+	enum resampler {
+		resampler_nearest = 0, //!< No interpolation
+		resampler_linear = 1, //!< Linear interpolation
+		resampler_cubic = 2, //!< Cubic interpolation
+		resampler_sinc8_lowpass = 3, //!< Windowed sinc with low-pass filter
+		resampler_sinc8 = 4, //!< Windowed sinc
+		resampler_amiga = 5, //!< Amiga BLEP synthesis
+		num_resamplers = 6
+	}; // enum resampler
+
+	//! Profiling data collected since the last reset
+	struct snapshot {
+		std::uint64_t stage_calls[num_stages]; //!< Number of times each stage was executed
+		double stage_seconds[num_stages]; //!< Cumulative time spent in each stage
+		std::uint64_t resampler_frames[num_resamplers]; //!< Number of sample frames rendered by each resampler, summed over all channels
+	}; // struct snapshot
+
+	//! Enable or disable profiling
+	/*!
+	  \param enabled Whether rendering should be profiled. Profiling is disabled by default.
+	  \remarks While profiling is disabled, rendering is not slowed down by the profiler.
+	  \since 0.7.0
+	*/
+	virtual void set_profiling_enabled( bool enabled ) = 0;
+
+	//! Check if profiling is enabled
+	/*!
+	  \return Whether rendering is being profiled.
+	  \since 0.7.0
+	*/
+	virtual bool get_profiling_enabled( ) const = 0;
+
+	//! Reset all profiling data to 0
+	/*!
+	  \since 0.7.0
+	*/
+	virtual void reset_profiling( ) = 0;
+
+	//! Get the profiling data collected since the last reset
+	/*!
+	  \return The cumulative call counts and times of all rendering stages and the number of sample frames rendered by each resampler.
+	  \since 0.7.0
+	*/
+	virtual snapshot get_profiling_snapshot( ) const = 0;
+
+}; // class profiling
+
+
 
 /* add stuff here */
 
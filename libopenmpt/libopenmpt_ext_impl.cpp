@@ -87,6 +87,10 @@ namespace openmpt {
 			return dynamic_cast< ext::interactive2 * >( this );
 		} else if ( interface_id == ext::interactive3_id ) {
 			return dynamic_cast< ext::interactive3 * >( this );
+#ifndef NO_RENDER_PROFILING
+		} else if ( interface_id == ext::profiling_id ) {
+			return dynamic_cast< ext::profiling * >( this );
+#endif // NO_RENDER_PROFILING
 
 
 
@@ -208,6 +212,8 @@ namespace openmpt {
 				m_sndFile->m_PlayState.Chn[i].dwFlags.set( OpenMPT::CHN_MUTE | OpenMPT::CHN_SYNCMUTE, mute );
 			}
 		}
+		// Song states recorded by previous seeks still contain the old mute status
+		m_seekCheckpoints->Clear();
 	}
 
 	bool module_ext_impl::get_channel_mute_status( std::int32_t channel ) const {
@@ -353,6 +359,56 @@ namespace openmpt {
 		m_sndFile->m_PlayState.m_nMusicTempo = decltype( m_sndFile->m_PlayState.m_nMusicTempo )( tempo );
 	}
 
+#ifndef NO_RENDER_PROFILING
+
+	static_assert( static_cast<int>( ext::profiling::num_stages ) == static_cast<int>( OpenMPT::RenderProfiler::numStages ) );
+	static_assert( static_cast<int>( ext::profiling::num_resamplers ) == static_cast<int>( OpenMPT::RenderProfiler::numResamplers ) );
+
+	void module_ext_impl::set_profiling_enabled( bool enabled ) {
+		m_sndFile->m_RenderProfiler.SetEnabled( enabled );
+	}
+
+	bool module_ext_impl::get_profiling_enabled( ) const {
+		return m_sndFile->m_RenderProfiler.IsEnabled();
+	}
+
+	void module_ext_impl::reset_profiling( ) {
+		m_sndFile->m_RenderProfiler.Reset();
+	}
+
+	ext::profiling::snapshot module_ext_impl::get_profiling_snapshot( ) const {
+		const OpenMPT::RenderProfiler::Snapshot data = m_sndFile->m_RenderProfiler.GetSnapshot();
+		snapshot result = {};
+		for ( std::size_t i = 0; i < num_stages; ++i ) {
+			result.stage_calls[i] = data.stages[i].calls;
+			result.stage_seconds[i] = data.stages[i].nanoseconds / 1000000000.0;
+		}
+		for ( std::size_t i = 0; i < num_resamplers; ++i ) {
+			result.resampler_frames[i] = data.resamplerFrames[i];
+		}
+		return result;
+	}
+
+#else // NO_RENDER_PROFILING
+
+	void module_ext_impl::set_profiling_enabled( bool /* enabled */ ) {
+		throw openmpt::exception("profiling not supported");
+	}
+
+	bool module_ext_impl::get_profiling_enabled( ) const {
+		return false;
+	}
+
+	void module_ext_impl::reset_profiling( ) {
+		return;
+	}
+
+	ext::profiling::snapshot module_ext_impl::get_profiling_snapshot( ) const {
+		return snapshot{};
+	}
+
+#endif // NO_RENDER_PROFILING
+
 	/* add stuff here */
 
 
@@ -22,6 +22,7 @@ class module_ext_impl
 	, public ext::interactive
 	, public ext::interactive2
 	, public ext::interactive3
+	, public ext::profiling
 
 
 
@@ -115,6 +116,16 @@ public:
 
 	void set_current_tempo2(double tempo) override;
 
+	// profiling
+
+	void set_profiling_enabled( bool enabled ) override;
+
+	bool get_profiling_enabled( ) const override;
+
+	void reset_profiling( ) override;
+
+	snapshot get_profiling_snapshot( ) const override;
+
 	/* add stuff here */
 
 }; // class module_ext_impl
@@ -15,32 +15,41 @@
 #include "libopenmpt_impl.hpp"
 
 #include <algorithm>
+#include <fstream>
 #include <iostream>
 #include <istream>
 #include <iterator>
 #include <limits>
+#include <locale>
 #include <ostream>
+#include <sstream>
 
 #include <cmath>
+#include <cstdio>
 #include <cstdlib>
 #include <cstring>
 
 #include "mpt/audio/span.hpp"
+#include "mpt/crc/crc.hpp"
 #include "mpt/base/algorithm.hpp"
+#include "mpt/base/bit.hpp"
 #include "mpt/base/saturate_cast.hpp"
 #include "mpt/base/saturate_round.hpp"
 #include "mpt/format/default_integer.hpp"
 #include "mpt/format/default_floatingpoint.hpp"
 #include "mpt/format/default_string.hpp"
+#include "mpt/format/simple.hpp"
 #include "mpt/io_read/callbackstream.hpp"
 #include "mpt/io_read/filecursor_callbackstream.hpp"
 #include "mpt/io_read/filecursor_memory.hpp"
 #include "mpt/io_read/filecursor_stdstream.hpp"
+#include "mpt/io_read/filedata_mmap.hpp"
 #include "mpt/mutex/mutex.hpp"
 #include "mpt/parse/parse.hpp"
 #include "mpt/string/types.hpp"
 #include "mpt/string/utility.hpp"
 #include "mpt/string_transcode/transcode.hpp"
+#include "mpt/uuid/uuid.hpp"
 
 #include "common/version.h"
 #include "common/misc_util.h"
@@ -50,6 +59,12 @@
 #include "soundlib/Sndfile.h"
 #include "soundlib/mod_specifications.h"
 #include "soundlib/AudioReadTarget.h"
+#include "soundlib/Resampler.h"
+
+#if MPT_IO_READ_FILEDATA_MMAP
+#include <fcntl.h>
+#include <unistd.h>
+#endif // MPT_IO_READ_FILEDATA_MMAP
 
 OPENMPT_NAMESPACE_BEGIN
 
@@ -281,6 +296,67 @@ void std_ostream_log::log( const std::string & message ) const {
 	destination.flush();
 }
 
+subsongs_cache_interface::subsongs_cache_interface() {
+	return;
+}
+subsongs_cache_interface::~subsongs_cache_interface() {
+	return;
+}
+
+subsongs_cache_directory::subsongs_cache_directory( const std::string & path ) : m_path(path) {
+	return;
+}
+subsongs_cache_directory::~subsongs_cache_directory() {
+	return;
+}
+const std::string & subsongs_cache_directory::get_path() const {
+	return m_path;
+}
+std::string subsongs_cache_directory::get_filename( const std::string & key ) const {
+	std::string filename = m_path;
+	if ( !filename.empty() && filename.back() != '/' && filename.back() != '\\' ) {
+		filename += "/";
+	}
+	filename += key + ".subsongs";
+	return filename;
+}
+bool subsongs_cache_directory::lookup( const std::string & key, std::string & record ) {
+	std::ifstream file( get_filename( key ), std::ios::binary );
+	if ( !file ) {
+		return false;
+	}
+	std::ostringstream data;
+	data << file.rdbuf();
+	if ( !file ) {
+		return false;
+	}
+	record = data.str();
+	return true;
+}
+// Writes data to a temporary file next to filename and renames it into place, so that concurrent readers never see a partial file.
+// The temporary file name is unique per writer, so concurrent writers (even in different processes) cannot truncate each other's file.
+static void write_file_atomically( const std::string & filename, const char * data, std::size_t size ) {
+	const std::string tmpfilename = filename + "." + OpenMPT::mpt::UUID::GenerateLocalUseOnly( OpenMPT::mpt::global_prng() ).ToAString() + ".tmp";
+	{
+		std::ofstream file( tmpfilename, std::ios::binary | std::ios::trunc );
+		if ( !file ) {
+			return;
+		}
+		file.write( data, size );
+		file.close();
+		if ( !file ) {
+			std::remove( tmpfilename.c_str() );
+			return;
+		}
+	}
+	if ( std::rename( tmpfilename.c_str(), filename.c_str() ) != 0 ) {
+		std::remove( tmpfilename.c_str() );
+	}
+}
+void subsongs_cache_directory::store( const std::string & key, const std::string & record ) {
+	write_file_atomically( get_filename( key ), record.data(), record.size() );
+}
+
 class log_forwarder : public OpenMPT::ILog {
 private:
 	log_interface & destination;
@@ -412,7 +488,10 @@ static void mixersettings_to_ramping( int & ramping, const OpenMPT::MixerSetting
 }
 
 std::string module_impl::mod_string_to_utf8( const std::string & encoded ) const {
-	return OpenMPT::mpt::ToCharset( OpenMPT::mpt::Charset::UTF8, m_sndFile->GetCharsetInternal(), encoded );
+	return mod_string_to_utf8( *m_sndFile, encoded );
+}
+std::string module_impl::mod_string_to_utf8( const OpenMPT::CSoundFile & sndFile, const std::string & encoded ) {
+	return OpenMPT::mpt::ToCharset( OpenMPT::mpt::Charset::UTF8, sndFile.GetCharsetInternal(), encoded );
 }
 void module_impl::apply_mixer_settings( std::int32_t samplerate, int channels ) {
 	bool samplerate_changed = static_cast<std::int32_t>( m_sndFile->m_MixerSettings.gdwMixingFreq ) != samplerate;
@@ -444,9 +523,9 @@ module_impl::subsongs_type module_impl::get_subsongs() const {
 	if ( m_sndFile->Order.GetNumSequences() == 0 ) {
 		throw openmpt::exception("module contains no songs");
 	}
-	for ( OpenMPT::SEQUENCEINDEX seq = 0; seq < m_sndFile->Order.GetNumSequences(); ++seq ) {
-		const std::vector<OpenMPT::GetLengthType> lengths = m_sndFile->GetLength( OpenMPT::eNoAdjust, OpenMPT::GetLengthTarget( true ).StartPos( seq, 0, 0 ) );
-		for ( const auto & l : lengths ) {
+	const std::vector<std::vector<OpenMPT::GetLengthType>> sequences = m_sndFile->GetSubsongsOfAllSequences( m_sndFile->GetLoaderThreads() );
+	for ( OpenMPT::SEQUENCEINDEX seq = 0; seq < sequences.size(); ++seq ) {
+		for ( const auto & l : sequences[seq] ) {
 			subsongs.push_back( subsong_data( l.duration, l.startRow, l.startOrder, seq ) );
 		}
 	}
@@ -455,10 +534,124 @@ module_impl::subsongs_type module_impl::get_subsongs() const {
 void module_impl::init_subsongs( subsongs_type & subsongs ) const {
 	subsongs = get_subsongs();
 }
+void module_impl::init_subsongs_cached( const OpenMPT::FileCursor & file, int load_flags, subsongs_type & subsongs ) const {
+	const std::string key = get_subsongs_cache_key( file, load_flags );
+	std::string record;
+	if ( m_subsongs_cache->lookup( key, record ) && deserialize_subsongs( record, subsongs ) ) {
+		return;
+	}
+	init_subsongs( subsongs );
+	m_subsongs_cache->store( key, serialize_subsongs( subsongs ) );
+}
+std::string module_impl::get_subsongs_cache_key( const OpenMPT::FileCursor & file, int load_flags ) {
+	OpenMPT::FileCursor data = file;
+	data.Rewind();
+	mpt::crc64_jones crc;
+	std::uint64_t size = 0;
+	std::vector<std::byte> buf( 65536 );
+	while ( !data.EndOfFile() ) {
+		mpt::byte_span chunk = data.ReadRaw( mpt::as_span( buf ) );
+		if ( chunk.empty() ) {
+			break;
+		}
+		crc.process( chunk.begin(), chunk.end() );
+		size += chunk.size();
+	}
+	return mpt::format<std::string>::hex0<16>( crc.result() ) + "-" + mpt::format<std::string>::hex0<16>( size ) + "-" + mpt::format<std::string>::hex0<8>( static_cast<std::uint32_t>( load_flags ) );
+}
+std::string module_impl::serialize_subsongs( const subsongs_type & subsongs ) {
+	std::ostringstream str;
+	str.imbue( std::locale::classic() );
+	str << "libopenmpt subsongs 1" << "\n";
+	str << version::get_core_version_string() << "\n";
+	str << subsongs.size() << "\n";
+	for ( const auto & subsong : subsongs ) {
+		// The duration is stored bit-exact.
+		str << mpt::format<std::string>::hex0<16>( mpt::bit_cast<std::uint64_t>( subsong.duration ) ) << " " << subsong.start_row << " " << subsong.start_order << " " << subsong.sequence << "\n";
+	}
+	return str.str();
+}
+bool module_impl::deserialize_subsongs( const std::string & record, subsongs_type & subsongs ) const {
+	std::istringstream str( record );
+	str.imbue( std::locale::classic() );
+	std::string magic;
+	std::string version;
+	if ( !std::getline( str, magic ) || magic != "libopenmpt subsongs 1" ) {
+		return false;
+	}
+	// Records written by a different playback engine may have different durations.
+	if ( !std::getline( str, version ) || version != version::get_core_version_string() ) {
+		return false;
+	}
+	std::size_t count = 0;
+	if ( !( str >> count ) || count == 0 || count > std::numeric_limits<std::uint16_t>::max() ) {
+		return false;
+	}
+	subsongs_type result;
+	result.reserve( count );
+	for ( std::size_t i = 0; i < count; ++i ) {
+		std::string duration;
+		std::int32_t start_row = 0;
+		std::int32_t start_order = 0;
+		std::int32_t sequence = 0;
+		if ( !( str >> duration >> start_row >> start_order >> sequence ) || duration.length() != 16 ) {
+			return false;
+		}
+		if ( sequence < 0 || sequence >= m_sndFile->Order.GetNumSequences() ) {
+			return false;
+		}
+		if ( start_order < 0 || start_order >= m_sndFile->Order( static_cast<OpenMPT::SEQUENCEINDEX>( sequence ) ).GetLength() || start_row < 0 ) {
+			return false;
+		}
+		result.push_back( subsong_data( mpt::bit_cast<double>( mpt::ConvertHexStringTo<std::uint64_t>( duration ) ), start_row, start_order, sequence ) );
+	}
+	subsongs = std::move( result );
+	return true;
+}
 bool module_impl::has_subsongs_inited() const {
 	return !m_subsongs.empty();
 }
+static bool load_resampler_tables_cache( const std::string & filename ) {
+#if MPT_IO_READ_FILEDATA_MMAP
+	int fd = open( filename.c_str(), O_RDONLY | O_CLOEXEC );
+	if ( fd < 0 ) {
+		return false;
+	}
+	std::shared_ptr<const mpt::IO::FileDataMapped> mapping = mpt::IO::FileDataMapped::Map( fd );
+	close( fd );
+	if ( !mapping ) {
+		return false;
+	}
+	return OpenMPT::CResampler::InitializeTablesCache( mpt::const_byte_span( mapping->GetRawData(), mapping->GetLength() ) );
+#else // !MPT_IO_READ_FILEDATA_MMAP
+	std::ifstream file( filename, std::ios::binary );
+	if ( !file ) {
+		return false;
+	}
+	std::vector<char> data( ( std::istreambuf_iterator<char>( file ) ), std::istreambuf_iterator<char>() );
+	return OpenMPT::CResampler::InitializeTablesCache( mpt::as_span( mpt::byte_cast<const std::byte *>( data.data() ), data.size() ) );
+#endif // MPT_IO_READ_FILEDATA_MMAP
+}
+static void store_resampler_tables_cache( const std::string & filename ) {
+	const std::vector<std::byte> blob = OpenMPT::CResampler::GetTablesCacheBlob();
+	write_file_atomically( filename, mpt::byte_cast<const char *>( blob.data() ), blob.size() );
+}
+void module_impl::init_resampler_tables_cache( const std::string & filename ) {
+	// The tables cache is process-wide, so only the first module that asks for it has to look at the file.
+	static const bool initialized = [&]() {
+		if ( !load_resampler_tables_cache( filename ) ) {
+			store_resampler_tables_cache( filename );
+		}
+		return true;
+	}();
+	static_cast<void>( initialized );
+}
 void module_impl::ctor( const std::map< std::string, std::string > & ctls ) {
+	// The resampler tables are set up when constructing the CSoundFile, so the tables cache has to be initialized before.
+	const auto resampler_tables_file = ctls.find( "load.resampler_tables_file" );
+	if ( resampler_tables_file != ctls.end() && !resampler_tables_file->second.empty() ) {
+		init_resampler_tables_cache( resampler_tables_file->second );
+	}
 	m_sndFile = std::make_unique<OpenMPT::CSoundFile>();
 	m_loaded = false;
 	m_mixer_initialized = false;
@@ -473,7 +666,10 @@ void module_impl::ctor( const std::map< std::string, std::string > & ctls ) {
 	m_ctl_load_skip_patterns = false;
 	m_ctl_load_skip_plugins = false;
 	m_ctl_load_skip_subsongs_init = false;
+	m_ctl_load_lazy_samples = false;
+	m_ctl_load_share_samples = false;
 	m_ctl_seek_sync_samples = true;
+	m_seekCheckpoints = std::make_unique<OpenMPT::GetLengthCheckpoints>();
 	// init member variables that correspond to ctls
 	for ( const auto & ctl : ctls ) {
 		ctl_set( ctl.first, ctl.second, false );
@@ -493,11 +689,23 @@ void module_impl::load( const OpenMPT::FileCursor & file, const std::map< std::s
 		if ( m_ctl_load_skip_plugins ) {
 			load_flags &= ~(OpenMPT::CSoundFile::loadPluginData | OpenMPT::CSoundFile::loadPluginInstance);
 		}
-		if ( !m_sndFile->Create( file, static_cast<OpenMPT::CSoundFile::ModLoadingFlags>( load_flags ) ) ) {
+		int create_flags = load_flags;
+		if ( m_ctl_load_lazy_samples ) {
+			// Does not change anything but the time at which sample data is decoded, so it is not part of load_flags used for the sub-song cache.
+			create_flags |= OpenMPT::CSoundFile::deferSampleData;
+		}
+		if ( m_ctl_load_share_samples ) {
+			create_flags |= OpenMPT::CSoundFile::shareSampleData;
+		}
+		if ( !m_sndFile->Create( file, static_cast<OpenMPT::CSoundFile::ModLoadingFlags>( create_flags ) ) ) {
 			throw openmpt::exception("error loading file");
 		}
 		if ( !m_ctl_load_skip_subsongs_init ) {
-			init_subsongs( m_subsongs );
+			if ( m_subsongs_cache ) {
+				init_subsongs_cached( file, load_flags, m_subsongs );
+			} else {
+				init_subsongs( m_subsongs );
+			}
 		}
 		m_loaded = true;
 	}
@@ -543,7 +751,8 @@ std::size_t module_impl::read_wrapper( std::size_t count, float * left, float *
 	m_sndFile->m_bIsRendering = ( m_ctl_play_at_end != song_end_action::fadeout_song );
 	std::size_t count_read = 0;
 	float * const buffers[4] = { left, right, rear_left, rear_right };
-	OpenMPT::AudioTargetBufferWithGain<mpt::audio_span_planar<float>> target( mpt::audio_span_planar<float>( buffers, valid_channels( buffers, std::size( buffers ) ), count ), *m_Dithers, m_Gain );
+	// Float output is not dithered, so it is written straight into the caller's buffers.
+	OpenMPT::AudioTargetPlanarFloat target( mpt::audio_span_planar<float>( buffers, valid_channels( buffers, std::size( buffers ) ), count ), m_Gain );
 	while ( count > 0 ) {
 		std::size_t count_chunk = m_sndFile->Read(
 			static_cast<OpenMPT::CSoundFile::samplecount_t>( std::min( static_cast<std::uint64_t>( count ), static_cast<std::uint64_t>( std::numeric_limits<OpenMPT::CSoundFile::samplecount_t>::max() / 2 / 4 / 4 ) ) ), // safety margin / samplesize / channels
@@ -929,6 +1138,92 @@ module_impl::~module_impl() {
 	m_sndFile->Destroy();
 }
 
+// Constructing a CSoundFile takes much longer than reading the header of a typical module,
+// so module_info keeps a few of the CSoundFile objects it has used for reading the next modules.
+// The idle objects (about 1.4 MB each) are only freed when the process exits, which is documented in the public API.
+class metadata_soundfile_pool {
+private:
+	static constexpr std::size_t max_idle = 4;
+	mpt::mutex m_mutex;
+	std::vector< std::unique_ptr<OpenMPT::CSoundFile> > m_idle;
+public:
+	std::unique_ptr<OpenMPT::CSoundFile> acquire() {
+		{
+			mpt::lock_guard<mpt::mutex> lock( m_mutex );
+			if ( !m_idle.empty() ) {
+				std::unique_ptr<OpenMPT::CSoundFile> sndFile = std::move( m_idle.back() );
+				m_idle.pop_back();
+				return sndFile;
+			}
+		}
+		return std::make_unique<OpenMPT::CSoundFile>();
+	}
+	void release( std::unique_ptr<OpenMPT::CSoundFile> sndFile ) {
+		sndFile->SetCustomLog( nullptr );
+		sndFile->Destroy();
+		mpt::lock_guard<mpt::mutex> lock( m_mutex );
+		if ( m_idle.size() < max_idle ) {
+			m_idle.push_back( std::move( sndFile ) );
+		}
+	}
+}; // class metadata_soundfile_pool
+
+static metadata_soundfile_pool & get_metadata_soundfile_pool() {
+	static metadata_soundfile_pool pool;
+	return pool;
+}
+
+void module_info_impl::load( const OpenMPT::FileCursor & file, const log_interface & log ) {
+	metadata_soundfile_pool & pool = get_metadata_soundfile_pool();
+	std::unique_ptr<OpenMPT::CSoundFile> sndFile = pool.acquire();
+	loader_log loaderlog;
+	sndFile->SetCustomLog( &loaderlog );
+	const bool loaded = sndFile->Create( file, OpenMPT::CSoundFile::onlyMetadata );
+	std::vector<std::string> loaderMessages;
+	for ( const auto & msg : loaderlog.GetMessages() ) {
+		loaderMessages.push_back( mpt::transcode<std::string>( mpt::common_encoding::utf8, LogLevelToString( msg.first ) ) + std::string(": ") + msg.second );
+		log.log( loaderMessages.back() );
+	}
+	if ( loaded ) {
+		for ( const auto & key : module_impl::get_metadata_keys() ) {
+			m_metadata.emplace_back( key, module_impl::get_metadata( *sndFile, loaderMessages, key ) );
+		}
+	}
+	pool.release( std::move( sndFile ) );
+	if ( !loaded ) {
+		throw openmpt::exception("error loading file");
+	}
+}
+module_info_impl::module_info_impl( callback_stream_wrapper stream, std::unique_ptr<log_interface> log ) {
+	mpt::IO::CallbackStream fstream;
+	fstream.stream = stream.stream;
+	fstream.read = stream.read;
+	fstream.seek = stream.seek;
+	fstream.tell = stream.tell;
+	load( mpt::IO::make_FileCursor<OpenMPT::mpt::PathString>( fstream ), *log );
+}
+module_info_impl::module_info_impl( std::istream & stream, std::unique_ptr<log_interface> log ) {
+	load( mpt::IO::make_FileCursor<OpenMPT::mpt::PathString>( stream ), *log );
+}
+module_info_impl::module_info_impl( const void * data, std::size_t size, std::unique_ptr<log_interface> log ) {
+	load( mpt::IO::make_FileCursor<OpenMPT::mpt::PathString>( mpt::as_span( mpt::void_cast< const std::byte * >( data ), size ) ), *log );
+}
+std::vector<std::string> module_info_impl::get_metadata_keys() const {
+	std::vector<std::string> keys;
+	for ( const auto & entry : m_metadata ) {
+		keys.push_back( entry.first );
+	}
+	return keys;
+}
+std::string module_info_impl::get_metadata( const std::string & key ) const {
+	for ( const auto & entry : m_metadata ) {
+		if ( entry.first == key ) {
+			return entry.second;
+		}
+	}
+	return "";
+}
+
 std::int32_t module_impl::get_render_param( int param ) const {
 	std::int32_t result = 0;
 	switch ( param ) {
@@ -1133,7 +1428,7 @@ double module_impl::set_position_seconds( double seconds ) {
 		subsong = &subsongs[m_current_subsong];
 	}
 	m_sndFile->SetCurrentOrder( static_cast<OpenMPT::ORDERINDEX>( subsong->start_order ) );
-	OpenMPT::GetLengthType t = m_sndFile->GetLength( m_ctl_seek_sync_samples ? OpenMPT::eAdjustSamplePositions : OpenMPT::eAdjust, OpenMPT::GetLengthTarget( seconds ).StartPos( static_cast<OpenMPT::SEQUENCEINDEX>( subsong->sequence ), static_cast<OpenMPT::ORDERINDEX>( subsong->start_order ), static_cast<OpenMPT::ROWINDEX>( subsong->start_row ) ) ).back();
+	OpenMPT::GetLengthType t = m_sndFile->GetLength( m_ctl_seek_sync_samples ? OpenMPT::eAdjustSamplePositions : OpenMPT::eAdjust, OpenMPT::GetLengthTarget( seconds ).StartPos( static_cast<OpenMPT::SEQUENCEINDEX>( subsong->sequence ), static_cast<OpenMPT::ORDERINDEX>( subsong->start_order ), static_cast<OpenMPT::ROWINDEX>( subsong->start_row ) ), m_seekCheckpoints.get() ).back();
 	m_sndFile->m_PlayState.m_nNextOrder = m_sndFile->m_PlayState.m_nCurrentOrder = t.targetReached ? t.lastOrder : t.endOrder;
 	m_sndFile->m_PlayState.m_nNextRow = t.targetReached ? t.lastRow : t.endRow;
 	m_sndFile->m_PlayState.m_nTickCount = OpenMPT::CSoundFile::TICKS_ROW_FINISHED;
@@ -1156,10 +1451,10 @@ double module_impl::set_position_order_row( std::int32_t order, std::int32_t row
 	m_sndFile->SetCurrentOrder( static_cast<OpenMPT::ORDERINDEX>( order ) );
 	m_sndFile->m_PlayState.m_nNextRow = static_cast<OpenMPT::ROWINDEX>( row );
 	m_sndFile->m_PlayState.m_nTickCount = OpenMPT::CSoundFile::TICKS_ROW_FINISHED;
-	m_currentPositionSeconds = m_sndFile->GetLength( m_ctl_seek_sync_samples ? OpenMPT::eAdjustSamplePositions : OpenMPT::eAdjust, OpenMPT::GetLengthTarget( static_cast<OpenMPT::ORDERINDEX>( order ), static_cast<OpenMPT::ROWINDEX>( row ) ) ).back().duration;
+	m_currentPositionSeconds = m_sndFile->GetLength( m_ctl_seek_sync_samples ? OpenMPT::eAdjustSamplePositions : OpenMPT::eAdjust, OpenMPT::GetLengthTarget( static_cast<OpenMPT::ORDERINDEX>( order ), static_cast<OpenMPT::ROWINDEX>( row ) ), m_seekCheckpoints.get() ).back().duration;
 	return m_currentPositionSeconds;
 }
-std::vector<std::string> module_impl::get_metadata_keys() const {
+std::vector<std::string> module_impl::get_metadata_keys() {
 	return
 	{
 		"type",
@@ -1177,12 +1472,12 @@ std::vector<std::string> module_impl::get_metadata_keys() const {
 		"warnings",
 	};
 }
-std::string module_impl::get_message_instruments() const {
+std::string module_impl::get_message_instruments( const OpenMPT::CSoundFile & sndFile ) {
 	std::string retval;
 	std::string tmp;
 	bool valid = false;
-	for ( OpenMPT::INSTRUMENTINDEX i = 1; i <= m_sndFile->GetNumInstruments(); ++i ) {
-		std::string instname = m_sndFile->GetInstrumentName( i );
+	for ( OpenMPT::INSTRUMENTINDEX i = 1; i <= sndFile.GetNumInstruments(); ++i ) {
+		std::string instname = sndFile.GetInstrumentName( i );
 		if ( !instname.empty() ) {
 			valid = true;
 		}
@@ -1194,12 +1489,12 @@ std::string module_impl::get_message_instruments() const {
 	}
 	return retval;
 }
-std::string module_impl::get_message_samples() const {
+std::string module_impl::get_message_samples( const OpenMPT::CSoundFile & sndFile ) {
 	std::string retval;
 	std::string tmp;
 	bool valid = false;
-	for ( OpenMPT::SAMPLEINDEX i = 1; i <= m_sndFile->GetNumSamples(); ++i ) {
-		std::string samplename = m_sndFile->GetSampleName( i );
+	for ( OpenMPT::SAMPLEINDEX i = 1; i <= sndFile.GetNumSamples(); ++i ) {
+		std::string samplename = sndFile.GetSampleName( i );
 		if ( !samplename.empty() ) {
 			valid = true;
 		}
@@ -1211,60 +1506,60 @@ std::string module_impl::get_message_samples() const {
 	}
 	return retval;
 }
-std::string module_impl::get_metadata( const std::string & key ) const {
+std::string module_impl::get_metadata( const OpenMPT::CSoundFile & sndFile, const std::vector<std::string> & loaderMessages, const std::string & key ) {
 	if ( key == std::string("type") ) {
-		return mpt::transcode<std::string>( mpt::common_encoding::utf8, m_sndFile->m_modFormat.type );
+		return mpt::transcode<std::string>( mpt::common_encoding::utf8, sndFile.m_modFormat.type );
 	} else if ( key == std::string("type_long") ) {
-		return mpt::transcode<std::string>( mpt::common_encoding::utf8, m_sndFile->m_modFormat.formatName );
+		return mpt::transcode<std::string>( mpt::common_encoding::utf8, sndFile.m_modFormat.formatName );
 	} else if ( key == std::string("originaltype") ) {
-		return mpt::transcode<std::string>( mpt::common_encoding::utf8, m_sndFile->m_modFormat.originalType );
+		return mpt::transcode<std::string>( mpt::common_encoding::utf8, sndFile.m_modFormat.originalType );
 	} else if ( key == std::string("originaltype_long") ) {
-		return mpt::transcode<std::string>( mpt::common_encoding::utf8, m_sndFile->m_modFormat.originalFormatName );
+		return mpt::transcode<std::string>( mpt::common_encoding::utf8, sndFile.m_modFormat.originalFormatName );
 	} else if ( key == std::string("container") ) {
-		return mpt::transcode<std::string>( mpt::common_encoding::utf8, OpenMPT::CSoundFile::ModContainerTypeToString( m_sndFile->GetContainerType() ) );
+		return mpt::transcode<std::string>( mpt::common_encoding::utf8, OpenMPT::CSoundFile::ModContainerTypeToString( sndFile.GetContainerType() ) );
 	} else if ( key == std::string("container_long") ) {
-		return mpt::transcode<std::string>( mpt::common_encoding::utf8, OpenMPT::CSoundFile::ModContainerTypeToTracker( m_sndFile->GetContainerType() ) );
+		return mpt::transcode<std::string>( mpt::common_encoding::utf8, OpenMPT::CSoundFile::ModContainerTypeToTracker( sndFile.GetContainerType() ) );
 	} else if ( key == std::string("tracker") ) {
-		return mpt::transcode<std::string>( mpt::common_encoding::utf8, m_sndFile->m_modFormat.madeWithTracker );
+		return mpt::transcode<std::string>( mpt::common_encoding::utf8, sndFile.m_modFormat.madeWithTracker );
 	} else if ( key == std::string("artist") ) {
-		return mpt::transcode<std::string>( mpt::common_encoding::utf8, m_sndFile->m_songArtist );
+		return mpt::transcode<std::string>( mpt::common_encoding::utf8, sndFile.m_songArtist );
 	} else if ( key == std::string("title") ) {
-		return mod_string_to_utf8( m_sndFile->GetTitle() );
+		return mod_string_to_utf8( sndFile, sndFile.GetTitle() );
 	} else if ( key == std::string("date") ) {
-		if ( m_sndFile->GetFileHistory().empty() || !m_sndFile->GetFileHistory().back().HasValidDate() ) {
+		if ( sndFile.GetFileHistory().empty() || !sndFile.GetFileHistory().back().HasValidDate() ) {
 			return std::string();
 		}
-		return mpt::transcode<std::string>( mpt::common_encoding::utf8, m_sndFile->GetFileHistory().back().AsISO8601() );
+		return mpt::transcode<std::string>( mpt::common_encoding::utf8, sndFile.GetFileHistory().back().AsISO8601() );
 	} else if ( key == std::string("message") ) {
-		std::string retval = m_sndFile->m_songMessage.GetFormatted( OpenMPT::SongMessage::leLF );
+		std::string retval = sndFile.m_songMessage.GetFormatted( OpenMPT::SongMessage::leLF );
 		if ( retval.empty() ) {
-			switch ( m_sndFile->GetMessageHeuristic() ) {
+			switch ( sndFile.GetMessageHeuristic() ) {
 				case OpenMPT::ModMessageHeuristicOrder::Instruments:
-					retval = get_message_instruments();
+					retval = get_message_instruments( sndFile );
 					break;
 				case OpenMPT::ModMessageHeuristicOrder::Samples:
-					retval = get_message_samples();
+					retval = get_message_samples( sndFile );
 					break;
 				case OpenMPT::ModMessageHeuristicOrder::InstrumentsSamples:
 					if ( retval.empty() ) {
-						retval = get_message_instruments();
+						retval = get_message_instruments( sndFile );
 					}
 					if ( retval.empty() ) {
-						retval = get_message_samples();
+						retval = get_message_samples( sndFile );
 					}
 					break;
 				case OpenMPT::ModMessageHeuristicOrder::SamplesInstruments:
 					if ( retval.empty() ) {
-						retval = get_message_samples();
+						retval = get_message_samples( sndFile );
 					}
 					if ( retval.empty() ) {
-						retval = get_message_instruments();
+						retval = get_message_instruments( sndFile );
 					}
 					break;
 				case OpenMPT::ModMessageHeuristicOrder::BothInstrumentsSamples:
 					{
-						std::string message_instruments = get_message_instruments();
-						std::string message_samples = get_message_samples();
+						std::string message_instruments = get_message_instruments( sndFile );
+						std::string message_samples = get_message_samples( sndFile );
 						if ( !message_instruments.empty() ) {
 							retval += std::move( message_instruments );
 						}
@@ -1275,8 +1570,8 @@ std::string module_impl::get_metadata( const std::string & key ) const {
 					break;
 				case OpenMPT::ModMessageHeuristicOrder::BothSamplesInstruments:
 					{
-						std::string message_instruments = get_message_instruments();
-						std::string message_samples = get_message_samples();
+						std::string message_instruments = get_message_instruments( sndFile );
+						std::string message_samples = get_message_samples( sndFile );
 						if ( !message_samples.empty() ) {
 							retval += std::move( message_samples );
 						}
@@ -1287,14 +1582,14 @@ std::string module_impl::get_metadata( const std::string & key ) const {
 					break;
 			}
 		}
-		return mod_string_to_utf8( retval );
+		return mod_string_to_utf8( sndFile, retval );
 	} else if ( key == std::string("message_raw") ) {
-		std::string retval = m_sndFile->m_songMessage.GetFormatted( OpenMPT::SongMessage::leLF );
-		return mod_string_to_utf8( retval );
+		std::string retval = sndFile.m_songMessage.GetFormatted( OpenMPT::SongMessage::leLF );
+		return mod_string_to_utf8( sndFile, retval );
 	} else if ( key == std::string("warnings") ) {
 		std::string retval;
 		bool first = true;
-		for ( const auto & msg : m_loaderMessages ) {
+		for ( const auto & msg : loaderMessages ) {
 			if ( !first ) {
 				retval += "\n";
 			} else {
@@ -1306,6 +1601,9 @@ std::string module_impl::get_metadata( const std::string & key ) const {
 	}
 	return "";
 }
+std::string module_impl::get_metadata( const std::string & key ) const {
+	return get_metadata( *m_sndFile, m_loaderMessages, key );
+}
 
 double module_impl::get_current_estimated_bpm() const {
 	return m_sndFile->GetCurrentBPM();
@@ -1587,6 +1885,68 @@ std::string module_impl::highlight_pattern_row_channel_command( std::int32_t p,
 	return format_and_highlight_pattern_row_channel_command( p, r, c, cmd ).second;
 }
 
+// Formats a cell as "NNN IIvVV EFF", leaving out columns that do not fit into width (0 means no limit).
+// put( text, highlight ) is called for each character and may be called more than width times.
+// Apart from note names of custom tunings, this does not allocate any memory.
+template < typename Tput >
+static void format_and_highlight_cell( const OpenMPT::CSoundFile & sndFile, const OpenMPT::ModCommand & cell, std::size_t width, Tput put ) {
+	const auto put_string = [&]( const char * text, const char * high, std::size_t length ) {
+		for ( std::size_t i = 0; i < length; ++i ) {
+			put( text[i], high[i] );
+		}
+	};
+	const auto put_hex = [&]( unsigned int value, int digits, char high ) {
+		for ( int i = digits - 1; i >= 0; --i ) {
+			put( "0123456789ABCDEF"[ ( value >> ( i * 4 ) ) & 0xf ], high );
+		}
+	};
+	//  0000000001111
+	//  1234567890123
+	// "NNN IIvVV EFF"
+	if ( ( cell.IsNote() || cell.IsSpecialNote() ) && sndFile.HasCustomNoteName( cell.note, cell.instr ) ) {
+		const std::string name = mpt::transcode<std::string>( mpt::common_encoding::utf8, sndFile.GetNoteName( cell.note, cell.instr ) );
+		for ( char ch : name ) {
+			put( ch, 'n' );
+		}
+	} else if ( cell.IsNote() || cell.IsSpecialNote() ) {
+		char name[3];
+		sndFile.GetNoteName( cell.note, name );
+		put_string( name, cell.IsNote() ? "nnn" : "mmm", 3 );
+	} else {
+		put_string( "...", "...", 3 );
+	}
+	if ( ( width == 0 ) || ( width >= 6 ) ) {
+		put( ' ', ' ' );
+		if ( cell.instr ) {
+			put_hex( cell.instr, 2, 'i' );
+		} else {
+			put_string( "..", "..", 2 );
+		}
+	}
+	if ( ( width == 0 ) || ( width >= 9 ) ) {
+		if ( cell.IsPcNote() ) {
+			put( ' ', ' ' );
+			put_hex( cell.GetValueVolCol() & 0xff, 2, 'v' );
+		} else if ( cell.volcmd != OpenMPT::VOLCMD_NONE ) {
+			put( sndFile.GetModSpecifications().GetVolEffectLetter( cell.volcmd ), 'u' );
+			put_hex( cell.vol, 2, 'v' );
+		} else {
+			put_string( " ..", " ..", 3 );
+		}
+	}
+	if ( ( width == 0 ) || ( width >= 13 ) ) {
+		put( ' ', ' ' );
+		if ( cell.IsPcNote() ) {
+			put_hex( cell.GetValueEffectCol() & 0x0fff, 3, 'e' );
+		} else if ( cell.command != OpenMPT::CMD_NONE ) {
+			put( sndFile.GetModSpecifications().GetEffectLetter( cell.command ), 'e' );
+			put_hex( cell.param, 2, 'f' );
+		} else {
+			put_string( "...", "...", 3 );
+		}
+	}
+}
+
 std::pair< std::string, std::string > module_impl::format_and_highlight_pattern_row_channel( std::int32_t p, std::int32_t r, std::int32_t c, std::size_t width, bool pad ) const {
 	std::string text = pad ? std::string( width, ' ' ) : std::string();
 	std::string high = pad ? std::string( width, ' ' ) : std::string();
@@ -1600,31 +1960,14 @@ std::pair< std::string, std::string > module_impl::format_and_highlight_pattern_
 	if ( c < 0 || c >= m_sndFile->GetNumChannels() ) {
 		return std::make_pair( text, high );
 	}
-	//  0000000001111
-	//  1234567890123
-	// "NNN IIvVV EFF"
 	const OpenMPT::ModCommand & cell = *pattern.GetpModCommand( static_cast<OpenMPT::ROWINDEX>( r ), static_cast<OpenMPT::CHANNELINDEX>( c ) );
 	text.clear();
 	high.clear();
+	format_and_highlight_cell( *m_sndFile, cell, width, [&]( char t, char h ) {
+		text.push_back( t );
+		high.push_back( h );
+	} );
 	// clang-format off
-	text += ( cell.IsNote() || cell.IsSpecialNote() ) ? mpt::transcode<std::string>( mpt::common_encoding::utf8, m_sndFile->GetNoteName( cell.note, cell.instr ) ) : std::string("...");
-	high += ( cell.IsNote() ) ? std::string("nnn") : cell.IsSpecialNote() ? std::string("mmm") : std::string("...");
-	if ( ( width == 0 ) || ( width >= 6 ) ) {
-		text += std::string(" ");
-		high += std::string(" ");
-		text += cell.instr ? OpenMPT::mpt::afmt::HEX0<2>( cell.instr ) : std::string("..");
-		high += cell.instr ? std::string("ii") : std::string("..");
-	}
-	if ( ( width == 0 ) || ( width >= 9 ) ) {
-		text += cell.IsPcNote() ? std::string(" ") + OpenMPT::mpt::afmt::HEX0<2>( cell.GetValueVolCol() & 0xff ) : cell.volcmd != OpenMPT::VOLCMD_NONE ? std::string( 1, m_sndFile->GetModSpecifications().GetVolEffectLetter( cell.volcmd ) ) + OpenMPT::mpt::afmt::HEX0<2>( cell.vol ) : std::string(" ..");
-		high += cell.IsPcNote() ? std::string(" vv") : cell.volcmd != OpenMPT::VOLCMD_NONE ? std::string("uvv") : std::string(" ..");
-	}
-	if ( ( width == 0 ) || ( width >= 13 ) ) {
-		text += std::string(" ");
-		high += std::string(" ");
-		text += cell.IsPcNote() ? OpenMPT::mpt::afmt::HEX0<3>( cell.GetValueEffectCol() & 0x0fff ) : cell.command != OpenMPT::CMD_NONE ? std::string( 1, m_sndFile->GetModSpecifications().GetEffectLetter( cell.command ) ) + OpenMPT::mpt::afmt::HEX0<2>( cell.param ) : std::string("...");
-		high += cell.IsPcNote() ? std::string("eff") : cell.command != OpenMPT::CMD_NONE ? std::string("eff") : std::string("...");
-	}
 	if ( ( width != 0 ) && ( text.length() > width ) ) {
 		text = text.substr( 0, width );
 	} else if ( ( width != 0 ) && pad ) {
@@ -1645,13 +1988,67 @@ std::string module_impl::highlight_pattern_row_channel( std::int32_t p, std::int
 	return format_and_highlight_pattern_row_channel( p, r, c, width, pad ).second;
 }
 
+std::size_t module_impl::format_and_highlight_pattern_block( std::int32_t p, std::int32_t first_row, std::int32_t num_rows, std::int32_t first_channel, std::int32_t num_channels, std::size_t width, char * text, char * high, std::size_t size ) const {
+	if ( num_rows <= 0 || num_channels <= 0 || width == 0 ) {
+		return 0;
+	}
+	if ( width > size / static_cast<std::size_t>( num_rows ) / static_cast<std::size_t>( num_channels ) ) {
+		return 0;
+	}
+	const OpenMPT::CPattern * pattern = nullptr;
+	if ( mpt::is_in_range( p, std::numeric_limits<OpenMPT::PATTERNINDEX>::min(), std::numeric_limits<OpenMPT::PATTERNINDEX>::max() ) && m_sndFile->Patterns.IsValidPat( static_cast<OpenMPT::PATTERNINDEX>( p ) ) ) {
+		pattern = &m_sndFile->Patterns[p];
+	}
+	std::size_t offset = 0;
+	for ( std::int32_t i = 0; i < num_rows; ++i ) {
+		const std::int64_t r = static_cast<std::int64_t>( first_row ) + i;
+		const bool valid_row = pattern && r >= 0 && r < static_cast<std::int64_t>( pattern->GetNumRows() );
+		for ( std::int32_t j = 0; j < num_channels; ++j ) {
+			const std::int64_t c = static_cast<std::int64_t>( first_channel ) + j;
+			std::size_t pos = 0;
+			if ( valid_row && c >= 0 && c < static_cast<std::int64_t>( m_sndFile->GetNumChannels() ) ) {
+				const OpenMPT::ModCommand & cell = *pattern->GetpModCommand( static_cast<OpenMPT::ROWINDEX>( r ), static_cast<OpenMPT::CHANNELINDEX>( c ) );
+				format_and_highlight_cell( *m_sndFile, cell, width, [&]( char t, char h ) {
+					if ( pos < width ) {
+						if ( text ) {
+							text[ offset + pos ] = t;
+						}
+						if ( high ) {
+							high[ offset + pos ] = h;
+						}
+					}
+					++pos;
+				} );
+			}
+			// Cells outside of the pattern are padded just like empty space in formatted cells
+			for ( ; pos < width; ++pos ) {
+				if ( text ) {
+					text[ offset + pos ] = ' ';
+				}
+				if ( high ) {
+					high[ offset + pos ] = ' ';
+				}
+			}
+			offset += width;
+		}
+	}
+	return offset;
+}
+
 std::pair<const module_impl::ctl_info *, const module_impl::ctl_info *> module_impl::get_ctl_infos() const {
 	static constexpr ctl_info ctl_infos[] = {
 		{ "load.skip_samples", ctl_type::boolean },
 		{ "load.skip_patterns", ctl_type::boolean },
 		{ "load.skip_plugins", ctl_type::boolean },
 		{ "load.skip_subsongs_init", ctl_type::boolean },
+		{ "load.lazy_samples", ctl_type::boolean },
+		{ "load.share_samples", ctl_type::boolean },
+		{ "load.threads", ctl_type::integer },
+		{ "load.subsongs_cache_directory", ctl_type::text },
+		{ "load.resampler_tables_file", ctl_type::text },
 		{ "seek.sync_samples", ctl_type::boolean },
+		{ "seek.checkpoint_interval", ctl_type::floatingpoint },
+		{ "seek.checkpoint_memory_limit", ctl_type::integer },
 		{ "subsong", ctl_type::integer },
 		{ "play.tempo_factor", ctl_type::floatingpoint },
 		{ "play.pitch_factor", ctl_type::floatingpoint },
@@ -1659,6 +2056,7 @@ std::pair<const module_impl::ctl_info *, const module_impl::ctl_info *> module_i
 		{ "render.resampler.emulate_amiga", ctl_type::boolean },
 		{ "render.resampler.emulate_amiga_type", ctl_type::text },
 		{ "render.opl.volume_factor", ctl_type::floatingpoint },
+		{ "render.mixer.threads", ctl_type::integer },
 		{ "dither", ctl_type::integer }
 	};
 	return std::make_pair(std::begin(ctl_infos), std::end(ctl_infos));
@@ -1752,6 +2150,10 @@ bool module_impl::ctl_get_boolean( std::string_view ctl, bool throw_if_unknown )
 		return m_ctl_load_skip_plugins;
 	} else if ( ctl == "load.skip_subsongs_init" ) {
 		return m_ctl_load_skip_subsongs_init;
+	} else if ( ctl == "load.lazy_samples" ) {
+		return m_ctl_load_lazy_samples;
+	} else if ( ctl == "load.share_samples" ) {
+		return m_ctl_load_share_samples;
 	} else if ( ctl == "seek.sync_samples" ) {
 		return m_ctl_seek_sync_samples;
 	} else if ( ctl == "render.resampler.emulate_amiga" ) {
@@ -1790,8 +2192,14 @@ std::int64_t module_impl::ctl_get_integer( std::string_view ctl, bool throw_if_u
 	}
 	if ( ctl == "" ) {
 		throw openmpt::exception("empty ctl");
+	} else if ( ctl == "load.threads" ) {
+		return m_sndFile->GetLoaderThreads();
 	} else if ( ctl == "subsong" ) {
 		return get_selected_subsong();
+	} else if ( ctl == "seek.checkpoint_memory_limit" ) {
+		return mpt::saturate_cast<std::int64_t>( m_seekCheckpoints->GetMemoryLimit() );
+	} else if ( ctl == "render.mixer.threads" ) {
+		return m_sndFile->GetMixerThreads();
 	} else if ( ctl == "dither" ) {
 		return static_cast<std::int64_t>( m_Dithers->GetMode() );
 	} else {
@@ -1828,6 +2236,8 @@ double module_impl::ctl_get_floatingpoint( std::string_view ctl, bool throw_if_u
 	}
 	if ( ctl == "" ) {
 		throw openmpt::exception("empty ctl");
+	} else if ( ctl == "seek.checkpoint_interval" ) {
+		return m_seekCheckpoints->GetInterval();
 	} else if ( ctl == "play.tempo_factor" ) {
 		if ( !is_loaded() ) {
 			return 1.0;
@@ -1871,6 +2281,11 @@ std::string module_impl::ctl_get_text( std::string_view ctl, bool throw_if_unkno
 	}
 	if ( ctl == "" ) {
 		throw openmpt::exception("empty ctl");
+	} else if ( ctl == "load.subsongs_cache_directory" ) {
+		const subsongs_cache_directory * cache = dynamic_cast<const subsongs_cache_directory *>( m_subsongs_cache.get() );
+		return cache ? cache->get_path() : std::string();
+	} else if ( ctl == "load.resampler_tables_file" ) {
+		return m_ctl_load_resampler_tables_file;
 	} else if ( ctl == "play.at_end" ) {
 		switch ( m_ctl_play_at_end )
 		{
@@ -1975,6 +2390,13 @@ void module_impl::ctl_set_boolean( std::string_view ctl, bool value, bool throw_
 		m_ctl_load_skip_plugins = value;
 	} else if ( ctl == "load.skip_subsongs_init" ) {
 		m_ctl_load_skip_subsongs_init = value;
+	} else if ( ctl == "load.lazy_samples" ) {
+		m_ctl_load_lazy_samples = value;
+		if ( !value && m_loaded ) {
+			m_sndFile->DecodeDeferredSamples();
+		}
+	} else if ( ctl == "load.share_samples" ) {
+		m_ctl_load_share_samples = value;
 	} else if ( ctl == "seek.sync_samples" ) {
 		m_ctl_seek_sync_samples = value;
 	} else if ( ctl == "render.resampler.emulate_amiga" ) {
@@ -2018,8 +2440,23 @@ void module_impl::ctl_set_integer( std::string_view ctl, std::int64_t value, boo
 
 	if ( ctl == "" ) {
 		throw openmpt::exception("empty ctl: := " + mpt::format_value_default<std::string>( value ) );
+	} else if ( ctl == "load.threads" ) {
+		if ( value < 0 ) {
+			throw openmpt::exception("invalid number of loader threads");
+		}
+		m_sndFile->SetLoaderThreads( mpt::saturate_cast<std::uint32_t>( value ) );
 	} else if ( ctl == "subsong" ) {
 		select_subsong( mpt::saturate_cast<std::int32_t>( value ) );
+	} else if ( ctl == "seek.checkpoint_memory_limit" ) {
+		if ( value < 0 ) {
+			throw openmpt::exception("invalid checkpoint memory limit");
+		}
+		m_seekCheckpoints->SetMemoryLimit( mpt::saturate_cast<std::size_t>( value ) );
+	} else if ( ctl == "render.mixer.threads" ) {
+		if ( value < 0 ) {
+			throw openmpt::exception("invalid number of mixer threads");
+		}
+		m_sndFile->SetMixerThreads( mpt::saturate_cast<std::uint32_t>( value ) );
 	} else if ( ctl == "dither" ) {
 		std::size_t dither = mpt::saturate_cast<std::size_t>( value );
 		if ( dither >= OpenMPT::DithersOpenMPT::GetNumDithers() ) {
@@ -2057,6 +2494,11 @@ void module_impl::ctl_set_floatingpoint( std::string_view ctl, double value, boo
 
 	if ( ctl == "" ) {
 		throw openmpt::exception("empty ctl: := " + mpt::format_value_default<std::string>( value ) );
+	} else if ( ctl == "seek.checkpoint_interval" ) {
+		if ( !( value >= 0.0 ) ) {
+			throw openmpt::exception("invalid checkpoint interval");
+		}
+		m_seekCheckpoints->SetInterval( value );
 	} else if ( ctl == "play.tempo_factor" ) {
 		if ( !is_loaded() ) {
 			return;
@@ -2110,6 +2552,14 @@ void module_impl::ctl_set_text( std::string_view ctl, std::string_view value, bo
 
 	if ( ctl == "" ) {
 		throw openmpt::exception("empty ctl: := " + std::string( value ) );
+	} else if ( ctl == "load.subsongs_cache_directory" ) {
+		if ( value.empty() ) {
+			m_subsongs_cache.reset();
+		} else {
+			m_subsongs_cache = std::make_unique<subsongs_cache_directory>( std::string( value ) );
+		}
+	} else if ( ctl == "load.resampler_tables_file" ) {
+		m_ctl_load_resampler_tables_file = std::string( value );
 	} else if ( ctl == "play.at_end" ) {
 		if ( value == "fadeout" ) {
 			m_ctl_play_at_end = song_end_action::fadeout_song;
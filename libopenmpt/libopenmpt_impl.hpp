@@ -44,6 +44,7 @@ class PathString;
 } // namespace mpt
 using FileCursor = detail::FileCursor<mpt::IO::FileCursorTraitsFileData, mpt::IO::FileCursorFilenameTraits<mpt::PathString>>;
 class CSoundFile;
+class GetLengthCheckpoints;
 struct DithersWrapperOpenMPT;
 } // namespace OpenMPT
 
@@ -74,6 +75,29 @@ public:
 	void log( const std::string & message ) const override;
 }; // class CSoundFileLog_std_ostream
 
+class subsongs_cache_interface {
+protected:
+	subsongs_cache_interface();
+public:
+	virtual ~subsongs_cache_interface();
+	// Returns false if there is no record for key.
+	virtual bool lookup( const std::string & key, std::string & record ) = 0;
+	virtual void store( const std::string & key, const std::string & record ) = 0;
+}; // class subsongs_cache_interface
+
+// Stores one file per record in an existing directory.
+class subsongs_cache_directory : public subsongs_cache_interface {
+private:
+	std::string m_path;
+	std::string get_filename( const std::string & key ) const;
+public:
+	subsongs_cache_directory( const std::string & path );
+	virtual ~subsongs_cache_directory();
+	const std::string & get_path() const;
+	bool lookup( const std::string & key, std::string & record ) override;
+	void store( const std::string & key, const std::string & record ) override;
+}; // class subsongs_cache_directory
+
 class log_forwarder;
 
 struct callback_stream_wrapper {
@@ -138,17 +162,28 @@ protected:
 	bool m_ctl_load_skip_patterns;
 	bool m_ctl_load_skip_plugins;
 	bool m_ctl_load_skip_subsongs_init;
+	bool m_ctl_load_lazy_samples;
+	bool m_ctl_load_share_samples;
 	bool m_ctl_seek_sync_samples;
+	std::unique_ptr<OpenMPT::GetLengthCheckpoints> m_seekCheckpoints;
+	std::unique_ptr<subsongs_cache_interface> m_subsongs_cache;
+	std::string m_ctl_load_resampler_tables_file;
 	std::vector<std::string> m_loaderMessages;
 public:
 	void PushToCSoundFileLog( const std::string & text ) const;
 	void PushToCSoundFileLog( int loglevel, const std::string & text ) const;
 protected:
 	std::string mod_string_to_utf8( const std::string & encoded ) const;
+	static std::string mod_string_to_utf8( const OpenMPT::CSoundFile & sndFile, const std::string & encoded );
 	void apply_mixer_settings( std::int32_t samplerate, int channels );
 	void apply_libopenmpt_defaults();
 	subsongs_type get_subsongs() const;
 	void init_subsongs( subsongs_type & subsongs ) const;
+	void init_subsongs_cached( const OpenMPT::FileCursor & file, int load_flags, subsongs_type & subsongs ) const;
+	static std::string get_subsongs_cache_key( const OpenMPT::FileCursor & file, int load_flags );
+	static std::string serialize_subsongs( const subsongs_type & subsongs );
+	bool deserialize_subsongs( const std::string & record, subsongs_type & subsongs ) const;
+	static void init_resampler_tables_cache( const std::string & filename );
 	bool has_subsongs_inited() const;
 	void ctor( const std::map< std::string, std::string > & ctls );
 	void load( const OpenMPT::FileCursor & file, const std::map< std::string, std::string > & ctls );
@@ -157,8 +192,8 @@ protected:
 	std::size_t read_wrapper( std::size_t count, float * left, float * right, float * rear_left, float * rear_right );
 	std::size_t read_interleaved_wrapper( std::size_t count, std::size_t channels, std::int16_t * interleaved );
 	std::size_t read_interleaved_wrapper( std::size_t count, std::size_t channels, float * interleaved );
-	std::string get_message_instruments() const;
-	std::string get_message_samples() const;
+	static std::string get_message_instruments( const OpenMPT::CSoundFile & sndFile );
+	static std::string get_message_samples( const OpenMPT::CSoundFile & sndFile );
 	std::pair< std::string, std::string > format_and_highlight_pattern_row_channel_command( std::int32_t p, std::int32_t r, std::int32_t c, int command ) const;
 	std::pair< std::string, std::string > format_and_highlight_pattern_row_channel( std::int32_t p, std::int32_t r, std::int32_t c, std::size_t width, bool pad ) const;
 	static double could_open_probability( const OpenMPT::FileCursor & file, double effort, std::unique_ptr<log_interface> log );
@@ -207,7 +242,8 @@ public:
 	std::size_t read_interleaved_quad( std::int32_t samplerate, std::size_t count, std::int16_t * interleaved_quad );
 	std::size_t read_interleaved_stereo( std::int32_t samplerate, std::size_t count, float * interleaved_stereo );
 	std::size_t read_interleaved_quad( std::int32_t samplerate, std::size_t count, float * interleaved_quad );
-	std::vector<std::string> get_metadata_keys() const;
+	static std::vector<std::string> get_metadata_keys();
+	static std::string get_metadata( const OpenMPT::CSoundFile & sndFile, const std::vector<std::string> & loaderMessages, const std::string & key );
 	std::string get_metadata( const std::string & key ) const;
 	double get_current_estimated_bpm() const;
 	std::int32_t get_current_speed() const;
@@ -241,6 +277,7 @@ public:
 	std::string highlight_pattern_row_channel_command( std::int32_t p, std::int32_t r, std::int32_t c, int cmd ) const;
 	std::string format_pattern_row_channel( std::int32_t p, std::int32_t r, std::int32_t c, std::size_t width, bool pad ) const;
 	std::string highlight_pattern_row_channel( std::int32_t p, std::int32_t r, std::int32_t c, std::size_t width, bool pad ) const;
+	std::size_t format_and_highlight_pattern_block( std::int32_t p, std::int32_t first_row, std::int32_t num_rows, std::int32_t first_channel, std::int32_t num_channels, std::size_t width, char * text, char * high, std::size_t size ) const;
 	std::pair<const module_impl::ctl_info *, const module_impl::ctl_info *> get_ctl_infos() const;
 	std::vector<std::string> get_ctls() const;
 	std::string ctl_get( std::string ctl, bool throw_if_unknown = true ) const;
@@ -255,6 +292,19 @@ public:
 	void ctl_set_text( std::string_view ctl, std::string_view value, bool throw_if_unknown = true );
 }; // class module_impl
 
+// Reads only the metadata of a module, without preparing it for playback (see openmpt::module_info).
+class module_info_impl {
+private:
+	std::vector< std::pair< std::string, std::string > > m_metadata;
+	void load( const OpenMPT::FileCursor & file, const log_interface & log );
+public:
+	module_info_impl( callback_stream_wrapper stream, std::unique_ptr<log_interface> log );
+	module_info_impl( std::istream & stream, std::unique_ptr<log_interface> log );
+	module_info_impl( const void * data, std::size_t size, std::unique_ptr<log_interface> log );
+	std::vector<std::string> get_metadata_keys() const;
+	std::string get_metadata( const std::string & key ) const;
+}; // class module_info_impl
+
 namespace helper {
 
 template<typename T, typename... Args> std::unique_ptr<T> make_unique(Args&&... args) {
@@ -18,6 +18,8 @@
 #if defined(MPT_ENABLE_ARCH_INTRINSICS)
 #if MPT_COMPILER_MSVC && (defined(MPT_ENABLE_ARCH_X86) || defined(MPT_ENABLE_ARCH_AMD64))
 #include <intrin.h>
+#elif (MPT_COMPILER_GCC || MPT_COMPILER_CLANG) && (defined(MPT_ENABLE_ARCH_X86) || defined(MPT_ENABLE_ARCH_AMD64))
+#include <cpuid.h>
 #endif // MPT_COMPILER_MSVC && (MPT_ENABLE_ARCH_X86 || MPT_ENABLE_ARCH_AMD64)
 #endif // MPT_ENABLE_ARCH_INTRINSICS
 
@@ -35,7 +37,7 @@ namespace CPU
 MPT_CONSTINIT uint32 EnabledFeatures = 0;
 
 
-#if MPT_COMPILER_MSVC && (defined(MPT_ENABLE_ARCH_X86) || defined(MPT_ENABLE_ARCH_AMD64))
+#if (MPT_COMPILER_MSVC || MPT_COMPILER_GCC || MPT_COMPILER_CLANG) && (defined(MPT_ENABLE_ARCH_X86) || defined(MPT_ENABLE_ARCH_AMD64))
 
 
 typedef char cpuid_result_string[12];
@@ -87,6 +89,9 @@ struct cpuid_result {
 };
 
 
+#if MPT_COMPILER_MSVC
+
+
 static cpuid_result cpuid(uint32 function)
 {
 	cpuid_result result;
@@ -113,6 +118,38 @@ static cpuid_result cpuidex(uint32 function_a, uint32 function_c)
 }
 
 
+#else // !MPT_COMPILER_MSVC
+
+
+static cpuid_result cpuid(uint32 function)
+{
+	cpuid_result result;
+	unsigned int a = 0, b = 0, c = 0, d = 0;
+	__cpuid(function, a, b, c, d);
+	result.a = a;
+	result.b = b;
+	result.c = c;
+	result.d = d;
+	return result;
+}
+
+
+static cpuid_result cpuidex(uint32 function_a, uint32 function_c)
+{
+	cpuid_result result;
+	unsigned int a = 0, b = 0, c = 0, d = 0;
+	__cpuid_count(function_a, function_c, a, b, c, d);
+	result.a = a;
+	result.b = b;
+	result.c = c;
+	result.d = d;
+	return result;
+}
+
+
+#endif // MPT_COMPILER_MSVC
+
+
 Info::Info()
 {
 
@@ -222,6 +259,12 @@ void EnableAvailableFeatures()
 }
 
 
+#if !defined(MODPLUG_TRACKER)
+// There are no user settings to restrict the used CPU features in the library, so enable all of them right away.
+static AvailableFeaturesEnabler g_AvailableFeaturesEnabler;
+#endif // !MODPLUG_TRACKER
+
+
 #endif // MPT_ENABLE_ARCH_INTRINSICS
 
 
@@ -247,6 +290,22 @@ uint32 GetMinimumFeatures()
 			#if defined(__AVX2__)
 				flags |= feature::avx2;
 			#endif
+		#elif MPT_COMPILER_GCC || MPT_COMPILER_CLANG
+			#if defined(__x86_64__)
+				flags |= feature::lm;
+			#endif
+			#if defined(__SSE__)
+				flags |= feature::sse;
+			#endif
+			#if defined(__SSE2__)
+				flags |= feature::sse2;
+			#endif
+			#if defined(__AVX__)
+				flags |= feature::avx;
+			#endif
+			#if defined(__AVX2__)
+				flags |= feature::avx2;
+			#endif
 		#endif	
 	#endif // MPT_ENABLE_ARCH_INTRINSICS
 	return flags;
@@ -38,6 +38,8 @@ static const char * const license =
 #include "openmpt123_config.hpp"
 
 #include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <deque>
 #include <fstream>
 #include <iomanip>
@@ -85,6 +87,7 @@ static const char * const license =
 #include <mmsystem.h>
 #include <mmreg.h>
 #else
+#include <fcntl.h>
 #include <termios.h>
 #include <unistd.h>
 #include <sys/ioctl.h>
@@ -97,6 +100,18 @@ static const char * const license =
 
 #include "openmpt123.hpp"
 
+#include "mpt/io_read/filedata_mmap.hpp"
+#include "mpt/mutex/mutex.hpp"
+
+#if MPT_MUTEX_STD && !(MPT_OS_WINDOWS && MPT_LIBCXX_GNU && !defined(_GLIBCXX_HAS_GTHREADS))
+#define OPENMPT123_ENABLE_JOBS
+#endif
+
+#if defined( OPENMPT123_ENABLE_JOBS )
+#include <mutex>
+#include <thread>
+#endif
+
 #include "openmpt123_flac.hpp"
 #include "openmpt123_mmio.hpp"
 #include "openmpt123_sndfile.hpp"
@@ -305,6 +320,7 @@ static std::ostream & operator << ( std::ostream & s, const commandlineflags & f
 	s << "Standard output: " << flags.use_stdout << std::endl;
 	s << "Output filename: " << flags.output_filename << std::endl;
 	s << "Force overwrite output file: " << flags.force_overwrite << std::endl;
+	s << "Jobs: " << flags.jobs << std::endl;
 	s << "Ctls: " << ctls_to_string( flags.ctls ) << std::endl;
 	s << std::endl;
 	s << "Files: " << std::endl;
@@ -419,6 +435,19 @@ static std::string get_filename( const std::string & filepath ) {
 	return filepath.substr( filepath.find_last_of( path_separators() ) + 1 );
 }
 
+#if MPT_IO_READ_FILEDATA_MMAP
+// Returns nullptr for stdin, pipes and anything else that cannot be mapped; the caller falls back to reading through a stream.
+static std::shared_ptr<const mpt::IO::FileDataMapped> map_file( const std::string & filename ) {
+	int fd = open( filename.c_str(), O_RDONLY | O_CLOEXEC );
+	if ( fd < 0 ) {
+		return nullptr;
+	}
+	std::shared_ptr<const mpt::IO::FileDataMapped> mapping = mpt::IO::FileDataMapped::Map( fd );
+	close( fd );
+	return mapping;
+}
+#endif
+
 static std::string prepend_lines( std::string str, const std::string & prefix ) {
 	if ( str.empty() ) {
 		return str;
@@ -668,6 +697,7 @@ static void show_help( textout & log, bool with_info = true, bool longhelp = fal
 		log << "     --output-type t        Use output format t when writing to a individual PCM files (only applies to --render mode) [default: " << commandlineflags().output_extension << "]" << std::endl;
 		log << " -o, --output f             Write PCM output to file f instead of streaming to audio device (only applies to --ui and --batch modes) [default: " << commandlineflags().output_filename << "]" << std::endl;
 		log << "     --force                Force overwriting of output file [default: " << commandlineflags().force_overwrite << "]" << std::endl;
+		log << "     --jobs n               Render n files at the same time, 0 means one per CPU core (only applies to --render mode) [default: " << commandlineflags().jobs << "]" << std::endl;
 		log << std::endl;
 		log << "     --                     Interpret further arguments as filenames" << std::endl;
 		log << std::endl;
@@ -1658,11 +1688,12 @@ static void probe_file( commandlineflags & flags, const std::string & filename,
 
 }
 
-static void render_file( commandlineflags & flags, const std::string & filename, textout & log, write_buffers_interface & audio_stream ) {
+static bool render_file( commandlineflags & flags, const std::string & filename, textout & log, write_buffers_interface & audio_stream ) {
 
 	log.writeout();
 
 	std::ostringstream silentlog;
+	bool success = false;
 
 	try {
 
@@ -1673,7 +1704,15 @@ static void render_file( commandlineflags & flags, const std::string & filename,
 #endif
 		std::uint64_t filesize = 0;
 		bool use_stdin = ( filename == "-" );
+		std::shared_ptr<const mpt::IO::IFileData> file_mapping;
+#if MPT_IO_READ_FILEDATA_MMAP
 		if ( !use_stdin ) {
+			file_mapping = map_file( filename );
+		}
+#endif
+		if ( file_mapping ) {
+			filesize = file_mapping->GetLength();
+		} else if ( !use_stdin ) {
 			#if defined(WIN32) && defined(UNICODE) && !defined(_MSC_VER)
 				// Only MSVC has std::ifstream::ifstream(std::wstring).
 				// Fake it for other compilers using _wfopen().
@@ -1704,16 +1743,24 @@ static void render_file( commandlineflags & flags, const std::string & filename,
 			#endif
 		}
 		std::istream & data_stream = use_stdin ? std::cin : file_stream;
-		if ( data_stream.fail() ) {
+		if ( !file_mapping && data_stream.fail() ) {
 			throw exception( "file open error" );
 		}
 
 		{
-			openmpt::module mod( data_stream, silentlog, flags.ctls );
-			mod.select_subsong( flags.subsong );
+			std::unique_ptr<openmpt::module> mod;
+			if ( file_mapping ) {
+				// The module does not reference the input data after construction, so the mapping can go away right here.
+				mod = std::make_unique<openmpt::module>( file_mapping->GetRawData(), file_mapping->GetLength(), silentlog, flags.ctls );
+				file_mapping = nullptr;
+			} else {
+				mod = std::make_unique<openmpt::module>( data_stream, silentlog, flags.ctls );
+			}
+			mod->select_subsong( flags.subsong );
 			silentlog.str( std::string() ); // clear, loader messages get stored to get_metadata( "warnings" ) by libopenmpt internally
-			render_mod_file( flags, filename, filesize, mod, log, audio_stream );
+			render_mod_file( flags, filename, filesize, *mod, log, audio_stream );
 		}
+		success = true;
 
 	} catch ( prev_file & ) {
 		throw;
@@ -1741,8 +1788,154 @@ static void render_file( commandlineflags & flags, const std::string & filename,
 
 	log.writeout();
 
+	return success;
+
+}
+
+
+#if defined( OPENMPT123_ENABLE_JOBS )
+
+class counting_audio_stream : public write_buffers_interface {
+private:
+	write_buffers_interface & impl;
+	std::uint64_t frames;
+public:
+	counting_audio_stream( write_buffers_interface & impl_ )
+		: impl(impl_)
+		, frames(0)
+	{
+		return;
+	}
+	virtual ~counting_audio_stream() {
+		return;
+	}
+	std::uint64_t get_frames() const {
+		return frames;
+	}
+	void write_metadata( std::map<std::string,std::string> metadata ) override {
+		impl.write_metadata( metadata );
+	}
+	void write_updated_metadata( std::map<std::string,std::string> metadata ) override {
+		impl.write_updated_metadata( metadata );
+	}
+	void write( const std::vector<float*> buffers, std::size_t frames_ ) override {
+		impl.write( buffers, frames_ );
+		frames += frames_;
+	}
+	void write( const std::vector<std::int16_t*> buffers, std::size_t frames_ ) override {
+		impl.write( buffers, frames_ );
+		frames += frames_;
+	}
+};
+
+// Renders each file to an individual PCM file on flags.jobs worker threads.
+// Every worker only ever holds a single module, so memory usage is bounded by the number of jobs.
+// Screen output of each file is collected and written in one go once the file is finished.
+static void render_files_parallel( const commandlineflags & flags, textout & log ) {
+
+	const std::size_t num_files = flags.filenames.size();
+	std::size_t num_jobs = ( flags.jobs > 0 ) ? static_cast<std::size_t>( flags.jobs ) : std::max( std::thread::hardware_concurrency(), 1u );
+	num_jobs = std::min( num_jobs, num_files );
+
+	log << "Rendering " << num_files << " files using " << num_jobs << " jobs" << std::endl;
+	log << std::endl;
+	log.writeout();
+
+	std::atomic<std::size_t> next_file{ 0 };
+	std::mutex log_mutex;
+	std::size_t files_done = 0;
+	std::size_t files_failed = 0;
+	double total_audio_seconds = 0.0;
+	double total_render_seconds = 0.0;
+	double slowest_render_seconds = 0.0;
+	std::string slowest_filename;
+
+	const auto start_time = std::chrono::steady_clock::now();
+
+	auto worker = [&]() {
+		commandlineflags job_flags = flags;
+		// Progress is reported per finished file instead.
+		job_flags.show_progress = false;
+		while ( true ) {
+			const std::size_t index = next_file++;
+			if ( index >= num_files ) {
+				break;
+			}
+			const std::string & filename = flags.filenames[ index ];
+			job_flags.playlist_index = index;
+			textout_buffer file_log;
+			bool success = false;
+			std::uint64_t frames = 0;
+			const auto file_start_time = std::chrono::steady_clock::now();
+			try {
+				file_audio_stream_raii file_audio_stream( job_flags, filename + std::string(".") + job_flags.output_extension, file_log );
+				counting_audio_stream audio_stream( file_audio_stream );
+				success = render_file( job_flags, filename, file_log, audio_stream );
+				frames = audio_stream.get_frames();
+			} catch ( std::exception & e ) {
+				file_log << "error rendering '" << filename << "': " << e.what() << std::endl;
+			} catch ( ... ) {
+				file_log << "unknown error rendering '" << filename << "'" << std::endl;
+			}
+			const double render_seconds = std::chrono::duration<double>( std::chrono::steady_clock::now() - file_start_time ).count();
+			const double audio_seconds = static_cast<double>( frames ) / static_cast<double>( job_flags.samplerate );
+			std::lock_guard<std::mutex> guard( log_mutex );
+			files_done++;
+			if ( success ) {
+				total_audio_seconds += audio_seconds;
+				total_render_seconds += render_seconds;
+				if ( render_seconds > slowest_render_seconds ) {
+					slowest_render_seconds = render_seconds;
+					slowest_filename = filename;
+				}
+			} else {
+				files_failed++;
+			}
+			log << file_log.take();
+			log << "[" << files_done << "/" << num_files << "] " << ( success ? "Rendered" : "Failed" ) << " '" << filename << "'";
+			if ( success ) {
+				log << ": " << seconds_to_string( audio_seconds ) << " in " << seconds_to_string( render_seconds );
+				if ( render_seconds > 0.0 ) {
+					log << " (" << static_cast<std::int64_t>( audio_seconds / render_seconds ) << "x realtime)";
+				}
+			}
+			log << std::endl;
+			log.writeout();
+		}
+	};
+
+	std::vector<std::thread> threads;
+	for ( std::size_t job = 1; job < num_jobs; ++job ) {
+		threads.emplace_back( worker );
+	}
+	worker();
+	for ( auto & thread : threads ) {
+		thread.join();
+	}
+
+	const double wall_seconds = std::chrono::duration<double>( std::chrono::steady_clock::now() - start_time ).count();
+
+	log << std::endl;
+	log << "Files rendered: " << ( files_done - files_failed ) << "/" << num_files << std::endl;
+	if ( files_failed > 0 ) {
+		log << "Files failed: " << files_failed << std::endl;
+	}
+	log << "Audio duration: " << seconds_to_string( total_audio_seconds ) << std::endl;
+	log << "Render time (all jobs): " << seconds_to_string( total_render_seconds ) << std::endl;
+	log << "Wall clock time: " << seconds_to_string( wall_seconds ) << std::endl;
+	if ( wall_seconds > 0.0 ) {
+		log << "Speed: " << static_cast<std::int64_t>( total_audio_seconds / wall_seconds ) << "x realtime" << std::endl;
+	}
+	if ( !slowest_filename.empty() ) {
+		log << "Slowest file: '" << slowest_filename << "' (" << seconds_to_string( slowest_render_seconds ) << ")" << std::endl;
+	}
+	log << std::endl;
+	log.writeout();
+
 }
 
+#endif // OPENMPT123_ENABLE_JOBS
+
 
 static std::string get_random_filename( std::set<std::string> & filenames, std::default_random_engine & prng ) {
 	std::size_t index = std::uniform_int_distribution<std::size_t>( 0, filenames.size() - 1 )( prng );
@@ -2108,6 +2301,10 @@ static commandlineflags parse_openmpt123( const std::vector<std::string> & args,
 				++i;
 			} else if ( arg == "--force" ) {
 				flags.force_overwrite = true;
+			} else if ( arg == "--jobs" && nextarg != "" ) {
+				std::istringstream istr( nextarg );
+				istr >> flags.jobs;
+				++i;
 			} else if ( arg == "--output-type" && nextarg != "" ) {
 				flags.output_extension = nextarg;
 				++i;
@@ -2472,6 +2669,13 @@ static int main( int argc, char * argv [] ) {
 				}
 			} break;
 			case Mode::Render: {
+#if defined( OPENMPT123_ENABLE_JOBS )
+				if ( flags.jobs != 1 ) {
+					flags.apply_default_buffer_sizes();
+					render_files_parallel( flags, log );
+					break;
+				}
+#endif
 				for ( const auto & filename : flags.filenames ) {
 					flags.apply_default_buffer_sizes();
 					file_audio_stream_raii file_audio_stream( flags, filename + std::string(".") + flags.output_extension, log );
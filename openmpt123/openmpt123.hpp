@@ -89,6 +89,37 @@ public:
 	}
 };
 
+// Collects text for later output.
+// Like on a terminal, a carriage return discards the current line, so repeatedly updated status lines do not pile up.
+class textout_buffer : public textout {
+private:
+	std::string buffer;
+public:
+	textout_buffer() {
+		return;
+	}
+	virtual ~textout_buffer() {
+		return;
+	}
+public:
+	void writeout() override {
+		for ( const char c : pop() ) {
+			if ( c == '\r' ) {
+				const std::size_t line_start = buffer.find_last_of( '\n' );
+				buffer.resize( ( line_start == std::string::npos ) ? 0 : line_start + 1 );
+			} else {
+				buffer.push_back( c );
+			}
+		}
+	}
+	std::string take() {
+		writeout();
+		std::string text;
+		text.swap( buffer );
+		return text;
+	}
+};
+
 class textout_ostream : public textout {
 private:
 	std::ostream & s;
@@ -307,6 +338,7 @@ struct commandlineflags {
 	std::string output_filename;
 	std::string output_extension;
 	bool force_overwrite;
+	std::int32_t jobs;
 	bool paused;
 	std::string warnings;
 	void apply_default_buffer_sizes() {
@@ -428,6 +460,7 @@ struct commandlineflags {
 		playlist_index = 0;
 		output_extension = "auto";
 		force_overwrite = false;
+		jobs = 1;
 		paused = false;
 	}
 	void check_and_sanitize() {
@@ -516,6 +549,12 @@ struct commandlineflags {
 		if ( mode == Mode::Render && !output_filename.empty() ) {
 			throw args_error_exception();
 		}
+		if ( jobs < 0 ) {
+			throw args_error_exception();
+		}
+		if ( mode != Mode::Render && jobs != 1 ) {
+			throw args_error_exception();
+		}
 		if ( mode != Mode::Render && !output_filename.empty() ) {
 			output_extension = get_extension( output_filename );
 		}
@@ -139,4 +139,54 @@ public:
 };
 
 
+// Writes directly into planar float output buffers.
+// Float output is never dithered, and the gain is folded into the fixed-point to float conversion factor.
+// As the conversion factor is a power of two, the result is bit-identical to AudioTargetBufferWithGain.
+class AudioTargetPlanarFloat
+	: public IAudioTarget
+{
+private:
+	std::size_t countRendered = 0;
+	mpt::audio_span_planar<float> outputBuffer;
+	const float gainFactor;
+public:
+	AudioTargetPlanarFloat(mpt::audio_span_planar<float> buf, float gainFactor_)
+		: outputBuffer(buf)
+		, gainFactor(gainFactor_)
+	{
+		return;
+	}
+	std::size_t GetRenderedCount() const { return countRendered; }
+public:
+	void Process(mpt::audio_span_interleaved<MixSampleInt> buffer) override
+	{
+		const float factor = gainFactor * (1.0f / static_cast<float>(1 << MixSampleIntTraits::mix_fractional_bits));
+		ProcessChannels(buffer, factor);
+	}
+	void Process(mpt::audio_span_interleaved<MixSampleFloat> buffer) override
+	{
+		ProcessChannels(buffer, gainFactor);
+	}
+private:
+	template <typename TSample>
+	void ProcessChannels(mpt::audio_span_interleaved<TSample> buffer, const float factor)
+	{
+		const std::size_t channels = buffer.size_channels();
+		const std::size_t frames = buffer.size_frames();
+		MPT_ASSERT(outputBuffer.size_channels() >= channels);
+		MPT_ASSERT(countRendered + frames <= outputBuffer.size_frames());
+		for(std::size_t channel = 0; channel < channels; ++channel)
+		{
+			const TSample *in = buffer.data() + channel;
+			float *out = outputBuffer.data_planar()[channel] + countRendered;
+			for(std::size_t frame = 0; frame < frames; ++frame)
+			{
+				out[frame] = static_cast<float>(in[frame * channels]) * factor;
+			}
+		}
+		countRendered += frames;
+	}
+};
+
+
 OPENMPT_NAMESPACE_END
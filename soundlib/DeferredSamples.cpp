@@ -0,0 +1,138 @@
+/*
+ * DeferredSamples.cpp
+ * -------------------
+ * Purpose: Sample data that is decoded when it is first needed instead of while loading the module.
+ * Notes  : (currently none)
+ * Authors: OpenMPT Devs
+ * The OpenMPT source code is released under the BSD license. Read LICENSE for more details.
+ */
+
+
+#include "stdafx.h"
+#include "DeferredSamples.h"
+#include "ITCompression.h"
+#include "ModSample.h"
+#include "../common/FileReader.h"
+
+
+OPENMPT_NAMESPACE_BEGIN
+
+
+// Returns the number of bytes occupied by an IT-compressed sample starting at the current file position,
+// or 0 if the data is truncated. The file position is not changed.
+static FileReader::pos_type GetITCompressedSize(const ModSample &sample, const SampleIO &format, FileReader file)
+{
+	const FileReader::pos_type startPos = file.GetPosition();
+	const SmpLength samplesPerBlock = static_cast<SmpLength>(ITCompression::blockSize / (format.GetBitDepth() / 8u));
+	for(uint8 chn = 0; chn < format.GetNumChannels(); chn++)
+	{
+		SmpLength writtenSamples = 0;
+		while(writtenSamples < sample.nLength)
+		{
+			if(!file.CanRead(sizeof(uint16)))
+				return 0;
+			const uint16 compressedSize = file.ReadUint16LE();
+			if(!compressedSize)
+				continue;
+			if(!file.Skip(compressedSize))
+				return 0;
+			writtenSamples += std::min(sample.nLength - writtenSamples, samplesPerBlock);
+		}
+	}
+	return file.GetPosition() - startPos;
+}
+
+
+bool DeferredSamples::Add(SAMPLEINDEX smp, ModSample &sample, const SampleIO &format, FileReader &file, std::size_t &encodedSize)
+{
+	if(sample.nLength < 1 || sample.nLength > MAX_SAMPLE_LENGTH || !file.IsValid())
+		return false;
+
+	// SampleIO::ReadSample shortens samples that are longer than what the available data can possibly decode to.
+	// Such samples are read right away, so that the sample length is already correct before decoding the sample.
+	encodedSize = 0;
+	const SampleIO::Encoding encoding = format.GetEncoding();
+	if(encoding == SampleIO::IT214 || encoding == SampleIO::IT215)
+	{
+		// Only the blocks that are needed for the given sample length are kept.
+		// Note: A block with corrupted data can make the decoder read beyond that, which the decoder then treats as truncated data.
+		encodedSize = GetITCompressedSize(sample, format, file);
+		if(!encodedSize || encodedSize * (8u / format.GetNumChannels()) < sample.nLength)
+			return false;
+	} else if(!format.IsVariableLengthEncoded() && file.CanRead(format.CalculateEncodedSize(sample.nLength)))
+	{
+		encodedSize = format.CalculateEncodedSize(sample.nLength);
+	} else
+	{
+		return false;
+	}
+
+	FileReader sampleData = file;
+	if(!Add(smp, sample, sampleData.ReadChunk(encodedSize), [format](ModSample &decodedSample, FileReader &data) { return format.ReadSample(decodedSample, data) != 0; }))
+		return false;
+	sample.uFlags.set(CHN_16BIT, format.GetBitDepth() >= 16);
+	sample.uFlags.set(CHN_STEREO, format.GetChannelFormat() != SampleIO::mono);
+	return true;
+}
+
+
+bool DeferredSamples::Add(SAMPLEINDEX smp, ModSample &sample, FileReader sampleData, Decoder decoder)
+{
+	if(smp == 0 || smp >= MAX_SAMPLES || sample.nLength < 1 || sample.nLength > MAX_SAMPLE_LENGTH || !sampleData.IsValid())
+		return false;
+
+	if(m_samples.size() <= smp)
+		m_samples.resize(smp + 1);
+	Sample &entry = m_samples[smp];
+	if(!entry.deferred)
+		m_numDeferred++;
+	sampleData.Rewind();
+	const auto view = sampleData.GetPinnedView();
+	entry.data.assign(view.begin(), view.end());
+	entry.decoder = std::move(decoder);
+	entry.deferred = true;
+
+	sample.FreeSample();
+	return true;
+}
+
+
+bool DeferredSamples::Decode(SAMPLEINDEX smp, ModSample &sample)
+{
+	if(!IsDeferred(smp))
+		return false;
+
+	Sample &entry = m_samples[smp];
+	entry.deferred = false;
+	m_numDeferred--;
+
+	const std::vector<std::byte> data = std::move(entry.data);
+	const Decoder decoder = std::move(entry.decoder);
+	entry = {};
+	FileReader file(mpt::as_span(data));
+	const bool decoded = decoder(sample, file);
+	if(empty())
+		Clear();
+	return decoded;
+}
+
+
+void DeferredSamples::Remove(SAMPLEINDEX smp)
+{
+	if(!IsDeferred(smp))
+		return;
+	m_samples[smp] = {};
+	m_numDeferred--;
+	if(empty())
+		Clear();
+}
+
+
+void DeferredSamples::Clear()
+{
+	m_samples.clear();
+	m_numDeferred = 0;
+}
+
+
+OPENMPT_NAMESPACE_END
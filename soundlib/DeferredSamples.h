@@ -0,0 +1,74 @@
+/*
+ * DeferredSamples.h
+ * -----------------
+ * Purpose: Sample data that is decoded when it is first needed instead of while loading the module.
+ * Notes  : Used when loading with CSoundFile::deferSampleData. The encoded data of each deferred sample
+ *          is copied so that it stays available after loading has finished, and freed once it has been decoded.
+ * Authors: OpenMPT Devs
+ * The OpenMPT source code is released under the BSD license. Read LICENSE for more details.
+ */
+
+
+#pragma once
+
+#include "openmpt/all/BuildSettings.hpp"
+
+#include "Snd_defs.h"
+#include "SampleIO.h"
+#include "../common/FileReaderFwd.h"
+
+#include <functional>
+#include <vector>
+
+
+OPENMPT_NAMESPACE_BEGIN
+
+
+struct ModSample;
+
+
+class DeferredSamples
+{
+public:
+	// Decodes the sample from the encoded data that was passed to Add(). Returns true if the sample has been decoded.
+	using Decoder = std::function<bool(ModSample &sample, FileReader &file)>;
+
+	// Remember that the sample data for the given sample starts at the current position of the file and is encoded in the given format.
+	// The sample properties are updated as if the sample was read.
+	// Returns false if the sample should be read right away instead, e.g. because the data is truncated. The file position is not changed.
+	// On success, encodedSize receives the number of bytes that the encoded sample data occupies in the file.
+	bool Add(SAMPLEINDEX smp, ModSample &sample, const SampleIO &format, FileReader &file, std::size_t &encodedSize);
+	// Remember that the sample data for the given sample is stored in sampleData and has to be decoded with the given decoder.
+	// The sample length and flags must already be set up.
+	bool Add(SAMPLEINDEX smp, ModSample &sample, FileReader sampleData, Decoder decoder);
+
+	// Check if the sample data for the given sample has not been decoded yet.
+	bool IsDeferred(SAMPLEINDEX smp) const
+	{
+		return smp < m_samples.size() && m_samples[smp].deferred;
+	}
+
+	bool empty() const { return m_numDeferred == 0; }
+
+	// Decode the sample data for the given sample and forget about it. Returns true if the sample has been decoded.
+	bool Decode(SAMPLEINDEX smp, ModSample &sample);
+
+	// Forget about a sample without decoding it.
+	void Remove(SAMPLEINDEX smp);
+
+	void Clear();
+
+protected:
+	struct Sample
+	{
+		std::vector<std::byte> data;  // Copy of the encoded sample data
+		Decoder decoder;
+		bool deferred = false;
+	};
+
+	std::vector<Sample> m_samples;
+	SAMPLEINDEX m_numDeferred = 0;
+};
+
+
+OPENMPT_NAMESPACE_END
@@ -20,6 +20,7 @@
 #include "Sndfile.h"
 #include "MixerLoops.h"
 #include "MixFuncTable.h"
+#include "MixerThreads.h"
 #include "plugins/PlugInterface.h"
 #include <cfloat>  // For FLT_EPSILON
 #include <algorithm>
@@ -294,230 +295,435 @@ struct MixLoopState
 };
 
 
-// Render count * number of channels samples
-void CSoundFile::CreateStereoMix(int count)
+// Select the buffer that a channel is mixed into (dry, reverb send, rear or plugin input) and prepare it for mixing.
+mixsample_t *CSoundFile::PrepareChannelMixBuffer(CHANNELINDEX nChn, const ModChannel &chn, int count, mixsample_t *&pOfsR, mixsample_t *&pOfsL, PLUGINDEX &nMixPlugin)
 {
-	mixsample_t *pOfsL, *pOfsR;
+	pOfsR = &m_dryROfsVol;
+	pOfsL = &m_dryLOfsVol;
+	nMixPlugin = 0;
 
-	if(!count)
-		return;
-
-	// Resetting sound buffer
-	StereoFill(MixSoundBuffer, count, m_dryROfsVol, m_dryLOfsVol);
-	if(m_MixerSettings.gnChannels > 2)
-		StereoFill(MixRearBuffer, count, m_surroundROfsVol, m_surroundLOfsVol);
+	mixsample_t *pbuffer = MixSoundBuffer;
+#ifndef NO_REVERB
+	if(((m_MixerSettings.DSPMask & SNDDSP_REVERB) && !chn.dwFlags[CHN_NOREVERB]) || chn.dwFlags[CHN_REVERB])
+	{
+		m_Reverb.TouchReverbSendBuffer(ReverbSendBuffer, m_RvbROfsVol, m_RvbLOfsVol, count);
+		pbuffer = ReverbSendBuffer;
+		pOfsR = &m_RvbROfsVol;
+		pOfsL = &m_RvbLOfsVol;
+	}
+#endif
+	if(chn.dwFlags[CHN_SURROUND] && m_MixerSettings.gnChannels > 2)
+	{
+		pbuffer = MixRearBuffer;
+		pOfsR = &m_surroundROfsVol;
+		pOfsL = &m_surroundLOfsVol;
+	}
 
-	CHANNELINDEX nchmixed = 0;
+	//Look for plugins associated with this implicit tracker channel.
+#ifndef NO_PLUGINS
+	nMixPlugin = GetBestPlugin(m_PlayState, nChn, PrioritiseInstrument, RespectMutes);
 
-	for(uint32 nChn = 0; nChn < m_nMixChannels; nChn++)
+	if ((nMixPlugin > 0) && (nMixPlugin <= MAX_MIXPLUGINS) && m_MixPlugins[nMixPlugin - 1].pMixPlugin != nullptr)
 	{
-		ModChannel &chn = m_PlayState.Chn[m_PlayState.ChnMix[nChn]];
+		// Render into plugin buffer instead of global buffer
+		SNDMIXPLUGINSTATE &mixState = m_MixPlugins[nMixPlugin - 1].pMixPlugin->m_MixState;
+		if (mixState.pMixBuffer)
+		{
+			pbuffer = mixState.pMixBuffer;
+			pOfsR = &mixState.nVolDecayR;
+			pOfsL = &mixState.nVolDecayL;
+			if (!(mixState.dwFlags & SNDMIXPLUGINSTATE::psfMixReady))
+			{
+				StereoFill(pbuffer, count, *pOfsR, *pOfsL);
+				mixState.dwFlags |= SNDMIXPLUGINSTATE::psfMixReady;
+			}
+		}
+	}
+#else
+	MPT_UNREFERENCED_PARAMETER(nChn);
+#endif // NO_PLUGINS
+
+	return pbuffer;
+}
 
-		if(!chn.pCurrentSample && !chn.nLOfs && !chn.nROfs)
-			continue;
 
-		pOfsR = &m_dryROfsVol;
-		pOfsL = &m_dryLOfsVol;
+// Render count samples of a single channel into pbuffer.
+// Only the channel, the buffer and the passed end-of-sample offsets are modified, so separate channels can be mixed concurrently into separate buffers.
+// Returns true if the channel was audible.
+bool CSoundFile::MixChannel(ModChannel &chn, mixsample_t *pbuffer, mixsample_t &ofsR, mixsample_t &ofsL, int count, bool tooManyChannels)
+{
+	if(chn.isPaused)
+	{
+		EndChannelOfs(chn, pbuffer, count);
+		ofsR += chn.nROfs;
+		ofsL += chn.nLOfs;
+		chn.nROfs = chn.nLOfs = 0;
+		return false;
+	}
 
-		uint32 functionNdx = MixFuncTable::ResamplingModeToMixFlags(static_cast<ResamplingMode>(chn.resamplingMode));
-		if(chn.dwFlags[CHN_16BIT]) functionNdx |= MixFuncTable::ndx16Bit;
-		if(chn.dwFlags[CHN_STEREO]) functionNdx |= MixFuncTable::ndxStereo;
+	uint32 functionNdx = MixFuncTable::ResamplingModeToMixFlags(static_cast<ResamplingMode>(chn.resamplingMode));
+	if(chn.dwFlags[CHN_16BIT]) functionNdx |= MixFuncTable::ndx16Bit;
+	if(chn.dwFlags[CHN_STEREO]) functionNdx |= MixFuncTable::ndxStereo;
 #ifndef NO_FILTER
-		if(chn.dwFlags[CHN_FILTER]) functionNdx |= MixFuncTable::ndxFilter;
+	if(chn.dwFlags[CHN_FILTER]) functionNdx |= MixFuncTable::ndxFilter;
 #endif
 
-		mixsample_t *pbuffer = MixSoundBuffer;
-#ifndef NO_REVERB
-		if(((m_MixerSettings.DSPMask & SNDDSP_REVERB) && !chn.dwFlags[CHN_NOREVERB]) || chn.dwFlags[CHN_REVERB])
+	MixLoopState mixLoopState(*this, chn);
+
+	////////////////////////////////////////////////////
+	bool naddmix = false;
+	int nsamples = count;
+	// Keep mixing this sample until the buffer is filled.
+	do
+	{
+		uint32 nrampsamples = nsamples;
+		int32 nSmpCount;
+		if(chn.nRampLength > 0)
 		{
-			m_Reverb.TouchReverbSendBuffer(ReverbSendBuffer, m_RvbROfsVol, m_RvbLOfsVol, count);
-			pbuffer = ReverbSendBuffer;
-			pOfsR = &m_RvbROfsVol;
-			pOfsL = &m_RvbLOfsVol;
+			if (nrampsamples > chn.nRampLength) nrampsamples = chn.nRampLength;
 		}
-#endif
-		if(chn.dwFlags[CHN_SURROUND] && m_MixerSettings.gnChannels > 2)
+
+		if((nSmpCount = mixLoopState.GetSampleCount(chn, nrampsamples)) <= 0)
 		{
-			pbuffer = MixRearBuffer;
-			pOfsR = &m_surroundROfsVol;
-			pOfsL = &m_surroundLOfsVol;
+			// Stopping the channel
+			chn.pCurrentSample = nullptr;
+			chn.nLength = 0;
+			chn.position.Set(0);
+			chn.nRampLength = 0;
+			EndChannelOfs(chn, pbuffer, nsamples);
+			ofsR += chn.nROfs;
+			ofsL += chn.nLOfs;
+			chn.nROfs = chn.nLOfs = 0;
+			chn.dwFlags.reset(CHN_PINGPONGFLAG);
+			break;
 		}
 
-		//Look for plugins associated with this implicit tracker channel.
-#ifndef NO_PLUGINS
-		PLUGINDEX nMixPlugin = GetBestPlugin(m_PlayState, m_PlayState.ChnMix[nChn], PrioritiseInstrument, RespectMutes);
-
-		if ((nMixPlugin > 0) && (nMixPlugin <= MAX_MIXPLUGINS) && m_MixPlugins[nMixPlugin - 1].pMixPlugin != nullptr)
+		// Should we mix this channel ?
+		if(tooManyChannels											// Too many channels
+			|| (!chn.nRampLength && !(chn.leftVol | chn.rightVol)))		// Channel is completely silent
 		{
-			// Render into plugin buffer instead of global buffer
-			SNDMIXPLUGINSTATE &mixState = m_MixPlugins[nMixPlugin - 1].pMixPlugin->m_MixState;
-			if (mixState.pMixBuffer)
+			chn.position += chn.increment * nSmpCount;
+			chn.nROfs = chn.nLOfs = 0;
+			pbuffer += nSmpCount * 2;
+			naddmix = false;
+		}
+#ifdef MODPLUG_TRACKER
+		else if(m_SamplePlayLengths != nullptr)
+		{
+			// Detecting the longest play time for each sample for optimization
+			SmpLength pos = chn.position.GetUInt();
+			chn.position += chn.increment * nSmpCount;
+			if(!chn.increment.IsNegative())
 			{
-				pbuffer = mixState.pMixBuffer;
-				pOfsR = &mixState.nVolDecayR;
-				pOfsL = &mixState.nVolDecayL;
-				if (!(mixState.dwFlags & SNDMIXPLUGINSTATE::psfMixReady))
-				{
-					StereoFill(pbuffer, count, *pOfsR, *pOfsL);
-					mixState.dwFlags |= SNDMIXPLUGINSTATE::psfMixReady;
-				}
+				pos = chn.position.GetUInt();
+			}
+			size_t smp = std::distance(static_cast<const ModSample*>(static_cast<std::decay<decltype(Samples)>::type>(Samples)), chn.pModSample);
+			if(smp < m_SamplePlayLengths->size())
+			{
+				(*m_SamplePlayLengths)[smp] = std::max((*m_SamplePlayLengths)[smp], pos);
 			}
 		}
-#endif // NO_PLUGINS
-
-		if(chn.isPaused)
+#endif
+		else
 		{
-			EndChannelOfs(chn, pbuffer, count);
-			*pOfsR += chn.nROfs;
-			*pOfsL += chn.nLOfs;
-			chn.nROfs = chn.nLOfs = 0;
-			continue;
-		}
+			// Do mixing
+			mixsample_t *pbufmax = pbuffer + (nSmpCount * 2);
+			chn.nROfs = -*(pbufmax - 2);
+			chn.nLOfs = -*(pbufmax - 1);
+
+#ifdef MPT_BUILD_DEBUG
+			SamplePosition targetpos = chn.position + chn.increment * nSmpCount;
+#endif
+			m_MixFuncTable[functionNdx | (chn.nRampLength ? MixFuncTable::ndxRamp : 0)](chn, m_Resampler, pbuffer, nSmpCount);
+#ifndef NO_RENDER_PROFILING
+			m_RenderProfiler.AddResampledFrames(chn.resamplingMode, nSmpCount);
+#endif // NO_RENDER_PROFILING
+#ifdef MPT_BUILD_DEBUG
+			MPT_ASSERT(chn.position.GetUInt() == targetpos.GetUInt());
+#endif
 
-		MixLoopState mixLoopState(*this, chn);
+			chn.nROfs += *(pbufmax - 2);
+			chn.nLOfs += *(pbufmax - 1);
+			pbuffer = pbufmax;
+			naddmix = true;
+		}
 
-		////////////////////////////////////////////////////
-		CHANNELINDEX naddmix = 0;
-		int nsamples = count;
-		// Keep mixing this sample until the buffer is filled.
-		do
+		nsamples -= nSmpCount;
+		if (chn.nRampLength)
 		{
-			uint32 nrampsamples = nsamples;
-			int32 nSmpCount;
-			if(chn.nRampLength > 0)
+			if (chn.nRampLength <= static_cast<uint32>(nSmpCount))
+			{
+				// Ramping is done
+				chn.nRampLength = 0;
+				chn.leftVol = chn.newLeftVol;
+				chn.rightVol = chn.newRightVol;
+				chn.rightRamp = chn.leftRamp = 0;
+				if(chn.dwFlags[CHN_NOTEFADE] && !chn.nFadeOutVol)
+				{
+					chn.nLength = 0;
+					chn.pCurrentSample = nullptr;
+				}
+			} else
 			{
-				if (nrampsamples > chn.nRampLength) nrampsamples = chn.nRampLength;
+				chn.nRampLength -= nSmpCount;
 			}
+		}
 
-			if((nSmpCount = mixLoopState.GetSampleCount(chn, nrampsamples)) <= 0)
+		const bool pastLoopEnd = chn.position.GetUInt() >= chn.nLoopEnd && chn.dwFlags[CHN_LOOP];
+		const bool pastSampleEnd = chn.position.GetUInt() >= chn.nLength && !chn.dwFlags[CHN_LOOP] && chn.nLength && !chn.nMasterChn;
+		const bool doSampleSwap = m_playBehaviour[kMODSampleSwap] && chn.nNewIns && chn.nNewIns <= GetNumSamples() && chn.pModSample != &Samples[chn.nNewIns];
+		if((pastLoopEnd || pastSampleEnd) && doSampleSwap)
+		{
+			// ProTracker compatibility: Instrument changes without a note do not happen instantly, but rather when the sample loop has finished playing.
+			// Test case: PTInstrSwap.mod, PTSwapNoLoop.mod
+			const ModSample &smp = Samples[chn.nNewIns];
+			chn.pModSample = &smp;
+			chn.pCurrentSample = smp.samplev();
+			chn.dwFlags = (chn.dwFlags & CHN_CHANNELFLAGS) | smp.uFlags;
+			chn.nLength = smp.uFlags[CHN_LOOP] ? smp.nLoopEnd : 0; // non-looping sample continue in oneshot mode (i.e. they will most probably just play silence)
+			chn.nLoopStart = smp.nLoopStart;
+			chn.nLoopEnd = smp.nLoopEnd;
+			chn.position.SetInt(chn.nLoopStart);
+			mixLoopState.UpdateLookaheadPointers(chn);
+			if(!chn.pCurrentSample)
 			{
-				// Stopping the channel
-				chn.pCurrentSample = nullptr;
-				chn.nLength = 0;
-				chn.position.Set(0);
-				chn.nRampLength = 0;
-				EndChannelOfs(chn, pbuffer, nsamples);
-				*pOfsR += chn.nROfs;
-				*pOfsL += chn.nLOfs;
-				chn.nROfs = chn.nLOfs = 0;
-				chn.dwFlags.reset(CHN_PINGPONGFLAG);
 				break;
 			}
+		} else if(pastLoopEnd && !doSampleSwap && m_playBehaviour[kMODOneShotLoops] && chn.nLoopStart == 0)
+		{
+			// ProTracker "oneshot" loops (if loop start is 0, play the whole sample once and then repeat until loop end)
+			chn.position.SetInt(0);
+			chn.nLoopEnd = chn.nLength = chn.pModSample->nLoopEnd;
+		}
+	} while(nsamples > 0);
+
+	// Restore sample pointer in case it got changed through loop wrap-around
+	chn.pCurrentSample = mixLoopState.samplePointer;
+	return naddmix;
+}
+
+
+// A channel for which this returns false does not write anything to its mix buffer during the next MixChannel call.
+static bool ChannelMayBeAudible(const ModChannel &chn)
+{
+	return chn.nRampLength || chn.leftVol || chn.rightVol || chn.nROfs || chn.nLOfs;
+}
+
+
+// Render count * number of channels samples
+// Returns true if nothing was mixed into the front and rear mix buffers, i.e. they are guaranteed to be silent.
+bool CSoundFile::CreateStereoMix(int count)
+{
+	if(!count)
+		return true;
+
+	// Any remaining end-of-sample offsets leave a tail in the buffers
+	bool silent = !m_dryROfsVol && !m_dryLOfsVol;
+	if(m_MixerSettings.gnChannels > 2 && (m_surroundROfsVol || m_surroundLOfsVol))
+		silent = false;
+
+	// Resetting sound buffer
+	StereoFill(MixSoundBuffer, count, m_dryROfsVol, m_dryLOfsVol);
+	if(m_MixerSettings.gnChannels > 2)
+		StereoFill(MixRearBuffer, count, m_surroundROfsVol, m_surroundLOfsVol);
+
+#ifdef MPT_ENABLE_MIXER_THREADS
+	if(m_mixerThreads && CreateStereoMixParallel(count, silent))
+		return silent;
+#endif // MPT_ENABLE_MIXER_THREADS
+
+	CHANNELINDEX nchmixed = 0;
+
+	for(uint32 nChn = 0; nChn < m_nMixChannels; nChn++)
+	{
+		ModChannel &chn = m_PlayState.Chn[m_PlayState.ChnMix[nChn]];
+
+		if(!chn.pCurrentSample && !chn.nLOfs && !chn.nROfs)
+			continue;
+
+		mixsample_t *pOfsR, *pOfsL;
+		PLUGINDEX nMixPlugin;
+		mixsample_t *pbuffer = PrepareChannelMixBuffer(m_PlayState.ChnMix[nChn], chn, count, pOfsR, pOfsL, nMixPlugin);
+		if(silent && (pbuffer == MixSoundBuffer || pbuffer == MixRearBuffer) && ChannelMayBeAudible(chn))
+			silent = false;
 
-			// Should we mix this channel ?
-			if((nchmixed >= m_MixerSettings.m_nMaxMixChannels)				// Too many channels
-				|| (!chn.nRampLength && !(chn.leftVol | chn.rightVol)))		// Channel is completely silent
+		if(MixChannel(chn, pbuffer, *pOfsR, *pOfsL, count, nchmixed >= m_MixerSettings.m_nMaxMixChannels))
+		{
+			nchmixed++;
+#ifndef NO_PLUGINS
+			if(nMixPlugin > 0 && nMixPlugin <= MAX_MIXPLUGINS && m_MixPlugins[nMixPlugin - 1].pMixPlugin)
 			{
-				chn.position += chn.increment * nSmpCount;
-				chn.nROfs = chn.nLOfs = 0;
-				pbuffer += nSmpCount * 2;
-				naddmix = 0;
+				m_MixPlugins[nMixPlugin - 1].pMixPlugin->ResetSilence();
 			}
+#endif // NO_PLUGINS
+		}
+	}
+	m_nMixStat = std::max(m_nMixStat, nchmixed);
+	return silent;
+}
+
+
+#ifdef MPT_ENABLE_MIXER_THREADS
+
+// Mix channels partitioned across the mixer thread pool.
+// Returns false if the current state requires mixing the channels one after another.
+// silent is reset if any channel is mixed into the front or rear mix buffers.
+bool CSoundFile::CreateStereoMixParallel(int count, bool &silent)
+{
+	// The mix channel limit depends on the order in which channels are mixed, and sample play length detection writes to shared state.
+	if(m_nMixChannels > m_MixerSettings.m_nMaxMixChannels)
+		return false;
 #ifdef MODPLUG_TRACKER
-			else if(m_SamplePlayLengths != nullptr)
-			{
-				// Detecting the longest play time for each sample for optimization
-				SmpLength pos = chn.position.GetUInt();
-				chn.position += chn.increment * nSmpCount;
-				if(!chn.increment.IsNegative())
-				{
-					pos = chn.position.GetUInt();
-				}
-				size_t smp = std::distance(static_cast<const ModSample*>(static_cast<std::decay<decltype(Samples)>::type>(Samples)), chn.pModSample);
-				if(smp < m_SamplePlayLengths->size())
-				{
-					(*m_SamplePlayLengths)[smp] = std::max((*m_SamplePlayLengths)[smp], pos);
-				}
-			}
-#endif
-			else
-			{
-				// Do mixing
-				mixsample_t *pbufmax = pbuffer + (nSmpCount * 2);
-				chn.nROfs = -*(pbufmax - 2);
-				chn.nLOfs = -*(pbufmax - 1);
+	if(m_SamplePlayLengths != nullptr)
+		return false;
+#endif // MODPLUG_TRACKER
 
-#ifdef MPT_BUILD_DEBUG
-				SamplePosition targetpos = chn.position + chn.increment * nSmpCount;
-#endif
-				MixFuncTable::Functions[functionNdx | (chn.nRampLength ? MixFuncTable::ndxRamp : 0)](chn, m_Resampler, pbuffer, nSmpCount);
-#ifdef MPT_BUILD_DEBUG
-				MPT_ASSERT(chn.position.GetUInt() == targetpos.GetUInt());
-#endif
+	MixerThreads &threads = *m_mixerThreads;
+	threads.channels.clear();
+	threads.channelTarget.clear();
+	threads.channelPlugin.clear();
+	threads.targets.clear();
 
-				chn.nROfs += *(pbufmax - 2);
-				chn.nLOfs += *(pbufmax - 1);
-				pbuffer = pbufmax;
-				naddmix = 1;
-			}
+	// Preparing the shared buffers has side effects (clearing reverb and plugin buffers), so it is done up-front in channel order.
+	for(uint32 nChn = 0; nChn < m_nMixChannels; nChn++)
+	{
+		const ModChannel &chn = m_PlayState.Chn[m_PlayState.ChnMix[nChn]];
+		if(!chn.pCurrentSample && !chn.nLOfs && !chn.nROfs)
+			continue;
 
-			nsamples -= nSmpCount;
-			if (chn.nRampLength)
+		MixerThreads::SharedTarget target;
+		PLUGINDEX nMixPlugin;
+		target.buffer = PrepareChannelMixBuffer(m_PlayState.ChnMix[nChn], chn, count, target.ofsR, target.ofsL, nMixPlugin);
+		if(silent && (target.buffer == MixSoundBuffer || target.buffer == MixRearBuffer) && ChannelMayBeAudible(chn))
+			silent = false;
+		auto existing = std::find_if(threads.targets.begin(), threads.targets.end(), [&target](const MixerThreads::SharedTarget &t) { return t.buffer == target.buffer; });
+		if(existing == threads.targets.end())
+			existing = threads.targets.insert(threads.targets.end(), target);
+
+		threads.channels.push_back(m_PlayState.ChnMix[nChn]);
+		threads.channelTarget.push_back(static_cast<uint16>(std::distance(threads.targets.begin(), existing)));
+		threads.channelPlugin.push_back(nMixPlugin);
+	}
+
+	const uint32 numChannels = static_cast<uint32>(threads.channels.size());
+	threads.channelMixed.assign(numChannels, 0);
+	const uint32 numPartitions = std::min(threads.pool.GetNumThreads(), numChannels / MixerThreads::MinChannelsPerPartition);
+
+	if(numPartitions < 2)
+	{
+		for(uint32 i = 0; i < numChannels; i++)
+		{
+			const MixerThreads::SharedTarget &target = threads.targets[threads.channelTarget[i]];
+			threads.channelMixed[i] = MixChannel(m_PlayState.Chn[threads.channels[i]], target.buffer, *target.ofsR, *target.ofsL, count, false) ? 1 : 0;
+		}
+	} else
+	{
+		if(threads.partitions.size() < numPartitions)
+			threads.partitions.resize(numPartitions);
+		const std::size_t bufferSize = static_cast<std::size_t>(count) * 2;
+		for(uint32 p = 0; p < numPartitions; p++)
+		{
+			auto &partitionTargets = threads.partitions[p].targets;
+			if(partitionTargets.size() < threads.targets.size())
+				partitionTargets.resize(threads.targets.size());
+		}
+
+		threads.pool.Run(numPartitions, [&](uint32 p)
+		{
+			MixerPartition &partition = threads.partitions[p];
+			const uint32 begin = static_cast<uint32>(static_cast<uint64>(numChannels) * p / numPartitions);
+			const uint32 end = static_cast<uint32>(static_cast<uint64>(numChannels) * (p + 1) / numPartitions);
+			for(uint32 i = begin; i < end; i++)
 			{
-				if (chn.nRampLength <= static_cast<uint32>(nSmpCount))
+				MixerPartition::Target &target = partition.targets[threads.channelTarget[i]];
+				if(!target.used)
 				{
-					// Ramping is done
-					chn.nRampLength = 0;
-					chn.leftVol = chn.newLeftVol;
-					chn.rightVol = chn.newRightVol;
-					chn.rightRamp = chn.leftRamp = 0;
-					if(chn.dwFlags[CHN_NOTEFADE] && !chn.nFadeOutVol)
-					{
-						chn.nLength = 0;
-						chn.pCurrentSample = nullptr;
-					}
-				} else
-				{
-					chn.nRampLength -= nSmpCount;
+					if(target.buffer.size() < bufferSize)
+						target.buffer.resize(bufferSize);
+					std::fill(target.buffer.begin(), target.buffer.begin() + bufferSize, mixsample_t(0));
+					target.ofsR = target.ofsL = 0;
+					target.used = true;
 				}
+				threads.channelMixed[i] = MixChannel(m_PlayState.Chn[threads.channels[i]], target.buffer.data(), target.ofsR, target.ofsL, count, false) ? 1 : 0;
 			}
+		});
 
-			const bool pastLoopEnd = chn.position.GetUInt() >= chn.nLoopEnd && chn.dwFlags[CHN_LOOP];
-			const bool pastSampleEnd = chn.position.GetUInt() >= chn.nLength && !chn.dwFlags[CHN_LOOP] && chn.nLength && !chn.nMasterChn;
-			const bool doSampleSwap = m_playBehaviour[kMODSampleSwap] && chn.nNewIns && chn.nNewIns <= GetNumSamples() && chn.pModSample != &Samples[chn.nNewIns];
-			if((pastLoopEnd || pastSampleEnd) && doSampleSwap)
+		// Sum up the partitions in a fixed order
+		for(uint32 p = 0; p < numPartitions; p++)
+		{
+			auto &partitionTargets = threads.partitions[p].targets;
+			for(std::size_t t = 0; t < threads.targets.size(); t++)
 			{
-				// ProTracker compatibility: Instrument changes without a note do not happen instantly, but rather when the sample loop has finished playing.
-				// Test case: PTInstrSwap.mod, PTSwapNoLoop.mod
-				const ModSample &smp = Samples[chn.nNewIns];
-				chn.pModSample = &smp;
-				chn.pCurrentSample = smp.samplev();
-				chn.dwFlags = (chn.dwFlags & CHN_CHANNELFLAGS) | smp.uFlags;
-				chn.nLength = smp.uFlags[CHN_LOOP] ? smp.nLoopEnd : 0; // non-looping sample continue in oneshot mode (i.e. they will most probably just play silence)
-				chn.nLoopStart = smp.nLoopStart;
-				chn.nLoopEnd = smp.nLoopEnd;
-				chn.position.SetInt(chn.nLoopStart);
-				mixLoopState.UpdateLookaheadPointers(chn);
-				if(!chn.pCurrentSample)
+				MixerPartition::Target &target = partitionTargets[t];
+				if(!target.used)
+					continue;
+				const MixerThreads::SharedTarget &shared = threads.targets[t];
+				for(std::size_t i = 0; i < bufferSize; i++)
 				{
-					break;
+					shared.buffer[i] += target.buffer[i];
 				}
-			} else if(pastLoopEnd && !doSampleSwap && m_playBehaviour[kMODOneShotLoops] && chn.nLoopStart == 0)
-			{
-				// ProTracker "oneshot" loops (if loop start is 0, play the whole sample once and then repeat until loop end)
-				chn.position.SetInt(0);
-				chn.nLoopEnd = chn.nLength = chn.pModSample->nLoopEnd;
+				*shared.ofsR += target.ofsR;
+				*shared.ofsL += target.ofsL;
+				target.used = false;
 			}
-		} while(nsamples > 0);
+		}
+	}
 
-		// Restore sample pointer in case it got changed through loop wrap-around
-		chn.pCurrentSample = mixLoopState.samplePointer;
-		nchmixed += naddmix;
-	
+	CHANNELINDEX nchmixed = 0;
+	for(uint32 i = 0; i < numChannels; i++)
+	{
+		if(!threads.channelMixed[i])
+			continue;
+		nchmixed++;
 #ifndef NO_PLUGINS
-		if(naddmix && nMixPlugin > 0 && nMixPlugin <= MAX_MIXPLUGINS && m_MixPlugins[nMixPlugin - 1].pMixPlugin)
+		const PLUGINDEX nMixPlugin = threads.channelPlugin[i];
+		if(nMixPlugin > 0 && nMixPlugin <= MAX_MIXPLUGINS && m_MixPlugins[nMixPlugin - 1].pMixPlugin)
 		{
 			m_MixPlugins[nMixPlugin - 1].pMixPlugin->ResetSilence();
 		}
 #endif // NO_PLUGINS
 	}
 	m_nMixStat = std::max(m_nMixStat, nchmixed);
+	return true;
+}
+
+#endif // MPT_ENABLE_MIXER_THREADS
+
+
+void CSoundFile::SetMixerThreads(uint32 numThreads)
+{
+#ifdef MPT_ENABLE_MIXER_THREADS
+	if(numThreads == 0)
+		numThreads = std::max(std::thread::hardware_concurrency(), 1u);
+	LimitMax(numThreads, MixerThreads::MaxThreads);
+	if(numThreads == GetMixerThreads())
+		return;
+	m_mixerThreads.reset();
+	if(numThreads > 1)
+		m_mixerThreads = std::make_unique<MixerThreads>(numThreads);
+#else
+	MPT_UNREFERENCED_PARAMETER(numThreads);
+#endif // MPT_ENABLE_MIXER_THREADS
+}
+
+
+uint32 CSoundFile::GetMixerThreads() const
+{
+#ifdef MPT_ENABLE_MIXER_THREADS
+	if(m_mixerThreads)
+		return m_mixerThreads->pool.GetNumThreads();
+#endif // MPT_ENABLE_MIXER_THREADS
+	return 1;
 }
 
 
-void CSoundFile::ProcessPlugins(uint32 nCount)
+// If mixBufferSilent is set, the master mix is known to be silent. It is reset if any plugin produced output.
+void CSoundFile::ProcessPlugins(uint32 nCount, bool &mixBufferSilent)
 {
 #ifndef NO_PLUGINS
+	m_pluginGraph.Update(m_MixPlugins);
+	const std::vector<PluginGraph::Node> &nodes = m_pluginGraph.GetNodes();
+
 	// If any sample channels are active or any plugin has some input, possibly suspended master plugins need to be woken up.
 	bool masterHasInput = (m_nMixStat > 0);
 
@@ -527,223 +733,298 @@ void CSoundFile::ProcessPlugins(uint32 nCount)
 #endif // MPT_INTMIXER
 
 	// Setup float inputs from samples
-	for(PLUGINDEX plug = 0; plug < MAX_MIXPLUGINS; plug++)
+	for(const auto &node : nodes)
 	{
-		SNDMIXPLUGIN &plugin = m_MixPlugins[plug];
-		if(plugin.pMixPlugin != nullptr
-			&& plugin.pMixPlugin->m_MixState.pMixBuffer != nullptr
-			&& plugin.pMixPlugin->m_mixBuffer.Ok())
-		{
-			IMixPlugin *mixPlug = plugin.pMixPlugin;
-			SNDMIXPLUGINSTATE &state = mixPlug->m_MixState;
+		SNDMIXPLUGIN &plugin = m_MixPlugins[node.plug];
+		IMixPlugin *mixPlug = plugin.pMixPlugin;
+		SNDMIXPLUGINSTATE &state = mixPlug->m_MixState;
 
-			//We should only ever reach this point if the song is playing.
-			if (!mixPlug->IsSongPlaying())
-			{
-				//Plugin doesn't know it is in a song that is playing;
-				//we must have added it during playback. Initialise it!
-				mixPlug->NotifySongPlaying(true);
-				mixPlug->Resume();
-			}
+		//We should only ever reach this point if the song is playing.
+		if (!mixPlug->IsSongPlaying())
+		{
+			//Plugin doesn't know it is in a song that is playing;
+			//we must have added it during playback. Initialise it!
+			mixPlug->NotifySongPlaying(true);
+			mixPlug->Resume();
+		}
 
 
-			// Setup float input
-			float *plugInputL = mixPlug->m_mixBuffer.GetInputBuffer(0);
-			float *plugInputR = mixPlug->m_mixBuffer.GetInputBuffer(1);
-			if (state.dwFlags & SNDMIXPLUGINSTATE::psfMixReady)
-			{
+		// Setup float input
+		float *plugInputL = mixPlug->m_mixBuffer.GetInputBuffer(0);
+		float *plugInputR = mixPlug->m_mixBuffer.GetInputBuffer(1);
+		if (state.dwFlags & SNDMIXPLUGINSTATE::psfMixReady)
+		{
 #ifdef MPT_INTMIXER
-				StereoMixToFloat(state.pMixBuffer, plugInputL, plugInputR, nCount, IntToFloat);
+			StereoMixToFloat(state.pMixBuffer, plugInputL, plugInputR, nCount, IntToFloat);
 #else
-				DeinterleaveStereo(state.pMixBuffer, plugInputL, plugInputR, nCount);
+			DeinterleaveStereo(state.pMixBuffer, plugInputL, plugInputR, nCount);
 #endif // MPT_INTMIXER
-			} else if (state.nVolDecayR || state.nVolDecayL)
-			{
-				StereoFill(state.pMixBuffer, nCount, state.nVolDecayR, state.nVolDecayL);
+		} else if (state.nVolDecayR || state.nVolDecayL)
+		{
+			StereoFill(state.pMixBuffer, nCount, state.nVolDecayR, state.nVolDecayL);
 #ifdef MPT_INTMIXER
-				StereoMixToFloat(state.pMixBuffer, plugInputL, plugInputR, nCount, IntToFloat);
+			StereoMixToFloat(state.pMixBuffer, plugInputL, plugInputR, nCount, IntToFloat);
 #else
-				DeinterleaveStereo(state.pMixBuffer, plugInputL, plugInputR, nCount);
+			DeinterleaveStereo(state.pMixBuffer, plugInputL, plugInputR, nCount);
 #endif // MPT_INTMIXER
-			} else
-			{
-				memset(plugInputL, 0, nCount * sizeof(plugInputL[0]));
-				memset(plugInputR, 0, nCount * sizeof(plugInputR[0]));
-			}
-			state.dwFlags &= ~SNDMIXPLUGINSTATE::psfMixReady;
-			
-			if(!plugin.IsMasterEffect() && !(state.dwFlags & SNDMIXPLUGINSTATE::psfSilenceBypass))
-			{
-				masterHasInput = true;
-			}
+		} else
+		{
+			memset(plugInputL, 0, nCount * sizeof(plugInputL[0]));
+			memset(plugInputR, 0, nCount * sizeof(plugInputR[0]));
+		}
+		state.dwFlags &= ~SNDMIXPLUGINSTATE::psfMixReady;
+		
+		if(!plugin.IsMasterEffect() && !(state.dwFlags & SNDMIXPLUGINSTATE::psfSilenceBypass))
+		{
+			masterHasInput = true;
 		}
 	}
 	// Convert mix buffer
+	if(mixBufferSilent)
+	{
+		memset(MixFloatBuffer[0], 0, nCount * sizeof(MixFloatBuffer[0][0]));
+		memset(MixFloatBuffer[1], 0, nCount * sizeof(MixFloatBuffer[1][0]));
+	} else
+	{
 #ifdef MPT_INTMIXER
-	StereoMixToFloat(MixSoundBuffer, MixFloatBuffer[0], MixFloatBuffer[1], nCount, IntToFloat);
+		StereoMixToFloat(MixSoundBuffer, MixFloatBuffer[0], MixFloatBuffer[1], nCount, IntToFloat);
 #else
-	DeinterleaveStereo(MixSoundBuffer, MixFloatBuffer[0], MixFloatBuffer[1], nCount);
+		DeinterleaveStereo(MixSoundBuffer, MixFloatBuffer[0], MixFloatBuffer[1], nCount);
 #endif // MPT_INTMIXER
+	}
 	float *pMixL = MixFloatBuffer[0];
 	float *pMixR = MixFloatBuffer[1];
+	PLUGINDEX mixTarget = MAX_MIXPLUGINS;  // Plugin whose input pMixL / pMixR point to, or MAX_MIXPLUGINS for the master mix
 
 	const bool positionChanged = HasPositionChanged();
 
-	// Process Plugins
-	for(PLUGINDEX plug = 0; plug < MAX_MIXPLUGINS; plug++)
+	// Decide which plugins are processed and where their audio goes. This already updates all plugin flags in plugin order,
+	// but no audio is processed yet. Every step remembers the last previous step that writes to its input,
+	// so that independent plugins can be rendered at the same time.
+	std::vector<PluginGraph::Step> &steps = m_pluginGraph.steps;
+	steps.clear();
+	std::fill(m_pluginGraph.lastWriter.begin(), m_pluginGraph.lastWriter.end(), -1);
+	for(const auto &node : nodes)
 	{
+		const PLUGINDEX plug = node.plug;
 		SNDMIXPLUGIN &plugin = m_MixPlugins[plug];
-		if (plugin.pMixPlugin != nullptr
-			&& plugin.pMixPlugin->m_MixState.pMixBuffer != nullptr
-			&& plugin.pMixPlugin->m_mixBuffer.Ok())
+		IMixPlugin *pObject = plugin.pMixPlugin;
+		if(!plugin.IsMasterEffect() && !plugin.pMixPlugin->ShouldProcessSilence() && !(plugin.pMixPlugin->m_MixState.dwFlags & SNDMIXPLUGINSTATE::psfHasInput))
 		{
-			IMixPlugin *pObject = plugin.pMixPlugin;
-			if(!plugin.IsMasterEffect() && !plugin.pMixPlugin->ShouldProcessSilence() && !(plugin.pMixPlugin->m_MixState.dwFlags & SNDMIXPLUGINSTATE::psfHasInput))
+			// If plugin has no inputs and isn't a master plugin, we shouldn't let it process silence if possible.
+			// I have yet to encounter a VST plugin which actually sets this flag.
+			if(!node.hasInputPlugins)
 			{
-				// If plugin has no inputs and isn't a master plugin, we shouldn't let it process silence if possible.
-				// I have yet to encounter a VST plugin which actually sets this flag.
-				bool hasInput = false;
-				for(PLUGINDEX inPlug = 0; inPlug < plug; inPlug++)
-				{
-					if(m_MixPlugins[inPlug].GetOutputPlugin() == plug)
-					{
-						hasInput = true;
-						break;
-					}
-				}
-				if(!hasInput)
-				{
-					continue;
-				}
+				continue;
 			}
+		}
+
+		// Processed or bypassed plugins can add to the master mix
+		mixBufferSilent = false;
+
+		PluginGraph::Step step;
+		step.mixPlugin = &plugin;
+		step.lastInputWriter = m_pluginGraph.lastWriter[plug];
 
-			bool isMasterMix = false;
-			float *plugInputL = pObject->m_mixBuffer.GetInputBuffer(0);
-			float *plugInputR = pObject->m_mixBuffer.GetInputBuffer(1);
+		bool isMasterMix = false;
+		float *plugInputL = pObject->m_mixBuffer.GetInputBuffer(0);
+		float *plugInputR = pObject->m_mixBuffer.GetInputBuffer(1);
 
-			if (pMixL == plugInputL)
+		if (pMixL == plugInputL)
+		{
+			isMasterMix = true;
+			pMixL = MixFloatBuffer[0];
+			pMixR = MixFloatBuffer[1];
+			mixTarget = MAX_MIXPLUGINS;
+		}
+		SNDMIXPLUGINSTATE &state = plugin.pMixPlugin->m_MixState;
+		float *pOutL = pMixL;
+		float *pOutR = pMixR;
+		PLUGINDEX outTarget = mixTarget;
+
+		if (!plugin.IsOutputToMaster() && node.outputPlugin != PLUGINDEX_INVALID)
+		{
+			IMixPlugin *outPlugin = m_MixPlugins[node.outputPlugin].pMixPlugin;
+			if(!(state.dwFlags & SNDMIXPLUGINSTATE::psfSilenceBypass)) outPlugin->ResetSilence();
+
+			if(outPlugin->m_mixBuffer.Ok())
 			{
-				isMasterMix = true;
-				pMixL = MixFloatBuffer[0];
-				pMixR = MixFloatBuffer[1];
+				pOutL = outPlugin->m_mixBuffer.GetInputBuffer(0);
+				pOutR = outPlugin->m_mixBuffer.GetInputBuffer(1);
+				outTarget = node.outputPlugin;
 			}
-			SNDMIXPLUGINSTATE &state = plugin.pMixPlugin->m_MixState;
-			float *pOutL = pMixL;
-			float *pOutR = pMixR;
+		}
 
-			if (!plugin.IsOutputToMaster())
+		if (plugin.IsMasterEffect())
+		{
+			if (!isMasterMix)
 			{
-				PLUGINDEX nOutput = plugin.GetOutputPlugin();
-				if(nOutput > plug && nOutput < MAX_MIXPLUGINS
-					&& m_MixPlugins[nOutput].pMixPlugin != nullptr)
-				{
-					IMixPlugin *outPlugin = m_MixPlugins[nOutput].pMixPlugin;
-					if(!(state.dwFlags & SNDMIXPLUGINSTATE::psfSilenceBypass)) outPlugin->ResetSilence();
+				step.masterL = pMixL;
+				step.masterR = pMixR;
+				m_pluginGraph.lastWriter[mixTarget] = static_cast<int32>(steps.size());
+			}
+			pMixL = pOutL;
+			pMixR = pOutR;
+			mixTarget = outTarget;
 
-					if(outPlugin->m_mixBuffer.Ok())
-					{
-						pOutL = outPlugin->m_mixBuffer.GetInputBuffer(0);
-						pOutR = outPlugin->m_mixBuffer.GetInputBuffer(1);
-					}
+			if(masterHasInput)
+			{
+				// Samples or plugins are being rendered, so turn off auto-bypass for this master effect.
+				pObject->ResetSilence();
+				for(IMixPlugin *chain : node.masterChain)
+				{
+					chain->ResetSilence();
 				}
 			}
+		}
 
-			/*
-			if (plugin.multiRouting) {
-				int nOutput=0;
-				for (int nOutput=0; nOutput < plugin.nOutputs / 2; nOutput++) {
-					destinationPlug = plugin.multiRoutingDestinations[nOutput];
-					pOutState = m_MixPlugins[destinationPlug].pMixState;
-					pOutputs[2 * nOutput] = plugInputL;
-					pOutputs[2 * (nOutput + 1)] = plugInputR;
-				}
+		step.inL = plugInputL;
+		step.inR = plugInputR;
+		step.outL = pOutL;
+		step.outR = pOutR;
+		step.bypass = plugin.IsBypassed() || (plugin.IsAutoSuspendable() && (state.dwFlags & SNDMIXPLUGINSTATE::psfSilenceBypass));
+		step.renderPending = !step.bypass;
+		m_pluginGraph.lastWriter[outTarget] = static_cast<int32>(steps.size());
+		steps.push_back(step);
 
-			}*/
+		state.dwFlags &= ~SNDMIXPLUGINSTATE::psfHasInput;
+	}
 
-			if (plugin.IsMasterEffect())
+	const auto moveMasterToInput = [nCount](PluginGraph::Step &step)
+	{
+		for (uint32 i=0; i<nCount; i++)
+		{
+			step.inL[i] += step.masterL[i];
+			step.inR[i] += step.masterR[i];
+			step.masterL[i] = 0;
+			step.masterR[i] = 0;
+		}
+		step.masterL = step.masterR = nullptr;
+	};
+	const auto renderStep = [nCount, positionChanged](PluginGraph::Step &step)
+	{
+		IMixPlugin *pObject = step.mixPlugin->pMixPlugin;
+		if(positionChanged)
+			pObject->PositionChanged();
+		step.hasOutput = pObject->RenderOutput(nCount);
+		step.renderPending = false;
+	};
+	// Mixes the plugin output into its destination. Must be called in plugin order.
+	const auto finishStep = [this, nCount](PluginGraph::Step &step)
+	{
+		const SNDMIXPLUGIN &plugin = *step.mixPlugin;
+		IMixPlugin *pObject = plugin.pMixPlugin;
+		float *pOutL = step.outL;
+		float *pOutR = step.outR;
+		if(step.bypass)
+		{
+			const float * const pInL = step.inL;
+			const float * const pInR = step.inR;
+			for (uint32 i=0; i<nCount; i++)
 			{
-				if (!isMasterMix)
-				{
-					float *pInL = plugInputL;
-					float *pInR = plugInputR;
-					for (uint32 i=0; i<nCount; i++)
-					{
-						pInL[i] += pMixL[i];
-						pInR[i] += pMixR[i];
-						pMixL[i] = 0;
-						pMixR[i] = 0;
-					}
-				}
-				pMixL = pOutL;
-				pMixR = pOutR;
+				pOutL[i] += pInL[i];
+				pOutR[i] += pInR[i];
+			}
+			return;
+		}
 
-				if(masterHasInput)
+		if(step.hasOutput)
+			pObject->MixOutput(pOutL, pOutR, nCount);
+
+		SNDMIXPLUGINSTATE &state = pObject->m_MixState;
+		state.inputSilenceCount += nCount;
+		if(plugin.IsAutoSuspendable() && pObject->GetNumOutputChannels() > 0 && state.inputSilenceCount >= m_MixerSettings.gdwMixingFreq * 4)
+		{
+			bool isSilent = true;
+			for(uint32 i = 0; i < nCount; i++)
+			{
+				if(pOutL[i] >= FLT_EPSILON || pOutL[i] <= -FLT_EPSILON
+					|| pOutR[i] >= FLT_EPSILON || pOutR[i] <= -FLT_EPSILON)
 				{
-					// Samples or plugins are being rendered, so turn off auto-bypass for this master effect.
-					if(plugin.pMixPlugin != nullptr) plugin.pMixPlugin->ResetSilence();
-					SNDMIXPLUGIN *chain = &plugin;
-					PLUGINDEX out = chain->GetOutputPlugin(), prevOut = plug;
-					while(out > prevOut && out < MAX_MIXPLUGINS)
-					{
-						chain = &m_MixPlugins[out];
-						prevOut = out;
-						out = chain->GetOutputPlugin();
-						if(chain->pMixPlugin)
-						{
-							chain->pMixPlugin->ResetSilence();
-						}
-					}
+					isSilent = false;
+					break;
 				}
 			}
+			if(isSilent)
+			{
+				state.dwFlags |= SNDMIXPLUGINSTATE::psfSilenceBypass;
+			} else
+			{
+				state.inputSilenceCount = 0;
+			}
+		}
+	};
+
+	// Process Plugins
+#ifdef MPT_ENABLE_MIXER_THREADS
+	if(m_mixerThreads && m_pluginGraph.CanRenderConcurrently())
+	{
+		// Render all plugins whose input is complete at the same time, then mix their output into the destinations in plugin order.
+		std::vector<uint32> &batch = m_pluginGraph.batch;
+		std::size_t pos = 0;
+		while(pos < steps.size())
+		{
+			if(steps[pos].masterL != nullptr)
+				moveMasterToInput(steps[pos]);
+
+			batch.clear();
+			for(std::size_t s = pos; s < steps.size(); s++)
+			{
+				const PluginGraph::Step &step = steps[s];
+				if(step.renderPending && step.masterL == nullptr && step.lastInputWriter < static_cast<int32>(pos))
+					batch.push_back(static_cast<uint32>(s));
+			}
+			if(batch.size() == 1)
+				renderStep(steps[batch[0]]);
+			else if(!batch.empty())
+				m_mixerThreads->pool.Run(static_cast<uint32>(batch.size()), [&](uint32 b) { renderStep(steps[batch[b]]); });
 
-			if(plugin.IsBypassed() || (plugin.IsAutoSuspendable() && (state.dwFlags & SNDMIXPLUGINSTATE::psfSilenceBypass)))
+			while(pos < steps.size())
 			{
-				const float * const pInL = plugInputL;
-				const float * const pInR = plugInputR;
-				for (uint32 i=0; i<nCount; i++)
+				PluginGraph::Step &step = steps[pos];
+				if(step.masterL != nullptr)
 				{
-					pOutL[i] += pInL[i];
-					pOutR[i] += pInR[i];
+					if(!step.bypass)
+						break;
+					moveMasterToInput(step);
 				}
-			} else
+				if(step.renderPending)
+					break;
+				finishStep(step);
+				pos++;
+			}
+		}
+	} else
+#endif // MPT_ENABLE_MIXER_THREADS
+	{
+		for(auto &step : steps)
+		{
+			if(step.masterL != nullptr)
+				moveMasterToInput(step);
+			if(!step.bypass)
 			{
+				IMixPlugin *pObject = step.mixPlugin->pMixPlugin;
 				if(positionChanged)
 					pObject->PositionChanged();
-				pObject->Process(pOutL, pOutR, nCount);
-
-				state.inputSilenceCount += nCount;
-				if(plugin.IsAutoSuspendable() && pObject->GetNumOutputChannels() > 0 && state.inputSilenceCount >= m_MixerSettings.gdwMixingFreq * 4)
-				{
-					bool isSilent = true;
-					for(uint32 i = 0; i < nCount; i++)
-					{
-						if(pOutL[i] >= FLT_EPSILON || pOutL[i] <= -FLT_EPSILON
-							|| pOutR[i] >= FLT_EPSILON || pOutR[i] <= -FLT_EPSILON)
-						{
-							isSilent = false;
-							break;
-						}
-					}
-					if(isSilent)
-					{
-						state.dwFlags |= SNDMIXPLUGINSTATE::psfSilenceBypass;
-					} else
-					{
-						state.inputSilenceCount = 0;
-					}
-				}
+				pObject->Process(step.outL, step.outR, nCount);
 			}
-			state.dwFlags &= ~SNDMIXPLUGINSTATE::psfHasInput;
+			finishStep(step);
 		}
 	}
+
+	// If no plugin was processed, the master mix is still silent and does not need to be converted back.
+	if(!mixBufferSilent)
+	{
 #ifdef MPT_INTMIXER
-	FloatToStereoMix(pMixL, pMixR, MixSoundBuffer, nCount, FloatToInt);
+		FloatToStereoMix(pMixL, pMixR, MixSoundBuffer, nCount, FloatToInt);
 #else
-	InterleaveStereo(pMixL, pMixR, MixSoundBuffer, nCount);
+		InterleaveStereo(pMixL, pMixR, MixSoundBuffer, nCount);
 #endif // MPT_INTMIXER
+	}
 
 #else
 	MPT_UNREFERENCED_PARAMETER(nCount);
+	MPT_UNREFERENCED_PARAMETER(mixBufferSilent);
 #endif // NO_PLUGINS
 }
 
@@ -0,0 +1,257 @@
+/*
+ * FormatSpecialization.h
+ * ----------------------
+ * Purpose: Compile-time description of the play behaviours supported by each module format, used for instantiating format-specific tick processing code.
+ * Notes  : Tick processing functions are templates on a format type. SpecificFormat<type> turns GetType() into a constant and play behaviours
+ *          that are never enabled for the format into constant false, so that the compiler can drop the code of other formats.
+ *          AnyFormat is the generic fallback that reads both from the CSoundFile object, as it has always been done.
+ *          The specialized code is only used if the module does not enable any play behaviours that are impossible for its format (see CSoundFile::UpdateFormatSpecialization).
+ * Authors: OpenMPT Devs
+ * The OpenMPT source code is released under the BSD license. Read LICENSE for more details.
+ */
+
+
+#pragma once
+
+#include "openmpt/all/BuildSettings.hpp"
+
+#include "Snd_defs.h"
+
+
+OPENMPT_NAMESPACE_BEGIN
+
+
+namespace FormatSpecialization
+{
+
+inline constexpr PlayBehaviour ITBehaviours[] =
+{
+	MSF_COMPATIBLE_PLAY,
+	kPeriodsAreHertz,
+	kTempoClamp,
+	kPerChannelGlobalVolSlide,
+	kPanOverride,
+	kITInstrWithoutNote,
+	kITVolColFinePortamento,
+	kITArpeggio,
+	kITOutOfRangeDelay,
+	kITPortaMemoryShare,
+	kITPatternLoopTargetReset,
+	kITFT2PatternLoop,
+	kITPingPongNoReset,
+	kITEnvelopeReset,
+	kITClearOldNoteAfterCut,
+	kITVibratoTremoloPanbrello,
+	kITTremor,
+	kITRetrigger,
+	kITMultiSampleBehaviour,
+	kITPortaTargetReached,
+	kITPatternLoopBreak,
+	kITOffset,
+	kITSwingBehaviour,
+	kITNNAReset,
+	kITSCxStopsSample,
+	kITEnvelopePositionHandling,
+	kITPortamentoInstrument,
+	kITPingPongMode,
+	kITRealNoteMapping,
+	kITHighOffsetNoRetrig,
+	kITFilterBehaviour,
+	kITNoSurroundPan,
+	kITShortSampleRetrig,
+	kITPortaNoNote,
+	kITFT2DontResetNoteOffOnPorta,
+	kITVolColMemory,
+	kITPortamentoSwapResetsPos,
+	kITEmptyNoteMapSlot,
+	kITFirstTickHandling,
+	kITSampleAndHoldPanbrello,
+	kITClearPortaTarget,
+	kITPanbrelloHold,
+	kITPanningReset,
+	kITPatternLoopWithJumps,
+	kITInstrWithNoteOff,
+	kITMultiSampleInstrumentNumber,
+	kRowDelayWithNoteDelay,
+	kITInstrWithNoteOffOldEffects,
+	kITDoNotOverrideChannelPan,
+	kITDCTBehaviour,
+	kITPitchPanSeparation,
+};
+
+// In addition to ITBehaviours
+inline constexpr PlayBehaviour MPTBehaviours[] =
+{
+	kOPLFlexibleNoteOff,
+	kOPLwithNNA,
+	kOPLNoteOffOnNoteChange,
+};
+
+inline constexpr PlayBehaviour XMBehaviours[] =
+{
+	MSF_COMPATIBLE_PLAY,
+	kFT2VolumeRamping,
+	kTempoClamp,
+	kPerChannelGlobalVolSlide,
+	kPanOverride,
+	kITFT2PatternLoop,
+	kITFT2DontResetNoteOffOnPorta,
+	kFT2Arpeggio,
+	kFT2Retrigger,
+	kFT2VolColVibrato,
+	kFT2PortaNoNote,
+	kFT2KeyOff,
+	kFT2PanSlide,
+	kFT2ST3OffsetOutOfRange,
+	kFT2RestrictXCommand,
+	kFT2RetrigWithNoteDelay,
+	kFT2SetPanEnvPos,
+	kFT2PortaIgnoreInstr,
+	kFT2VolColMemory,
+	kFT2LoopE60Restart,
+	kFT2ProcessSilentChannels,
+	kFT2ReloadSampleSettings,
+	kFT2PortaDelay,
+	kFT2Transpose,
+	kFT2PatternLoopWithJumps,
+	kFT2PortaTargetNoReset,
+	kFT2EnvelopeEscape,
+	kFT2Tremor,
+	kFT2OutOfRangeDelay,
+	kFT2Periods,
+	kFT2PanWithDelayedNoteOff,
+	kFT2VolColDelay,
+	kFT2FinetunePrecision,
+	kFT2NoteOffFlags,
+	kRowDelayWithNoteDelay,
+	kFT2MODTremoloRampWaveform,
+	kFT2PortaUpDownMemory,
+	kFT2PanSustainRelease,
+	kFT2NoteDelayWithoutInstr,
+	kFT2PortaResetDirection,
+};
+
+inline constexpr PlayBehaviour S3MBehaviours[] =
+{
+	MSF_COMPATIBLE_PLAY,
+	kTempoClamp,
+	kPanOverride,
+	kITPanbrelloHold,
+	kFT2ST3OffsetOutOfRange,
+	kST3NoMutedChannels,
+	kST3PortaSampleChange,
+	kST3EffectMemory,
+	kST3VibratoMemory,
+	KST3PortaAfterArpeggio,
+	kRowDelayWithNoteDelay,
+	kST3OffsetWithoutInstrument,
+	kST3RetrigAfterNoteCut,
+	kST3SampleSwap,
+	kOPLNoteOffOnNoteChange,
+	kApplyUpperPeriodLimit,
+};
+
+inline constexpr PlayBehaviour MODBehaviours[] =
+{
+	kMODVBlankTiming,
+	kMODOneShotLoops,
+	kMODIgnorePanning,
+	kMODSampleSwap,
+	kMODOutOfRangeNoteDelay,
+	kMODTempoOnSecondTick,
+	kRowDelayWithNoteDelay,
+	kFT2MODTremoloRampWaveform,
+};
+
+// All other formats
+inline constexpr PlayBehaviour OtherBehaviours[] =
+{
+	MSF_COMPATIBLE_PLAY,
+	kPeriodsAreHertz,
+	kTempoClamp,
+	kPanOverride,
+};
+
+
+// Behaviours that cannot be selected for the formats above, but are enabled by module loaders or UpgradeModule
+// to emulate other trackers or older OpenMPT versions. The specialized tick processing code still checks them at runtime.
+inline constexpr PlayBehaviour CompatibilityBehaviours[] =
+{
+	kMPTOldSwingBehaviour,
+	kMIDICCBugEmulation,
+	kOldMIDIPitchBends,
+	kPeriodsAreHertz,
+	kITRetrigger,
+	kITShortSampleRetrig,
+	kITPatternLoopWithJumpsOld,
+	kST3LimitPeriod,
+	kLegacyReleaseNode,
+	kMIDIVolumeOnNoteOffBug,
+	kApplyOffsetWithoutNote,
+	kOPLBeatingOscillators,
+	kOPLNoResetAtEnvelopeEnd,
+	kOPLRealRetrig,
+	kImprecisePingPongLoops,
+	kPluginIgnoreTonePortamento,
+};
+
+
+template <std::size_t size>
+constexpr bool Contains(const PlayBehaviour (&behaviours)[size], PlayBehaviour behaviour) noexcept
+{
+	for(const auto b : behaviours)
+	{
+		if(b == behaviour)
+			return true;
+	}
+	return false;
+}
+
+}  // namespace FormatSpecialization
+
+
+// Returns true if the given play behaviour can be enabled in modules of the given type (see CSoundFile::GetSupportedPlaybackBehaviour)
+constexpr bool IsPlayBehaviourSupported(MODTYPE type, PlayBehaviour behaviour) noexcept
+{
+	using namespace FormatSpecialization;
+	switch(type)
+	{
+	case MOD_TYPE_MPT:
+		return Contains(ITBehaviours, behaviour) || Contains(MPTBehaviours, behaviour);
+	case MOD_TYPE_IT:
+		return Contains(ITBehaviours, behaviour);
+	case MOD_TYPE_XM:
+		return Contains(XMBehaviours, behaviour);
+	case MOD_TYPE_S3M:
+		return Contains(S3MBehaviours, behaviour);
+	case MOD_TYPE_MOD:
+		return Contains(MODBehaviours, behaviour);
+	default:
+		return Contains(OtherBehaviours, behaviour);
+	}
+}
+
+
+// Returns false if the given play behaviour is never enabled in modules of the given type, i.e. the specialized tick processing code for this type can ignore it
+constexpr bool IsPlayBehaviourPossible(MODTYPE type, PlayBehaviour behaviour) noexcept
+{
+	return IsPlayBehaviourSupported(type, behaviour) || FormatSpecialization::Contains(FormatSpecialization::CompatibilityBehaviours, behaviour);
+}
+
+
+// Generic tick processing code for any module
+struct AnyFormat
+{
+	static constexpr MODTYPE type = MOD_TYPE_NONE;
+};
+
+// Tick processing code specialized for one module format
+template <MODTYPE formatType>
+struct SpecificFormat
+{
+	static_assert(formatType != MOD_TYPE_NONE);
+	static constexpr MODTYPE type = formatType;
+};
+
+
+OPENMPT_NAMESPACE_END
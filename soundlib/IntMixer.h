@@ -17,6 +17,10 @@
 #include "MixerInterface.h"
 #include "Paula.h"
 
+#if defined(MPT_ENABLE_ARCH_INTRINSICS_SSE2)
+#include <emmintrin.h>
+#endif
+
 OPENMPT_NAMESPACE_BEGIN
 
 template<int channelsOut, int channelsIn, typename out, typename in, size_t mixPrecision>
@@ -222,6 +226,101 @@ struct FIRFilterInterpolation
 };
 
 
+#if defined(MPT_ENABLE_ARCH_INTRINSICS_SSE2)
+
+// Load the 8 sampling points around the current position (3 before, 4 after) of one channel as 16-bit values.
+// 8-bit samples are scaled up to 16-bit in the same way Traits::Convert does it.
+template<class Traits>
+MPT_FORCEINLINE void LoadSincTapsSSE2(const typename Traits::input_t * const MPT_RESTRICT inBuffer, __m128i (&taps)[Traits::numChannelsIn])
+{
+	static_assert(Traits::numChannelsIn == 1 || Traits::numChannelsIn == 2);
+	const typename Traits::input_t *first = inBuffer - 3 * Traits::numChannelsIn;
+	__m128i lo, hi;
+	if constexpr(sizeof(typename Traits::input_t) == 1)
+	{
+		if constexpr(Traits::numChannelsIn == 1)
+		{
+			taps[0] = _mm_unpacklo_epi8(_mm_setzero_si128(), _mm_loadl_epi64(reinterpret_cast<const __m128i *>(first)));
+			return;
+		}
+		const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(first));
+		lo = _mm_unpacklo_epi8(_mm_setzero_si128(), v);
+		hi = _mm_unpackhi_epi8(_mm_setzero_si128(), v);
+	} else
+	{
+		if constexpr(Traits::numChannelsIn == 1)
+		{
+			taps[0] = _mm_loadu_si128(reinterpret_cast<const __m128i *>(first));
+			return;
+		}
+		lo = _mm_loadu_si128(reinterpret_cast<const __m128i *>(first));
+		hi = _mm_loadu_si128(reinterpret_cast<const __m128i *>(first + 8));
+	}
+	if constexpr(Traits::numChannelsIn == 2)
+	{
+		// De-interleave L/R pairs
+		taps[0] = _mm_packs_epi32(_mm_srai_epi32(_mm_slli_epi32(lo, 16), 16), _mm_srai_epi32(_mm_slli_epi32(hi, 16), 16));
+		taps[1] = _mm_packs_epi32(_mm_srai_epi32(lo, 16), _mm_srai_epi32(hi, 16));
+	}
+}
+
+
+// Sum of the first and second half of an 8-tap convolution (pmaddwd already summed adjacent pairs).
+// Integer wrap-around behaviour is identical to summing the products one by one.
+MPT_FORCEINLINE void SumSincTapsSSE2(__m128i products, int32 &firstHalf, int32 &secondHalf)
+{
+	const __m128i pairs = _mm_add_epi32(products, _mm_shuffle_epi32(products, _MM_SHUFFLE(2, 3, 0, 1)));
+	firstHalf = _mm_cvtsi128_si32(pairs);
+	secondHalf = _mm_cvtsi128_si32(_mm_shuffle_epi32(pairs, _MM_SHUFFLE(2, 2, 2, 2)));
+}
+
+
+// SSE2 version of PolyphaseInterpolation, bit-identical to the scalar code
+template<class Traits>
+struct PolyphaseInterpolationSSE2 : public PolyphaseInterpolation<Traits>
+{
+	MPT_FORCEINLINE void operator() (typename Traits::outbuf_t &outSample, const typename Traits::input_t * const MPT_RESTRICT inBuffer, const uint32 posLo)
+	{
+		static_assert(static_cast<int>(Traits::numChannelsIn) <= static_cast<int>(Traits::numChannelsOut), "Too many input channels");
+		const SINC_TYPE *lut = this->sinc + ((posLo >> (32 - SINC_PHASES_BITS)) & SINC_MASK) * SINC_WIDTH;
+		const __m128i coeffs = _mm_loadu_si128(reinterpret_cast<const __m128i *>(lut));
+
+		__m128i taps[Traits::numChannelsIn];
+		LoadSincTapsSSE2<Traits>(inBuffer, taps);
+		for(int i = 0; i < Traits::numChannelsIn; i++)
+		{
+			int32 vol1, vol2;
+			SumSincTapsSSE2(_mm_madd_epi16(taps[i], coeffs), vol1, vol2);
+			outSample[i] = static_cast<typename Traits::output_t>(static_cast<uint32>(vol1) + static_cast<uint32>(vol2)) / (1 << SINC_QUANTSHIFT);
+		}
+	}
+};
+
+
+// SSE2 version of FIRFilterInterpolation, bit-identical to the scalar code
+template<class Traits>
+struct FIRFilterInterpolationSSE2 : public FIRFilterInterpolation<Traits>
+{
+	MPT_FORCEINLINE void operator() (typename Traits::outbuf_t &outSample, const typename Traits::input_t * const MPT_RESTRICT inBuffer, const uint32 posLo)
+	{
+		static_assert(static_cast<int>(Traits::numChannelsIn) <= static_cast<int>(Traits::numChannelsOut), "Too many input channels");
+		const int16 * const lut = this->WFIRlut + ((((posLo >> 16) + WFIR_FRACHALVE) >> WFIR_FRACSHIFT) & WFIR_FRACMASK);
+		const __m128i coeffs = _mm_loadu_si128(reinterpret_cast<const __m128i *>(lut));
+
+		__m128i taps[Traits::numChannelsIn];
+		LoadSincTapsSSE2<Traits>(inBuffer, taps);
+		for(int i = 0; i < Traits::numChannelsIn; i++)
+		{
+			int32 vol1, vol2;
+			SumSincTapsSSE2(_mm_madd_epi16(taps[i], coeffs), vol1, vol2);
+			outSample[i] = ((vol1 / 2) + (vol2 / 2)) / (1 << (WFIR_16BITSHIFT - 1));
+		}
+	}
+};
+
+#endif // MPT_ENABLE_ARCH_INTRINSICS_SSE2
+
+
 //////////////////////////////////////////////////////////////////////////
 // Mixing templates (add sample to stereo mix)
 
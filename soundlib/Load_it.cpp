@@ -28,6 +28,7 @@
 #include <sstream>
 #include "../common/version.h"
 #include "ITTools.h"
+#include "SampleDecodeQueue.h"
 #include "mpt/io/base.hpp"
 #include "mpt/io/io.hpp"
 #include "mpt/io/io_stdstream.hpp"
@@ -776,6 +777,9 @@ bool CSoundFile::ReadIT(FileReader &file, ModLoadingFlags loadFlags)
 	// Reading Samples
 	m_nSamples = std::min(static_cast<SAMPLEINDEX>(fileHeader.smpnum), static_cast<SAMPLEINDEX>(MAX_SAMPLES - 1));
 	bool lastSampleCompressed = false;
+	SampleDecodeQueue decodeQueue(*this, file);
+	// Where the data of compressed samples ends is only known once they have been decoded
+	std::vector<FileReader::off_t> compressedSampleEnd(GetNumSamples(), 0);
 	for(SAMPLEINDEX i = 0; i < GetNumSamples(); i++)
 	{
 		ITSample sampleHeader;
@@ -802,7 +806,19 @@ bool CSoundFile::ReadIT(FileReader &file, ModLoadingFlags loadFlags)
 			} else if(!sample.uFlags[SMP_KEEPONDISK])
 			{
 				SampleIO sampleIO = sampleHeader.GetSampleFormat(fileHeader.cwtv);
-				if(loadFlags & loadSampleData)
+				std::size_t encodedSize = 0;
+				if((loadFlags & (loadSampleData | deferSampleData)) == (loadSampleData | deferSampleData) && m_deferredSamples.Add(i + 1, sample, sampleIO, file, encodedSize))
+				{
+					// The size of compressed samples is known as well, so we end up at the same position as when decoding the sample right away
+					file.Skip(encodedSize);
+				} else if((loadFlags & loadSampleData) && sampleIO.IsVariableLengthEncoded())
+				{
+					decodeQueue.Add([&sample, &sampleEnd = compressedSampleEnd[i], sampleIO, sampleData = file](const ILog &) mutable
+					{
+						sampleIO.ReadSample(sample, sampleData);
+						sampleEnd = sampleData.GetPosition();
+					});
+				} else if(loadFlags & loadSampleData)
 				{
 					sampleIO.ReadSample(sample, file);
 				} else
@@ -840,6 +856,11 @@ bool CSoundFile::ReadIT(FileReader &file, ModLoadingFlags loadFlags)
 			lastSampleOffset = std::max(lastSampleOffset, file.GetPosition());
 		}
 	}
+	decodeQueue.Run();
+	for(const auto sampleEnd : compressedSampleEnd)
+	{
+		lastSampleOffset = std::max(lastSampleOffset, sampleEnd);
+	}
 	m_nSamples = std::max(SAMPLEINDEX(1), GetNumSamples());
 
 	if(possibleXMconversion && fileHeader.cwtv == 0x0204 && fileHeader.cmwt == 0x0200 && fileHeader.special == 0 && fileHeader.reserved == 0
@@ -25,6 +25,9 @@
 #include "mpt/audio/span.hpp"
 #include "MPEGFrame.h"
 #include "OggStream.h"
+#include "SampleDecodeQueue.h"
+
+#include <atomic>
 
 #if defined(MPT_WITH_VORBIS) && defined(MPT_WITH_VORBISFILE)
 #include <sstream>
@@ -363,6 +366,28 @@ struct MO3SampleChunk
 };
 
 
+// MP3 sample that still needs to be decoded
+struct MO3MPEGSample
+{
+	FileReader data;
+	uint16 encoderDelay = 0;
+	uint32 length = 0;
+	bool needsFallback = false;
+
+	// Remove encoder delay and padding from the decoded sample
+	void Finish(ModSample &sample) const
+	{
+		if(encoderDelay > 0 && encoderDelay < sample.GetSampleSizeInBytes())
+		{
+			SmpLength delay = encoderDelay / sample.GetBytesPerSample();
+			memmove(sample.sampleb(), sample.sampleb() + encoderDelay, sample.GetSampleSizeInBytes() - encoderDelay);
+			sample.nLength -= delay;
+		}
+		LimitMax(sample.nLength, length);
+	}
+};
+
+
 // Unpack macros
 
 // shift control bits until it is empty:
@@ -724,6 +749,323 @@ static long VorbisfileFilereaderTell(void *datasource)
 #endif  // MPT_WITH_VORBIS && MPT_WITH_VORBISFILE
 
 
+// Decode an MO3 Ogg Vorbis sample, with the Vorbis headers optionally stored in another sample's chunk.
+// Returns false if the sample data is not supported.
+static bool ReadMO3OggSample(ModSample &sample, SAMPLEINDEX smp, FileReader sampleChunk, FileReader sharedHeaderChunk, uint16 headerSize, bool sharedHeader, const ILog &log)
+{
+	bool supported = true;
+
+#if defined(MPT_WITH_VORBIS) && defined(MPT_WITH_VORBISFILE)
+
+	std::vector<char> mergedData;
+	if(sharedHeader)
+	{
+		// Prepend the shared header to the actual sample data and adjust bitstream serial numbers.
+		// We do not handle multiple muxed logical streams as they do not exist in practice in mo3.
+		// We assume sequence numbers are consecutive at the end of the headers.
+		// Corrupted pages get dropped as required by Ogg spec. We cannot do any further sane parsing on them anyway.
+		// We do not match up multiple muxed stream properly as this would need parsing of actual packet data to determine or guess the codec.
+		// Ogg Vorbis files may contain at least an additional Ogg Skeleton stream. It is not clear whether these actually exist in MO3.
+		// We do not validate packet structure or logical bitstream structure (i.e. sequence numbers and granule positions).
+
+		// TODO: At least handle Skeleton streams here, as they violate our stream ordering assumptions here.
+
+#if 0
+		// This block may still turn out to be useful as it does a more thourough validation of the stream than the optimized version below.
+
+		// We copy the whole data into a single consecutive buffer in order to keep things simple when interfacing libvorbisfile.
+		// We could in theory only adjust the header and pass 2 chunks to libvorbisfile.
+		// Another option would be to demux both chunks on our own (or using libogg) and pass the raw packet data to libvorbis directly.
+
+		std::ostringstream mergedStream(std::ios::binary);
+		mergedStream.imbue(std::locale::classic());
+
+		sharedHeaderChunk.Rewind();
+		FileReader sharedChunk = sharedHeaderChunk.ReadChunk(headerSize);
+		sharedChunk.Rewind();
+
+		std::vector<uint32> streamSerials;
+		Ogg::PageInfo oggPageInfo;
+		std::vector<uint8> oggPageData;
+
+		streamSerials.clear();
+		while(Ogg::ReadPageAndSkipJunk(sharedChunk, oggPageInfo, oggPageData))
+		{
+			auto it = std::find(streamSerials.begin(), streamSerials.end(), oggPageInfo.header.bitstream_serial_number);
+			if(it == streamSerials.end())
+			{
+				streamSerials.push_back(oggPageInfo.header.bitstream_serial_number);
+				it = streamSerials.begin() + (streamSerials.size() - 1);
+			}
+			uint32 newSerial = it - streamSerials.begin() + 1;
+			oggPageInfo.header.bitstream_serial_number = newSerial;
+			Ogg::UpdatePageCRC(oggPageInfo, oggPageData);
+			Ogg::WritePage(mergedStream, oggPageInfo, oggPageData);
+		}
+
+		streamSerials.clear();
+		while(Ogg::ReadPageAndSkipJunk(sampleChunk, oggPageInfo, oggPageData))
+		{
+			auto it = std::find(streamSerials.begin(), streamSerials.end(), oggPageInfo.header.bitstream_serial_number);
+			if(it == streamSerials.end())
+			{
+				streamSerials.push_back(oggPageInfo.header.bitstream_serial_number);
+				it = streamSerials.begin() + (streamSerials.size() - 1);
+			}
+			uint32 newSerial = it - streamSerials.begin() + 1;
+			oggPageInfo.header.bitstream_serial_number = newSerial;
+			Ogg::UpdatePageCRC(oggPageInfo, oggPageData);
+			Ogg::WritePage(mergedStream, oggPageInfo, oggPageData);
+		}
+
+		std::string mergedStreamData = mergedStream.str();
+		mergedData.insert(mergedData.end(), mergedStreamData.begin(), mergedStreamData.end());
+
+#else
+
+		// We assume same ordering of streams in both header and data if
+		// multiple streams are present.
+
+		std::ostringstream mergedStream(std::ios::binary);
+		mergedStream.imbue(std::locale::classic());
+
+		sharedHeaderChunk.Rewind();
+		FileReader sharedChunk = sharedHeaderChunk.ReadChunk(headerSize);
+		sharedChunk.Rewind();
+
+		std::vector<uint32> dataStreamSerials;
+		std::vector<uint32> headStreamSerials;
+		Ogg::PageInfo oggPageInfo;
+		std::vector<uint8> oggPageData;
+
+		// Gather bitstream serial numbers form sample data chunk
+		dataStreamSerials.clear();
+		while(Ogg::ReadPageAndSkipJunk(sampleChunk, oggPageInfo, oggPageData))
+		{
+			if(!mpt::contains(dataStreamSerials, oggPageInfo.header.bitstream_serial_number))
+			{
+				dataStreamSerials.push_back(oggPageInfo.header.bitstream_serial_number);
+			}
+		}
+
+		// Apply the data bitstream serial numbers to the header
+		headStreamSerials.clear();
+		while(Ogg::ReadPageAndSkipJunk(sharedChunk, oggPageInfo, oggPageData))
+		{
+			auto it = std::find(headStreamSerials.begin(), headStreamSerials.end(), oggPageInfo.header.bitstream_serial_number);
+			if(it == headStreamSerials.end())
+			{
+				headStreamSerials.push_back(oggPageInfo.header.bitstream_serial_number);
+				it = headStreamSerials.begin() + (headStreamSerials.size() - 1);
+			}
+			uint32 newSerial = 0;
+			if(dataStreamSerials.size() >= static_cast<std::size_t>(it - headStreamSerials.begin()))
+			{
+				// Found corresponding stream in data chunk.
+				newSerial = dataStreamSerials[it - headStreamSerials.begin()];
+			} else
+			{
+				// No corresponding stream in data chunk. Find a free serialno.
+				std::size_t extraIndex = (it - headStreamSerials.begin()) - dataStreamSerials.size();
+				for(newSerial = 1; newSerial < 0xffffffffu; ++newSerial)
+				{
+					if(!mpt::contains(dataStreamSerials, newSerial))
+					{
+						extraIndex -= 1;
+					}
+					if(extraIndex == 0)
+					{
+						break;
+					}
+				}
+			}
+			oggPageInfo.header.bitstream_serial_number = newSerial;
+			Ogg::UpdatePageCRC(oggPageInfo, oggPageData);
+			Ogg::WritePage(mergedStream, oggPageInfo, oggPageData);
+		}
+
+		if(headStreamSerials.size() > 1)
+		{
+			log.AddToLog(LogWarning, MPT_UFORMAT("Sample {}: Ogg Vorbis data with shared header and multiple logical bitstreams in header chunk found. This may be handled incorrectly.")(smp));
+		} else if(dataStreamSerials.size() > 1)
+		{
+			log.AddToLog(LogWarning, MPT_UFORMAT("Sample {}: Ogg Vorbis sample with shared header and multiple logical bitstreams found. This may be handled incorrectly.")(smp));
+		} else if((dataStreamSerials.size() == 1) && (headStreamSerials.size() == 1) && (dataStreamSerials[0] != headStreamSerials[0]))
+		{
+			log.AddToLog(LogInformation, MPT_UFORMAT("Sample {}: Ogg Vorbis data with shared header and different logical bitstream serials found.")(smp));
+		}
+
+		std::string mergedStreamData = mergedStream.str();
+		mergedData.insert(mergedData.end(), mergedStreamData.begin(), mergedStreamData.end());
+
+		sampleChunk.Rewind();
+		FileReader::PinnedView sampleChunkView = sampleChunk.GetPinnedView();
+		mpt::span<const char> sampleChunkViewSpan = mpt::byte_cast<mpt::span<const char>>(sampleChunkView.span());
+		mergedData.insert(mergedData.end(), sampleChunkViewSpan.begin(), sampleChunkViewSpan.end());
+
+#endif
+	}
+	FileReader mergedDataChunk(mpt::byte_cast<mpt::const_byte_span>(mpt::as_span(mergedData)));
+
+	FileReader &sampleData = sharedHeader ? mergedDataChunk : sampleChunk;
+	FileReader &headerChunk = sampleData;
+
+#else  // !(MPT_WITH_VORBIS && MPT_WITH_VORBISFILE)
+
+	FileReader &sampleData = sampleChunk;
+	FileReader &headerChunk = sharedHeader ? sharedHeaderChunk : sampleData;
+#if defined(MPT_WITH_STBVORBIS)
+	std::size_t initialRead = sharedHeader ? headerSize : headerChunk.GetLength();
+#endif  // MPT_WITH_STBVORBIS
+
+#endif  // MPT_WITH_VORBIS && MPT_WITH_VORBISFILE
+
+	headerChunk.Rewind();
+	if(sharedHeader && !headerChunk.CanRead(headerSize))
+		return true;
+
+#if defined(MPT_WITH_VORBIS) && defined(MPT_WITH_VORBISFILE)
+
+	ov_callbacks callbacks = {
+	    &VorbisfileFilereaderRead,
+	    &VorbisfileFilereaderSeek,
+	    nullptr,
+	    &VorbisfileFilereaderTell};
+	OggVorbis_File vf;
+	MemsetZero(vf);
+	if(ov_open_callbacks(&sampleData, &vf, nullptr, 0, callbacks) == 0)
+	{
+		if(ov_streams(&vf) == 1)
+		{  // we do not support chained vorbis samples
+			vorbis_info *vi = ov_info(&vf, -1);
+			if(vi && vi->rate > 0 && vi->channels > 0)
+			{
+						sample.AllocateSample();
+				SmpLength offset = 0;
+				int channels = vi->channels;
+				int current_section = 0;
+				long decodedSamples = 0;
+				bool eof = false;
+				while(!eof && offset < sample.nLength && sample.HasSampleData())
+				{
+					float **output = nullptr;
+					long ret = ov_read_float(&vf, &output, 1024, &current_section);
+					if(ret == 0)
+					{
+						eof = true;
+					} else if(ret < 0)
+					{
+						// stream error, just try to continue
+					} else
+					{
+						decodedSamples = ret;
+						LimitMax(decodedSamples, mpt::saturate_cast<long>(sample.nLength - offset));
+						if(decodedSamples > 0 && channels == sample.GetNumChannels())
+						{
+							if(sample.uFlags[CHN_16BIT])
+							{
+								CopyAudio(mpt::audio_span_interleaved(sample.sample16() + (offset * sample.GetNumChannels()), sample.GetNumChannels(), decodedSamples), mpt::audio_span_planar(output, channels, decodedSamples));
+							} else
+							{
+								CopyAudio(mpt::audio_span_interleaved(sample.sample8() + (offset * sample.GetNumChannels()), sample.GetNumChannels(), decodedSamples), mpt::audio_span_planar(output, channels, decodedSamples));
+							}
+						}
+						offset += decodedSamples;
+					}
+				}
+			} else
+			{
+				supported = false;
+			}
+		} else
+		{
+			log.AddToLog(LogWarning, MPT_UFORMAT("Sample {}: Unsupported Ogg Vorbis chained stream found.")(smp));
+			supported = false;
+		}
+		ov_clear(&vf);
+	} else
+	{
+		supported = false;
+	}
+
+#elif defined(MPT_WITH_STBVORBIS)
+
+	MPT_UNREFERENCED_PARAMETER(smp);
+	MPT_UNREFERENCED_PARAMETER(log);
+
+	// NOTE/TODO: stb_vorbis does not handle inferred negative PCM sample
+	// position at stream start. (See
+	// <https://www.xiph.org/vorbis/doc/Vorbis_I_spec.html#x1-132000A.2>).
+	// This means that, for remuxed and re-aligned/cutted (at stream start)
+	// Vorbis files, stb_vorbis will include superfluous samples at the
+	// beginning. MO3 files with this property are yet to be spotted in the
+	// wild, thus, this behaviour is currently not problematic.
+
+	int consumed = 0, error = 0;
+	stb_vorbis *vorb = nullptr;
+	if(sharedHeader)
+	{
+		FileReader::PinnedView headChunkView = headerChunk.GetPinnedView(initialRead);
+		vorb = stb_vorbis_open_pushdata(mpt::byte_cast<const unsigned char *>(headChunkView.data()), mpt::saturate_cast<int>(headChunkView.size()), &consumed, &error, nullptr);
+		headerChunk.Skip(consumed);
+	}
+	FileReader::PinnedView sampleDataView = sampleData.GetPinnedView();
+	const std::byte *data = sampleDataView.data();
+	std::size_t dataLeft = sampleDataView.size();
+	if(!sharedHeader)
+	{
+		vorb = stb_vorbis_open_pushdata(mpt::byte_cast<const unsigned char *>(data), mpt::saturate_cast<int>(dataLeft), &consumed, &error, nullptr);
+		sampleData.Skip(consumed);
+		data += consumed;
+		dataLeft -= consumed;
+	}
+	if(vorb)
+	{
+		// Header has been read, proceed to reading the sample data
+		sample.AllocateSample();
+		SmpLength offset = 0;
+		while((error == VORBIS__no_error || (error == VORBIS_need_more_data && dataLeft > 0))
+		      && offset < sample.nLength && sample.HasSampleData())
+		{
+			int channels = 0, decodedSamples = 0;
+			float **output;
+			consumed = stb_vorbis_decode_frame_pushdata(vorb, mpt::byte_cast<const unsigned char *>(data), mpt::saturate_cast<int>(dataLeft), &channels, &output, &decodedSamples);
+			sampleData.Skip(consumed);
+			data += consumed;
+			dataLeft -= consumed;
+			LimitMax(decodedSamples, mpt::saturate_cast<int>(sample.nLength - offset));
+			if(decodedSamples > 0 && channels == sample.GetNumChannels())
+			{
+				if(sample.uFlags[CHN_16BIT])
+				{
+					CopyAudio(mpt::audio_span_interleaved(sample.sample16() + (offset * sample.GetNumChannels()), sample.GetNumChannels(), decodedSamples), mpt::audio_span_planar(output, channels, decodedSamples));
+				} else
+				{
+					CopyAudio(mpt::audio_span_interleaved(sample.sample8() + (offset * sample.GetNumChannels()), sample.GetNumChannels(), decodedSamples), mpt::audio_span_planar(output, channels, decodedSamples));
+				}
+			}
+			offset += decodedSamples;
+			error = stb_vorbis_get_error(vorb);
+		}
+		stb_vorbis_close(vorb);
+	} else
+	{
+		supported = false;
+	}
+
+#else  // !VORBIS
+
+	MPT_UNREFERENCED_PARAMETER(sample);
+	MPT_UNREFERENCED_PARAMETER(smp);
+	MPT_UNREFERENCED_PARAMETER(log);
+	supported = false;
+
+#endif  // VORBIS
+
+	return supported;
+}
+
+
 struct MO3ContainerHeader
 {
 	char     magic[3];   // MO3
@@ -1273,7 +1615,12 @@ bool CSoundFile::ReadMO3(FileReader &file, ModLoadingFlags loadFlags)
 	std::vector<MO3SampleChunk> sampleChunks(m_nSamples);
 
 	const bool frequencyIsHertz = (version >= 5 || !(fileHeader.flags & MO3FileHeader::linearSlides));
-	bool unsupportedSamples = false;
+	std::atomic<bool> unsupportedSamples = false;
+	SampleDecodeQueue decodeQueue(*this, file);
+	// Duplicated samples are copied once the samples they are copied from have been decoded
+	std::vector<std::pair<SAMPLEINDEX, SAMPLEINDEX>> duplicateSamples;
+	// MP3 samples that could only be decoded with Media Foundation, which is not done on the decoding threads
+	std::vector<MO3MPEGSample> mpegSamples(m_nSamples);
 	for(SAMPLEINDEX smp = 1; smp <= m_nSamples; smp++)
 	{
 		ModSample &sample = Samples[smp];
@@ -1300,20 +1647,25 @@ bool CSoundFile::ReadMO3(FileReader &file, ModLoadingFlags loadFlags)
 		if(!(loadFlags & loadSampleData))
 			continue;
 
+		const bool deferSample = (loadFlags & deferSampleData) != 0;
 		const uint32 compression = (smpHeader.flags & MO3Sample::smpCompressionMask);
 		if(!compression && smpHeader.compressedSize == 0)
 		{
 			// Uncompressed sample
-			SampleIO(
+			const SampleIO sampleIO(
 			    (smpHeader.flags & MO3Sample::smp16Bit) ? SampleIO::_16bit : SampleIO::_8bit,
 			    (smpHeader.flags & MO3Sample::smpStereo) ? SampleIO::stereoSplit : SampleIO::mono,
 			    SampleIO::littleEndian,
-			    SampleIO::signedPCM)
-			    .ReadSample(Samples[smp], file);
+			    SampleIO::signedPCM);
+			std::size_t encodedSize = 0;
+			if(deferSample && m_deferredSamples.Add(smp, sample, sampleIO, file, encodedSize))
+				file.Skip(encodedSize);
+			else
+				sampleIO.ReadSample(sample, file);
 		} else if(smpHeader.compressedSize < 0 && (smp + smpHeader.compressedSize) > 0)
 		{
 			// Duplicate sample
-			sample.CopyWaveform(Samples[smp + smpHeader.compressedSize]);
+			duplicateSamples.emplace_back(smp, static_cast<SAMPLEINDEX>(smp + smpHeader.compressedSize));
 		} else if(smpHeader.compressedSize > 0)
 		{
 			if(smpHeader.flags & MO3Sample::smp16Bit)
@@ -1337,23 +1689,33 @@ bool CSoundFile::ReadMO3(FileReader &file, ModLoadingFlags loadFlags)
 				LimitMax(sample.nLength, mpt::saturate_cast<SmpLength>(maxLength));
 			}
 
-			if(compression == MO3Sample::smpDeltaCompression)
+			if(compression == MO3Sample::smpDeltaCompression || compression == MO3Sample::smpDeltaPrediction)
 			{
-				if(sample.AllocateSample())
+				const auto decodeDeltaSample = [compression, numChannels](ModSample &mptSample, FileReader &data)
 				{
-					if(smpHeader.flags & MO3Sample::smp16Bit)
-						UnpackMO3DeltaSample<MO3Delta16BitParams>(sampleData, sample.sample16(), sample.nLength, numChannels);
-					else
-						UnpackMO3DeltaSample<MO3Delta8BitParams>(sampleData, sample.sample8(), sample.nLength, numChannels);
-				}
-			} else if(compression == MO3Sample::smpDeltaPrediction)
-			{
-				if(sample.AllocateSample())
+					if(!mptSample.AllocateSample())
+						return false;
+					if(compression == MO3Sample::smpDeltaCompression)
+					{
+						if(mptSample.uFlags[CHN_16BIT])
+							UnpackMO3DeltaSample<MO3Delta16BitParams>(data, mptSample.sample16(), mptSample.nLength, numChannels);
+						else
+							UnpackMO3DeltaSample<MO3Delta8BitParams>(data, mptSample.sample8(), mptSample.nLength, numChannels);
+					} else
+					{
+						if(mptSample.uFlags[CHN_16BIT])
+							UnpackMO3DeltaPredictionSample<MO3Delta16BitParams>(data, mptSample.sample16(), mptSample.nLength, numChannels);
+						else
+							UnpackMO3DeltaPredictionSample<MO3Delta8BitParams>(data, mptSample.sample8(), mptSample.nLength, numChannels);
+					}
+					return true;
+				};
+				if(!deferSample || !m_deferredSamples.Add(smp, sample, sampleData, decodeDeltaSample))
 				{
-					if(smpHeader.flags & MO3Sample::smp16Bit)
-						UnpackMO3DeltaPredictionSample<MO3Delta16BitParams>(sampleData, sample.sample16(), sample.nLength, numChannels);
-					else
-						UnpackMO3DeltaPredictionSample<MO3Delta8BitParams>(sampleData, sample.sample8(), sample.nLength, numChannels);
+					decodeQueue.Add([&sample, sampleData, decodeDeltaSample](const ILog &) mutable
+					{
+						decodeDeltaSample(sample, sampleData);
+					});
 				}
 			} else if(compression == MO3Sample::smpCompressionOgg || compression == MO3Sample::smpSharedOgg)
 			{
@@ -1378,19 +1740,16 @@ bool CSoundFile::ReadMO3(FileReader &file, ModLoadingFlags loadFlags)
 					mpegData = sampleData.ReadChunk(sampleData.BytesLeft());
 				}
 
-				if(ReadMP3Sample(smp, mpegData, true, true) || ReadMediaFoundationSample(smp, mpegData, true))
-				{
-					if(smpHeader.encoderDelay > 0 && smpHeader.encoderDelay < sample.GetSampleSizeInBytes())
-					{
-						SmpLength delay = smpHeader.encoderDelay / sample.GetBytesPerSample();
-						memmove(sample.sampleb(), sample.sampleb() + smpHeader.encoderDelay, sample.GetSampleSizeInBytes() - smpHeader.encoderDelay);
-						sample.nLength -= delay;
-					}
-					LimitMax(sample.nLength, smpHeader.length);
-				} else
+				MO3MPEGSample &mpegSample = mpegSamples[smp - 1];
+				mpegSample = {mpegData, smpHeader.encoderDelay, smpHeader.length, false};
+				decodeQueue.Add([this, smp, &mpegSample](const ILog &)
 				{
-					unsupportedSamples = true;
-				}
+					FileReader mpegData = mpegSample.data;
+					if(ReadMP3Sample(smp, mpegData, true, true))
+						mpegSample.Finish(Samples[smp]);
+					else
+						mpegSample.needsFallback = true;
+				});
 			} else if(compression == MO3Sample::smpOPLInstrument)
 			{
 				OPLPatch patch;
@@ -1405,6 +1764,24 @@ bool CSoundFile::ReadMO3(FileReader &file, ModLoadingFlags loadFlags)
 		}
 	}
 
+	decodeQueue.Run();
+	for(SAMPLEINDEX smp = 1; smp <= m_nSamples; smp++)
+	{
+		MO3MPEGSample &mpegSample = mpegSamples[smp - 1];
+		if(!mpegSample.needsFallback)
+			continue;
+		if(ReadMediaFoundationSample(smp, mpegSample.data, true))
+			mpegSample.Finish(Samples[smp]);
+		else
+			unsupportedSamples = true;
+	}
+	for(const auto &[smp, sourceSmp] : duplicateSamples)
+	{
+		// The copy needs the decoded sample data
+		DecodeDeferredSample(sourceSmp);
+		Samples[smp].CopyWaveform(Samples[sourceSmp]);
+	}
+
 	// Now we can load Ogg samples with shared headers.
 	if(loadFlags & loadSampleData)
 	{
@@ -1421,310 +1798,14 @@ bool CSoundFile::ReadMO3(FileReader &file, ModLoadingFlags loadFlags)
 			// stb_vorbis (currently) ignores this serial number so we can just stitch
 			// together our sample without adjusting the shared header's serial number.
 			const bool sharedHeader = sharedOggHeader != smp && sharedOggHeader > 0 && sharedOggHeader <= m_nSamples && sampleChunk.headerSize > 0;
-
-#if defined(MPT_WITH_VORBIS) && defined(MPT_WITH_VORBISFILE)
-
-			std::vector<char> mergedData;
-			if(sharedHeader)
+			// The chunks are copied so that several samples can read from the same shared header at once.
+			decodeQueue.Add([this, smp, sharedHeader, headerSize = sampleChunk.headerSize, sampleData = sampleChunk.chunk, sharedHeaderData = sharedHeader ? sampleChunks[sharedOggHeader - 1].chunk : FileReader(), &unsupportedSamples](const ILog &log)
 			{
-				// Prepend the shared header to the actual sample data and adjust bitstream serial numbers.
-				// We do not handle multiple muxed logical streams as they do not exist in practice in mo3.
-				// We assume sequence numbers are consecutive at the end of the headers.
-				// Corrupted pages get dropped as required by Ogg spec. We cannot do any further sane parsing on them anyway.
-				// We do not match up multiple muxed stream properly as this would need parsing of actual packet data to determine or guess the codec.
-				// Ogg Vorbis files may contain at least an additional Ogg Skeleton stream. It is not clear whether these actually exist in MO3.
-				// We do not validate packet structure or logical bitstream structure (i.e. sequence numbers and granule positions).
-
-				// TODO: At least handle Skeleton streams here, as they violate our stream ordering assumptions here.
-
-#if 0
-				// This block may still turn out to be useful as it does a more thourough validation of the stream than the optimized version below.
-
-				// We copy the whole data into a single consecutive buffer in order to keep things simple when interfacing libvorbisfile.
-				// We could in theory only adjust the header and pass 2 chunks to libvorbisfile.
-				// Another option would be to demux both chunks on our own (or using libogg) and pass the raw packet data to libvorbis directly.
-
-				std::ostringstream mergedStream(std::ios::binary);
-				mergedStream.imbue(std::locale::classic());
-
-				sampleChunks[sharedOggHeader - 1].chunk.Rewind();
-				FileReader sharedChunk = sampleChunks[sharedOggHeader - 1].chunk.ReadChunk(sampleChunk.headerSize);
-				sharedChunk.Rewind();
-
-				std::vector<uint32> streamSerials;
-				Ogg::PageInfo oggPageInfo;
-				std::vector<uint8> oggPageData;
-
-				streamSerials.clear();
-				while(Ogg::ReadPageAndSkipJunk(sharedChunk, oggPageInfo, oggPageData))
-				{
-					auto it = std::find(streamSerials.begin(), streamSerials.end(), oggPageInfo.header.bitstream_serial_number);
-					if(it == streamSerials.end())
-					{
-						streamSerials.push_back(oggPageInfo.header.bitstream_serial_number);
-						it = streamSerials.begin() + (streamSerials.size() - 1);
-					}
-					uint32 newSerial = it - streamSerials.begin() + 1;
-					oggPageInfo.header.bitstream_serial_number = newSerial;
-					Ogg::UpdatePageCRC(oggPageInfo, oggPageData);
-					Ogg::WritePage(mergedStream, oggPageInfo, oggPageData);
-				}
-
-				streamSerials.clear();
-				while(Ogg::ReadPageAndSkipJunk(sampleChunk.chunk, oggPageInfo, oggPageData))
-				{
-					auto it = std::find(streamSerials.begin(), streamSerials.end(), oggPageInfo.header.bitstream_serial_number);
-					if(it == streamSerials.end())
-					{
-						streamSerials.push_back(oggPageInfo.header.bitstream_serial_number);
-						it = streamSerials.begin() + (streamSerials.size() - 1);
-					}
-					uint32 newSerial = it - streamSerials.begin() + 1;
-					oggPageInfo.header.bitstream_serial_number = newSerial;
-					Ogg::UpdatePageCRC(oggPageInfo, oggPageData);
-					Ogg::WritePage(mergedStream, oggPageInfo, oggPageData);
-				}
-
-				std::string mergedStreamData = mergedStream.str();
-				mergedData.insert(mergedData.end(), mergedStreamData.begin(), mergedStreamData.end());
-
-#else
-
-				// We assume same ordering of streams in both header and data if
-				// multiple streams are present.
-
-				std::ostringstream mergedStream(std::ios::binary);
-				mergedStream.imbue(std::locale::classic());
-
-				sampleChunks[sharedOggHeader - 1].chunk.Rewind();
-				FileReader sharedChunk = sampleChunks[sharedOggHeader - 1].chunk.ReadChunk(sampleChunk.headerSize);
-				sharedChunk.Rewind();
-
-				std::vector<uint32> dataStreamSerials;
-				std::vector<uint32> headStreamSerials;
-				Ogg::PageInfo oggPageInfo;
-				std::vector<uint8> oggPageData;
-
-				// Gather bitstream serial numbers form sample data chunk
-				dataStreamSerials.clear();
-				while(Ogg::ReadPageAndSkipJunk(sampleChunk.chunk, oggPageInfo, oggPageData))
-				{
-					if(!mpt::contains(dataStreamSerials, oggPageInfo.header.bitstream_serial_number))
-					{
-						dataStreamSerials.push_back(oggPageInfo.header.bitstream_serial_number);
-					}
-				}
-
-				// Apply the data bitstream serial numbers to the header
-				headStreamSerials.clear();
-				while(Ogg::ReadPageAndSkipJunk(sharedChunk, oggPageInfo, oggPageData))
-				{
-					auto it = std::find(headStreamSerials.begin(), headStreamSerials.end(), oggPageInfo.header.bitstream_serial_number);
-					if(it == headStreamSerials.end())
-					{
-						headStreamSerials.push_back(oggPageInfo.header.bitstream_serial_number);
-						it = headStreamSerials.begin() + (headStreamSerials.size() - 1);
-					}
-					uint32 newSerial = 0;
-					if(dataStreamSerials.size() >= static_cast<std::size_t>(it - headStreamSerials.begin()))
-					{
-						// Found corresponding stream in data chunk.
-						newSerial = dataStreamSerials[it - headStreamSerials.begin()];
-					} else
-					{
-						// No corresponding stream in data chunk. Find a free serialno.
-						std::size_t extraIndex = (it - headStreamSerials.begin()) - dataStreamSerials.size();
-						for(newSerial = 1; newSerial < 0xffffffffu; ++newSerial)
-						{
-							if(!mpt::contains(dataStreamSerials, newSerial))
-							{
-								extraIndex -= 1;
-							}
-							if(extraIndex == 0)
-							{
-								break;
-							}
-						}
-					}
-					oggPageInfo.header.bitstream_serial_number = newSerial;
-					Ogg::UpdatePageCRC(oggPageInfo, oggPageData);
-					Ogg::WritePage(mergedStream, oggPageInfo, oggPageData);
-				}
-
-				if(headStreamSerials.size() > 1)
-				{
-					AddToLog(LogWarning, MPT_UFORMAT("Sample {}: Ogg Vorbis data with shared header and multiple logical bitstreams in header chunk found. This may be handled incorrectly.")(smp));
-				} else if(dataStreamSerials.size() > 1)
-				{
-					AddToLog(LogWarning, MPT_UFORMAT("Sample {}: Ogg Vorbis sample with shared header and multiple logical bitstreams found. This may be handled incorrectly.")(smp));
-				} else if((dataStreamSerials.size() == 1) && (headStreamSerials.size() == 1) && (dataStreamSerials[0] != headStreamSerials[0]))
-				{
-					AddToLog(LogInformation, MPT_UFORMAT("Sample {}: Ogg Vorbis data with shared header and different logical bitstream serials found.")(smp));
-				}
-
-				std::string mergedStreamData = mergedStream.str();
-				mergedData.insert(mergedData.end(), mergedStreamData.begin(), mergedStreamData.end());
-
-				sampleChunk.chunk.Rewind();
-				FileReader::PinnedView sampleChunkView = sampleChunk.chunk.GetPinnedView();
-				mpt::span<const char> sampleChunkViewSpan = mpt::byte_cast<mpt::span<const char>>(sampleChunkView.span());
-				mergedData.insert(mergedData.end(), sampleChunkViewSpan.begin(), sampleChunkViewSpan.end());
-
-#endif
-			}
-			FileReader mergedDataChunk(mpt::byte_cast<mpt::const_byte_span>(mpt::as_span(mergedData)));
-
-			FileReader &sampleData = sharedHeader ? mergedDataChunk : sampleChunk.chunk;
-			FileReader &headerChunk = sampleData;
-
-#else  // !(MPT_WITH_VORBIS && MPT_WITH_VORBISFILE)
-
-			FileReader &sampleData = sampleChunk.chunk;
-			FileReader &headerChunk = sharedHeader ? sampleChunks[sharedOggHeader - 1].chunk : sampleData;
-#if defined(MPT_WITH_STBVORBIS)
-			std::size_t initialRead = sharedHeader ? sampleChunk.headerSize : headerChunk.GetLength();
-#endif  // MPT_WITH_STBVORBIS
-
-#endif  // MPT_WITH_VORBIS && MPT_WITH_VORBISFILE
-
-			headerChunk.Rewind();
-			if(sharedHeader && !headerChunk.CanRead(sampleChunk.headerSize))
-				continue;
-
-#if defined(MPT_WITH_VORBIS) && defined(MPT_WITH_VORBISFILE)
-
-			ov_callbacks callbacks = {
-			    &VorbisfileFilereaderRead,
-			    &VorbisfileFilereaderSeek,
-			    nullptr,
-			    &VorbisfileFilereaderTell};
-			OggVorbis_File vf;
-			MemsetZero(vf);
-			if(ov_open_callbacks(&sampleData, &vf, nullptr, 0, callbacks) == 0)
-			{
-				if(ov_streams(&vf) == 1)
-				{  // we do not support chained vorbis samples
-					vorbis_info *vi = ov_info(&vf, -1);
-					if(vi && vi->rate > 0 && vi->channels > 0)
-					{
-						ModSample &sample = Samples[smp];
-						sample.AllocateSample();
-						SmpLength offset = 0;
-						int channels = vi->channels;
-						int current_section = 0;
-						long decodedSamples = 0;
-						bool eof = false;
-						while(!eof && offset < sample.nLength && sample.HasSampleData())
-						{
-							float **output = nullptr;
-							long ret = ov_read_float(&vf, &output, 1024, &current_section);
-							if(ret == 0)
-							{
-								eof = true;
-							} else if(ret < 0)
-							{
-								// stream error, just try to continue
-							} else
-							{
-								decodedSamples = ret;
-								LimitMax(decodedSamples, mpt::saturate_cast<long>(sample.nLength - offset));
-								if(decodedSamples > 0 && channels == sample.GetNumChannels())
-								{
-									if(sample.uFlags[CHN_16BIT])
-									{
-										CopyAudio(mpt::audio_span_interleaved(sample.sample16() + (offset * sample.GetNumChannels()), sample.GetNumChannels(), decodedSamples), mpt::audio_span_planar(output, channels, decodedSamples));
-									} else
-									{
-										CopyAudio(mpt::audio_span_interleaved(sample.sample8() + (offset * sample.GetNumChannels()), sample.GetNumChannels(), decodedSamples), mpt::audio_span_planar(output, channels, decodedSamples));
-									}
-								}
-								offset += decodedSamples;
-							}
-						}
-					} else
-					{
-						unsupportedSamples = true;
-					}
-				} else
-				{
-					AddToLog(LogWarning, MPT_UFORMAT("Sample {}: Unsupported Ogg Vorbis chained stream found.")(smp));
+				if(!ReadMO3OggSample(Samples[smp], smp, sampleData, sharedHeaderData, headerSize, sharedHeader, log))
 					unsupportedSamples = true;
-				}
-				ov_clear(&vf);
-			} else
-			{
-				unsupportedSamples = true;
-			}
-
-#elif defined(MPT_WITH_STBVORBIS)
-
-			// NOTE/TODO: stb_vorbis does not handle inferred negative PCM sample
-			// position at stream start. (See
-			// <https://www.xiph.org/vorbis/doc/Vorbis_I_spec.html#x1-132000A.2>).
-			// This means that, for remuxed and re-aligned/cutted (at stream start)
-			// Vorbis files, stb_vorbis will include superfluous samples at the
-			// beginning. MO3 files with this property are yet to be spotted in the
-			// wild, thus, this behaviour is currently not problematic.
-
-			int consumed = 0, error = 0;
-			stb_vorbis *vorb = nullptr;
-			if(sharedHeader)
-			{
-				FileReader::PinnedView headChunkView = headerChunk.GetPinnedView(initialRead);
-				vorb = stb_vorbis_open_pushdata(mpt::byte_cast<const unsigned char *>(headChunkView.data()), mpt::saturate_cast<int>(headChunkView.size()), &consumed, &error, nullptr);
-				headerChunk.Skip(consumed);
-			}
-			FileReader::PinnedView sampleDataView = sampleData.GetPinnedView();
-			const std::byte *data = sampleDataView.data();
-			std::size_t dataLeft = sampleDataView.size();
-			if(!sharedHeader)
-			{
-				vorb = stb_vorbis_open_pushdata(mpt::byte_cast<const unsigned char *>(data), mpt::saturate_cast<int>(dataLeft), &consumed, &error, nullptr);
-				sampleData.Skip(consumed);
-				data += consumed;
-				dataLeft -= consumed;
-			}
-			if(vorb)
-			{
-				// Header has been read, proceed to reading the sample data
-				ModSample &sample = Samples[smp];
-				sample.AllocateSample();
-				SmpLength offset = 0;
-				while((error == VORBIS__no_error || (error == VORBIS_need_more_data && dataLeft > 0))
-				      && offset < sample.nLength && sample.HasSampleData())
-				{
-					int channels = 0, decodedSamples = 0;
-					float **output;
-					consumed = stb_vorbis_decode_frame_pushdata(vorb, mpt::byte_cast<const unsigned char *>(data), mpt::saturate_cast<int>(dataLeft), &channels, &output, &decodedSamples);
-					sampleData.Skip(consumed);
-					data += consumed;
-					dataLeft -= consumed;
-					LimitMax(decodedSamples, mpt::saturate_cast<int>(sample.nLength - offset));
-					if(decodedSamples > 0 && channels == sample.GetNumChannels())
-					{
-						if(sample.uFlags[CHN_16BIT])
-						{
-							CopyAudio(mpt::audio_span_interleaved(sample.sample16() + (offset * sample.GetNumChannels()), sample.GetNumChannels(), decodedSamples), mpt::audio_span_planar(output, channels, decodedSamples));
-						} else
-						{
-							CopyAudio(mpt::audio_span_interleaved(sample.sample8() + (offset * sample.GetNumChannels()), sample.GetNumChannels(), decodedSamples), mpt::audio_span_planar(output, channels, decodedSamples));
-						}
-					}
-					offset += decodedSamples;
-					error = stb_vorbis_get_error(vorb);
-				}
-				stb_vorbis_close(vorb);
-			} else
-			{
-				unsupportedSamples = true;
-			}
-
-#else  // !VORBIS
-
-			unsupportedSamples = true;
-
-#endif  // VORBIS
+			});
 		}
+		decodeQueue.Run();
 	}
 
 	if(m_nType == MOD_TYPE_XM)
@@ -245,7 +245,7 @@ struct SymVirtualInst
 					functionNdx |= MixFuncTable::ndxStereo;
 
 				const SmpLength procCount = std::min(writeCount - chn.oldOffset, mpt::saturate_round<SmpLength>((chn.nLength - chn.position.ToDouble()) / chn.increment.ToDouble()));
-				MixFuncTable::Functions[functionNdx](chn, sndFile.m_Resampler, buffer.data() + chn.oldOffset * 2, procCount);
+				sndFile.m_MixFuncTable[functionNdx](chn, sndFile.m_Resampler, buffer.data() + chn.oldOffset * 2, procCount);
 				chn.oldOffset = 0;
 				if(chn.position.GetUInt() >= chn.nLength)
 					chn.pCurrentSample = nullptr;
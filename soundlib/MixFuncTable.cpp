@@ -20,6 +20,9 @@
 
 #ifdef MPT_INTMIXER
 #include "IntMixer.h"
+#if defined(MPT_ENABLE_ARCH_INTRINSICS_SSE2)
+#include "../misc/mptCPU.h"
+#endif // MPT_ENABLE_ARCH_INTRINSICS_SSE2
 #else
 #include "FloatMixer.h"
 #endif // MPT_INTMIXER
@@ -67,11 +70,34 @@ const MixFuncInterface Functions[6 * 16] =
 	BuildMixFuncTable(AmigaBlepInterpolation), // Amiga emulation
 };
 
+#if defined(MPT_INTMIXER) && defined(MPT_ENABLE_ARCH_INTRINSICS_SSE2)
+// Same as above, but with vectorized 8-tap interpolation kernels. Output is bit-identical to the scalar table.
+const MixFuncInterface FunctionsSSE2[6 * 16] =
+{
+	BuildMixFuncTable(NoInterpolation),            // No SRC
+	BuildMixFuncTable(LinearInterpolation),        // Linear SRC
+	BuildMixFuncTable(FastSincInterpolation),      // Fast Sinc (Cubic Spline) SRC
+	BuildMixFuncTable(PolyphaseInterpolationSSE2), // Kaiser SRC
+	BuildMixFuncTable(FIRFilterInterpolationSSE2), // FIR SRC
+	BuildMixFuncTable(AmigaBlepInterpolation),     // Amiga emulation
+};
+#endif // MPT_INTMIXER && MPT_ENABLE_ARCH_INTRINSICS_SSE2
+
 #undef BuildMixFuncTableRamp
 #undef BuildMixFuncTableFilter
 #undef BuildMixFuncTable
 
 
+const MixFuncInterface *GetFunctions()
+{
+#if defined(MPT_INTMIXER) && defined(MPT_ENABLE_ARCH_INTRINSICS_SSE2)
+	if(CPU::HasFeatureSet(CPU::feature::sse2))
+		return FunctionsSSE2;
+#endif // MPT_INTMIXER && MPT_ENABLE_ARCH_INTRINSICS_SSE2
+	return Functions;
+}
+
+
 ResamplingIndex ResamplingModeToMixFlags(ResamplingMode resamplingMode)
 {
 	switch(resamplingMode)
@@ -12,6 +12,7 @@
 
 #include "openmpt/all/BuildSettings.hpp"
 
+#include "Mixer.h"
 #include "MixerInterface.h"
 
 OPENMPT_NAMESPACE_BEGIN
@@ -45,6 +46,12 @@ namespace MixFuncTable
 	};
 
 	extern const MixFuncInterface Functions[6 * 16];
+#if defined(MPT_INTMIXER) && defined(MPT_ENABLE_ARCH_INTRINSICS_SSE2)
+	extern const MixFuncInterface FunctionsSSE2[6 * 16];
+#endif // MPT_INTMIXER && MPT_ENABLE_ARCH_INTRINSICS_SSE2
+
+	// Returns the fastest function table supported by the enabled CPU features
+	const MixFuncInterface *GetFunctions();
 
 	ResamplingIndex ResamplingModeToMixFlags(ResamplingMode resamplingMode);
 }
@@ -0,0 +1,102 @@
+/*
+ * MixerThreads.cpp
+ * ----------------
+ * Purpose: Worker pool for mixing sample channels on multiple threads.
+ * Notes  : (currently none)
+ * Authors: OpenMPT Devs
+ * The OpenMPT source code is released under the BSD license. Read LICENSE for more details.
+ */
+
+
+#include "stdafx.h"
+#include "MixerThreads.h"
+
+#include <system_error>
+
+
+OPENMPT_NAMESPACE_BEGIN
+
+
+#ifdef MPT_ENABLE_MIXER_THREADS
+
+
+MixerThreadPool::MixerThreadPool(uint32 numThreads)
+{
+	m_threads.reserve(numThreads > 1 ? numThreads - 1 : 0);
+	try
+	{
+		for(uint32 i = 1; i < numThreads; i++)
+		{
+			m_threads.emplace_back(&MixerThreadPool::WorkerProc, this);
+		}
+	} catch(const std::system_error &)
+	{
+		// Could not start all requested threads, make do with the ones we already have
+	}
+}
+
+
+MixerThreadPool::~MixerThreadPool()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_shutdown = true;
+	}
+	m_wake.notify_all();
+	for(auto &thread : m_threads)
+	{
+		thread.join();
+	}
+}
+
+
+void MixerThreadPool::Run(uint32 numTasks, const std::function<void(uint32)> &task)
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+	m_task = &task;
+	m_numTasks = numTasks;
+	m_nextTask = 0;
+	m_finishedTasks = 0;
+	lock.unlock();
+	m_wake.notify_all();
+
+	// The calling thread takes part in the work as well
+	lock.lock();
+	while(m_nextTask < m_numTasks)
+	{
+		const uint32 taskIndex = m_nextTask++;
+		lock.unlock();
+		task(taskIndex);
+		lock.lock();
+		m_finishedTasks++;
+	}
+	m_done.wait(lock, [this]() { return m_finishedTasks == m_numTasks; });
+	m_task = nullptr;
+	m_numTasks = 0;
+	m_nextTask = 0;
+}
+
+
+void MixerThreadPool::WorkerProc()
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+	while(true)
+	{
+		m_wake.wait(lock, [this]() { return m_shutdown || m_nextTask < m_numTasks; });
+		if(m_shutdown)
+			return;
+		const uint32 taskIndex = m_nextTask++;
+		const std::function<void(uint32)> &task = *m_task;
+		lock.unlock();
+		task(taskIndex);
+		lock.lock();
+		if(++m_finishedTasks == m_numTasks)
+			m_done.notify_one();
+	}
+}
+
+
+#endif // MPT_ENABLE_MIXER_THREADS
+
+
+OPENMPT_NAMESPACE_END
@@ -0,0 +1,115 @@
+/*
+ * MixerThreads.h
+ * --------------
+ * Purpose: Worker pool and per-partition buffers for mixing sample channels on multiple threads.
+ * Notes  : Partitions are mixed into private buffers and summed in a fixed order afterwards.
+ *          As the mixer works on integers, the result is bit-identical to single-threaded mixing.
+ * Authors: OpenMPT Devs
+ * The OpenMPT source code is released under the BSD license. Read LICENSE for more details.
+ */
+
+
+#pragma once
+
+#include "openmpt/all/BuildSettings.hpp"
+
+#include "mpt/mutex/mutex.hpp"
+
+#include "Mixer.h"
+#include "Snd_defs.h"
+
+#include <functional>
+#include <vector>
+
+#if MPT_MUTEX_STD && !(MPT_OS_WINDOWS && MPT_LIBCXX_GNU && !defined(_GLIBCXX_HAS_GTHREADS))
+#define MPT_ENABLE_MIXER_THREADS
+#endif
+
+#ifdef MPT_ENABLE_MIXER_THREADS
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#endif // MPT_ENABLE_MIXER_THREADS
+
+
+OPENMPT_NAMESPACE_BEGIN
+
+
+#ifdef MPT_ENABLE_MIXER_THREADS
+
+
+class MixerThreadPool
+{
+public:
+	// numThreads includes the calling thread, i.e. numThreads - 1 worker threads are started.
+	explicit MixerThreadPool(uint32 numThreads);
+	~MixerThreadPool();
+
+	MixerThreadPool(const MixerThreadPool &) = delete;
+	MixerThreadPool &operator=(const MixerThreadPool &) = delete;
+
+	uint32 GetNumThreads() const { return static_cast<uint32>(m_threads.size()) + 1; }
+
+	// Runs task(0) ... task(numTasks - 1) on the workers and the calling thread. Returns once all tasks have finished.
+	void Run(uint32 numTasks, const std::function<void(uint32)> &task);
+
+protected:
+	void WorkerProc();
+
+	std::vector<std::thread> m_threads;
+	std::mutex m_mutex;
+	std::condition_variable m_wake;
+	std::condition_variable m_done;
+	const std::function<void(uint32)> *m_task = nullptr;
+	uint32 m_numTasks = 0;
+	uint32 m_nextTask = 0;
+	uint32 m_finishedTasks = 0;
+	bool m_shutdown = false;
+};
+
+
+// Private mix targets of one channel partition
+struct MixerPartition
+{
+	struct Target
+	{
+		std::vector<mixsample_t> buffer;
+		mixsample_t ofsR = 0, ofsL = 0;
+		bool used = false;
+	};
+	std::vector<Target> targets;
+};
+
+
+struct MixerThreads
+{
+	static constexpr uint32 MaxThreads = 64;
+	// Splitting off fewer channels than this is not worth the synchronization overhead
+	static constexpr uint32 MinChannelsPerPartition = 4;
+
+	// One of the CSoundFile mix buffers along with its end-of-sample offsets
+	struct SharedTarget
+	{
+		mixsample_t *buffer = nullptr;
+		mixsample_t *ofsR = nullptr, *ofsL = nullptr;
+	};
+
+	explicit MixerThreads(uint32 numThreads)
+		: pool(numThreads)
+	{ }
+
+	MixerThreadPool pool;
+	std::vector<MixerPartition> partitions;
+	// Scratch space for the channels to be mixed in the current chunk, reused to avoid allocations while rendering
+	std::vector<SharedTarget> targets;
+	std::vector<CHANNELINDEX> channels;
+	std::vector<uint16> channelTarget;
+	std::vector<PLUGINDEX> channelPlugin;
+	std::vector<uint8> channelMixed;
+};
+
+
+#endif // MPT_ENABLE_MIXER_THREADS
+
+
+OPENMPT_NAMESPACE_END
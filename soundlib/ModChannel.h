@@ -40,6 +40,7 @@ struct ModChannel
 	};
 
 	// Information used in the mixer (should be kept tight for better caching)
+	// Everything that CSoundFile::MixChannel reads for every channel it mixes should be found here, so that mixing a channel only touches the first few cache lines of this struct.
 	SamplePosition position;     // Current play position (fixed point)
 	SamplePosition increment;    // Sample speed relative to mixing frequency (fixed point)
 	const void *pCurrentSample;  // Currently playing sample (nullptr if no sample is playing)
@@ -59,18 +60,22 @@ struct ModChannel
 	FlagSet<ChannelFlags> dwFlags;
 	mixsample_t nROfs, nLOfs;
 	uint32 nRampLength;
+	ResamplingMode resamplingMode;
+	uint8 nNewIns;   // Also used by ProTracker sample swapping in the mixer
+	bool isPaused;   // Don't mix or increment channel position, but keep the note alive
 
 	const ModSample *pModSample;  // Currently assigned sample slot (may already be stopped)
-	Paula::State paulaState;
+	int32 newLeftVol, newRightVol;  // Volume after ramping has finished
+	int32 nFadeOutVol;
+	CHANNELINDEX nMasterChn;
 
 	// Information not used in the mixer
 	const ModInstrument *pModInstrument;  // Currently assigned instrument slot
 	SmpLength prevNoteOffset;             // Offset for instrument-less notes for ProTracker/ScreamTracker
 	SmpLength oldOffset;                  // Offset command memory
 	FlagSet<ChannelFlags> dwOldFlags;     // Flags from previous tick
-	int32 newLeftVol, newRightVol;
 	int32 nRealVolume, nRealPan;
-	int32 nVolume, nPan, nFadeOutVol;
+	int32 nVolume, nPan;
 	int32 nPeriod;  // Frequency in Hz if CSoundFile::PeriodsAreFrequencies() or using custom tuning, 4x Amiga periods otherwise
 	int32 nC5Speed, nPortamentoDest;
 	int32 cachedPeriod, glissandoPeriod;
@@ -88,17 +93,15 @@ struct ModChannel
 	int16 nVolSwing, nPanSwing;
 	int16 nCutSwing, nResSwing;
 	uint16 nRestorePanOnNewNote;  // If > 0, nPan should be set to nRestorePanOnNewNote - 1 on new note. Used to recover from pan swing and IT sample / instrument panning. High bit set = surround
-	CHANNELINDEX nMasterChn;
 	ModCommand rowCommand;
 	// 8-bit members
-	ResamplingMode resamplingMode;
 	uint8 nRestoreResonanceOnNewNote;  // See nRestorePanOnNewNote
 	uint8 nRestoreCutoffOnNewNote;     // ditto
 	uint8 nNote;
 	NewNoteAction nNNA;
 	uint8 nLastNote;  // Last note, ignoring note offs and cuts - for MIDI macros
 	uint8 nArpeggioLastNote, nArpeggioBaseNote;  // For plugin arpeggio
-	uint8 nNewNote, nNewIns, nOldIns, nCommand, nArpeggio;
+	uint8 nNewNote, nOldIns, nCommand, nArpeggio;
 	uint8 nRetrigParam, nRetrigCount;
 	uint8 nOldVolumeSlide, nOldFineVolUpDown;
 	uint8 nOldPortaUp, nOldPortaDown, nOldFinePortaUpDown, nOldExtraFinePortaUpDown;
@@ -123,7 +126,6 @@ struct ModChannel
 	bool isFirstTick : 1;                    // Execute tick-0 effects on this channel? (condition differs between formats due to Pattern Delay commands)
 	bool triggerNote : 1;                    // Trigger note on this tick on this channel if there is one?
 	bool isPreviewNote : 1;                  // Notes preview in editor
-	bool isPaused : 1;                       // Don't mix or increment channel position, but keep the note alive
 	bool portaTargetReached : 1;             // Tone portamento is finished
 
 	//-->Variables used to make user-definable tuning modes work with pattern effects.
@@ -142,6 +144,9 @@ struct ModChannel
 	uint16 m_RowPlugParam;
 	PLUGINDEX m_RowPlug;
 
+	// Only used by the Amiga resampler, and large, so it is kept out of the way of everything else
+	Paula::State paulaState;
+
 	void ClearRowCmd() { rowCommand = ModCommand(); }
 
 	// Get a reference to a specific envelope of this channel
@@ -12,6 +12,7 @@
 #include "Sndfile.h"
 #include "ModSample.h"
 #include "modsmp_ctrl.h"
+#include "SamplePool.h"
 #include "mpt/base/numbers.hpp"
 
 #include <cmath>
@@ -260,7 +261,7 @@ void ModSample::FreeSample()
 
 void ModSample::FreeSample(void *samplePtr)
 {
-	if(samplePtr)
+	if(samplePtr && !SamplePool::Release(samplePtr))
 	{
 		delete[](((char *)samplePtr) - (InterpolationLookaheadBufferSize * MaxSamplingPointSize));
 	}
@@ -430,6 +431,9 @@ void ModSample::PrecomputeLoops(CSoundFile &sndFile, bool updateChannels)
 {
 	if(!HasSampleData())
 		return;
+	// The lookahead buffers are part of the shared sample data
+	if(!SamplePool::MakeUnique(*this, sndFile))
+		return;
 
 	SanitizeLoops();
 
@@ -51,13 +51,17 @@ void OPL::Mix(int32 *target, size_t count, uint32 volumeFactorQ16)
 
 	// This factor causes a sample voice to be more or less as loud as an OPL voice
 	const int32 factor = Util::muldiv_unsigned(volumeFactorQ16, 6169, (1 << 16));
-	while(count--)
+	std::array<int16, 2 * 256> block;
+	while(count)
 	{
-		int16 l, r;
-		m_opl->Sample(&l, &r);
-		target[0] += l * factor;
-		target[1] += r * factor;
-		target += 2;
+		const size_t frames = std::min(count, block.size() / 2);
+		m_opl->SampleBlock(block.data(), frames);
+		for(size_t i = 0; i < frames * 2; i++)
+		{
+			target[i] += block[i] * factor;
+		}
+		target += frames * 2;
+		count -= frames;
 	}
 }
 
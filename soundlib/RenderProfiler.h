@@ -0,0 +1,159 @@
+/*
+ * RenderProfiler.h
+ * ----------------
+ * Purpose: Cumulative time and call counts of the stages of CSoundFile::Read, and the number of sample frames rendered by each resampler.
+ * Notes  : Nothing is measured until the profiler is enabled, so that only a branch per stage is left in the rendering code.
+ *          Defining NO_RENDER_PROFILING removes the profiler completely.
+ *          The resampler counters are updated from mixer threads, all other data only from the thread calling CSoundFile::Read.
+ * Authors: OpenMPT Devs
+ * The OpenMPT source code is released under the BSD license. Read LICENSE for more details.
+ */
+
+
+#pragma once
+
+#include "openmpt/all/BuildSettings.hpp"
+
+#include "Snd_defs.h"
+
+#ifndef NO_RENDER_PROFILING
+#include <array>
+#include <atomic>
+#include <chrono>
+#endif // NO_RENDER_PROFILING
+
+
+OPENMPT_NAMESPACE_BEGIN
+
+
+#ifndef NO_RENDER_PROFILING
+
+class RenderProfiler
+{
+public:
+	enum Stage : uint8
+	{
+		stageReadNote,         // Tick processing
+		stageCreateStereoMix,  // Sample mixing
+		stageOPL,
+		stageReverb,
+		stagePlugins,
+		stageDSP,
+		stageOutput,           // Conversion to the output format
+		numStages
+	};
+
+	enum Resampler : uint8
+	{
+		resamplerNearest,
+		resamplerLinear,
+		resamplerCubic,
+		resamplerSinc8LP,
+		resamplerSinc8,
+		resamplerAmiga,
+		numResamplers
+	};
+
+	struct StageStatistics
+	{
+		uint64 calls = 0;
+		uint64 nanoseconds = 0;
+	};
+
+	struct Snapshot
+	{
+		std::array<StageStatistics, numStages> stages;
+		std::array<uint64, numResamplers> resamplerFrames{};  // Sample frames rendered per resampler
+	};
+
+	// Measures the time until the end of the scope
+	class Scope
+	{
+	public:
+		Scope(RenderProfiler &profiler, Stage stage)
+		{
+			if(profiler.m_enabled)
+			{
+				m_profiler = &profiler;
+				m_stage = stage;
+				m_start = std::chrono::steady_clock::now();
+			}
+		}
+		~Scope()
+		{
+			if(m_profiler)
+			{
+				StageStatistics &stats = m_profiler->m_stages[m_stage];
+				stats.calls++;
+				stats.nanoseconds += static_cast<uint64>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - m_start).count());
+			}
+		}
+		Scope(const Scope &) = delete;
+		Scope &operator=(const Scope &) = delete;
+
+	private:
+		RenderProfiler *m_profiler = nullptr;
+		Stage m_stage = stageReadNote;
+		std::chrono::steady_clock::time_point m_start;
+	};
+
+	void SetEnabled(bool enabled) noexcept { m_enabled = enabled; }
+	bool IsEnabled() const noexcept { return m_enabled; }
+
+	void Reset() noexcept
+	{
+		m_stages = {};
+		for(auto &frames : m_resamplerFrames)
+		{
+			frames.store(0, std::memory_order_relaxed);
+		}
+	}
+
+	Snapshot GetSnapshot() const noexcept
+	{
+		Snapshot snapshot;
+		snapshot.stages = m_stages;
+		for(size_t i = 0; i < numResamplers; i++)
+		{
+			snapshot.resamplerFrames[i] = m_resamplerFrames[i].load(std::memory_order_relaxed);
+		}
+		return snapshot;
+	}
+
+	// May be called concurrently from several mixer threads
+	void AddResampledFrames(uint8 resamplingMode, uint32 frames) noexcept
+	{
+		if(!m_enabled)
+			return;
+		m_resamplerFrames[ResamplingModeToIndex(resamplingMode)].fetch_add(frames, std::memory_order_relaxed);
+	}
+
+	static constexpr Resampler ResamplingModeToIndex(uint8 resamplingMode) noexcept
+	{
+		switch(resamplingMode)
+		{
+		case SRCMODE_NEAREST: return resamplerNearest;
+		case SRCMODE_LINEAR:  return resamplerLinear;
+		case SRCMODE_CUBIC:   return resamplerCubic;
+		case SRCMODE_SINC8LP: return resamplerSinc8LP;
+		case SRCMODE_SINC8:   return resamplerSinc8;
+		default:              return resamplerAmiga;
+		}
+	}
+
+private:
+	bool m_enabled = false;
+	std::array<StageStatistics, numStages> m_stages;
+	std::array<std::atomic<uint64>, numResamplers> m_resamplerFrames{};
+};
+
+#define MPT_PROFILE_RENDER_STAGE(profiler, stage) const RenderProfiler::Scope renderProfilerScope((profiler), RenderProfiler::stage)
+
+#else // NO_RENDER_PROFILING
+
+#define MPT_PROFILE_RENDER_STAGE(profiler, stage) do { } while(0)
+
+#endif // NO_RENDER_PROFILING
+
+
+OPENMPT_NAMESPACE_END
@@ -17,6 +17,8 @@
 #include "MixerSettings.h"
 #include "Paula.h"
 
+#include <vector>
+
 
 OPENMPT_NAMESPACE_BEGIN
 
@@ -131,11 +133,24 @@ public:
 		InitializeTablesFromScratch(false);
 	}
 
+#ifdef MPT_RESAMPLER_TABLES_CACHED
+	// Initialize from a tables blob as returned by GetTablesCacheBlob, or from scratch if the blob is not valid.
+	explicit CResampler(mpt::const_byte_span tablesBlob);
+
+	// The process-wide tables cache can be stored as a blob, e.g. in a file that later processes read the tables from. The tables are copied out of the blob.
+	// Blobs are only valid for the exact same library version and build configuration.
+	static std::vector<std::byte> GetTablesCacheBlob();
+	static bool IsValidTablesBlob(mpt::const_byte_span tablesBlob);
+	// Initializes the tables cache from the blob if it has not been initialized yet. Returns false if the blob is not valid.
+	static bool InitializeTablesCache(mpt::const_byte_span tablesBlob);
+#endif // MPT_RESAMPLER_TABLES_CACHED
+
 private:
 	void InitFloatmixerTables();
 	void InitializeTablesFromScratch(bool force=false);
 #ifdef MPT_RESAMPLER_TABLES_CACHED
 	void InitializeTablesFromCache();
+	bool InitializeTablesFromBlob(mpt::const_byte_span tablesBlob);
 #endif
 };
 
@@ -0,0 +1,112 @@
+/*
+ * ResonantFilterCache.h
+ * ---------------------
+ * Purpose: Memoization of resonant channel filter coefficients.
+ * Notes  : Filter envelopes cause the same coefficients to be computed again on every tick,
+ *          which involves two calls to std::pow. The cache is owned by CSoundFile and is only
+ *          accessed from the thread that processes ticks.
+ * Authors: OpenMPT Devs
+ * The OpenMPT source code is released under the BSD license. Read LICENSE for more details.
+ */
+
+
+#pragma once
+
+#include "openmpt/all/BuildSettings.hpp"
+
+#include <array>
+
+
+OPENMPT_NAMESPACE_BEGIN
+
+
+struct ResonantFilterCoefficients
+{
+	float gain = 0.0f;       // Applied to the input sample
+	float feedback0 = 0.0f;  // Applied to the previous output sample
+	float feedback1 = 0.0f;  // Applied to the output sample before that
+};
+
+
+// Direct-mapped cache keyed on the clamped cutoff [0, 127], resonance [0, 127] and envelope modifier [-256, 256].
+class ResonantFilterCache
+{
+public:
+	// Everything else that the coefficients depend on. Changing any of these discards all cached entries.
+	struct Config
+	{
+		uint32 mixingFreq = 0;
+		bool extendedRange = false;
+		bool imfCutoff = false;
+		bool itFilterBehaviour = false;
+
+		bool operator==(const Config &other) const
+		{
+			return mixingFreq == other.mixingFreq && extendedRange == other.extendedRange && imfCutoff == other.imfCutoff && itFilterBehaviour == other.itFilterBehaviour;
+		}
+		bool operator!=(const Config &other) const { return !(*this == other); }
+	};
+
+	void Reset()
+	{
+		for(auto &entry : m_entries)
+		{
+			entry.key = InvalidKey;
+		}
+	}
+
+	// Returns the coefficients stored for these parameters, or nullptr if they have to be computed.
+	const ResonantFilterCoefficients *Find(const Config &config, int cutoff, int resonance, int envModifier)
+	{
+		if(config != m_config)
+		{
+			Reset();
+			m_config = config;
+			return nullptr;
+		}
+		const uint32 key = GetKey(cutoff, resonance, envModifier);
+		if(key == InvalidKey)
+			return nullptr;
+		const Entry &entry = m_entries[GetIndex(key)];
+		return (entry.key == key) ? &entry.coefficients : nullptr;
+	}
+
+	// Config must be the same as in the previous call to Find().
+	void Store(int cutoff, int resonance, int envModifier, const ResonantFilterCoefficients &coefficients)
+	{
+		const uint32 key = GetKey(cutoff, resonance, envModifier);
+		if(key == InvalidKey)
+			return;
+		Entry &entry = m_entries[GetIndex(key)];
+		entry.key = key;
+		entry.coefficients = coefficients;
+	}
+
+protected:
+	static constexpr uint32 IndexBits = 10;
+	static constexpr uint32 InvalidKey = uint32_max;
+
+	static uint32 GetKey(int cutoff, int resonance, int envModifier)
+	{
+		if(cutoff < 0 || cutoff > 127 || resonance < 0 || resonance > 127 || envModifier < -256 || envModifier > 256)
+			return InvalidKey;
+		return static_cast<uint32>(cutoff) | (static_cast<uint32>(resonance) << 7) | (static_cast<uint32>(envModifier + 256) << 14);
+	}
+
+	static uint32 GetIndex(uint32 key)
+	{
+		return (key * 0x9E3779B1u) >> (32 - IndexBits);
+	}
+
+	struct Entry
+	{
+		uint32 key = InvalidKey;
+		ResonantFilterCoefficients coefficients;
+	};
+
+	std::array<Entry, 1u << IndexBits> m_entries;
+	Config m_config;
+};
+
+
+OPENMPT_NAMESPACE_END
@@ -19,6 +19,8 @@
 #include "RowVisitor.h"
 #include "Sndfile.h"
 
+#include "mpt/base/bit.hpp"
+
 OPENMPT_NAMESPACE_BEGIN
 
 RowVisitor::LoopState::LoopState(const ChannelStates &chnState, const bool ignoreRow)
@@ -64,8 +66,20 @@ RowVisitor::RowVisitor(const CSoundFile &sndFile, SEQUENCEINDEX sequence)
 
 void RowVisitor::MoveVisitedRowsFrom(RowVisitor &other) noexcept
 {
-	m_visitedRows = std::move(other.m_visitedRows);
-	m_visitedLoopStates = std::move(other.m_visitedLoopStates);
+	std::swap(m_visitedRows, other.m_visitedRows);
+	std::swap(m_orderOffsets, other.m_orderOffsets);
+	std::swap(m_loopRows, other.m_loopRows);
+	std::swap(m_visitedLoopStates, other.m_visitedLoopStates);
+}
+
+
+void RowVisitor::CopyVisitedRowsFrom(const RowVisitor &other)
+{
+	m_visitedRows = other.m_visitedRows;
+	m_orderOffsets = other.m_orderOffsets;
+	m_loopRows = other.m_loopRows;
+	m_visitedLoopStates = other.m_visitedLoopStates;
+	m_rowsSpentInLoops = other.m_rowsSpentInLoops;
 }
 
 
@@ -84,81 +98,53 @@ void RowVisitor::Initialize(bool reset)
 {
 	auto &order = Order();
 	const ORDERINDEX endOrder = order.GetLengthTailTrimmed();
-	m_visitedRows.resize(endOrder);
+
+	// The module might have been edited, so rows that are kept have to be moved to their new bit positions.
+	std::vector<uint32> oldOffsets;
+	std::vector<uint64> oldVisitedRows, oldLoopRows;
 	if(reset)
 	{
 		m_visitedLoopStates.clear();
 		m_rowsSpentInLoops = 0;
+	} else
+	{
+		oldOffsets = std::move(m_orderOffsets);
+		oldVisitedRows = std::move(m_visitedRows);
+		oldLoopRows = std::move(m_loopRows);
 	}
 
-	std::vector<uint8> loopCount;
-	std::vector<ORDERINDEX> visitedPatterns(m_sndFile.Patterns.GetNumPatterns(), ORDERINDEX_INVALID);
+	m_orderOffsets.resize(endOrder + 1);
+	m_orderOffsets[0] = 0;
 	for(ORDERINDEX ord = 0; ord < endOrder; ord++)
 	{
-		const PATTERNINDEX pat = order[ord];
-		const ROWINDEX numRows = VisitedRowsVectorSize(pat);
-		auto &visitedRows = m_visitedRows[ord];
-
-		if(reset)
-			visitedRows.assign(numRows, false);
-		else
-			visitedRows.resize(numRows, false);
-
-		if(!order.IsValidPat(ord))
-			continue;
-
-		const ROWINDEX startRow = std::min(static_cast<ROWINDEX>(reset ? 0 : visitedRows.size()), numRows);
-		auto insertionHint = m_visitedLoopStates.end();
+		m_orderOffsets[ord + 1] = m_orderOffsets[ord] + VisitedRowsVectorSize(order[ord]);
+	}
+	m_visitedRows.assign((m_orderOffsets.back() + 63u) / 64u, 0);
+	m_loopRows.assign(m_visitedRows.size(), 0);
 
-		if(visitedPatterns[pat] != ORDERINDEX_INVALID)
+	const ORDERINDEX keepOrders = std::min(endOrder, static_cast<ORDERINDEX>(oldOffsets.empty() ? 0 : oldOffsets.size() - 1));
+	for(ORDERINDEX ord = 0; ord < keepOrders; ord++)
+	{
+		const ROWINDEX keepRows = std::min(GetNumRows(ord), oldOffsets[ord + 1] - oldOffsets[ord]);
+		for(ROWINDEX row = 0; row < keepRows; row++)
 		{
-			// We visited this pattern before, copy over the results
-			const auto begin = m_visitedLoopStates.lower_bound({visitedPatterns[pat], startRow});
-			const auto end = (begin != m_visitedLoopStates.end()) ? m_visitedLoopStates.lower_bound({visitedPatterns[pat], numRows}) : m_visitedLoopStates.end();
-			for(auto pos = begin; pos != end; ++pos)
-			{
-				LoopStateSet loopStates;
-				loopStates.reserve(pos->second.capacity());
-				insertionHint = ++m_visitedLoopStates.insert_or_assign(insertionHint, {ord, pos->first.second}, std::move(loopStates));
-			}
-			continue;
+			const uint32 oldPos = oldOffsets[ord] + row, newPos = m_orderOffsets[ord] + row;
+			if(IsBitSet(oldVisitedRows, oldPos))
+				SetBit(m_visitedRows, newPos);
+			if(IsBitSet(oldLoopRows, oldPos))
+				SetBit(m_loopRows, newPos);
 		}
-
-		// Pre-allocate loop count state
-		const auto &pattern = m_sndFile.Patterns[pat];
-		loopCount.assign(pattern.GetNumChannels(), 0);
-		for(ROWINDEX i = numRows; i != startRow; i--)
-		{
-			const ROWINDEX row = i - 1;
-			uint32 maxLoopStates = 1;
-			auto m = pattern.GetRow(row);
-			// Break condition: If it's more than 16, it's probably wrong :) exact loop count depends on how loops overlap.
-			for(CHANNELINDEX chn = 0; chn < pattern.GetNumChannels() && maxLoopStates < 16; chn++, m++)
-			{
-				auto count = loopCount[chn];
-				if((m->command == CMD_S3MCMDEX && (m->param & 0xF0) == 0xB0) || (m->command == CMD_MODCMDEX && (m->param & 0xF0) == 0x60))
-				{
-					loopCount[chn] = (m->param & 0x0F);
-					if(loopCount[chn])
-						count = loopCount[chn];
-				}
-				if(count)
-					maxLoopStates *= (count + 1);
-			}
-			if(maxLoopStates > 1)
-			{
-				LoopStateSet loopStates;
-				loopStates.reserve(maxLoopStates);
-				insertionHint = m_visitedLoopStates.insert_or_assign(insertionHint, {ord, row}, std::move(loopStates));
-			}
-		}
-		// Only use this order as a blueprint for other orders using the same pattern if we fully parsed the pattern.
-		if(startRow == 0)
-			visitedPatterns[pat] = ord;
 	}
 }
 
 
+void RowVisitor::Reset(SEQUENCEINDEX sequence)
+{
+	m_sequence = sequence;
+	Initialize(true);
+}
+
+
 // Mark an order/row combination as visited and returns true if it was visited before.
 bool RowVisitor::Visit(ORDERINDEX ord, ROWINDEX row, const ChannelStates &chnState, bool ignoreRow)
 {
@@ -167,25 +153,25 @@ bool RowVisitor::Visit(ORDERINDEX ord, ROWINDEX row, const ChannelStates &chnSta
 		return false;
 
 	// The module might have been edited in the meantime - so we have to extend this a bit.
-	if(ord >= m_visitedRows.size() || row >= m_visitedRows[ord].size())
+	if(ord >= GetNumOrders() || row >= GetNumRows(ord))
 	{
 		Initialize(false);
 		// If it's still past the end of the vector, this means that ord >= order.GetLengthTailTrimmed(), i.e. we are trying to play an empty order.
-		if(ord >= m_visitedRows.size())
+		if(ord >= GetNumOrders())
 			return false;
 	}
 
 	MPT_ASSERT(chnState.size() >= m_sndFile.GetNumChannels());
-	LoopState newState{chnState.first(m_sndFile.GetNumChannels()), ignoreRow};
-	const auto rowLoopState = m_visitedLoopStates.find({ord, row});
-	const bool oldHadLoops = (rowLoopState != m_visitedLoopStates.end() && !rowLoopState->second.empty());
-	const bool newHasLoops = newState.HasLoops();
-	const bool wasVisited = m_visitedRows[ord][row];
+	VisitedLoopState newState{PositionKey(ord, row), LoopState{chnState.first(m_sndFile.GetNumChannels()), ignoreRow}};
+	const uint32 pos = m_orderOffsets[ord] + row;
+	const bool oldHadLoops = IsBitSet(m_loopRows, pos);
+	const bool newHasLoops = newState.state.HasLoops();
+	const bool wasVisited = IsBitSet(m_visitedRows, pos);
 	
 	// Check if new state is part of row state already. If so, we visited this row already and thus the module must be looping
 	if(!oldHadLoops && !newHasLoops && wasVisited)
 		return true;
-	if(oldHadLoops && mpt::contains(rowLoopState->second, newState))
+	if(oldHadLoops && m_visitedLoopStates.count(newState))
 		return true;
 
 	if(newHasLoops)
@@ -195,14 +181,30 @@ bool RowVisitor::Visit(ORDERINDEX ord, ROWINDEX row, const ChannelStates &chnSta
 	{
 		// Convert to set representation if it isn't already
 		if(!oldHadLoops && wasVisited)
-			m_visitedLoopStates[{ord, row}].emplace_back();
-		m_visitedLoopStates[{ord, row}].emplace_back(std::move(newState));
+			m_visitedLoopStates.insert({newState.position, LoopState{}});
+		m_visitedLoopStates.insert(std::move(newState));
+		SetBit(m_loopRows, pos);
 	}
-	m_visitedRows[ord][row] = true;
+	SetBit(m_visitedRows, pos);
 	return false;
 }
 
 
+// Returns true if the order/row combination has been visited, regardless of any pattern loop state.
+bool RowVisitor::IsVisited(ORDERINDEX ord, ROWINDEX row) const noexcept
+{
+	return ord < GetNumOrders() && row < GetNumRows(ord) && IsBitSet(m_visitedRows, m_orderOffsets[ord] + row);
+}
+
+
+// Rough estimate of the memory held by this object, in bytes.
+std::size_t RowVisitor::GetMemoryUsage() const noexcept
+{
+	return sizeof(*this) + (m_visitedRows.capacity() + m_loopRows.capacity()) * sizeof(uint64) + m_orderOffsets.capacity() * sizeof(uint32)
+		+ m_visitedLoopStates.bucket_count() * sizeof(void *) + m_visitedLoopStates.size() * (sizeof(VisitedLoopState) + 16u);  // 16 bytes for hash node overhead
+}
+
+
 // Get the needed vector size for a given pattern.
 ROWINDEX RowVisitor::VisitedRowsVectorSize(PATTERNINDEX pattern) const noexcept
 {
@@ -213,6 +215,22 @@ ROWINDEX RowVisitor::VisitedRowsVectorSize(PATTERNINDEX pattern) const noexcept
 }
 
 
+// Returns the position of the first bit in [begin, end) that is set (or not set if value is false), or end if there is no such bit.
+uint32 RowVisitor::FindBit(uint32 begin, uint32 end, bool value) const noexcept
+{
+	const uint64 invert = value ? 0 : ~uint64(0);
+	uint32 pos = begin;
+	while(pos < end)
+	{
+		const uint64 word = (m_visitedRows[pos / 64u] ^ invert) >> (pos % 64u);
+		if(word)
+			return std::min(pos + static_cast<uint32>(mpt::countr_zero(word)), end);
+		pos = (pos / 64u + 1u) * 64u;
+	}
+	return end;
+}
+
+
 // Find the first row that has not been played yet.
 // The order and row is stored in the order and row variables on success, on failure they contain invalid values.
 // If onlyUnplayedPatterns is true (default), only completely unplayed patterns are considered, otherwise a song can start on any unplayed row.
@@ -226,16 +244,16 @@ bool RowVisitor::GetFirstUnvisitedRow(ORDERINDEX &ord, ROWINDEX &row, bool onlyU
 		if(!order.IsValidPat(ord))
 			continue;
 
-		if(ord >= m_visitedRows.size())
+		if(ord >= GetNumOrders())
 		{
 			// Not yet initialized => unvisited
 			row = 0;
 			return true;
 		}
 
-		const auto &visitedRows = m_visitedRows[ord];
-		const auto firstUnplayedRow = std::find(visitedRows.begin(), visitedRows.end(), onlyUnplayedPatterns);
-		if(onlyUnplayedPatterns && firstUnplayedRow == visitedRows.end())
+		const uint32 begin = m_orderOffsets[ord], end = m_orderOffsets[ord + 1];
+		const uint32 firstUnplayedRow = FindBit(begin, end, onlyUnplayedPatterns);
+		if(onlyUnplayedPatterns && firstUnplayedRow == end)
 		{
 			// No row of this pattern has been played yet.
 			row = 0;
@@ -243,15 +261,15 @@ bool RowVisitor::GetFirstUnvisitedRow(ORDERINDEX &ord, ROWINDEX &row, bool onlyU
 		} else if(!onlyUnplayedPatterns)
 		{
 			// Return the first unplayed row in this pattern
-			if(firstUnplayedRow != visitedRows.end())
+			if(firstUnplayedRow != end)
 			{
-				row = static_cast<ROWINDEX>(std::distance(visitedRows.begin(), firstUnplayedRow));
+				row = firstUnplayedRow - begin;
 				return true;
 			}
-			if(visitedRows.size() < m_sndFile.Patterns[order[ord]].GetNumRows())
+			if(GetNumRows(ord) < m_sndFile.Patterns[order[ord]].GetNumRows())
 			{
 				// History is not fully initialized
-				row = static_cast<ROWINDEX>(visitedRows.size());
+				row = GetNumRows(ord);
 				return true;
 			}
 		}
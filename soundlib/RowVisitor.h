@@ -15,7 +15,7 @@
 #include "mpt/base/span.hpp"
 #include "Snd_defs.h"
 
-#include <map>
+#include <unordered_set>
 
 OPENMPT_NAMESPACE_BEGIN
 
@@ -66,31 +66,62 @@ protected:
 #endif
 			return m_hash != FNV1a_BASIS;
 		}
+
+		[[nodiscard]] uint64 GetHash() const noexcept { return m_hash; }
 	};
 
-	using LoopStateSet = std::vector<LoopState>;
+	// A loop state that has been encountered on a specific row
+	struct VisitedLoopState
+	{
+		uint64 position;  // PositionKey(order, row)
+		LoopState state;
 
-	// Stores for every (order, row) combination in the sequence if it has been visited or not.
-	std::vector<std::vector<bool>> m_visitedRows;
-	// Map for each row that's part of a pattern loop which loop states have been visited. Held in a separate data structure because it is sparse data in typical modules.
-	std::map<std::pair<ORDERINDEX, ROWINDEX>, LoopStateSet> m_visitedLoopStates;
+		[[nodiscard]] bool operator==(const VisitedLoopState &other) const noexcept { return position == other.position && state == other.state; }
+	};
+
+	struct VisitedLoopStateHash
+	{
+		std::size_t operator()(const VisitedLoopState &visited) const noexcept
+		{
+			return static_cast<std::size_t>(visited.state.GetHash() ^ (visited.position * 0x9E3779B97F4A7C15ull));
+		}
+	};
+
+	// Stores for every (order, row) combination in the sequence if it has been visited or not, one bit per row.
+	// The rows of order ord are found at bit positions m_orderOffsets[ord] to m_orderOffsets[ord + 1] - 1.
+	std::vector<uint64> m_visitedRows;
+	std::vector<uint32> m_orderOffsets;
+	// Same layout as m_visitedRows, the bit is set if a row has been visited as part of a pattern loop, i.e. its loop states are found in m_visitedLoopStates.
+	std::vector<uint64> m_loopRows;
+	// All loop states that have been visited on each row that's part of a pattern loop. Held in a separate data structure because it is sparse data in typical modules.
+	std::unordered_set<VisitedLoopState, VisitedLoopStateHash> m_visitedLoopStates;
 
 	const CSoundFile &m_sndFile;
 	ROWINDEX m_rowsSpentInLoops = 0;
-	const SEQUENCEINDEX m_sequence;
+	SEQUENCEINDEX m_sequence;
 
 public:
 	RowVisitor(const CSoundFile &sndFile, SEQUENCEINDEX sequence = SEQUENCEINDEX_INVALID);
 	
+	// The other object receives the previous contents of this object, so that their memory can be reused.
 	void MoveVisitedRowsFrom(RowVisitor &other) noexcept;
+	void CopyVisitedRowsFrom(const RowVisitor &other);
 
 	// Resize / Clear the row vector.
 	// If reset is true, the vector is not only resized to the required dimensions, but also completely cleared (i.e. all visited rows are unset).
 	void Initialize(bool reset);
+	// Clear all visited rows and switch to another sequence, keeping the allocated memory.
+	void Reset(SEQUENCEINDEX sequence);
 
 	// Mark an order/row combination as visited and returns true if it was visited before.
 	bool Visit(ORDERINDEX ord, ROWINDEX row, const ChannelStates &chnState, bool ignoreRow);
 
+	// Returns true if the order/row combination has been visited, regardless of any pattern loop state.
+	[[nodiscard]] bool IsVisited(ORDERINDEX ord, ROWINDEX row) const noexcept;
+
+	// Rough estimate of the memory held by this object, in bytes.
+	[[nodiscard]] std::size_t GetMemoryUsage() const noexcept;
+
 	// Find the first row that has not been played yet.
 	// The order and row is stored in the order and row variables on success, on failure they contain invalid values.
 	// If onlyUnplayedPatterns is true (default), only completely unplayed patterns are considered, otherwise a song can start anywhere.
@@ -106,6 +137,15 @@ protected:
 	// Get the needed vector size for a given pattern.
 	[[nodiscard]] ROWINDEX VisitedRowsVectorSize(PATTERNINDEX pattern) const noexcept;
 
+	[[nodiscard]] ORDERINDEX GetNumOrders() const noexcept { return m_orderOffsets.empty() ? ORDERINDEX(0) : static_cast<ORDERINDEX>(m_orderOffsets.size() - 1); }
+	[[nodiscard]] ROWINDEX GetNumRows(ORDERINDEX ord) const noexcept { return m_orderOffsets[ord + 1] - m_orderOffsets[ord]; }
+	[[nodiscard]] static bool IsBitSet(const std::vector<uint64> &bits, uint32 pos) noexcept { return (bits[pos / 64u] >> (pos % 64u)) & 1u; }
+	static void SetBit(std::vector<uint64> &bits, uint32 pos) noexcept { bits[pos / 64u] |= uint64(1) << (pos % 64u); }
+	// Returns the position of the first bit in [begin, end) that is set (or not set if value is false), or end if there is no such bit.
+	[[nodiscard]] uint32 FindBit(uint32 begin, uint32 end, bool value) const noexcept;
+
+	static constexpr uint64 PositionKey(ORDERINDEX ord, ROWINDEX row) noexcept { return (uint64(ord) << 32) | row; }
+
 	[[nodiscard]] const ModSequence &Order() const;
 };
 
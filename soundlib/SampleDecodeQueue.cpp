@@ -0,0 +1,105 @@
+/*
+ * SampleDecodeQueue.cpp
+ * ---------------------
+ * Purpose: Lets module loaders decode independent samples on multiple threads.
+ * Notes  : (currently none)
+ * Authors: OpenMPT Devs
+ * The OpenMPT source code is released under the BSD license. Read LICENSE for more details.
+ */
+
+
+#include "stdafx.h"
+#include "SampleDecodeQueue.h"
+#include "MixerThreads.h"
+#include "Sndfile.h"
+#include "../common/FileReader.h"
+
+
+OPENMPT_NAMESPACE_BEGIN
+
+
+void SampleDecodeQueue::DirectLog::AddToLog(LogLevel level, const mpt::ustring &text) const
+{
+	m_sndFile.AddToLog(level, text);
+}
+
+
+SampleDecodeQueue::SampleDecodeQueue(const CSoundFile &sndFile, const FileReader &file)
+	: m_sndFile(sndFile)
+{
+#ifdef MPT_ENABLE_MIXER_THREADS
+	// Reading from files that are not completely in memory modifies the file's internal state
+	if(file.PrepareConcurrentReads())
+	{
+		m_numThreads = sndFile.GetLoaderThreads();
+		if(m_numThreads == 0)
+			m_numThreads = std::max(std::thread::hardware_concurrency(), 1u);
+		LimitMax(m_numThreads, MixerThreads::MaxThreads);
+	}
+#else
+	MPT_UNREFERENCED_PARAMETER(file);
+#endif // MPT_ENABLE_MIXER_THREADS
+}
+
+
+void SampleDecodeQueue::Add(Job job)
+{
+	if(m_numThreads <= 1)
+	{
+		job(DirectLog(m_sndFile));
+		return;
+	}
+	m_jobs.push_back({std::move(job), {}, {}});
+}
+
+
+void SampleDecodeQueue::Run()
+{
+	if(m_jobs.empty())
+		return;
+
+	const auto runJob = [this](uint32 i)
+	{
+		QueuedJob &queued = m_jobs[i];
+		try
+		{
+			queued.job(queued.log);
+		} catch(...)
+		{
+			queued.exception = std::current_exception();
+		}
+	};
+
+	const uint32 numJobs = static_cast<uint32>(m_jobs.size());
+#ifdef MPT_ENABLE_MIXER_THREADS
+	if(numJobs > 1)
+	{
+		MixerThreadPool pool(std::min(m_numThreads, numJobs));
+		pool.Run(numJobs, runJob);
+	} else
+#endif // MPT_ENABLE_MIXER_THREADS
+	{
+		for(uint32 i = 0; i < numJobs; i++)
+		{
+			runJob(i);
+		}
+	}
+
+	std::vector<QueuedJob> jobs = std::move(m_jobs);
+	m_jobs.clear();
+	for(const auto &queued : jobs)
+	{
+		for(const auto &[level, text] : queued.log.messages)
+		{
+			m_sndFile.AddToLog(level, text);
+		}
+	}
+	for(const auto &queued : jobs)
+	{
+		if(queued.exception)
+			std::rethrow_exception(queued.exception);
+	}
+}
+
+
+OPENMPT_NAMESPACE_END
@@ -0,0 +1,83 @@
+/*
+ * SampleDecodeQueue.h
+ * -------------------
+ * Purpose: Lets module loaders decode independent samples on multiple threads.
+ * Notes  : Jobs only run concurrently if the module data can be read from several threads at once.
+ *          Otherwise, and if only one loader thread is requested, each job runs as soon as it is added.
+ * Authors: OpenMPT Devs
+ * The OpenMPT source code is released under the BSD license. Read LICENSE for more details.
+ */
+
+
+#pragma once
+
+#include "openmpt/all/BuildSettings.hpp"
+
+#include "../common/FileReaderFwd.h"
+#include "../common/Logging.h"
+
+#include <exception>
+#include <functional>
+#include <utility>
+#include <vector>
+
+
+OPENMPT_NAMESPACE_BEGIN
+
+
+class CSoundFile;
+
+
+class SampleDecodeQueue
+{
+public:
+	// A job must only modify the sample(s) it decodes, and it must only read from its own copies of FileReaders.
+	// Log messages must be written to the passed log instead of the CSoundFile log.
+	using Job = std::function<void(const ILog &log)>;
+
+	SampleDecodeQueue(const CSoundFile &sndFile, const FileReader &file);
+
+	SampleDecodeQueue(const SampleDecodeQueue &) = delete;
+	SampleDecodeQueue &operator=(const SampleDecodeQueue &) = delete;
+
+	void Add(Job job);
+
+	// Runs all jobs added so far and forwards their log messages in the order in which the jobs were added.
+	// If a job threw an exception, the first one is rethrown afterwards.
+	void Run();
+
+protected:
+	class JobLog : public ILog
+	{
+	public:
+		void AddToLog(LogLevel level, const mpt::ustring &text) const override
+		{
+			messages.emplace_back(level, text);
+		}
+		mutable std::vector<std::pair<LogLevel, mpt::ustring>> messages;
+	};
+
+	// Forwards log messages directly to the CSoundFile log
+	class DirectLog : public ILog
+	{
+	public:
+		DirectLog(const CSoundFile &sndFile) : m_sndFile(sndFile) { }
+		void AddToLog(LogLevel level, const mpt::ustring &text) const override;
+	protected:
+		const CSoundFile &m_sndFile;
+	};
+
+	struct QueuedJob
+	{
+		Job job;
+		JobLog log;
+		std::exception_ptr exception;
+	};
+
+	const CSoundFile &m_sndFile;
+	std::vector<QueuedJob> m_jobs;
+	uint32 m_numThreads = 1;
+};
+
+
+OPENMPT_NAMESPACE_END
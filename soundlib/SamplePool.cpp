@@ -0,0 +1,196 @@
+/*
+ * SamplePool.cpp
+ * --------------
+ * Purpose: Process-wide pool of immutable sample buffers, so that modules with identical samples can share their sample data.
+ * Notes  : (currently none)
+ * Authors: OpenMPT Devs
+ * The OpenMPT source code is released under the BSD license. Read LICENSE for more details.
+ */
+
+
+#include "stdafx.h"
+#include "SamplePool.h"
+#include "Sndfile.h"
+#include "modsmp_ctrl.h"
+#include "mpt/crc/crc.hpp"
+#include "mpt/mutex/mutex.hpp"
+
+#include <atomic>
+#include <type_traits>
+#include <unordered_map>
+
+
+OPENMPT_NAMESPACE_BEGIN
+
+
+namespace
+{
+
+struct PoolEntry
+{
+	uint64 hash;
+	size_t size;
+	size_t refCount;
+};
+
+struct PoolState
+{
+	mpt::mutex mutex;
+	std::unordered_map<const void *, PoolEntry> entries;  // Indexed by sample data pointer
+	std::unordered_multimap<uint64, void *> buffers;       // Indexed by hash
+	std::atomic<size_t> numEntries = 0;                    // Avoids locking the mutex when freeing samples while the pool is not in use
+};
+
+
+PoolState &GetPool()
+{
+	// Intentionally leaked, as samples of static CSoundFile objects may still be freed after static objects in this translation unit have been destroyed.
+	static PoolState *pool = new PoolState();
+	return *pool;
+}
+
+
+// The complete buffer starts before the actual sample data (see ModSample::AllocateSample)
+template <typename T>
+auto GetBufferStart(T *sampleData)
+{
+	return mpt::void_cast<std::conditional_t<std::is_const_v<T>, const std::byte *, std::byte *>>(sampleData) - (InterpolationLookaheadBufferSize * MaxSamplingPointSize);
+}
+
+
+// Must be called with the pool mutex held
+void RemoveEntry(PoolState &pool, std::unordered_map<const void *, PoolEntry>::iterator it)
+{
+	const auto [first, last] = pool.buffers.equal_range(it->second.hash);
+	for(auto buf = first; buf != last; buf++)
+	{
+		if(buf->second == it->first)
+		{
+			pool.buffers.erase(buf);
+			break;
+		}
+	}
+	pool.entries.erase(it);
+	pool.numEntries--;
+}
+
+}  // unnamed namespace
+
+
+void SamplePool::Share(ModSample &sample)
+{
+	if(!sample.HasSampleData())
+		return;
+
+	PoolState &pool = GetPool();
+	void *sampleData = sample.samplev();
+	const size_t size = ModSample::GetRealSampleBufferSize(sample.nLength, sample.GetBytesPerSample());
+	if(!size || Contains(sampleData))
+		return;
+
+	const std::byte *bufferStart = GetBufferStart(sampleData);
+	const uint64 hash = mpt::crc64_jones(bufferStart, bufferStart + size);
+
+	void *sharedData = nullptr;
+	{
+		mpt::lock_guard<mpt::mutex> lock(pool.mutex);
+		const auto [first, last] = pool.buffers.equal_range(hash);
+		for(auto it = first; it != last; it++)
+		{
+			PoolEntry &entry = pool.entries.at(it->second);
+			if(entry.size == size && !memcmp(GetBufferStart(it->second), bufferStart, size))
+			{
+				entry.refCount++;
+				sharedData = it->second;
+				break;
+			}
+		}
+		if(!sharedData)
+		{
+			pool.entries[sampleData] = {hash, size, 1};
+			pool.buffers.emplace(hash, sampleData);
+			pool.numEntries++;
+			return;
+		}
+	}
+	sample.pData.pSample = sharedData;
+	ModSample::FreeSample(sampleData);
+}
+
+
+bool SamplePool::MakeUnique(ModSample &sample, CSoundFile &sndFile)
+{
+	PoolState &pool = GetPool();
+	void *sampleData = sample.samplev();
+	if(!sampleData || !pool.numEntries)
+		return true;
+
+	size_t size = 0;
+	{
+		mpt::lock_guard<mpt::mutex> lock(pool.mutex);
+		auto it = pool.entries.find(sampleData);
+		if(it == pool.entries.end())
+			return true;
+		if(it->second.refCount == 1)
+		{
+			// Nobody else is using this buffer, so we can simply take it back
+			RemoveEntry(pool, it);
+			return true;
+		}
+		size = it->second.size;
+	}
+
+	// Shared buffers are never modified, so they can be copied without holding the lock
+	void *newData = ModSample::AllocateSample(sample.nLength, sample.GetBytesPerSample());
+	if(!newData)
+		return false;
+	memcpy(GetBufferStart(newData), GetBufferStart(static_cast<const void *>(sampleData)), size);
+	ctrlSmp::ReplaceSample(sample, newData, sample.nLength, sndFile);
+	return true;
+}
+
+
+bool SamplePool::Release(void *sampleData)
+{
+	PoolState &pool = GetPool();
+	if(!pool.numEntries)
+		return false;
+
+	mpt::lock_guard<mpt::mutex> lock(pool.mutex);
+	auto it = pool.entries.find(sampleData);
+	if(it == pool.entries.end())
+		return false;
+	if(--it->second.refCount > 0)
+		return true;
+
+	RemoveEntry(pool, it);
+	return false;
+}
+
+
+bool SamplePool::Contains(const void *sampleData)
+{
+	PoolState &pool = GetPool();
+	if(!sampleData || !pool.numEntries)
+		return false;
+	mpt::lock_guard<mpt::mutex> lock(pool.mutex);
+	return pool.entries.count(sampleData) != 0;
+}
+
+
+SamplePool::Statistics SamplePool::GetStatistics()
+{
+	PoolState &pool = GetPool();
+	mpt::lock_guard<mpt::mutex> lock(pool.mutex);
+	Statistics stats;
+	for(const auto &[sampleData, entry] : pool.entries)
+	{
+		stats.numBuffers++;
+		stats.numReferences += entry.refCount;
+		stats.numBytes += entry.size;
+	}
+	return stats;
+}
+
+
+OPENMPT_NAMESPACE_END
@@ -0,0 +1,52 @@
+/*
+ * SamplePool.h
+ * ------------
+ * Purpose: Process-wide pool of immutable sample buffers, so that modules with identical samples can share their sample data.
+ * Notes  : Buffers are identified by a hash of their complete contents, including the pre-computed loop lookahead area.
+ *          Shared sample data must not be modified in place. Code that does so must call MakeUnique first.
+ *          As the tracker modifies sample data in many places, only libopenmpt uses the pool.
+ * Authors: OpenMPT Devs
+ * The OpenMPT source code is released under the BSD license. Read LICENSE for more details.
+ */
+
+
+#pragma once
+
+#include "openmpt/all/BuildSettings.hpp"
+
+
+OPENMPT_NAMESPACE_BEGIN
+
+
+class CSoundFile;
+struct ModSample;
+
+
+class SamplePool
+{
+public:
+	struct Statistics
+	{
+		size_t numBuffers = 0;     // Number of distinct buffers in the pool
+		size_t numReferences = 0;  // Number of samples referencing these buffers
+		size_t numBytes = 0;       // Memory used by the buffers in the pool
+	};
+
+	// Replace the sample's data by an identical buffer from the pool if there is one, otherwise add the sample's data to the pool.
+	// Must only be called while the sample is not being played.
+	static void Share(ModSample &sample);
+
+	// Give the sample its own copy of its data if it is part of the pool, so that it can be modified.
+	// Returns false if the copy could not be allocated.
+	static bool MakeUnique(ModSample &sample, CSoundFile &sndFile);
+
+	// Drop a reference to a sample buffer. Returns true if the buffer is still in use by other samples, i.e. it must not be freed by the caller.
+	static bool Release(void *sampleData);
+
+	static bool Contains(const void *sampleData);
+
+	static Statistics GetStatistics();
+};
+
+
+OPENMPT_NAMESPACE_END
@@ -58,6 +58,37 @@ uint32 CSoundFile::CutOffToFrequency(uint32 nCutOff, int envModifier) const
 }
 
 
+// Coefficients of the 2-pole resonant filter for the given (clamped) cutoff and resonance.
+ResonantFilterCoefficients CSoundFile::CalculateFilterCoefficients(int cutoff, int resonance, int envModifier) const
+{
+	// 2 * damping factor
+	const float dmpfac = std::pow(10.0f, -resonance * ((24.0f / 128.0f) / 20.0f));
+	const float fc = CutOffToFrequency(cutoff, envModifier) * (2.0f * mpt::numbers::pi_v<float>);
+	float d, e;
+	if(m_playBehaviour[kITFilterBehaviour] && !m_SongFlags[SONG_EXFILTERRANGE])
+	{
+		const float r = m_MixerSettings.gdwMixingFreq / fc;
+
+		d = dmpfac * r + dmpfac - 1.0f;
+		e = r * r;
+	} else
+	{
+		const float r = fc / m_MixerSettings.gdwMixingFreq;
+
+		d = (1.0f - 2.0f * dmpfac) * r;
+		LimitMax(d, 2.0f);
+		d = (2.0f * dmpfac - d) / r;
+		e = 1.0f / (r * r);
+	}
+
+	ResonantFilterCoefficients coefficients;
+	coefficients.gain = 1.0f / (1.0f + d + e);
+	coefficients.feedback0 = (d + e + e) / (1 + d + e);
+	coefficients.feedback1 = -e / (1.0f + d + e);
+	return coefficients;
+}
+
+
 // Simple 2-poles resonant filter. Returns computed cutoff in range [0, 254] or -1 if filter is not applied.
 int CSoundFile::SetupChannelFilter(ModChannel &chn, bool bReset, int envModifier) const
 {
@@ -92,29 +123,17 @@ int CSoundFile::SetupChannelFilter(ModChannel &chn, bool bReset, int envModifier
 
 	chn.dwFlags.set(CHN_FILTER);
 
-	// 2 * damping factor
-	const float dmpfac = std::pow(10.0f, -resonance * ((24.0f / 128.0f) / 20.0f));
-	const float fc = CutOffToFrequency(cutoff, envModifier) * (2.0f * mpt::numbers::pi_v<float>);
-	float d, e;
-	if(m_playBehaviour[kITFilterBehaviour] && !m_SongFlags[SONG_EXFILTERRANGE])
+	const ResonantFilterCache::Config config{m_MixerSettings.gdwMixingFreq, m_SongFlags[SONG_EXFILTERRANGE], GetType() == MOD_TYPE_IMF, m_playBehaviour[kITFilterBehaviour]};
+	ResonantFilterCoefficients coefficients;
+	if(const ResonantFilterCoefficients *cached = m_filterCache.Find(config, cutoff, resonance, envModifier))
 	{
-		const float r = m_MixerSettings.gdwMixingFreq / fc;
-
-		d = dmpfac * r + dmpfac - 1.0f;
-		e = r * r;
+		coefficients = *cached;
 	} else
 	{
-		const float r = fc / m_MixerSettings.gdwMixingFreq;
-
-		d = (1.0f - 2.0f * dmpfac) * r;
-		LimitMax(d, 2.0f);
-		d = (2.0f * dmpfac - d) / r;
-		e = 1.0f / (r * r);
+		coefficients = CalculateFilterCoefficients(cutoff, resonance, envModifier);
+		m_filterCache.Store(cutoff, resonance, envModifier, coefficients);
 	}
-
-	float fg = 1.0f / (1.0f + d + e);
-	float fb0 = (d + e + e) / (1 + d + e);
-	float fb1 = -e / (1.0f + d + e);
+	const float fg = coefficients.gain, fb0 = coefficients.feedback0, fb1 = coefficients.feedback1;
 
 #if defined(MPT_INTMIXER)
 #define MPT_FILTER_CONVERT(x) mpt::saturate_round<mixsample_t>((x) * (1 << MIXING_FILTER_PRECISION))
@@ -26,6 +26,10 @@
 #include "plugins/PlugInterface.h"
 #include "OPL.h"
 #include "MIDIEvents.h"
+#include "SamplePool.h"
+#include "MixerThreads.h"
+
+#include <exception>
 
 OPENMPT_NAMESPACE_BEGIN
 
@@ -68,10 +72,12 @@ public:
 	double elapsedTime;
 	static constexpr uint32 IGNORE_CHANNEL = uint32_max;
 
-	GetLengthMemory(const CSoundFile &sf)
+	// The walk starts from the current play state. The state object of a previous walk can be reused to avoid allocating it again.
+	GetLengthMemory(const CSoundFile &sf, std::unique_ptr<CSoundFile::PlayState> buffer)
 		: sndFile(sf)
-		, state(std::make_unique<CSoundFile::PlayState>(sf.m_PlayState))
+		, state(buffer ? std::move(buffer) : std::make_unique<CSoundFile::PlayState>())
 	{
+		state->CopySongState(sf.m_PlayState, sf.GetNumChannels());
 		Reset();
 	}
 
@@ -277,11 +283,134 @@ public:
 };
 
 
-// Get mod length in various cases. Parameters:
-// [in]  adjustMode: See enmGetLengthResetMode for possible adjust modes.
-// [in]  target: Time or position target which should be reached, or no target to get length of the first sub song. Use GetLengthTarget::StartPos to also specify a position from where the seeking should begin.
-// [out] See definition of type GetLengthType for the returned values.
-std::vector<GetLengthType> CSoundFile::GetLength(enmGetLengthResetMode adjustMode, GetLengthTarget target)
+// Song state at the start of a row, as seen by GetLength()
+struct GetLengthCheckpoints::Checkpoint
+{
+	CSoundFile::PlayState state;
+	std::vector<GetLengthMemory::ChnSettings> chnSettings;
+	RowVisitor visitedRows;
+	GetLengthType retval;
+	double elapsedTime;
+	uint32 oldTickDuration;
+	bool breakToRow;
+	std::size_t memoryUsage;
+
+	Checkpoint(const GetLengthMemory &memory, const RowVisitor &visitedRows, const GetLengthType &retval, uint32 oldTickDuration, bool breakToRow)
+		: state(*memory.state)
+		, chnSettings(memory.chnSettings)
+		, visitedRows(visitedRows)
+		, retval(retval)
+		, elapsedTime(memory.elapsedTime)
+		, oldTickDuration(oldTickDuration)
+		, breakToRow(breakToRow)
+	{
+		memoryUsage = sizeof(*this) - sizeof(visitedRows) + visitedRows.GetMemoryUsage()
+			+ chnSettings.capacity() * sizeof(GetLengthMemory::ChnSettings) + state.m_midiMacroScratchSpace.capacity();
+		if(state.m_midiMacroEvaluationResults)
+			memoryUsage += (state.m_midiMacroEvaluationResults->pluginDryWetRatio.size() + state.m_midiMacroEvaluationResults->pluginParameter.size()) * 48u;
+	}
+
+	// Replace by another state of the same song walk, reusing the memory of this snapshot (the memory usage is not updated)
+	void Assign(const GetLengthMemory &memory, const RowVisitor &newVisitedRows, const GetLengthType &newRetval, uint32 newOldTickDuration, bool newBreakToRow, CHANNELINDEX numChannels)
+	{
+		state.CopySongState(*memory.state, numChannels);
+		chnSettings = memory.chnSettings;
+		visitedRows.CopyVisitedRowsFrom(newVisitedRows);
+		retval = newRetval;
+		elapsedTime = memory.elapsedTime;
+		oldTickDuration = newOldTickDuration;
+		breakToRow = newBreakToRow;
+	}
+};
+
+
+GetLengthCheckpoints::GetLengthCheckpoints() = default;
+GetLengthCheckpoints::~GetLengthCheckpoints() = default;
+
+
+void GetLengthCheckpoints::SetInterval(double interval)
+{
+	if(!(interval > 0.0))
+		interval = 0.0;
+	if(interval != m_interval)
+	{
+		m_interval = interval;
+		Clear();
+	}
+}
+
+
+void GetLengthCheckpoints::SetMemoryLimit(std::size_t limit)
+{
+	m_memoryLimit = limit;
+	while(m_memoryUsage > m_memoryLimit)
+		ThinOut();
+}
+
+
+void GetLengthCheckpoints::Clear() noexcept
+{
+	m_checkpoints.clear();
+	m_resumePoint.reset();
+	m_memoryUsage = 0;
+	m_spacing = m_interval;
+}
+
+
+// Discard all snapshots if they were recorded for a different song walk
+void GetLengthCheckpoints::SetKey(const Key &key)
+{
+	if(!(key == m_key))
+	{
+		Clear();
+		m_key = key;
+	}
+}
+
+
+// Song time at which the next snapshot should be recorded
+double GetLengthCheckpoints::GetNextCheckpointTime() const noexcept
+{
+	return (m_checkpoints.empty() ? 0.0 : m_checkpoints.back()->elapsedTime) + m_spacing;
+}
+
+
+void GetLengthCheckpoints::Add(std::unique_ptr<Checkpoint> checkpoint)
+{
+	m_memoryUsage += checkpoint->memoryUsage;
+	m_checkpoints.push_back(std::move(checkpoint));
+	while(m_memoryUsage > m_memoryLimit)
+		ThinOut();
+}
+
+
+// Discard every other snapshot and double the spacing between future snapshots.
+void GetLengthCheckpoints::ThinOut() noexcept
+{
+	if(m_checkpoints.size() <= 1)
+	{
+		// Even a single snapshot is too big, don't record any more of them.
+		m_checkpoints.clear();
+		m_memoryUsage = 0;
+		m_spacing = std::numeric_limits<double>::infinity();
+		return;
+	}
+	std::size_t numKept = 0;
+	m_memoryUsage = 0;
+	for(std::size_t i = 1; i < m_checkpoints.size(); i += 2)
+	{
+		m_memoryUsage += m_checkpoints[i]->memoryUsage;
+		m_checkpoints[numKept++] = std::move(m_checkpoints[i]);
+	}
+	m_checkpoints.resize(numKept);
+	m_spacing *= 2.0;
+}
+
+
+// Walk through the song as GetLength() does, without modifying anything but the passed song walk state.
+// memory and visitedRows must have been set up for target.sequence, which must be a valid sequence index.
+// Several walks can run concurrently as long as no snapshots are passed.
+std::vector<GetLengthType> CSoundFile::WalkSong(enmGetLengthResetMode adjustMode, GetLengthTarget target, GetLengthCheckpoints *checkpoints, GetLengthMemory &memory, RowVisitor &visitedRows) const
 {
 	std::vector<GetLengthType> results;
 	GetLengthType retval;
@@ -290,14 +419,11 @@ std::vector<GetLengthType> CSoundFile::GetLength(enmGetLengthResetMode adjustMod
 	const bool hasSearchTarget = target.mode != GetLengthTarget::NoTarget && target.mode != GetLengthTarget::GetAllSubsongs;
 	const bool adjustSamplePos = (adjustMode & eAdjustSamplePositions) == eAdjustSamplePositions;
 
-	SEQUENCEINDEX sequence = target.sequence;
-	if(sequence >= Order.GetNumSequences()) sequence = Order.GetCurrentSequenceIndex();
+	const SEQUENCEINDEX sequence = target.sequence;
 	const ModSequence &orderList = Order(sequence);
-
-	GetLengthMemory memory(*this);
 	CSoundFile::PlayState &playState = *memory.state;
-	// Temporary visited rows vector (so that GetLength() won't interfere with the player code if the module is playing at the same time)
-	RowVisitor visitedRows(*this, sequence);
+	// The tempo rounding error of the current playback position must not influence the result, so that walks continuing from a snapshot arrive at the same result as a walk from the start.
+	playState.m_dBufferDiff = 0.0;
 	ROWINDEX allowedPatternLoopComplexity = 32768;
 
 	// If sequence starts with some non-existent patterns, find a better start
@@ -309,6 +435,52 @@ std::vector<GetLengthType> CSoundFile::GetLength(enmGetLengthResetMode adjustMod
 	retval.startRow = playState.m_nNextRow = playState.m_nRow = target.startRow;
 	retval.startOrder = playState.m_nNextOrder = playState.m_nCurrentOrder = target.startOrder;
 
+	if(adjustMode & eAdjust)
+		playState.m_midiMacroEvaluationResults.emplace();
+
+	// If samples are being synced, force them to resync if tick duration changes
+	uint32 oldTickDuration = 0;
+	bool breakToRow = false;
+
+	// Snapshots can be used as long as the song walk up to the target is the same as the one they were recorded in.
+	// When seeking to a position with sample sync, channels that are re-triggered on the target row are not synced, so no snapshots are recorded in that case.
+	// The end of a seek to a time is always remembered, so that the next seek to a later time or position can continue from there.
+	const bool useCheckpoints = checkpoints != nullptr && (adjustMode & eAdjust) && playState.m_nSeqOverride == ORDERINDEX_INVALID
+		&& (target.mode == GetLengthTarget::SeekSeconds
+			|| (target.mode == GetLengthTarget::SeekPosition && orderList.IsValidPat(target.pos.order) && Patterns[orderList[target.pos.order]].IsValidRow(target.pos.row)));
+	const bool recordCheckpoints = useCheckpoints && checkpoints->m_interval > 0.0 && (target.mode == GetLengthTarget::SeekSeconds || !adjustSamplePos);
+	const bool recordResumePoint = useCheckpoints && target.mode == GetLengthTarget::SeekSeconds;
+	if(useCheckpoints)
+	{
+		checkpoints->SetKey({sequence, target.startOrder, target.startRow, adjustSamplePos, m_MixerSettings.gdwMixingFreq, m_nTempoFactor, m_nFreqFactor});
+		// Find the latest snapshot that was recorded before the target was reached
+		const auto isBeforeTarget = [&target](const GetLengthCheckpoints::Checkpoint &cp)
+		{
+			if(target.mode == GetLengthTarget::SeekSeconds)
+				return cp.elapsedTime < target.time;
+			else
+				return !cp.visitedRows.IsVisited(target.pos.order, target.pos.row);
+		};
+		const auto &checkpointList = checkpoints->m_checkpoints;
+		const auto checkpoint = std::find_if(checkpointList.rbegin(), checkpointList.rend(), [&isBeforeTarget](const auto &cp) { return isBeforeTarget(*cp); });
+		const GetLengthCheckpoints::Checkpoint *resumeFrom = (checkpoint != checkpointList.rend()) ? checkpoint->get() : nullptr;
+		const auto &resumePoint = checkpoints->m_resumePoint;
+		if(resumePoint && isBeforeTarget(*resumePoint) && (!resumeFrom || resumePoint->elapsedTime > resumeFrom->elapsedTime))
+			resumeFrom = resumePoint.get();
+		if(resumeFrom)
+		{
+			// Background channels are not part of the song walk, so they are left alone.
+			const GetLengthCheckpoints::Checkpoint &cp = *resumeFrom;
+			playState.CopySongState(cp.state, GetNumChannels());
+			memory.chnSettings = cp.chnSettings;
+			memory.elapsedTime = cp.elapsedTime;
+			visitedRows.CopyVisitedRowsFrom(cp.visitedRows);
+			retval = cp.retval;
+			oldTickDuration = cp.oldTickDuration;
+			breakToRow = cp.breakToRow;
+		}
+	}
+
 	// Fast LUTs for commands that are too weird / complicated / whatever to emulate in sample position adjust mode.
 	std::bitset<MAX_EFFECTS> forbiddenCommands;
 
@@ -335,15 +507,20 @@ std::vector<GetLengthType> CSoundFile::GetLength(enmGetLengthResetMode adjustMod
 		}
 	}
 
-	if(adjustMode & eAdjust)
-		playState.m_midiMacroEvaluationResults.emplace();
-
-	// If samples are being synced, force them to resync if tick duration changes
-	uint32 oldTickDuration = 0;
-	bool breakToRow = false;
-
 	for (;;)
 	{
+		// Only snapshots from the first part of the song walk are recorded; once the walk restarts at another unplayed row, elapsed time starts from zero again.
+		if(recordCheckpoints && results.empty() && memory.elapsedTime >= checkpoints->GetNextCheckpointTime())
+			checkpoints->Add(std::make_unique<GetLengthCheckpoints::Checkpoint>(memory, visitedRows, retval, oldTickDuration, breakToRow));
+		// This is where the time target is reached (see below).
+		if(recordResumePoint && results.empty() && memory.elapsedTime >= target.time)
+		{
+			if(checkpoints->m_resumePoint)
+				checkpoints->m_resumePoint->Assign(memory, visitedRows, retval, oldTickDuration, breakToRow, GetNumChannels());
+			else
+				checkpoints->m_resumePoint = std::make_unique<GetLengthCheckpoints::Checkpoint>(memory, visitedRows, retval, oldTickDuration, breakToRow);
+		}
+
 		const bool ignoreRow = NextRow(playState, breakToRow).first;
 
 		// Time target reached.
@@ -874,10 +1051,11 @@ std::vector<GetLengthType> CSoundFile::GetLength(enmGetLengthResetMode adjustMod
 
 			case CMD_MIDI:
 			case CMD_SMOOTHMIDI:
+				// Plugin changes are collected in the play state instead of being sent anywhere (see EvaluateMIDIData)
 				if(param < 0x80)
-					ProcessMIDIMacro(playState, nChn, false, m_MidiCfg.SFx[chn.nActiveMacro], chn.rowCommand.param, 0);
+					EvaluateMIDIMacro(playState, nChn, m_MidiCfg.SFx[chn.nActiveMacro], chn.rowCommand.param);
 				else
-					ProcessMIDIMacro(playState, nChn, false, m_MidiCfg.Zxx[param & 0x7F], chn.rowCommand.param, 0);
+					EvaluateMIDIMacro(playState, nChn, m_MidiCfg.Zxx[param & 0x7F], chn.rowCommand.param);
 				break;
 
 			default:
@@ -1227,6 +1405,36 @@ std::vector<GetLengthType> CSoundFile::GetLength(enmGetLengthResetMode adjustMod
 	}
 	retval.duration = memory.elapsedTime;
 	results.push_back(retval);
+	return results;
+}
+
+
+// Get mod length in various cases. Parameters:
+// [in]  adjustMode: See enmGetLengthResetMode for possible adjust modes.
+// [in]  target: Time or position target which should be reached, or no target to get length of the first sub song. Use GetLengthTarget::StartPos to also specify a position from where the seeking should begin.
+// [in]  checkpoints: Optional song state snapshots from previous seek operations (only used in adjust modes when seeking to a time or position).
+// [out] See definition of type GetLengthType for the returned values.
+std::vector<GetLengthType> CSoundFile::GetLength(enmGetLengthResetMode adjustMode, GetLengthTarget target, GetLengthCheckpoints *checkpoints)
+{
+	const bool adjustSamplePos = (adjustMode & eAdjustSamplePositions) == eAdjustSamplePositions;
+
+	if(target.sequence >= Order.GetNumSequences())
+		target.sequence = Order.GetCurrentSequenceIndex();
+	const SEQUENCEINDEX sequence = target.sequence;
+
+	// The song is walked on copies of the play state and visited rows (so that GetLength() won't interfere with the player code if the module is playing at the same time).
+	// Their memory is kept for the next call.
+	GetLengthMemory memory(*this, std::move(m_songWalkState));
+	std::unique_ptr<RowVisitor> visitedRowsBuffer = std::move(m_songWalkRows);
+	if(visitedRowsBuffer)
+		visitedRowsBuffer->Reset(sequence);
+	else
+		visitedRowsBuffer = std::make_unique<RowVisitor>(*this, sequence);
+	RowVisitor &visitedRows = *visitedRowsBuffer;
+
+	std::vector<GetLengthType> results = WalkSong(adjustMode, target, checkpoints, memory, visitedRows);
+	const GetLengthType &retval = results.back();
+	CSoundFile::PlayState &playState = *memory.state;
 
 	// Store final variables
 	if(adjustMode & eAdjust)
@@ -1236,7 +1444,7 @@ std::vector<GetLengthType> CSoundFile::GetLength(enmGetLengthResetMode adjustMod
 			const auto midiMacroEvaluationResults = std::move(playState.m_midiMacroEvaluationResults);
 			playState.m_midiMacroEvaluationResults.reset();
 			// Target found, or there is no target (i.e. play whole song)...
-			m_PlayState = std::move(playState);
+			m_PlayState.CopySongState(playState, GetNumChannels());
 			m_PlayState.ResetGlobalVolumeRamping();
 			m_PlayState.m_nNextRow = m_PlayState.m_nRow;
 			m_PlayState.m_nFrameDelay = m_PlayState.m_nPatternDelay = 0;
@@ -1313,6 +1521,57 @@ std::vector<GetLengthType> CSoundFile::GetLength(enmGetLengthResetMode adjustMod
 	if(adjustMode & (eAdjust | eAdjustOnlyVisitedRows))
 		m_visitedRows.MoveVisitedRowsFrom(visitedRows);
 
+	m_songWalkState = std::move(memory.state);
+	m_songWalkRows = std::move(visitedRowsBuffer);
+	return results;
+}
+
+
+std::vector<std::vector<GetLengthType>> CSoundFile::GetSubsongsOfAllSequences(uint32 numThreads) const
+{
+	const SEQUENCEINDEX numSequences = Order.GetNumSequences();
+	std::vector<std::vector<GetLengthType>> results(numSequences);
+	std::vector<std::exception_ptr> exceptions(numSequences);
+
+	// The walks of different sequences don't depend on each other, so each one only needs its own song walk state.
+	const auto walkSequence = [&](uint32 seq)
+	{
+		try
+		{
+			const auto sequence = static_cast<SEQUENCEINDEX>(seq);
+			GetLengthMemory memory(*this, nullptr);
+			RowVisitor visitedRows(*this, sequence);
+			results[seq] = WalkSong(eNoAdjust, GetLengthTarget(true).StartPos(sequence, 0, 0), nullptr, memory, visitedRows);
+		} catch(...)
+		{
+			exceptions[seq] = std::current_exception();
+		}
+	};
+
+#ifdef MPT_ENABLE_MIXER_THREADS
+	if(numThreads == 0)
+		numThreads = std::max(std::thread::hardware_concurrency(), 1u);
+	LimitMax(numThreads, std::min(MixerThreads::MaxThreads, uint32(numSequences)));
+	if(numThreads > 1)
+	{
+		MixerThreadPool pool(numThreads);
+		pool.Run(numSequences, walkSequence);
+	} else
+#else
+	MPT_UNREFERENCED_PARAMETER(numThreads);
+#endif // MPT_ENABLE_MIXER_THREADS
+	{
+		for(SEQUENCEINDEX seq = 0; seq < numSequences; seq++)
+		{
+			walkSequence(seq);
+		}
+	}
+
+	for(const auto &exception : exceptions)
+	{
+		if(exception)
+			std::rethrow_exception(exception);
+	}
 	return results;
 }
 
@@ -1428,6 +1687,9 @@ void CSoundFile::InstrumentChange(ModChannel &chn, uint32 instr, bool bPorta, bo
 		chn.pModInstrument = pIns;
 	}
 
+	if(pSmp != nullptr)
+		PrepareSampleForPlayback(*pSmp);
+
 	// Update Volume
 	if (bUpdVol && (!(GetType() & (MOD_TYPE_MOD | MOD_TYPE_S3M)) || ((pSmp != nullptr && pSmp->HasSampleData()) || chn.HasMIDIOutput())))
 	{
@@ -1881,6 +2143,7 @@ void CSoundFile::NoteChange(ModChannel &chn, int note, bool bPorta, bool bResetE
 	}
 
 	if(!pSmp) return;
+	PrepareSampleForPlayback(*pSmp);
 	if(period)
 	{
 		if((!bPorta) || (!chn.nPeriod)) chn.nPeriod = period;
@@ -2421,6 +2684,13 @@ CHANNELINDEX CSoundFile::CheckNNA(CHANNELINDEX nChn, uint32 instr, int note, boo
 
 
 bool CSoundFile::ProcessEffects()
+{
+	return CallWithFormatSpecialization([this](auto format) { return ProcessEffectsImpl<decltype(format)>(); });
+}
+
+
+template <typename TFormat>
+bool CSoundFile::ProcessEffectsImpl()
 {
 	m_PlayState.m_breakRow = ROWINDEX_INVALID;    // Is changed if a break to row command is encountered
 	m_PlayState.m_patLoopRow = ROWINDEX_INVALID;  // Is changed if a pattern loop jump-back is executed
@@ -2516,10 +2786,10 @@ bool CSoundFile::ProcessEffects()
 			//:xy --> note delay until tick x, note cut at tick x+y
 			nStartTick = (param & 0xF0) >> 4;
 			const uint32 cutAtTick = nStartTick + (param & 0x0F);
-			NoteCut(nChn, cutAtTick, m_playBehaviour[kITSCxStopsSample]);
+			NoteCut(nChn, cutAtTick, PlayBehaviourEnabled<TFormat, kITSCxStopsSample>());
 		} else if ((cmd == CMD_MODCMDEX) || (cmd == CMD_S3MCMDEX))
 		{
-			if ((!param) && (GetType() & (MOD_TYPE_S3M|MOD_TYPE_IT|MOD_TYPE_MPT)))
+			if ((!param) && (GetType<TFormat>() & (MOD_TYPE_S3M|MOD_TYPE_IT|MOD_TYPE_MPT)))
 				param = chn.nOldCmdEx;
 			else
 				chn.nOldCmdEx = static_cast<ModCommand::PARAM>(param);
@@ -2531,12 +2801,12 @@ bool CSoundFile::ProcessEffects()
 				if(nStartTick == 0)
 				{
 					//IT compatibility 22. SD0 == SD1
-					if(GetType() & (MOD_TYPE_IT | MOD_TYPE_MPT))
+					if(GetType<TFormat>() & (MOD_TYPE_IT | MOD_TYPE_MPT))
 						nStartTick = 1;
 					//ST3 ignores notes with SD0 completely
-					else if(GetType() == MOD_TYPE_S3M)
+					else if(GetType<TFormat>() == MOD_TYPE_S3M)
 						continue;
-				} else if(nStartTick >= (m_PlayState.m_nMusicSpeed + m_PlayState.m_nFrameDelay) && m_playBehaviour[kITOutOfRangeDelay])
+				} else if(nStartTick >= (m_PlayState.m_nMusicSpeed + m_PlayState.m_nFrameDelay) && PlayBehaviourEnabled<TFormat, kITOutOfRangeDelay>())
 				{
 					// IT compatibility 08. Handling of out-of-range delay command.
 					// Additional test case: tickdelay.it
@@ -2555,9 +2825,9 @@ bool CSoundFile::ProcessEffects()
 					// In Scream Tracker 3 / Impulse Tracker, only the first delay command on this row is considered.
 					// Test cases: PatternDelays.it, PatternDelays.s3m, PatternDelays.xm
 					// XXX In Scream Tracker 3, the "left" channels are evaluated before the "right" channels, which is not emulated here!
-					if(!(GetType() & (MOD_TYPE_S3M | MOD_TYPE_IT | MOD_TYPE_MPT)) || !m_PlayState.m_nPatternDelay)
+					if(!(GetType<TFormat>() & (MOD_TYPE_S3M | MOD_TYPE_IT | MOD_TYPE_MPT)) || !m_PlayState.m_nPatternDelay)
 					{
-						if(!(GetType() & (MOD_TYPE_S3M)) || (param & 0x0F) != 0)
+						if(!(GetType<TFormat>() & (MOD_TYPE_S3M)) || (param & 0x0F) != 0)
 						{
 							// While Impulse Tracker *does* count S60 as a valid row delay (and thus ignores any other row delay commands on the right),
 							// Scream Tracker 3 simply ignores such commands.
@@ -2568,7 +2838,7 @@ bool CSoundFile::ProcessEffects()
 			}
 		}
 
-		if(GetType() == MOD_TYPE_MTM && cmd == CMD_MODCMDEX && (param & 0xF0) == 0xD0)
+		if(GetType<TFormat>() == MOD_TYPE_MTM && cmd == CMD_MODCMDEX && (param & 0xF0) == 0xD0)
 		{
 			// Apparently, retrigger and note delay have the same behaviour in MultiTracker:
 			// They both restart the note at tick x, and if there is a note on the same row,
@@ -2577,7 +2847,7 @@ bool CSoundFile::ProcessEffects()
 			param = 0x90 | (param & 0x0F);
 		}
 
-		if(nStartTick != 0 && chn.rowCommand.note == NOTE_KEYOFF && chn.rowCommand.volcmd == VOLCMD_PANNING && m_playBehaviour[kFT2PanWithDelayedNoteOff])
+		if(nStartTick != 0 && chn.rowCommand.note == NOTE_KEYOFF && chn.rowCommand.volcmd == VOLCMD_PANNING && PlayBehaviourEnabled<TFormat, kFT2PanWithDelayedNoteOff>())
 		{
 			// FT2 compatibility: If there's a delayed note off, panning commands are ignored. WTF!
 			// Test case: PanOff.xm
@@ -2585,13 +2855,13 @@ bool CSoundFile::ProcessEffects()
 		}
 
 		bool triggerNote = (m_PlayState.m_nTickCount == nStartTick);	// Can be delayed by a note delay effect
-		if(m_playBehaviour[kFT2OutOfRangeDelay] && nStartTick >= m_PlayState.m_nMusicSpeed)
+		if(PlayBehaviourEnabled<TFormat, kFT2OutOfRangeDelay>() && nStartTick >= m_PlayState.m_nMusicSpeed)
 		{
 			// FT2 compatibility: Note delays greater than the song speed should be ignored.
 			// However, EEx pattern delay is *not* considered at all.
 			// Test case: DelayCombination.xm, PortaDelay.xm
 			triggerNote = false;
-		} else if(m_playBehaviour[kRowDelayWithNoteDelay] && nStartTick > 0 && tickCount == nStartTick)
+		} else if(PlayBehaviourEnabled<TFormat, kRowDelayWithNoteDelay>() && nStartTick > 0 && tickCount == nStartTick)
 		{
 			// IT compatibility: Delayed notes (using SDx) that are on the same row as a Row Delay effect are retriggered.
 			// ProTracker / Scream Tracker 3 / FastTracker 2 do the same.
@@ -2601,7 +2871,7 @@ bool CSoundFile::ProcessEffects()
 
 		// IT compatibility: Tick-0 vs non-tick-0 effect distinction is always based on tick delay.
 		// Test case: SlideDelay.it
-		if(m_playBehaviour[kITFirstTickHandling])
+		if(PlayBehaviourEnabled<TFormat, kITFirstTickHandling>())
 		{
 			chn.isFirstTick = tickCount == nStartTick;
 		}
@@ -2609,7 +2879,7 @@ bool CSoundFile::ProcessEffects()
 
 		// FT2 compatibility: Note + portamento + note delay = no portamento
 		// Test case: PortaDelay.xm
-		if(m_playBehaviour[kFT2PortaDelay] && nStartTick != 0)
+		if(PlayBehaviourEnabled<TFormat, kFT2PortaDelay>() && nStartTick != 0)
 		{
 			bPorta = false;
 		}
@@ -2638,7 +2908,7 @@ bool CSoundFile::ProcessEffects()
 			ModCommand::NOTE note = chn.rowCommand.note;
 			if(instr) chn.nNewIns = static_cast<ModCommand::INSTR>(instr);
 
-			if(ModCommand::IsNote(note) && m_playBehaviour[kFT2Transpose])
+			if(ModCommand::IsNote(note) && PlayBehaviourEnabled<TFormat, kFT2Transpose>())
 			{
 				// Notes that exceed FT2's limit are completely ignored.
 				// Test case: NoteLimit.xm
@@ -2657,7 +2927,7 @@ bool CSoundFile::ProcessEffects()
 				{
 					note = NOTE_NONE;
 				}
-			} else if((GetType() & (MOD_TYPE_IT | MOD_TYPE_MPT | MOD_TYPE_J2B)) && GetNumInstruments() != 0 && ModCommand::IsNoteOrEmpty(static_cast<ModCommand::NOTE>(note)))
+			} else if((GetType<TFormat>() & (MOD_TYPE_IT | MOD_TYPE_MPT | MOD_TYPE_J2B)) && GetNumInstruments() != 0 && ModCommand::IsNoteOrEmpty(static_cast<ModCommand::NOTE>(note)))
 			{
 				// IT compatibility: Invalid instrument numbers do nothing, but they are remembered for upcoming notes and do not trigger a note in that case.
 				// Test case: InstrumentNumberChange.it
@@ -2670,7 +2940,7 @@ bool CSoundFile::ProcessEffects()
 			}
 
 			// XM: FT2 ignores a note next to a K00 effect, and a fade-out seems to be done when no volume envelope is present (not exactly the Kxx behaviour)
-			if(cmd == CMD_KEYOFF && param == 0 && m_playBehaviour[kFT2KeyOff])
+			if(cmd == CMD_KEYOFF && param == 0 && PlayBehaviourEnabled<TFormat, kFT2KeyOff>())
 			{
 				note = NOTE_NONE;
 				instr = 0;
@@ -2680,20 +2950,20 @@ bool CSoundFile::ProcessEffects()
 
 			// Apparently, any note number in a pattern causes instruments to recall their original volume settings - no matter if there's a Note Off next to it or whatever.
 			// Test cases: keyoff+instr.xm, delay.xm
-			bool reloadSampleSettings = (m_playBehaviour[kFT2ReloadSampleSettings] && instr != 0);
+			bool reloadSampleSettings = (PlayBehaviourEnabled<TFormat, kFT2ReloadSampleSettings>() && instr != 0);
 			// ProTracker Compatibility: If a sample was stopped before, lone instrument numbers can retrigger it
 			// Test case: PTSwapEmpty.mod, PTInstrVolume.mod, SampleSwap.s3m
-			bool keepInstr = (GetType() & (MOD_TYPE_IT | MOD_TYPE_MPT))
-				|| m_playBehaviour[kST3SampleSwap]
-				|| (m_playBehaviour[kMODSampleSwap] && !chn.IsSamplePlaying() && (chn.pModSample == nullptr || !chn.pModSample->HasSampleData()));
+			bool keepInstr = (GetType<TFormat>() & (MOD_TYPE_IT | MOD_TYPE_MPT))
+				|| PlayBehaviourEnabled<TFormat, kST3SampleSwap>()
+				|| (PlayBehaviourEnabled<TFormat, kMODSampleSwap>() && !chn.IsSamplePlaying() && (chn.pModSample == nullptr || !chn.pModSample->HasSampleData()));
 
 			// Now it's time for some FT2 crap...
-			if (GetType() & (MOD_TYPE_XM | MOD_TYPE_MT2))
+			if (GetType<TFormat>() & (MOD_TYPE_XM | MOD_TYPE_MT2))
 			{
 				// XM: Key-Off + Sample == Note Cut (BUT: Only if no instr number or volume effect is present!)
 				// Test case: NoteOffVolume.xm
 				if(note == NOTE_KEYOFF
-					&& ((!instr && volcmd != VOLCMD_VOLUME && cmd != CMD_VOLUME) || !m_playBehaviour[kFT2KeyOff])
+					&& ((!instr && volcmd != VOLCMD_VOLUME && cmd != CMD_VOLUME) || !PlayBehaviourEnabled<TFormat, kFT2KeyOff>())
 					&& (chn.pModInstrument == nullptr || !chn.pModInstrument->VolEnv.dwFlags[ENV_ENABLED]))
 				{
 					chn.dwFlags.set(CHN_FASTVOLRAMP);
@@ -2703,9 +2973,9 @@ bool CSoundFile::ProcessEffects()
 					retrigEnv = false;
 					// FT2 Compatbility: Start fading the note for notes with no delay. Only relevant when a volume command is encountered after the note-off.
 					// Test case: NoteOffFadeNoEnv.xm
-					if(m_SongFlags[SONG_FIRSTTICK] && m_playBehaviour[kFT2NoteOffFlags])
+					if(m_SongFlags[SONG_FIRSTTICK] && PlayBehaviourEnabled<TFormat, kFT2NoteOffFlags>())
 						chn.dwFlags.set(CHN_NOTEFADE);
-				} else if(m_playBehaviour[kFT2RetrigWithNoteDelay] && !m_SongFlags[SONG_FIRSTTICK])
+				} else if(PlayBehaviourEnabled<TFormat, kFT2RetrigWithNoteDelay>() && !m_SongFlags[SONG_FIRSTTICK])
 				{
 					// FT2 Compatibility: Some special hacks for rogue note delays... (EDx with x > 0)
 					// Apparently anything that is next to a note delay behaves totally unpredictable in FT2. Swedish tracker logic. :)
@@ -2729,7 +2999,7 @@ bool CSoundFile::ProcessEffects()
 						note = NOTE_NONE;
 						keepInstr = false;
 						reloadSampleSettings = true;
-					} else if(instr || !m_playBehaviour[kFT2NoteDelayWithoutInstr])
+					} else if(instr || !PlayBehaviourEnabled<TFormat, kFT2NoteDelayWithoutInstr>())
 					{
 						// Normal note (only if there is an instrument, test case: DelayVolume.xm)
 						keepInstr = true;
@@ -2738,7 +3008,7 @@ bool CSoundFile::ProcessEffects()
 				}
 			}
 
-			if((retrigEnv && !m_playBehaviour[kFT2ReloadSampleSettings]) || reloadSampleSettings)
+			if((retrigEnv && !PlayBehaviourEnabled<TFormat, kFT2ReloadSampleSettings>()) || reloadSampleSettings)
 			{
 				const ModSample *oldSample = nullptr;
 				// Reset default volume when retriggering envelopes
@@ -2754,7 +3024,7 @@ bool CSoundFile::ProcessEffects()
 
 				if(oldSample != nullptr)
 				{
-					if(!oldSample->uFlags[SMP_NODEFAULTVOLUME] && (GetType() != MOD_TYPE_S3M || oldSample->HasSampleData()))
+					if(!oldSample->uFlags[SMP_NODEFAULTVOLUME] && (GetType<TFormat>() != MOD_TYPE_S3M || oldSample->HasSampleData()))
 						chn.nVolume = oldSample->nVolume;
 					if(reloadSampleSettings)
 					{
@@ -2766,7 +3036,7 @@ bool CSoundFile::ProcessEffects()
 
 			// FT2 compatibility: Instrument number disables tremor effect
 			// Test case: TremorInstr.xm, TremoRecover.xm
-			if(m_playBehaviour[kFT2Tremor] && instr != 0)
+			if(PlayBehaviourEnabled<TFormat, kFT2Tremor>() && instr != 0)
 			{
 				chn.nTremorCount = 0x20;
 			}
@@ -2779,7 +3049,7 @@ bool CSoundFile::ProcessEffects()
 			//  off     on     reset on instrument with portamento
 			//  on      on     always reset
 			// Test case: ins-xx.it, ins-ox.it, ins-oc.it, ins-xc.it, ResetEnvNoteOffOldFx.it, ResetEnvNoteOffOldFx2.it, noteoff3.it
-			if(GetNumInstruments() && m_playBehaviour[kITInstrWithNoteOffOldEffects]
+			if(GetNumInstruments() && PlayBehaviourEnabled<TFormat, kITInstrWithNoteOffOldEffects>()
 				&& instr && !ModCommand::IsNote(note))
 			{
 				if((bPorta && m_SongFlags[SONG_ITCOMPATGXX])
@@ -2794,11 +3064,11 @@ bool CSoundFile::ProcessEffects()
 			if(retrigEnv) //Case: instrument with no note data.
 			{
 				//IT compatibility: Instrument with no note.
-				if(m_playBehaviour[kITInstrWithoutNote] || GetType() == MOD_TYPE_PLM)
+				if(PlayBehaviourEnabled<TFormat, kITInstrWithoutNote>() || GetType<TFormat>() == MOD_TYPE_PLM)
 				{
 					// IT compatibility: Completely retrigger note after sample end to also reset portamento.
 					// Test case: PortaResetAfterRetrigger.it
-					bool triggerAfterSmpEnd = m_playBehaviour[kITMultiSampleInstrumentNumber] && !chn.IsSamplePlaying();
+					bool triggerAfterSmpEnd = PlayBehaviourEnabled<TFormat, kITMultiSampleInstrumentNumber>() && !chn.IsSamplePlaying();
 					if(GetNumInstruments())
 					{
 						// Instrument mode
@@ -2812,7 +3082,7 @@ bool CSoundFile::ProcessEffects()
 					}
 				}
 
-				if(GetNumInstruments() && (GetType() & (MOD_TYPE_XM | MOD_TYPE_MT2 | MOD_TYPE_MED)))
+				if(GetNumInstruments() && (GetType<TFormat>() & (MOD_TYPE_XM | MOD_TYPE_MT2 | MOD_TYPE_MED)))
 				{
 					chn.ResetEnvelopes();
 					chn.dwFlags.set(CHN_FASTVOLRAMP);
@@ -2822,7 +3092,7 @@ bool CSoundFile::ProcessEffects()
 					chn.nFadeOutVol = 65536;
 					// FT2 Compatbility: Reset key-off status with instrument number
 					// Test case: NoteOffInstrChange.xm
-					if(m_playBehaviour[kFT2NoteOffFlags])
+					if(PlayBehaviourEnabled<TFormat, kFT2NoteOffFlags>())
 						chn.dwFlags.reset(CHN_KEYOFF);
 				}
 				if (!keepInstr) instr = 0;
@@ -2833,7 +3103,7 @@ bool CSoundFile::ProcessEffects()
 			{
 				// IT compatibility: Default volume of sample is recalled if instrument number is next to a note-off.
 				// Test case: NoteOffInstr.it, noteoff2.it
-				if(m_playBehaviour[kITInstrWithNoteOff] && instr)
+				if(PlayBehaviourEnabled<TFormat, kITInstrWithNoteOff>() && instr)
 				{
 					const SAMPLEINDEX smp = GetSampleIndex(chn.nLastNote, instr);
 					if(smp > 0 && !Samples[smp].uFlags[SMP_NODEFAULTVOLUME])
@@ -2841,7 +3111,7 @@ bool CSoundFile::ProcessEffects()
 				}
 				// IT compatibility: Note-off with instrument number + Old Effects retriggers envelopes.
 				// Test case: ResetEnvNoteOffOldFx.it
-				if(!m_playBehaviour[kITInstrWithNoteOffOldEffects] || !m_SongFlags[SONG_ITOLDEFFECTS])
+				if(!PlayBehaviourEnabled<TFormat, kITInstrWithNoteOffOldEffects>() || !m_SongFlags[SONG_ITOLDEFFECTS])
 					instr = 0;
 			}
 
@@ -2889,16 +3159,16 @@ bool CSoundFile::ProcessEffects()
 
 				// IT compatibility: Keep new instrument number for next instrument-less note even if sample playback is stopped
 				// Test case: StoppedInstrSwap.it
-				if(GetType() == MOD_TYPE_MOD)
+				if(GetType<TFormat>() == MOD_TYPE_MOD)
 				{
 					// Test case: PortaSwapPT.mod
-					if(!bPorta || !m_playBehaviour[kMODSampleSwap]) chn.nNewIns = 0;
+					if(!bPorta || !PlayBehaviourEnabled<TFormat, kMODSampleSwap>()) chn.nNewIns = 0;
 				} else
 				{
-					if(!m_playBehaviour[kITInstrWithNoteOff] || ModCommand::IsNote(note)) chn.nNewIns = 0;
+					if(!PlayBehaviourEnabled<TFormat, kITInstrWithNoteOff>() || ModCommand::IsNote(note)) chn.nNewIns = 0;
 				}
 
-				if(m_playBehaviour[kITPortamentoSwapResetsPos])
+				if(PlayBehaviourEnabled<TFormat, kITPortamentoSwapResetsPos>())
 				{
 					// Test cases: PortaInsNum.it, PortaSample.it
 					if(ModCommand::IsNote(note) && oldSample != chn.pModSample)
@@ -2906,18 +3176,18 @@ bool CSoundFile::ProcessEffects()
 						//const bool newInstrument = oldInstrument != chn.pModInstrument && chn.pModInstrument->Keyboard[chn.nNewNote - NOTE_MIN] != 0;
 						chn.position.Set(0);
 					}
-				} else if((GetType() & (MOD_TYPE_IT | MOD_TYPE_MPT)) && oldSample != chn.pModSample && ModCommand::IsNote(note))
+				} else if((GetType<TFormat>() & (MOD_TYPE_IT | MOD_TYPE_MPT)) && oldSample != chn.pModSample && ModCommand::IsNote(note))
 				{
 					// Special IT case: portamento+note causes sample change -> ignore portamento
 					bPorta = false;
-				} else if(m_playBehaviour[kST3SampleSwap] && oldSample != chn.pModSample && (bPorta || !ModCommand::IsNote(note)) && chn.position.GetUInt() > chn.nLength)
+				} else if(PlayBehaviourEnabled<TFormat, kST3SampleSwap>() && oldSample != chn.pModSample && (bPorta || !ModCommand::IsNote(note)) && chn.position.GetUInt() > chn.nLength)
 				{
 					// ST3 with SoundBlaster does sample swapping and continues playing the new sample where the old sample was stopped.
 					// If the new sample is shorter than that, it is stopped, even if it could be looped.
 					// This also applies to portamento between different samples.
 					// Test case: SampleSwap.s3m
 					chn.nLength = 0;
-				} else if(m_playBehaviour[kMODSampleSwap] && !chn.IsSamplePlaying())
+				} else if(PlayBehaviourEnabled<TFormat, kMODSampleSwap>() && !chn.IsSamplePlaying())
 				{
 					// If channel was paused and is resurrected by a lone instrument number, reset the sample position.
 					// Test case: PTSwapEmpty.mod
@@ -2930,7 +3200,7 @@ bool CSoundFile::ProcessEffects()
 				const bool instrChange = (!instr) && (chn.nNewIns) && ModCommand::IsNote(note);
 				if(instrChange)
 				{
-					InstrumentChange(chn, chn.nNewIns, bPorta, chn.pModSample == nullptr && chn.pModInstrument == nullptr, !(GetType() & (MOD_TYPE_XM|MOD_TYPE_MT2)));
+					InstrumentChange(chn, chn.nNewIns, bPorta, chn.pModSample == nullptr && chn.pModInstrument == nullptr, !(GetType<TFormat>() & (MOD_TYPE_XM|MOD_TYPE_MT2)));
 					chn.nNewIns = 0;
 				}
 				if(chn.pModSample != nullptr && chn.pModSample->uFlags[CHN_ADLIB] && m_opl && (instrChange || !m_opl->IsActive(nChn)))
@@ -2938,9 +3208,9 @@ bool CSoundFile::ProcessEffects()
 					m_opl->Patch(nChn, chn.pModSample->adlib);
 				}
 
-				NoteChange(chn, note, bPorta, !(GetType() & (MOD_TYPE_XM | MOD_TYPE_MT2)), false, nChn);
+				NoteChange(chn, note, bPorta, !(GetType<TFormat>() & (MOD_TYPE_XM | MOD_TYPE_MT2)), false, nChn);
 				HandleDigiSamplePlayDirection(m_PlayState, nChn);
-				if ((bPorta) && (GetType() & (MOD_TYPE_XM|MOD_TYPE_MT2)) && (instr))
+				if ((bPorta) && (GetType<TFormat>() & (MOD_TYPE_XM|MOD_TYPE_MT2)) && (instr))
 				{
 					chn.dwFlags.set(CHN_FASTVOLRAMP);
 					chn.ResetEnvelopes();
@@ -2948,9 +3218,9 @@ bool CSoundFile::ProcessEffects()
 					chn.nAutoVibPos = 0;
 				}
 				if(chn.dwFlags[CHN_ADLIB] && m_opl
-					&& ((note == NOTE_NOTECUT || note == NOTE_KEYOFF) || (note == NOTE_FADE && !m_playBehaviour[kOPLFlexibleNoteOff])))
+					&& ((note == NOTE_NOTECUT || note == NOTE_KEYOFF) || (note == NOTE_FADE && !PlayBehaviourEnabled<TFormat, kOPLFlexibleNoteOff>())))
 				{
-					if(m_playBehaviour[kOPLNoteStopWith0Hz])
+					if(PlayBehaviourEnabled<TFormat, kOPLNoteStopWith0Hz>())
 						m_opl->Frequency(nChn, 0, true, false);
 					m_opl->NoteOff(nChn);
 				}
@@ -2972,7 +3242,7 @@ bool CSoundFile::ProcessEffects()
 #endif // NO_PLUGINS
 		}
 
-		if(m_playBehaviour[kST3NoMutedChannels] && ChnSettings[nChn].dwFlags[CHN_MUTE])	// not even effects are processed on muted S3M channels
+		if(PlayBehaviourEnabled<TFormat, kST3NoMutedChannels>() && ChnSettings[nChn].dwFlags[CHN_MUTE])	// not even effects are processed on muted S3M channels
 			continue;
 
 		// Volume Column Effect (except volume & panning)
@@ -2990,7 +3260,7 @@ bool CSoundFile::ProcessEffects()
 		// FT2 compatibility: If there's a note delay, volume column effects are NOT executed
 		// on the first tick and, if there's an instrument number, on the delayed tick.
 		// Test case: VolColDelay.xm, PortaDelay.xm
-		if(m_playBehaviour[kFT2VolColDelay] && nStartTick != 0)
+		if(PlayBehaviourEnabled<TFormat, kFT2VolColDelay>() && nStartTick != 0)
 		{
 			doVolumeColumn = m_PlayState.m_nTickCount != 0 && (m_PlayState.m_nTickCount != nStartTick || (chn.rowCommand.instr == 0 && volcmd != VOLCMD_TONEPORTAMENTO));
 		}
@@ -3006,7 +3276,7 @@ bool CSoundFile::ProcessEffects()
 			} else
 			{
 				// FT2 Compatibility: FT2 ignores some volume commands with parameter = 0.
-				if(m_playBehaviour[kFT2VolColMemory] && vol == 0)
+				if(PlayBehaviourEnabled<TFormat, kFT2VolColMemory>() && vol == 0)
 				{
 					switch(volcmd)
 					{
@@ -3027,7 +3297,7 @@ bool CSoundFile::ProcessEffects()
 						volcmd = VOLCMD_NONE;
 					}
 
-				} else if(!m_playBehaviour[kITVolColMemory])
+				} else if(!PlayBehaviourEnabled<TFormat, kITVolColMemory>())
 				{
 					// IT Compatibility: Effects in the volume column don't have an unified memory.
 					// Test case: VolColMemory.it
@@ -3040,7 +3310,7 @@ bool CSoundFile::ProcessEffects()
 				case VOLCMD_VOLSLIDEDOWN:
 					// IT Compatibility: Volume column volume slides have their own memory
 					// Test case: VolColMemory.it
-					if(vol == 0 && m_playBehaviour[kITVolColMemory])
+					if(vol == 0 && PlayBehaviourEnabled<TFormat, kITVolColMemory>())
 					{
 						vol = chn.nOldVolParam;
 						if(vol == 0)
@@ -3055,28 +3325,28 @@ bool CSoundFile::ProcessEffects()
 				case VOLCMD_FINEVOLUP:
 					// IT Compatibility: Fine volume slides in the volume column are only executed on the first tick, not on multiples of the first tick in case of pattern delay
 					// Test case: FineVolColSlide.it
-					if(m_PlayState.m_nTickCount == nStartTick || !m_playBehaviour[kITVolColMemory])
+					if(m_PlayState.m_nTickCount == nStartTick || !PlayBehaviourEnabled<TFormat, kITVolColMemory>())
 					{
 						// IT Compatibility: Volume column volume slides have their own memory
 						// Test case: VolColMemory.it
-						FineVolumeUp(chn, static_cast<ModCommand::PARAM>(vol), m_playBehaviour[kITVolColMemory]);
+						FineVolumeUp(chn, static_cast<ModCommand::PARAM>(vol), PlayBehaviourEnabled<TFormat, kITVolColMemory>());
 					}
 					break;
 
 				case VOLCMD_FINEVOLDOWN:
 					// IT Compatibility: Fine volume slides in the volume column are only executed on the first tick, not on multiples of the first tick in case of pattern delay
 					// Test case: FineVolColSlide.it
-					if(m_PlayState.m_nTickCount == nStartTick || !m_playBehaviour[kITVolColMemory])
+					if(m_PlayState.m_nTickCount == nStartTick || !PlayBehaviourEnabled<TFormat, kITVolColMemory>())
 					{
 						// IT Compatibility: Volume column volume slides have their own memory
 						// Test case: VolColMemory.it
-						FineVolumeDown(chn, static_cast<ModCommand::PARAM>(vol), m_playBehaviour[kITVolColMemory]);
+						FineVolumeDown(chn, static_cast<ModCommand::PARAM>(vol), PlayBehaviourEnabled<TFormat, kITVolColMemory>());
 					}
 					break;
 
 				case VOLCMD_VIBRATOSPEED:
 					// FT2 does not automatically enable vibrato with the "set vibrato speed" command
-					if(m_playBehaviour[kFT2VolColVibrato])
+					if(PlayBehaviourEnabled<TFormat, kFT2VolColVibrato>())
 						chn.nVibratoSpeed = vol & 0x0F;
 					else
 						Vibrato(chn, vol << 4);
@@ -3087,21 +3357,21 @@ bool CSoundFile::ProcessEffects()
 					break;
 
 				case VOLCMD_PANSLIDELEFT:
-					PanningSlide(chn, static_cast<ModCommand::PARAM>(vol), !m_playBehaviour[kFT2VolColMemory]);
+					PanningSlide(chn, static_cast<ModCommand::PARAM>(vol), !PlayBehaviourEnabled<TFormat, kFT2VolColMemory>());
 					break;
 
 				case VOLCMD_PANSLIDERIGHT:
-					PanningSlide(chn, static_cast<ModCommand::PARAM>(vol << 4), !m_playBehaviour[kFT2VolColMemory]);
+					PanningSlide(chn, static_cast<ModCommand::PARAM>(vol << 4), !PlayBehaviourEnabled<TFormat, kFT2VolColMemory>());
 					break;
 
 				case VOLCMD_PORTAUP:
 					// IT compatibility (one of the first testcases - link effect memory)
-					PortamentoUp(nChn, static_cast<ModCommand::PARAM>(vol << 2), m_playBehaviour[kITVolColFinePortamento]);
+					PortamentoUp(nChn, static_cast<ModCommand::PARAM>(vol << 2), PlayBehaviourEnabled<TFormat, kITVolColFinePortamento>());
 					break;
 
 				case VOLCMD_PORTADOWN:
 					// IT compatibility (one of the first testcases - link effect memory)
-					PortamentoDown(nChn, static_cast<ModCommand::PARAM>(vol << 2), m_playBehaviour[kITVolColFinePortamento]);
+					PortamentoDown(nChn, static_cast<ModCommand::PARAM>(vol << 2), PlayBehaviourEnabled<TFormat, kITVolColFinePortamento>());
 					break;
 
 				case VOLCMD_OFFSET:
@@ -3141,19 +3411,19 @@ bool CSoundFile::ProcessEffects()
 
 		// Portamento Up
 		case CMD_PORTAMENTOUP:
-			if(param || !(GetType() & MOD_TYPE_MOD))
+			if(param || !(GetType<TFormat>() & MOD_TYPE_MOD))
 				PortamentoUp(nChn, static_cast<ModCommand::PARAM>(param), false);
 			break;
 
 		// Portamento Down
 		case CMD_PORTAMENTODOWN:
-			if(param || !(GetType() & MOD_TYPE_MOD))
+			if(param || !(GetType<TFormat>() & MOD_TYPE_MOD))
 				PortamentoDown(nChn, static_cast<ModCommand::PARAM>(param), false);
 			break;
 
 		// Volume Slide
 		case CMD_VOLUMESLIDE:
-			if (param || (GetType() != MOD_TYPE_MOD)) VolumeSlide(chn, static_cast<ModCommand::PARAM>(param));
+			if (param || (GetType<TFormat>() != MOD_TYPE_MOD)) VolumeSlide(chn, static_cast<ModCommand::PARAM>(param));
 			break;
 
 		// Tone-Portamento
@@ -3163,7 +3433,7 @@ bool CSoundFile::ProcessEffects()
 
 		// Tone-Portamento + Volume Slide
 		case CMD_TONEPORTAVOL:
-			if ((param) || (GetType() != MOD_TYPE_MOD)) VolumeSlide(chn, static_cast<ModCommand::PARAM>(param));
+			if ((param) || (GetType<TFormat>() != MOD_TYPE_MOD)) VolumeSlide(chn, static_cast<ModCommand::PARAM>(param));
 			TonePortamento(nChn, 0);
 			break;
 
@@ -3174,7 +3444,7 @@ bool CSoundFile::ProcessEffects()
 
 		// Vibrato + Volume Slide
 		case CMD_VIBRATOVOL:
-			if ((param) || (GetType() != MOD_TYPE_MOD)) VolumeSlide(chn, static_cast<ModCommand::PARAM>(param));
+			if ((param) || (GetType<TFormat>() != MOD_TYPE_MOD)) VolumeSlide(chn, static_cast<ModCommand::PARAM>(param));
 			Vibrato(chn, 0);
 			break;
 
@@ -3186,7 +3456,7 @@ bool CSoundFile::ProcessEffects()
 
 		// Set Tempo
 		case CMD_TEMPO:
-			if(m_playBehaviour[kMODVBlankTiming])
+			if(PlayBehaviourEnabled<TFormat, kMODVBlankTiming>())
 			{
 				// ProTracker MODs with VBlank timing: All Fxx parameters set the tick count.
 				if(m_SongFlags[SONG_FIRSTTICK] && param != 0) SetSpeed(m_PlayState, param);
@@ -3194,7 +3464,7 @@ bool CSoundFile::ProcessEffects()
 			}
 			{
 				param = CalculateXParam(m_PlayState.m_nPattern, m_PlayState.m_nRow, nChn);
-				if (GetType() & (MOD_TYPE_S3M|MOD_TYPE_IT|MOD_TYPE_MPT))
+				if (GetType<TFormat>() & (MOD_TYPE_S3M|MOD_TYPE_IT|MOD_TYPE_MPT))
 				{
 					if (param) chn.nOldTempo = static_cast<ModCommand::PARAM>(param); else param = chn.nOldTempo;
 				}
@@ -3210,7 +3480,7 @@ bool CSoundFile::ProcessEffects()
 			{
 				// FT2 compatibility: Portamento + Offset = Ignore offset
 				// Test case: porta-offset.xm
-				if(bPorta && GetType() == MOD_TYPE_XM)
+				if(bPorta && GetType<TFormat>() == MOD_TYPE_XM)
 					break;
 
 				ProcessSampleOffset(chn, nChn, m_PlayState);
@@ -3231,22 +3501,22 @@ bool CSoundFile::ProcessEffects()
 			if(m_PlayState.m_nTickCount) break;
 			if((!chn.nPeriod || !chn.nNote)
 				&& (chn.pModInstrument == nullptr || !chn.pModInstrument->HasValidMIDIChannel())	// Plugin arpeggio
-				&& !m_playBehaviour[kITArpeggio] && (GetType() & (MOD_TYPE_IT | MOD_TYPE_MPT))) break;
-			if (!param && (GetType() & (MOD_TYPE_XM | MOD_TYPE_MOD))) break;	// Only important when editing MOD/XM files (000 effects are removed when loading files where this means "no effect")
+				&& !PlayBehaviourEnabled<TFormat, kITArpeggio>() && (GetType<TFormat>() & (MOD_TYPE_IT | MOD_TYPE_MPT))) break;
+			if (!param && (GetType<TFormat>() & (MOD_TYPE_XM | MOD_TYPE_MOD))) break;	// Only important when editing MOD/XM files (000 effects are removed when loading files where this means "no effect")
 			chn.nCommand = CMD_ARPEGGIO;
 			if (param) chn.nArpeggio = static_cast<ModCommand::PARAM>(param);
 			break;
 
 		// Retrig
 		case CMD_RETRIG:
-			if (GetType() & (MOD_TYPE_XM|MOD_TYPE_MT2))
+			if (GetType<TFormat>() & (MOD_TYPE_XM|MOD_TYPE_MT2))
 			{
 				if (!(param & 0xF0)) param |= chn.nRetrigParam & 0xF0;
 				if (!(param & 0x0F)) param |= chn.nRetrigParam & 0x0F;
 				param |= 0x100; // increment retrig count on first row
 			}
 			// IT compatibility 15. Retrigger
-			if(m_playBehaviour[kITRetrigger])
+			if(PlayBehaviourEnabled<TFormat, kITRetrigger>())
 			{
 				if (param) chn.nRetrigParam = static_cast<uint8>(param & 0xFF);
 				RetrigNote(nChn, chn.nRetrigParam, (volcmd == VOLCMD_OFFSET) ? vol + 1 : 0);
@@ -3266,7 +3536,7 @@ bool CSoundFile::ProcessEffects()
 			}
 
 			// IT compatibility 12. / 13. Tremor (using modified DUMB's Tremor logic here because of old effects - http://dumb.sf.net/)
-			if(m_playBehaviour[kITTremor])
+			if(PlayBehaviourEnabled<TFormat, kITTremor>())
 			{
 				if(param && !m_SongFlags[SONG_ITOLDEFFECTS])
 				{
@@ -3278,7 +3548,7 @@ bool CSoundFile::ProcessEffects()
 					chn.nTremorParam = static_cast<ModCommand::PARAM>(param);
 				}
 				chn.nTremorCount |= 0x80; // set on/off flag
-			} else if(m_playBehaviour[kFT2Tremor])
+			} else if(PlayBehaviourEnabled<TFormat, kFT2Tremor>())
 			{
 				// XM Tremor. Logic is being processed in sndmix.cpp
 				chn.nTremorCount |= 0x80; // set on/off flag
@@ -3297,8 +3567,8 @@ bool CSoundFile::ProcessEffects()
 			if(!m_SongFlags[SONG_FIRSTTICK])
 				break;
 			// ST3 applies global volume on tick 1 and does other weird things, but we won't emulate this for now.
-// 			if(((GetType() & MOD_TYPE_S3M) && m_nTickCount != 1)
-// 				|| (!(GetType() & MOD_TYPE_S3M) && !m_SongFlags[SONG_FIRSTTICK]))
+// 			if(((GetType<TFormat>() & MOD_TYPE_S3M) && m_nTickCount != 1)
+// 				|| (!(GetType<TFormat>() & MOD_TYPE_S3M) && !m_SongFlags[SONG_FIRSTTICK]))
 // 			{
 // 				break;
 // 			}
@@ -3312,14 +3582,14 @@ bool CSoundFile::ProcessEffects()
 // 				break;
 // 			}
 
-			if (!(GetType() & GLOBALVOL_7BIT_FORMATS)) param *= 2;
+			if (!(GetType<TFormat>() & GLOBALVOL_7BIT_FORMATS)) param *= 2;
 
 			// IT compatibility 16. ST3 and IT ignore out-of-range values.
 			// Test case: globalvol-invalid.it
 			if(param <= 128)
 			{
 				m_PlayState.m_nGlobalVolume = param * 2;
-			} else if(!(GetType() & (MOD_TYPE_IT | MOD_TYPE_MPT | MOD_TYPE_S3M)))
+			} else if(!(GetType<TFormat>() & (MOD_TYPE_IT | MOD_TYPE_MPT | MOD_TYPE_S3M)))
 			{
 				m_PlayState.m_nGlobalVolume = 256;
 			}
@@ -3328,7 +3598,7 @@ bool CSoundFile::ProcessEffects()
 		// Global Volume Slide
 		case CMD_GLOBALVOLSLIDE:
 			//IT compatibility 16. Saving last global volume slide param per channel (FT2/IT)
-			if(m_playBehaviour[kPerChannelGlobalVolSlide])
+			if(PlayBehaviourEnabled<TFormat, kPerChannelGlobalVolSlide>())
 				GlobalVolSlide(static_cast<ModCommand::PARAM>(param), chn.nOldGlobalVolSlide);
 			else
 				GlobalVolSlide(static_cast<ModCommand::PARAM>(param), m_PlayState.Chn[0].nOldGlobalVolSlide);
@@ -3364,7 +3634,7 @@ bool CSoundFile::ProcessEffects()
 
 		// S3M/IT Sxx Extended Commands
 		case CMD_S3MCMDEX:
-			if(m_playBehaviour[kST3EffectMemory] && param == 0)
+			if(PlayBehaviourEnabled<TFormat, kST3EffectMemory>() && param == 0)
 			{
 				param = chn.nArpeggio;	// S00 uses the last non-zero effect parameter as memory, like other effects including Arpeggio, so we "borrow" our memory there.
 			}
@@ -3374,7 +3644,7 @@ bool CSoundFile::ProcessEffects()
 		// Key Off
 		case CMD_KEYOFF:
 			// This is how Key Off is supposed to sound... (in FT2 at least)
-			if(m_playBehaviour[kFT2KeyOff])
+			if(PlayBehaviourEnabled<TFormat, kFT2KeyOff>())
 			{
 				if (m_PlayState.m_nTickCount == param)
 				{
@@ -3408,12 +3678,12 @@ bool CSoundFile::ProcessEffects()
 			{
 			case 0x10:
 				ExtraFinePortamentoUp(chn, param & 0x0F);
-				if(!m_playBehaviour[kPluginIgnoreTonePortamento])
+				if(!PlayBehaviourEnabled<TFormat, kPluginIgnoreTonePortamento>())
 					MidiPortamento(nChn, 0xE0 | (param & 0x0F), true);
 				break;
 			case 0x20:
 				ExtraFinePortamentoDown(chn, param & 0x0F);
-				if(!m_playBehaviour[kPluginIgnoreTonePortamento])
+				if(!PlayBehaviourEnabled<TFormat, kPluginIgnoreTonePortamento>())
 					MidiPortamento(nChn, -static_cast<int>(0xE0 | (param & 0x0F)), true);
 				break;
 			// ModPlug XM Extensions (ignore in compatible mode)
@@ -3422,7 +3692,7 @@ bool CSoundFile::ProcessEffects()
 			case 0x70:
 			case 0x90:
 			case 0xA0:
-				if(!m_playBehaviour[kFT2RestrictXCommand]) ExtendedS3MCommands(nChn, static_cast<ModCommand::PARAM>(param));
+				if(!PlayBehaviourEnabled<TFormat, kFT2RestrictXCommand>()) ExtendedS3MCommands(nChn, static_cast<ModCommand::PARAM>(param));
 				break;
 			}
 			break;
@@ -3467,7 +3737,7 @@ bool CSoundFile::ProcessEffects()
 
 				// FT2 compatibility: FT2 only sets the position of the panning envelope if the volume envelope's sustain flag is set
 				// Test case: SetEnvPos.xm
-				if(!m_playBehaviour[kFT2SetPanEnvPos] || chn.VolEnv.flags[ENV_SUSTAIN])
+				if(!PlayBehaviourEnabled<TFormat, kFT2SetPanEnvPos>() || chn.VolEnv.flags[ENV_SUSTAIN])
 				{
 					chn.PanEnv.nEnvPosition = param;
 					chn.PitchEnv.nEnvPosition = param;
@@ -3544,7 +3814,7 @@ bool CSoundFile::ProcessEffects()
 			break;
 		}
 
-		if(m_playBehaviour[kST3EffectMemory] && param != 0)
+		if(PlayBehaviourEnabled<TFormat, kST3EffectMemory>() && param != 0)
 		{
 			UpdateS3MEffectMemory(chn, static_cast<ModCommand::PARAM>(param));
 		}
@@ -4904,6 +5174,8 @@ void CSoundFile::InvertLoop(ModChannel &chn)
 		chn.nEFxOffset = 0;
 
 	// TRASH IT!!! (Yes, the sample!)
+	if(!SamplePool::MakeUnique(*pModSample, *this))
+		return;
 	const uint8 bps = pModSample->GetBytesPerSample();
 	uint8 *begin = mpt::byte_cast<uint8 *>(pModSample->sampleb()) + (loopStart + chn.nEFxOffset) * bps;
 	for(auto &sample : mpt::as_span(begin, bps))
@@ -4914,22 +5186,10 @@ void CSoundFile::InvertLoop(ModChannel &chn)
 }
 
 
-// Process a MIDI Macro.
-// Parameters:
-// playState: The playback state to operate on.
-// nChn: Mod channel to apply macro on
-// isSmooth: If true, internal macros are interpolated between two rows
-// macro: MIDI Macro string to process
-// param: Parameter for parametric macros (Zxx / \xx parameter)
-// plugin: Plugin to send MIDI message to (if not specified but needed, it is autodetected)
-void CSoundFile::ProcessMIDIMacro(PlayState &playState, CHANNELINDEX nChn, bool isSmooth, const MIDIMacroConfigData::Macro &macro, uint8 param, PLUGINDEX plugin)
+// Split a parsed MIDI macro into individual MIDI messages and pass each of them to sendMessage.
+template<typename TSendFunc>
+static void SplitMIDIMacro(mpt::span<uint8> out, TSendFunc sendMessage)
 {
-	playState.m_midiMacroScratchSpace.resize(macro.Length() + 1);
-	auto out = mpt::as_span(playState.m_midiMacroScratchSpace);
-
-	ParseMIDIMacro(playState, nChn, isSmooth, macro, out, param, plugin);
-
-	// Macro string has been parsed and translated, now send the message(s)...
 	uint32 outSize = static_cast<uint32>(out.size());
 	uint32 sendPos = 0;
 	uint8 runningStatus = 0;
@@ -4988,13 +5248,46 @@ void CSoundFile::ProcessMIDIMacro(PlayState &playState, CHANNELINDEX nChn, bool
 		{
 			runningStatus = out[sendPos];
 		}
-		const auto midiMsg = out.subspan(sendPos, sendLen);
-		SendMIDIData(playState, nChn, isSmooth, midiMsg, plugin);
+		sendMessage(mpt::span<const uint8>(out.subspan(sendPos, sendLen)));
 		sendPos += sendLen;
 	}
 }
 
 
+// Process a MIDI Macro.
+// Parameters:
+// playState: The playback state to operate on.
+// nChn: Mod channel to apply macro on
+// isSmooth: If true, internal macros are interpolated between two rows
+// macro: MIDI Macro string to process
+// param: Parameter for parametric macros (Zxx / \xx parameter)
+// plugin: Plugin to send MIDI message to (if not specified but needed, it is autodetected)
+void CSoundFile::ProcessMIDIMacro(PlayState &playState, CHANNELINDEX nChn, bool isSmooth, const MIDIMacroConfigData::Macro &macro, uint8 param, PLUGINDEX plugin)
+{
+	playState.m_midiMacroScratchSpace.resize(macro.Length() + 1);
+	auto out = mpt::as_span(playState.m_midiMacroScratchSpace);
+
+	ParseMIDIMacro(playState, nChn, isSmooth, macro, out, param, plugin);
+
+	// Macro string has been parsed and translated, now send the message(s)...
+	SplitMIDIMacro(out, [&](mpt::span<const uint8> midiMsg) { SendMIDIData(playState, nChn, isSmooth, midiMsg, plugin); });
+}
+
+
+// Evaluate a MIDI Macro without sending it anywhere (for WalkSong).
+// Only the play state is modified; plugin changes are collected in playState.m_midiMacroEvaluationResults.
+void CSoundFile::EvaluateMIDIMacro(PlayState &playState, CHANNELINDEX nChn, const MIDIMacroConfigData::Macro &macro, uint8 param) const
+{
+	MPT_ASSERT(playState.m_midiMacroEvaluationResults);
+	playState.m_midiMacroScratchSpace.resize(macro.Length() + 1);
+	auto out = mpt::as_span(playState.m_midiMacroScratchSpace);
+
+	ParseMIDIMacro(playState, nChn, false, macro, out, param, 0);
+
+	SplitMIDIMacro(out, [&](mpt::span<const uint8> midiMsg) { EvaluateMIDIData(playState, nChn, false, midiMsg, 0); });
+}
+
+
 void CSoundFile::ParseMIDIMacro(PlayState &playState, CHANNELINDEX nChn, bool isSmooth, const mpt::span<const char> macro, mpt::span<uint8> &out, uint8 param, PLUGINDEX plugin) const
 {
 	ModChannel &chn = playState.Chn[nChn];
@@ -5192,15 +5485,10 @@ float CSoundFile::CalculateSmoothParamChange(const PlayState &playState, float c
 }
 
 
-// Process exactly one MIDI message parsed by ProcessMIDIMacro. Returns bytes sent on success, 0 on (parse) failure.
-void CSoundFile::SendMIDIData(PlayState &playState, CHANNELINDEX nChn, bool isSmooth, const mpt::span<const uint8> macro, PLUGINDEX plugin)
+// Apply the parts of a MIDI message that only affect the play state (MIDI resets and internal filter macros).
+// Returns the channel's new cutoff value as computed by SetupChannelFilter if the cutoff was set, -1 otherwise.
+int CSoundFile::ProcessChannelMIDIData(PlayState &playState, CHANNELINDEX nChn, bool isSmooth, const mpt::span<const uint8> macro) const
 {
-	if(macro.size() < 1)
-		return;
-
-	// Don't do anything that modifies state outside of the playState itself.
-	const bool localOnly = playState.m_midiMacroEvaluationResults.has_value();
-
 	if(macro[0] == 0xFA || macro[0] == 0xFC || macro[0] == 0xFF)
 	{
 		// Start Song, Stop Song, MIDI Reset - both interpreted internally and sent to plugins
@@ -5211,15 +5499,15 @@ void CSoundFile::SendMIDIData(PlayState &playState, CHANNELINDEX nChn, bool isSm
 		}
 	}
 
+	int cutoff = -1;
 	ModChannel &chn = playState.Chn[nChn];
-	if(macro.size() == 4 && macro[0] == 0xF0 && (macro[1] == 0xF0 || macro[1] == 0xF1))
+	if(macro.size() == 4 && macro[0] == 0xF0 && macro[1] == 0xF0)
 	{
 		// Internal device.
-		const bool isExtended = (macro[1] == 0xF1);
 		const uint8 macroCode = macro[2];
 		const uint8 param = macro[3];
 
-		if(macroCode == 0x00 && !isExtended && param < 0x80)
+		if(macroCode == 0x00 && param < 0x80)
 		{
 			// F0.F0.00.xx: Set CutOff
 			if(!isSmooth)
@@ -5227,14 +5515,8 @@ void CSoundFile::SendMIDIData(PlayState &playState, CHANNELINDEX nChn, bool isSm
 			else
 				chn.nCutOff = mpt::saturate_round<uint8>(CalculateSmoothParamChange(playState, chn.nCutOff, param));
 			chn.nRestoreCutoffOnNewNote = 0;
-			int cutoff = SetupChannelFilter(chn, !chn.dwFlags[CHN_FILTER]);
-
-			if(cutoff >= 0 && chn.dwFlags[CHN_ADLIB] && m_opl && !localOnly)
-			{
-				// Cutoff doubles as modulator intensity for FM instruments
-				m_opl->Volume(nChn, static_cast<uint8>(cutoff / 4), true);
-			}
-		} else if(macroCode == 0x01 && !isExtended && param < 0x80)
+			cutoff = SetupChannelFilter(chn, !chn.dwFlags[CHN_FILTER]);
+		} else if(macroCode == 0x01 && param < 0x80)
 		{
 			// F0.F0.01.xx: Set Resonance
 			if(!isSmooth)
@@ -5243,7 +5525,7 @@ void CSoundFile::SendMIDIData(PlayState &playState, CHANNELINDEX nChn, bool isSm
 				chn.nResonance = mpt::saturate_round<uint8>(CalculateSmoothParamChange(playState, chn.nResonance, param));
 			chn.nRestoreResonanceOnNewNote = 0;
 			SetupChannelFilter(chn, !chn.dwFlags[CHN_FILTER]);
-		} else if(macroCode == 0x02 && !isExtended)
+		} else if(macroCode == 0x02)
 		{
 			// F0.F0.02.xx: Set filter mode (high nibble determines filter mode)
 			if(param < 0x20)
@@ -5251,47 +5533,109 @@ void CSoundFile::SendMIDIData(PlayState &playState, CHANNELINDEX nChn, bool isSm
 				chn.nFilterMode = static_cast<FilterMode>(param >> 4);
 				SetupChannelFilter(chn, !chn.dwFlags[CHN_FILTER]);
 			}
+		}
+	}
+	return cutoff;
+}
+
+
 #ifndef NO_PLUGINS
-		} else if(macroCode == 0x03 && !isExtended)
-		{
-			// F0.F0.03.xx: Set plug dry/wet
-			PLUGINDEX plug = (plugin != 0) ? plugin : GetBestPlugin(playState, nChn, PrioritiseChannel, EvenIfMuted);
-			if(plug > 0 && plug <= MAX_MIXPLUGINS && param < 0x80)
-			{
-				plug--;
-				if(IMixPlugin* pPlugin = m_MixPlugins[plug].pMixPlugin; pPlugin)
-				{
-					const float newRatio = (127 - param) / 127.0f;
-					if(localOnly)
-						playState.m_midiMacroEvaluationResults->pluginDryWetRatio[plug] = newRatio;
-					else if(!isSmooth)
-						pPlugin->SetDryRatio(newRatio);
-					else
-						pPlugin->SetDryRatio(CalculateSmoothParamChange(playState, m_MixPlugins[plug].fDryRatio, newRatio));
-				}
-			}
-		} else if((macroCode & 0x80) || isExtended)
-		{
-			// F0.F0.{80|n}.xx / F0.F1.n.xx: Set VST effect parameter n to xx
-			PLUGINDEX plug = (plugin != 0) ? plugin : GetBestPlugin(playState, nChn, PrioritiseChannel, EvenIfMuted);
-			if(plug > 0 && plug <= MAX_MIXPLUGINS && param < 0x80)
+// Find the plugin targeted by an internal plugin macro (F0.F0.03.xx: Set plug dry/wet, F0.F0.{80|n}.xx / F0.F1.n.xx: Set VST effect parameter n to xx).
+// Returns the 0-based plugin index, or PLUGINDEX_INVALID if the message is not such a macro or if there is no plugin to apply it to.
+PLUGINDEX CSoundFile::GetMIDIDataPlugin(const PlayState &playState, CHANNELINDEX nChn, const mpt::span<const uint8> macro, PLUGINDEX plugin) const
+{
+	if(macro.size() != 4 || macro[0] != 0xF0 || (macro[1] != 0xF0 && macro[1] != 0xF1) || macro[3] >= 0x80)
+		return PLUGINDEX_INVALID;
+	const bool isExtended = (macro[1] == 0xF1);
+	const uint8 macroCode = macro[2];
+	if(!isExtended && macroCode != 0x03 && !(macroCode & 0x80))
+		return PLUGINDEX_INVALID;
+
+	PLUGINDEX plug = (plugin != 0) ? plugin : GetBestPlugin(playState, nChn, PrioritiseChannel, EvenIfMuted);
+	if(plug == 0 || plug > MAX_MIXPLUGINS || m_MixPlugins[plug - 1].pMixPlugin == nullptr)
+		return PLUGINDEX_INVALID;
+	return plug - 1;
+}
+#endif // NO_PLUGINS
+
+
+// Process exactly one MIDI message parsed by EvaluateMIDIMacro. Nothing outside of the play state is modified.
+void CSoundFile::EvaluateMIDIData(PlayState &playState, CHANNELINDEX nChn, bool isSmooth, const mpt::span<const uint8> macro, PLUGINDEX plugin) const
+{
+	if(macro.size() < 1)
+		return;
+
+	ProcessChannelMIDIData(playState, nChn, isSmooth, macro);
+
+#ifndef NO_PLUGINS
+	if(const PLUGINDEX plug = GetMIDIDataPlugin(playState, nChn, macro, plugin); plug != PLUGINDEX_INVALID)
+	{
+		const bool isExtended = (macro[1] == 0xF1);
+		const uint8 macroCode = macro[2];
+		const uint8 param = macro[3];
+		if(macroCode == 0x03 && !isExtended)
+			playState.m_midiMacroEvaluationResults->pluginDryWetRatio[plug] = (127 - param) / 127.0f;
+		else
+			playState.m_midiMacroEvaluationResults->pluginParameter[{plug, isExtended ? (0x80 + macroCode) : (macroCode & 0x7F)}] = param / 127.0f;
+	}
+#else
+	MPT_UNREFERENCED_PARAMETER(plugin);
+#endif // NO_PLUGINS
+}
+
+
+// Process exactly one MIDI message parsed by ProcessMIDIMacro.
+void CSoundFile::SendMIDIData(PlayState &playState, CHANNELINDEX nChn, bool isSmooth, const mpt::span<const uint8> macro, PLUGINDEX plugin)
+{
+	if(macro.size() < 1)
+		return;
+
+	if(playState.m_midiMacroEvaluationResults)
+	{
+		// Don't do anything that modifies state outside of the playState itself.
+		EvaluateMIDIData(playState, nChn, isSmooth, macro, plugin);
+		return;
+	}
+
+	ModChannel &chn = playState.Chn[nChn];
+	const int cutoff = ProcessChannelMIDIData(playState, nChn, isSmooth, macro);
+	if(cutoff >= 0 && chn.dwFlags[CHN_ADLIB] && m_opl)
+	{
+		// Cutoff doubles as modulator intensity for FM instruments
+		m_opl->Volume(nChn, static_cast<uint8>(cutoff / 4), true);
+	}
+
+	if(macro.size() == 4 && macro[0] == 0xF0 && (macro[1] == 0xF0 || macro[1] == 0xF1))
+	{
+		// Internal device.
+#ifndef NO_PLUGINS
+		if(const PLUGINDEX plug = GetMIDIDataPlugin(playState, nChn, macro, plugin); plug != PLUGINDEX_INVALID)
+		{
+			IMixPlugin *pPlugin = m_MixPlugins[plug].pMixPlugin;
+			const bool isExtended = (macro[1] == 0xF1);
+			const uint8 macroCode = macro[2];
+			const uint8 param = macro[3];
+			if(macroCode == 0x03 && !isExtended)
+			{
+				// F0.F0.03.xx: Set plug dry/wet
+				const float newRatio = (127 - param) / 127.0f;
+				if(!isSmooth)
+					pPlugin->SetDryRatio(newRatio);
+				else
+					pPlugin->SetDryRatio(CalculateSmoothParamChange(playState, m_MixPlugins[plug].fDryRatio, newRatio));
+			} else
 			{
-				plug--;
-				if(IMixPlugin *pPlugin = m_MixPlugins[plug].pMixPlugin; pPlugin)
-				{
-					const PlugParamIndex plugParam = isExtended ? (0x80 + macroCode) : (macroCode & 0x7F);
-					const PlugParamValue value = param / 127.0f;
-					if(localOnly)
-						playState.m_midiMacroEvaluationResults->pluginParameter[{plug, plugParam}] = value;
-					else if(!isSmooth)
-						pPlugin->SetParameter(plugParam, value);
-					else
-						pPlugin->SetParameter(plugParam, CalculateSmoothParamChange(playState, pPlugin->GetParameter(plugParam), value));
-				}
+				// F0.F0.{80|n}.xx / F0.F1.n.xx: Set VST effect parameter n to xx
+				const PlugParamIndex plugParam = isExtended ? (0x80 + macroCode) : (macroCode & 0x7F);
+				const PlugParamValue value = param / 127.0f;
+				if(!isSmooth)
+					pPlugin->SetParameter(plugParam, value);
+				else
+					pPlugin->SetParameter(plugParam, CalculateSmoothParamChange(playState, pPlugin->GetParameter(plugParam), value));
 			}
-#endif // NO_PLUGINS
 		}
-	} else if(!localOnly)
+#endif // NO_PLUGINS
+	} else
 	{
 #ifndef NO_PLUGINS
 		// Not an internal device. Pass on to appropriate plugin.
@@ -25,6 +25,7 @@
 #include "../common/serialization_utils.h"
 #include "Sndfile.h"
 #include "Tables.h"
+#include "MixFuncTable.h"
 #include "mod_specifications.h"
 #include "tuningcollection.h"
 #include "plugins/PluginManager.h"
@@ -33,6 +34,7 @@
 #include "../common/FileReader.h"
 #include "Container.h"
 #include "OPL.h"
+#include "SamplePool.h"
 #include "mpt/io/io.hpp"
 #include "mpt/io/io_stdstream.hpp"
 
@@ -77,6 +79,42 @@ CSoundFile::PlayState::PlayState()
 }
 
 
+// Must be kept in sync with the members of PlayState.
+void CSoundFile::PlayState::CopySongState(const PlayState &other, CHANNELINDEX numChannels)
+{
+	m_lTotalSampleCount = other.m_lTotalSampleCount;
+	m_nBufferCount = other.m_nBufferCount;
+	m_dBufferDiff = other.m_dBufferDiff;
+	m_nTickCount = other.m_nTickCount;
+	m_nPatternDelay = other.m_nPatternDelay;
+	m_nFrameDelay = other.m_nFrameDelay;
+	m_nSamplesPerTick = other.m_nSamplesPerTick;
+	m_nCurrentRowsPerBeat = other.m_nCurrentRowsPerBeat;
+	m_nCurrentRowsPerMeasure = other.m_nCurrentRowsPerMeasure;
+	m_nMusicSpeed = other.m_nMusicSpeed;
+	m_nMusicTempo = other.m_nMusicTempo;
+	m_nRow = other.m_nRow;
+	m_nNextRow = other.m_nNextRow;
+	m_nextPatStartRow = other.m_nextPatStartRow;
+	m_breakRow = other.m_breakRow;
+	m_patLoopRow = other.m_patLoopRow;
+	m_posJump = other.m_posJump;
+	m_nPattern = other.m_nPattern;
+	m_nCurrentOrder = other.m_nCurrentOrder;
+	m_nNextOrder = other.m_nNextOrder;
+	m_nSeqOverride = other.m_nSeqOverride;
+	m_nGlobalVolume = other.m_nGlobalVolume;
+	m_nSamplesToGlobalVolRampDest = other.m_nSamplesToGlobalVolRampDest;
+	m_nGlobalVolumeRampAmount = other.m_nGlobalVolumeRampAmount;
+	m_nGlobalVolumeDestination = other.m_nGlobalVolumeDestination;
+	m_lHighResRampingGlobalVolume = other.m_lHighResRampingGlobalVolume;
+	m_bPositionChanged = other.m_bPositionChanged;
+	std::copy(std::begin(other.Chn), std::begin(other.Chn) + numChannels, std::begin(Chn));
+	m_midiMacroScratchSpace = other.m_midiMacroScratchSpace;
+	m_midiMacroEvaluationResults = other.m_midiMacroEvaluationResults;
+}
+
+
 //////////////////////////////////////////////////////////
 // CSoundFile
 
@@ -101,6 +139,7 @@ CSoundFile::CSoundFile() :
 	MemsetZero(MixSoundBuffer);
 	MemsetZero(MixRearBuffer);
 	MemsetZero(MixFloatBuffer);
+	m_MixFuncTable = MixFuncTable::GetFunctions();
 
 #ifdef MODPLUG_TRACKER
 	m_bChannelMuteTogglePending.reset();
@@ -209,16 +248,52 @@ void CSoundFile::InitializeChannels()
 }
 
 
+// Magic bytes at a fixed offset that are required by a format's header validation.
+struct FileFormatSignature
+{
+	uint16 offset = 0;
+	uint8 length = 0;
+	const char *magic = nullptr;
+
+	constexpr FileFormatSignature() = default;
+	template <std::size_t N>
+	constexpr FileFormatSignature(uint16 offset_, const char (&magic_)[N])
+		: offset{offset_}, length{static_cast<uint8>(N - 1)}, magic{magic_}
+	{ }
+
+	bool Matches(mpt::span<const std::byte> data) const
+	{
+		return data.size() >= static_cast<std::size_t>(offset) + length && !std::memcmp(data.data() + offset, magic, length);
+	}
+};
+
 struct FileFormatLoader
 {
 	decltype(CSoundFile::ProbeFileHeaderXM) *prober;
 	decltype(&CSoundFile::ReadXM) loader;
+	MODTYPE type;  // Module type produced by the loader, MOD_TYPE_NONE if it depends on the file contents
+	// If there are any signatures, the prober can only succeed if at least one of them matches.
+	std::array<FileFormatSignature, 2> signatures;
+
+	bool MayMatch(mpt::span<const std::byte> data) const
+	{
+		if(!signatures[0].length)
+			return true;
+		for(const auto &signature : signatures)
+		{
+			if(signature.length && signature.Matches(data))
+				return true;
+		}
+		return false;
+	}
 };
 
 #ifdef MODPLUG_TRACKER
-#define MPT_DECLARE_FORMAT(format) { nullptr, &CSoundFile::Read ## format }
+#define MPT_DECLARE_FORMAT(format, type) { nullptr, &CSoundFile::Read ## format, type, {} }
+#define MPT_DECLARE_FORMAT_MAGIC(format, type, ...) { nullptr, &CSoundFile::Read ## format, type, {{ __VA_ARGS__ }} }
 #else
-#define MPT_DECLARE_FORMAT(format) { CSoundFile::ProbeFileHeader ## format, &CSoundFile::Read ## format }
+#define MPT_DECLARE_FORMAT(format, type) { CSoundFile::ProbeFileHeader ## format, &CSoundFile::Read ## format, type, {} }
+#define MPT_DECLARE_FORMAT_MAGIC(format, type, ...) { CSoundFile::ProbeFileHeader ## format, &CSoundFile::Read ## format, type, {{ __VA_ARGS__ }} }
 #endif
 
 // All module format loaders, in the order they should be executed.
@@ -226,61 +301,64 @@ struct FileFormatLoader
 // clashes or lack of magic bytes that can lead to mis-detection of some formats.
 // Apart from that, more common formats with sane magic bytes are also found
 // at the top of the list to match the most common cases more quickly.
+// The magic bytes listed here must be kept in sync with the respective header validation,
+// as ProbeBatch relies on them to skip formats that cannot match.
 static constexpr FileFormatLoader ModuleFormatLoaders[] =
 {
-	MPT_DECLARE_FORMAT(XM),
-	MPT_DECLARE_FORMAT(IT),
-	MPT_DECLARE_FORMAT(S3M),
-	MPT_DECLARE_FORMAT(STM),
-	MPT_DECLARE_FORMAT(MED),
-	MPT_DECLARE_FORMAT(MTM),
-	MPT_DECLARE_FORMAT(MDL),
-	MPT_DECLARE_FORMAT(DBM),
-	MPT_DECLARE_FORMAT(FAR),
-	MPT_DECLARE_FORMAT(AMS),
-	MPT_DECLARE_FORMAT(AMS2),
-	MPT_DECLARE_FORMAT(OKT),
-	MPT_DECLARE_FORMAT(PTM),
-	MPT_DECLARE_FORMAT(ULT),
-	MPT_DECLARE_FORMAT(DMF),
-	MPT_DECLARE_FORMAT(DSM),
-	MPT_DECLARE_FORMAT(AMF_Asylum),
-	MPT_DECLARE_FORMAT(AMF_DSMI),
-	MPT_DECLARE_FORMAT(PSM),
-	MPT_DECLARE_FORMAT(PSM16),
-	MPT_DECLARE_FORMAT(MT2),
-	MPT_DECLARE_FORMAT(ITP),
+	MPT_DECLARE_FORMAT_MAGIC(XM, MOD_TYPE_XM, {0, "Extended Module: "}),
+	MPT_DECLARE_FORMAT_MAGIC(IT, MOD_TYPE_IT, {0, "IMPM"}, {0, "tpm."}),
+	MPT_DECLARE_FORMAT_MAGIC(S3M, MOD_TYPE_S3M, {44, "SCRM"}),
+	MPT_DECLARE_FORMAT(STM, MOD_TYPE_STM),
+	MPT_DECLARE_FORMAT_MAGIC(MED, MOD_TYPE_MED, {0, "MMD"}),
+	MPT_DECLARE_FORMAT_MAGIC(MTM, MOD_TYPE_MTM, {0, "MTM"}),
+	MPT_DECLARE_FORMAT_MAGIC(MDL, MOD_TYPE_MDL, {0, "DMDL"}),
+	MPT_DECLARE_FORMAT_MAGIC(DBM, MOD_TYPE_DBM, {0, "DBM0"}),
+	MPT_DECLARE_FORMAT_MAGIC(FAR, MOD_TYPE_FAR, {0, "FAR\xFE"}),
+	MPT_DECLARE_FORMAT_MAGIC(AMS, MOD_TYPE_AMS, {0, "Extreme"}),
+	MPT_DECLARE_FORMAT_MAGIC(AMS2, MOD_TYPE_AMS, {0, "AMShdr\x1A"}),
+	MPT_DECLARE_FORMAT_MAGIC(OKT, MOD_TYPE_OKT, {0, "OKTASONG"}),
+	MPT_DECLARE_FORMAT_MAGIC(PTM, MOD_TYPE_PTM, {44, "PTMF"}),
+	MPT_DECLARE_FORMAT_MAGIC(ULT, MOD_TYPE_ULT, {0, "MAS_UTrack_V00"}),
+	MPT_DECLARE_FORMAT_MAGIC(DMF, MOD_TYPE_DMF, {0, "DDMF"}),
+	MPT_DECLARE_FORMAT_MAGIC(DSM, MOD_TYPE_DSM, {0, "RIFF"}, {0, "DSMF"}),
+	MPT_DECLARE_FORMAT_MAGIC(AMF_Asylum, MOD_TYPE_AMF0, {0, "ASYLUM Music Format V1.0\0"}),
+	MPT_DECLARE_FORMAT_MAGIC(AMF_DSMI, MOD_TYPE_AMF, {0, "AMF"}),
+	MPT_DECLARE_FORMAT_MAGIC(PSM, MOD_TYPE_PSM, {0, "PSM "}, {0, "QUP$"}),
+	MPT_DECLARE_FORMAT_MAGIC(PSM16, MOD_TYPE_PSM, {0, "PSM\xFE"}),
+	MPT_DECLARE_FORMAT_MAGIC(MT2, MOD_TYPE_MT2, {0, "MT20"}),
+	MPT_DECLARE_FORMAT(ITP, MOD_TYPE_IT),
 #if defined(MODPLUG_TRACKER) || defined(MPT_FUZZ_TRACKER)
 	// These make little sense for a module player library
-	MPT_DECLARE_FORMAT(UAX),
-	MPT_DECLARE_FORMAT(WAV),
-	MPT_DECLARE_FORMAT(MID),
+	MPT_DECLARE_FORMAT(UAX, MOD_TYPE_MPT),
+	MPT_DECLARE_FORMAT(WAV, MOD_TYPE_MPT),
+	MPT_DECLARE_FORMAT(MID, MOD_TYPE_MID),
 #endif // MODPLUG_TRACKER || MPT_FUZZ_TRACKER
-	MPT_DECLARE_FORMAT(GDM),
-	MPT_DECLARE_FORMAT(IMF),
-	MPT_DECLARE_FORMAT(DIGI),
-	MPT_DECLARE_FORMAT(DTM),
-	MPT_DECLARE_FORMAT(PLM),
-	MPT_DECLARE_FORMAT(AM),
-	MPT_DECLARE_FORMAT(J2B),
-	MPT_DECLARE_FORMAT(GT2),
-	MPT_DECLARE_FORMAT(GTK),
-	MPT_DECLARE_FORMAT(PT36),
-	MPT_DECLARE_FORMAT(SymMOD),
-	MPT_DECLARE_FORMAT(MUS_KM),
-	MPT_DECLARE_FORMAT(FMT),
-	MPT_DECLARE_FORMAT(SFX),
-	MPT_DECLARE_FORMAT(STP),
-	MPT_DECLARE_FORMAT(DSym),
-	MPT_DECLARE_FORMAT(STX),
-	MPT_DECLARE_FORMAT(MOD),
-	MPT_DECLARE_FORMAT(ICE),
-	MPT_DECLARE_FORMAT(669),
-	MPT_DECLARE_FORMAT(C67),
-	MPT_DECLARE_FORMAT(MO3),
-	MPT_DECLARE_FORMAT(M15),
+	MPT_DECLARE_FORMAT_MAGIC(GDM, MOD_TYPE_NONE, {0, "GDM\xFE"}),
+	MPT_DECLARE_FORMAT_MAGIC(IMF, MOD_TYPE_IMF, {60, "IM10"}),
+	MPT_DECLARE_FORMAT_MAGIC(DIGI, MOD_TYPE_DIGI, {0, "DIGI Booster module\0"}),
+	MPT_DECLARE_FORMAT_MAGIC(DTM, MOD_TYPE_DTM, {0, "D.T."}),
+	MPT_DECLARE_FORMAT_MAGIC(PLM, MOD_TYPE_PLM, {0, "PLM\x1A"}),
+	MPT_DECLARE_FORMAT_MAGIC(AM, MOD_TYPE_J2B, {0, "RIFF"}),
+	MPT_DECLARE_FORMAT_MAGIC(J2B, MOD_TYPE_J2B, {0, "MUSE"}),
+	MPT_DECLARE_FORMAT_MAGIC(GT2, MOD_TYPE_MPT, {0, "GT2"}),
+	MPT_DECLARE_FORMAT_MAGIC(GTK, MOD_TYPE_MPT, {0, "GTK"}),
+	MPT_DECLARE_FORMAT_MAGIC(PT36, MOD_TYPE_MOD, {0, "FORM"}),
+	MPT_DECLARE_FORMAT_MAGIC(SymMOD, MOD_TYPE_MPT, {0, "SymM"}),
+	MPT_DECLARE_FORMAT(MUS_KM, MOD_TYPE_MOD),
+	MPT_DECLARE_FORMAT(FMT, MOD_TYPE_S3M),
+	MPT_DECLARE_FORMAT(SFX, MOD_TYPE_SFX),
+	MPT_DECLARE_FORMAT_MAGIC(STP, MOD_TYPE_STP, {0, "STP3"}),
+	MPT_DECLARE_FORMAT_MAGIC(DSym, MOD_TYPE_MOD, {0, "\x02\x01\x13\x13\x14\x12\x01\x0B"}),
+	MPT_DECLARE_FORMAT_MAGIC(STX, MOD_TYPE_STM, {60, "SCRM"}),
+	MPT_DECLARE_FORMAT(MOD, MOD_TYPE_MOD),
+	MPT_DECLARE_FORMAT(ICE, MOD_TYPE_MOD),
+	MPT_DECLARE_FORMAT(669, MOD_TYPE_669),
+	MPT_DECLARE_FORMAT(C67, MOD_TYPE_S3M),
+	MPT_DECLARE_FORMAT_MAGIC(MO3, MOD_TYPE_NONE, {0, "MO3"}),
+	MPT_DECLARE_FORMAT(M15, MOD_TYPE_MOD),
 };
 
+#undef MPT_DECLARE_FORMAT_MAGIC
 #undef MPT_DECLARE_FORMAT
 
 
@@ -312,21 +390,11 @@ CSoundFile::ProbeResult CSoundFile::ProbeAdditionalSize(MemoryFileReader &file,
 }
 
 
-#define MPT_DO_PROBE( storedResult , call ) \
-	do { \
-		ProbeResult lastResult = call ; \
-		if(lastResult == ProbeSuccess) { \
-			return ProbeSuccess; \
-		} else if(lastResult == ProbeWantMoreData) { \
-			storedResult = ProbeWantMoreData; \
-		} \
-	} while(0) \
-/**/
-
-
-CSoundFile::ProbeResult CSoundFile::Probe(ProbeFlags flags, mpt::span<const std::byte> data, const uint64 *pfilesize)
+// Probes the data and remembers which format matched.
+// If allowSignatures is true, module formats that require magic bytes which are not present are skipped if they could not have asked for more data anyway.
+static CSoundFile::ProbeBatchResult ProbeTyped(CSoundFile::ProbeFlags flags, mpt::span<const std::byte> data, const uint64 *pfilesize, bool allowSignatures)
 {
-	ProbeResult result = ProbeFailure;
+	CSoundFile::ProbeBatchResult result;
 	if(pfilesize && (*pfilesize < data.size()))
 	{
 		throw std::out_of_range("");
@@ -335,47 +403,90 @@ CSoundFile::ProbeResult CSoundFile::Probe(ProbeFlags flags, mpt::span<const std:
 	{
 		throw std::invalid_argument("");
 	}
+	// The magic bytes can only be used for skipping formats if either the recommended amount of data (which is larger
+	// than any of the affected headers) or the whole file is available. Otherwise, a skipped format might have returned
+	// ProbeWantMoreData instead of ProbeFailure.
+	const bool useSignatures = allowSignatures && ((data.size() >= CSoundFile::ProbeRecommendedSize) || (pfilesize && *pfilesize <= data.size()));
 	MemoryFileReader file(data);
-	if(flags & ProbeContainers)
+	const auto tryProbe = [&result](CSoundFile::ProbeResult probeResult, MODTYPE type, MODCONTAINERTYPE containerType)
+	{
+		if(probeResult == CSoundFile::ProbeSuccess)
+		{
+			result.result = CSoundFile::ProbeSuccess;
+			result.type = type;
+			result.containerType = containerType;
+			return true;
+		} else if(probeResult == CSoundFile::ProbeWantMoreData)
+		{
+			result.result = CSoundFile::ProbeWantMoreData;
+		}
+		return false;
+	};
+	bool found = false;
+	if(flags & CSoundFile::ProbeContainers)
 	{
 #if !defined(MPT_WITH_ANCIENT)
-		MPT_DO_PROBE(result, ProbeFileHeaderMMCMP(file, pfilesize));
-		MPT_DO_PROBE(result, ProbeFileHeaderPP20(file, pfilesize));
-		MPT_DO_PROBE(result, ProbeFileHeaderXPK(file, pfilesize));
+		found = found || tryProbe(CSoundFile::ProbeFileHeaderMMCMP(file, pfilesize), MOD_TYPE_NONE, MOD_CONTAINERTYPE_MMCMP);
+		found = found || tryProbe(CSoundFile::ProbeFileHeaderPP20(file, pfilesize), MOD_TYPE_NONE, MOD_CONTAINERTYPE_PP20);
+		found = found || tryProbe(CSoundFile::ProbeFileHeaderXPK(file, pfilesize), MOD_TYPE_NONE, MOD_CONTAINERTYPE_XPK);
 #endif // !MPT_WITH_ANCIENT
-		MPT_DO_PROBE(result, ProbeFileHeaderUMX(file, pfilesize));
+		found = found || tryProbe(CSoundFile::ProbeFileHeaderUMX(file, pfilesize), MOD_TYPE_NONE, MOD_CONTAINERTYPE_UMX);
 	}
-	if(flags & ProbeModules)
+	if(!found && (flags & CSoundFile::ProbeModules))
 	{
 		for(const auto &format : ModuleFormatLoaders)
 		{
-			if(format.prober != nullptr)
+			if(format.prober == nullptr || (useSignatures && !format.MayMatch(data)))
+				continue;
+			if(tryProbe(format.prober(file, pfilesize), format.type, MOD_CONTAINERTYPE_NONE))
 			{
-				MPT_DO_PROBE(result, format.prober(file, pfilesize));
+				found = true;
+				break;
 			}
 		}
 	}
+	if(found)
+		return result;
 	if(pfilesize)
 	{
-		if((result == ProbeWantMoreData) && (mpt::saturate_cast<std::size_t>(*pfilesize) <= data.size()))
+		if((result.result == CSoundFile::ProbeWantMoreData) && (mpt::saturate_cast<std::size_t>(*pfilesize) <= data.size()))
 		{
 			// If the prober wants more data but we already reached EOF,
 			// probing must fail.
-			result = ProbeFailure;
+			result.result = CSoundFile::ProbeFailure;
 		}
 	} else
 	{
-		if((result == ProbeWantMoreData) && (data.size() >= ProbeRecommendedSize))
+		if((result.result == CSoundFile::ProbeWantMoreData) && (data.size() >= CSoundFile::ProbeRecommendedSize))
 		{
 			// If the prober wants more daat but we already provided the recommended required maximum,
 			// just return success as this is the best we can do for the suggestesd probing size.
-			result = ProbeSuccess;
+			result.result = CSoundFile::ProbeSuccess;
 		}
 	}
 	return result;
 }
 
 
+CSoundFile::ProbeResult CSoundFile::Probe(ProbeFlags flags, mpt::span<const std::byte> data, const uint64 *pfilesize)
+{
+	return ProbeTyped(flags, data, pfilesize, false).result;
+}
+
+
+void CSoundFile::ProbeBatch(ProbeFlags flags, mpt::span<const ProbeBatchItem> items, mpt::span<ProbeBatchResult> results)
+{
+	if(results.size() < items.size())
+	{
+		throw std::out_of_range("");
+	}
+	for(std::size_t i = 0; i < items.size(); i++)
+	{
+		results[i] = ProbeTyped(flags, items[i].data, items[i].pfilesize, true);
+	}
+}
+
+
 bool CSoundFile::Create(FileReader file, ModLoadingFlags loadFlags, CModDoc *pModDoc)
 {
 	m_nMixChannels = 0;
@@ -417,6 +528,18 @@ bool CSoundFile::Create(FileReader file, ModLoadingFlags loadFlags, CModDoc *pMo
 }
 
 
+// Remove everything from a sample that only makes sense with sample data
+static void ResetEmptySample(ModSample &sample)
+{
+	sample.nLength = 0;
+	sample.nLoopStart = 0;
+	sample.nLoopEnd = 0;
+	sample.nSustainStart = 0;
+	sample.nSustainEnd = 0;
+	sample.uFlags.reset(CHN_LOOP | CHN_PINGPONGLOOP | CHN_SUSTAINLOOP | CHN_PINGPONGSUSTAIN);
+}
+
+
 bool CSoundFile::CreateInternal(FileReader file, ModLoadingFlags loadFlags)
 {
 	if(file.IsValid())
@@ -456,6 +579,7 @@ bool CSoundFile::CreateInternal(FileReader file, ModLoadingFlags loadFlags)
 		bool loaderSuccess = false;
 		for(const auto &format : ModuleFormatLoaders)
 		{
+			m_deferredSamples.Clear();
 			loaderSuccess = (this->*(format.loader))(file, loadFlags);
 			if(loaderSuccess)
 				break;
@@ -465,6 +589,7 @@ bool CSoundFile::CreateInternal(FileReader file, ModLoadingFlags loadFlags)
 		{
 			m_nType = MOD_TYPE_NONE;
 			m_ContainerType = MOD_CONTAINERTYPE_NONE;
+			m_deferredSamples.Clear();
 		}
 		if(loadFlags == onlyVerifyHeader)
 		{
@@ -475,6 +600,10 @@ bool CSoundFile::CreateInternal(FileReader file, ModLoadingFlags loadFlags)
 		{
 			m_ContainerType = packedContainerType;
 		}
+		if(loadFlags & onlyMetadata)
+		{
+			return loaderSuccess;
+		}
 
 		m_visitedRows.Initialize(true);
 	} else
@@ -530,14 +659,11 @@ bool CSoundFile::CreateInternal(FileReader file, ModLoadingFlags loadFlags)
 		if(sample.HasSampleData())
 		{
 			sample.PrecomputeLoops(*this, false);
-		} else if(!sample.uFlags[SMP_KEEPONDISK])
+			if(loadFlags & shareSampleData)
+				SamplePool::Share(sample);
+		} else if(!sample.uFlags[SMP_KEEPONDISK] && !m_deferredSamples.IsDeferred(nSmp))
 		{
-			sample.nLength = 0;
-			sample.nLoopStart = 0;
-			sample.nLoopEnd = 0;
-			sample.nSustainStart = 0;
-			sample.nSustainEnd = 0;
-			sample.uFlags.reset(CHN_LOOP | CHN_PINGPONGLOOP | CHN_SUSTAINLOOP | CHN_PINGPONGSUSTAIN);
+			ResetEmptySample(sample);
 		}
 		if(sample.nGlobalVol > 64) sample.nGlobalVol = 64;
 		if(sample.uFlags[CHN_ADLIB] && m_opl == nullptr) InitOPL();
@@ -728,6 +854,7 @@ bool CSoundFile::Destroy()
 	{
 		smp.FreeSample();
 	}
+	m_deferredSamples.Clear();
 	for(auto &ins : Instruments)
 	{
 		delete ins;
@@ -1022,149 +1149,11 @@ void CSoundFile::SetDefaultPlaybackBehaviour(MODTYPE type)
 
 PlayBehaviourSet CSoundFile::GetSupportedPlaybackBehaviour(MODTYPE type)
 {
+	// The lists of supported behaviours are found in FormatSpecialization.h, as the specialized tick processing code depends on them
 	PlayBehaviourSet playBehaviour;
-	switch(type)
+	for(size_t i = 0; i < kMaxPlayBehaviours; i++)
 	{
-	case MOD_TYPE_MPT:
-	case MOD_TYPE_IT:
-		playBehaviour.set(MSF_COMPATIBLE_PLAY);
-		playBehaviour.set(kPeriodsAreHertz);
-		playBehaviour.set(kTempoClamp);
-		playBehaviour.set(kPerChannelGlobalVolSlide);
-		playBehaviour.set(kPanOverride);
-		playBehaviour.set(kITInstrWithoutNote);
-		playBehaviour.set(kITVolColFinePortamento);
-		playBehaviour.set(kITArpeggio);
-		playBehaviour.set(kITOutOfRangeDelay);
-		playBehaviour.set(kITPortaMemoryShare);
-		playBehaviour.set(kITPatternLoopTargetReset);
-		playBehaviour.set(kITFT2PatternLoop);
-		playBehaviour.set(kITPingPongNoReset);
-		playBehaviour.set(kITEnvelopeReset);
-		playBehaviour.set(kITClearOldNoteAfterCut);
-		playBehaviour.set(kITVibratoTremoloPanbrello);
-		playBehaviour.set(kITTremor);
-		playBehaviour.set(kITRetrigger);
-		playBehaviour.set(kITMultiSampleBehaviour);
-		playBehaviour.set(kITPortaTargetReached);
-		playBehaviour.set(kITPatternLoopBreak);
-		playBehaviour.set(kITOffset);
-		playBehaviour.set(kITSwingBehaviour);
-		playBehaviour.set(kITNNAReset);
-		playBehaviour.set(kITSCxStopsSample);
-		playBehaviour.set(kITEnvelopePositionHandling);
-		playBehaviour.set(kITPortamentoInstrument);
-		playBehaviour.set(kITPingPongMode);
-		playBehaviour.set(kITRealNoteMapping);
-		playBehaviour.set(kITHighOffsetNoRetrig);
-		playBehaviour.set(kITFilterBehaviour);
-		playBehaviour.set(kITNoSurroundPan);
-		playBehaviour.set(kITShortSampleRetrig);
-		playBehaviour.set(kITPortaNoNote);
-		playBehaviour.set(kITFT2DontResetNoteOffOnPorta);
-		playBehaviour.set(kITVolColMemory);
-		playBehaviour.set(kITPortamentoSwapResetsPos);
-		playBehaviour.set(kITEmptyNoteMapSlot);
-		playBehaviour.set(kITFirstTickHandling);
-		playBehaviour.set(kITSampleAndHoldPanbrello);
-		playBehaviour.set(kITClearPortaTarget);
-		playBehaviour.set(kITPanbrelloHold);
-		playBehaviour.set(kITPanningReset);
-		playBehaviour.set(kITPatternLoopWithJumps);
-		playBehaviour.set(kITInstrWithNoteOff);
-		playBehaviour.set(kITMultiSampleInstrumentNumber);
-		playBehaviour.set(kRowDelayWithNoteDelay);
-		playBehaviour.set(kITInstrWithNoteOffOldEffects);
-		playBehaviour.set(kITDoNotOverrideChannelPan);
-		playBehaviour.set(kITDCTBehaviour);
-		playBehaviour.set(kITPitchPanSeparation);
-		if(type == MOD_TYPE_MPT)
-		{
-			playBehaviour.set(kOPLFlexibleNoteOff);
-			playBehaviour.set(kOPLwithNNA);
-			playBehaviour.set(kOPLNoteOffOnNoteChange);
-		}
-		break;
-
-	case MOD_TYPE_XM:
-		playBehaviour.set(MSF_COMPATIBLE_PLAY);
-		playBehaviour.set(kFT2VolumeRamping);
-		playBehaviour.set(kTempoClamp);
-		playBehaviour.set(kPerChannelGlobalVolSlide);
-		playBehaviour.set(kPanOverride);
-		playBehaviour.set(kITFT2PatternLoop);
-		playBehaviour.set(kITFT2DontResetNoteOffOnPorta);
-		playBehaviour.set(kFT2Arpeggio);
-		playBehaviour.set(kFT2Retrigger);
-		playBehaviour.set(kFT2VolColVibrato);
-		playBehaviour.set(kFT2PortaNoNote);
-		playBehaviour.set(kFT2KeyOff);
-		playBehaviour.set(kFT2PanSlide);
-		playBehaviour.set(kFT2ST3OffsetOutOfRange);
-		playBehaviour.set(kFT2RestrictXCommand);
-		playBehaviour.set(kFT2RetrigWithNoteDelay);
-		playBehaviour.set(kFT2SetPanEnvPos);
-		playBehaviour.set(kFT2PortaIgnoreInstr);
-		playBehaviour.set(kFT2VolColMemory);
-		playBehaviour.set(kFT2LoopE60Restart);
-		playBehaviour.set(kFT2ProcessSilentChannels);
-		playBehaviour.set(kFT2ReloadSampleSettings);
-		playBehaviour.set(kFT2PortaDelay);
-		playBehaviour.set(kFT2Transpose);
-		playBehaviour.set(kFT2PatternLoopWithJumps);
-		playBehaviour.set(kFT2PortaTargetNoReset);
-		playBehaviour.set(kFT2EnvelopeEscape);
-		playBehaviour.set(kFT2Tremor);
-		playBehaviour.set(kFT2OutOfRangeDelay);
-		playBehaviour.set(kFT2Periods);
-		playBehaviour.set(kFT2PanWithDelayedNoteOff);
-		playBehaviour.set(kFT2VolColDelay);
-		playBehaviour.set(kFT2FinetunePrecision);
-		playBehaviour.set(kFT2NoteOffFlags);
-		playBehaviour.set(kRowDelayWithNoteDelay);
-		playBehaviour.set(kFT2MODTremoloRampWaveform);
-		playBehaviour.set(kFT2PortaUpDownMemory);
-		playBehaviour.set(kFT2PanSustainRelease);
-		playBehaviour.set(kFT2NoteDelayWithoutInstr);
-		playBehaviour.set(kFT2PortaResetDirection);
-		break;
-
-	case MOD_TYPE_S3M:
-		playBehaviour.set(MSF_COMPATIBLE_PLAY);
-		playBehaviour.set(kTempoClamp);
-		playBehaviour.set(kPanOverride);
-		playBehaviour.set(kITPanbrelloHold);
-		playBehaviour.set(kFT2ST3OffsetOutOfRange);
-		playBehaviour.set(kST3NoMutedChannels);
-		playBehaviour.set(kST3PortaSampleChange);
-		playBehaviour.set(kST3EffectMemory);
-		playBehaviour.set(kST3VibratoMemory);
-		playBehaviour.set(KST3PortaAfterArpeggio);
-		playBehaviour.set(kRowDelayWithNoteDelay);
-		playBehaviour.set(kST3OffsetWithoutInstrument);
-		playBehaviour.set(kST3RetrigAfterNoteCut);
-		playBehaviour.set(kST3SampleSwap);
-		playBehaviour.set(kOPLNoteOffOnNoteChange);
-		playBehaviour.set(kApplyUpperPeriodLimit);
-		break;
-
-	case MOD_TYPE_MOD:
-		playBehaviour.set(kMODVBlankTiming);
-		playBehaviour.set(kMODOneShotLoops);
-		playBehaviour.set(kMODIgnorePanning);
-		playBehaviour.set(kMODSampleSwap);
-		playBehaviour.set(kMODOutOfRangeNoteDelay);
-		playBehaviour.set(kMODTempoOnSecondTick);
-		playBehaviour.set(kRowDelayWithNoteDelay);
-		playBehaviour.set(kFT2MODTremoloRampWaveform);
-		break;
-
-	default:
-		playBehaviour.set(MSF_COMPATIBLE_PLAY);
-		playBehaviour.set(kPeriodsAreHertz);
-		playBehaviour.set(kTempoClamp);
-		playBehaviour.set(kPanOverride);
-		break;
+		playBehaviour.set(i, IsPlayBehaviourSupported(type, static_cast<PlayBehaviour>(i)));
 	}
 	return playBehaviour;
 }
@@ -1234,6 +1223,35 @@ PlayBehaviourSet CSoundFile::GetDefaultPlaybackBehaviour(MODTYPE type)
 }
 
 
+void CSoundFile::UpdateFormatSpecialization()
+{
+	m_specializationCheckedType = GetType();
+	m_specializationCheckedBehaviour = m_playBehaviour;
+	m_specializedType = MOD_TYPE_NONE;
+	switch(GetType())
+	{
+	case MOD_TYPE_MOD:
+	case MOD_TYPE_S3M:
+	case MOD_TYPE_XM:
+	case MOD_TYPE_IT:
+	case MOD_TYPE_MPT:
+		m_specializedType = GetType();
+		for(size_t i = 0; i < kMaxPlayBehaviours; i++)
+		{
+			// The specialized code assumes that impossible behaviours are disabled, which may not be true if the module type was changed in the tracker
+			if(m_playBehaviour[i] && !IsPlayBehaviourPossible(GetType(), static_cast<PlayBehaviour>(i)))
+			{
+				m_specializedType = MOD_TYPE_NONE;
+				break;
+			}
+		}
+		break;
+	default:
+		break;
+	}
+}
+
+
 MODTYPE CSoundFile::GetBestSaveFormat() const
 {
 	switch(GetType())
@@ -1464,6 +1482,7 @@ bool CSoundFile::DestroySample(SAMPLEINDEX nSample)
 	{
 		return false;
 	}
+	m_deferredSamples.Remove(nSample);
 	if(!Samples[nSample].HasSampleData())
 	{
 		return true;
@@ -1500,6 +1519,49 @@ bool CSoundFile::DestroySampleThreadsafe(SAMPLEINDEX nSample)
 }
 
 
+bool CSoundFile::DecodeDeferredSample(SAMPLEINDEX smp)
+{
+	if(!m_deferredSamples.IsDeferred(smp))
+	{
+		return false;
+	}
+	ModSample &sample = Samples[smp];
+	if(m_deferredSamples.Decode(smp, sample) && sample.HasSampleData())
+	{
+		sample.PrecomputeLoops(*this, false);
+		return true;
+	}
+	// Same as for samples without data when loading the module
+	sample.FreeSample();
+	ResetEmptySample(sample);
+	return false;
+}
+
+
+void CSoundFile::DecodeDeferredSamples()
+{
+	for(SAMPLEINDEX smp = 1; smp <= GetNumSamples() && HasDeferredSamples(); smp++)
+	{
+		DecodeDeferredSample(smp);
+	}
+}
+
+
+void CSoundFile::PrepareSampleForPlayback(const ModSample &sample) const
+{
+	if(m_deferredSamples.empty() || std::less<const ModSample *>()(&sample, Samples) || !std::less<const ModSample *>()(&sample, Samples + MAX_SAMPLES))
+	{
+		return;
+	}
+	const SAMPLEINDEX smp = static_cast<SAMPLEINDEX>(&sample - Samples);
+	if(m_deferredSamples.IsDeferred(smp))
+	{
+		// Only the sample data itself changes, which is why this is allowed while playing.
+		const_cast<CSoundFile *>(this)->DecodeDeferredSample(smp);
+	}
+}
+
+
 std::unique_ptr<CTuning> CSoundFile::CreateTuning12TET(const mpt::ustring &name)
 {
 	std::unique_ptr<CTuning> pT = CTuning::CreateGeometric(name, 12, 2, 15);
@@ -1514,7 +1576,7 @@ std::unique_ptr<CTuning> CSoundFile::CreateTuning12TET(const mpt::ustring &name)
 mpt::ustring CSoundFile::GetNoteName(const ModCommand::NOTE note, const INSTRUMENTINDEX inst) const
 {
 	// For MPTM instruments with custom tuning, find the appropriate note name. Else, use default note names.
-	if(ModCommand::IsNote(note) && GetType() == MOD_TYPE_MPT && inst >= 1 && inst <= GetNumInstruments() && Instruments[inst] && Instruments[inst]->pTuning)
+	if(HasCustomNoteName(note, inst))
 	{
 		return Instruments[inst]->pTuning->GetNoteName(note - NOTE_MIDDLEC);
 	} else
@@ -1531,25 +1593,43 @@ mpt::ustring CSoundFile::GetNoteName(const ModCommand::NOTE note) const
 
 
 mpt::ustring CSoundFile::GetNoteName(const ModCommand::NOTE note, const NoteName *noteNames)
+{
+	char name[3];
+	GetNoteName(note, noteNames, name);
+	return mpt::ustring(std::begin(name), std::end(name));
+}
+
+
+bool CSoundFile::HasCustomNoteName(const ModCommand::NOTE note, const INSTRUMENTINDEX inst) const
+{
+	return ModCommand::IsNote(note) && GetType() == MOD_TYPE_MPT && inst >= 1 && inst <= GetNumInstruments() && Instruments[inst] && Instruments[inst]->pTuning;
+}
+
+
+void CSoundFile::GetNoteName(const ModCommand::NOTE note, char (&name)[3]) const
+{
+	GetNoteName(note, m_NoteNames, name);
+}
+
+
+void CSoundFile::GetNoteName(const ModCommand::NOTE note, const NoteName *noteNames, char (&name)[3])
 {
 	if(ModCommand::IsSpecialNote(note))
 	{
-		// cppcheck false-positive
-		// cppcheck-suppress constStatement
-		const mpt::uchar specialNoteNames[][4] = { UL_("PCs"), UL_("PC "), UL_("~~~"), UL_("^^^"), UL_("===") };
+		static constexpr char specialNoteNames[][4] = { "PCs", "PC ", "~~~", "^^^", "===" };
 		static_assert(mpt::array_size<decltype(specialNoteNames)>::size == NOTE_MAX_SPECIAL - NOTE_MIN_SPECIAL + 1);
-		return specialNoteNames[note - NOTE_MIN_SPECIAL];
+		std::copy(specialNoteNames[note - NOTE_MIN_SPECIAL], specialNoteNames[note - NOTE_MIN_SPECIAL] + 3, name);
 	} else if(ModCommand::IsNote(note))
 	{
-		return mpt::ustring()
-			.append(noteNames[(note - NOTE_MIN) % 12])
-			.append(1, UC_('0') + (note - NOTE_MIN) / 12)
-			;	// e.g. "C#" + "5"
-	} else if(note == NOTE_NONE)
+		// e.g. "C#" + "5"
+		name[0] = static_cast<char>(noteNames[(note - NOTE_MIN) % 12][0]);
+		name[1] = static_cast<char>(noteNames[(note - NOTE_MIN) % 12][1]);
+		name[2] = static_cast<char>('0' + (note - NOTE_MIN) / 12);
+	} else
 	{
-		return UL_("...");
+		const char c = (note == NOTE_NONE) ? '.' : '?';
+		name[0] = name[1] = name[2] = c;
 	}
-	return UL_("???");
 }
 
 
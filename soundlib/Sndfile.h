@@ -20,8 +20,10 @@
 #include "../common/version.h"
 #include <vector>
 #include <bitset>
+#include <map>
 #include <set>
 #include "Snd_defs.h"
+#include "FormatSpecialization.h"
 #include "tuningbase.h"
 #include "MIDIMacros.h"
 #ifdef MODPLUG_TRACKER
@@ -29,7 +31,12 @@
 #endif // MODPLUG_TRACKER
 
 #include "Mixer.h"
+#include "MixerInterface.h"
 #include "Resampler.h"
+#include "ResonantFilterCache.h"
+#include "DeferredSamples.h"
+#include "MixerThreads.h"
+#include "RenderProfiler.h"
 #ifndef NO_REVERB
 #include "../sounddsp/Reverb.h"
 #endif
@@ -48,6 +55,7 @@
 #include "ModInstrument.h"
 #include "ModChannel.h"
 #include "plugins/PluginStructs.h"
+#include "plugins/PluginGraph.h"
 #include "RowVisitor.h"
 #include "Message.h"
 #include "pattern.h"
@@ -81,6 +89,9 @@ void AMSUnpack(const int8 * const source, size_t sourceSize, void * const dest,
 uintptr_t DMFUnpack(FileReader &file, uint8 *psample, uint32 maxlen);
 
 
+class GetLengthMemory;
+
+
 #ifdef LIBOPENMPT_BUILD
 #ifndef NO_PLUGINS
 class CVstPluginManager;
@@ -218,6 +229,62 @@ enum enmGetLengthResetMode
 };
 
 
+// Song state snapshots recorded by GetLength() while seeking.
+// Seeking to a later position can then resume from the nearest earlier snapshot instead of evaluating the song from its start again.
+// The song state at the end of the last seek is always kept, so that seeking forward continues from there even if no snapshots are recorded.
+class GetLengthCheckpoints
+{
+	friend class CSoundFile;
+
+public:
+	GetLengthCheckpoints();
+	~GetLengthCheckpoints();
+
+	// Minimum song time in seconds between two snapshots. 0 disables recording and using snapshots.
+	void SetInterval(double interval);
+	double GetInterval() const noexcept { return m_interval; }
+	// Approximate amount of memory (in bytes) that may be used for snapshots. If it is exceeded, every other snapshot is discarded.
+	void SetMemoryLimit(std::size_t limit);
+	std::size_t GetMemoryLimit() const noexcept { return m_memoryLimit; }
+
+	std::size_t GetNumCheckpoints() const noexcept { return m_checkpoints.size(); }
+	std::size_t GetMemoryUsage() const noexcept { return m_memoryUsage; }
+	void Clear() noexcept;
+
+protected:
+	struct Checkpoint;
+
+	// Everything that influences the song walk apart from the module itself
+	struct Key
+	{
+		SEQUENCEINDEX sequence = SEQUENCEINDEX_INVALID;
+		ORDERINDEX startOrder = ORDERINDEX_INVALID;
+		ROWINDEX startRow = ROWINDEX_INVALID;
+		bool sampleSync = false;
+		uint32 mixingFreq = 0, tempoFactor = 0, freqFactor = 0;
+
+		bool operator==(const Key &other) const noexcept
+		{
+			return sequence == other.sequence && startOrder == other.startOrder && startRow == other.startRow && sampleSync == other.sampleSync
+				&& mixingFreq == other.mixingFreq && tempoFactor == other.tempoFactor && freqFactor == other.freqFactor;
+		}
+	};
+
+	void SetKey(const Key &key);
+	double GetNextCheckpointTime() const noexcept;
+	void Add(std::unique_ptr<Checkpoint> checkpoint);
+	void ThinOut() noexcept;
+
+	std::vector<std::unique_ptr<Checkpoint>> m_checkpoints;  // Sorted by song time
+	std::unique_ptr<Checkpoint> m_resumePoint;              // Where the last seek ended, not counted towards the memory limit
+	Key m_key;
+	double m_interval = 0.0;
+	double m_spacing = 0.0;  // Current spacing between snapshots, grows if snapshots have to be thinned out
+	std::size_t m_memoryLimit = 64 * 1024 * 1024;
+	std::size_t m_memoryUsage = 0;
+};
+
+
 // Delete samples assigned to instrument
 enum deleteInstrumentSamples
 {
@@ -380,6 +447,11 @@ public:
 	mpt::ustring GetNoteName(const ModCommand::NOTE note, const INSTRUMENTINDEX inst) const;
 	mpt::ustring GetNoteName(const ModCommand::NOTE note) const;
 	static mpt::ustring GetNoteName(const ModCommand::NOTE note, const NoteName *noteNames);
+	// Returns true if the note name is provided by the instrument's custom tuning, in which case it can have any length
+	bool HasCustomNoteName(const ModCommand::NOTE note, const INSTRUMENTINDEX inst) const;
+	// Non-allocating variants for all other notes, whose names are always three ASCII characters long
+	void GetNoteName(const ModCommand::NOTE note, char (&name)[3]) const;
+	static void GetNoteName(const ModCommand::NOTE note, const NoteName *noteNames, char (&name)[3]);
 #ifdef MODPLUG_TRACKER
 public:
 	static void SetDefaultNoteNames();
@@ -419,6 +491,16 @@ private:
 public:
 	MixerSettings m_MixerSettings;
 	CResampler m_Resampler;
+	const MixFuncInterface *m_MixFuncTable = nullptr;  // Sample mixing functions, depending on available CPU features
+	mutable ResonantFilterCache m_filterCache;         // Channel filter coefficients, reset when the mixer settings change
+#ifndef NO_RENDER_PROFILING
+	RenderProfiler m_RenderProfiler;                   // Where the rendering time goes, for libopenmpt's profiling extension
+#endif // NO_RENDER_PROFILING
+private:
+#ifdef MPT_ENABLE_MIXER_THREADS
+	std::unique_ptr<MixerThreads> m_mixerThreads;  // Only present if sample channels are mixed on more than one thread
+#endif // MPT_ENABLE_MIXER_THREADS
+public:
 #ifndef NO_REVERB
 	mixsample_t ReverbSendBuffer[MIXBUFFERSIZE * 2];
 	mixsample_t m_RvbROfsVol = 0, m_RvbLOfsVol = 0;
@@ -496,12 +578,17 @@ public:
 	ModSequenceSet Order;  // Pattern sequences (order lists)
 protected:
 	ModSample Samples[MAX_SAMPLES];
+	DeferredSamples m_deferredSamples;  // Samples that have not been decoded yet (see deferSampleData)
+	uint32 m_loaderThreads = 1;
 public:
 	ModInstrument *Instruments[MAX_INSTRUMENTS];  // Instrument Headers
 	MIDIMacroConfig m_MidiCfg;                    // MIDI Macro config table
 #ifndef NO_PLUGINS
 	std::array<SNDMIXPLUGIN, MAX_MIXPLUGINS> m_MixPlugins;  // Mix plugins
 	uint32 m_loadedPlugins = 0;                             // Not a PLUGINDEX because number of loaded plugins may exceed MAX_MIXPLUGINS during MIDI conversion
+private:
+	PluginGraph m_pluginGraph;  // Routing of m_MixPlugins, compiled again whenever it changes
+public:
 #endif
 	mpt::charbuf<MAX_SAMPLENAME> m_szNames[MAX_SAMPLES];  // Sample names
 
@@ -511,6 +598,10 @@ public:
 	PlayBehaviourSet m_playBehaviour;
 
 protected:
+	// Which tick processing code to use, see CallWithFormatSpecialization
+	MODTYPE m_specializedType = MOD_TYPE_NONE;  // Format whose specialized code can be used, or MOD_TYPE_NONE for the generic code
+	MODTYPE m_specializationCheckedType = MOD_TYPE_NONE;
+	PlayBehaviourSet m_specializationCheckedBehaviour;
 
 	mpt::fast_prng m_PRNG;
 	inline mpt::fast_prng & AccessPRNG() const { return const_cast<CSoundFile*>(this)->m_PRNG; }
@@ -586,6 +677,9 @@ public:
 	public:
 		PlayState();
 
+		// Copy everything apart from the background channels and the mix channel list, which are not touched when walking through the song.
+		void CopySongState(const PlayState &other, CHANNELINDEX numChannels);
+
 		void ResetGlobalVolumeRamping()
 		{
 			m_lHighResRampingGlobalVolume = m_nGlobalVolume << VOLUMERAMPPRECISION;
@@ -605,6 +699,9 @@ public:
 protected:
 	// For handling backwards jumps and stuff to prevent infinite loops when counting the mod length or rendering to wav.
 	RowVisitor m_visitedRows;
+	// Song walk state of GetLength(), kept between calls so that its memory doesn't have to be allocated again every time.
+	std::unique_ptr<PlayState> m_songWalkState;
+	std::unique_ptr<RowVisitor> m_songWalkRows;
 
 public:
 #ifdef MODPLUG_TRACKER
@@ -688,6 +785,9 @@ public:
 		loadPluginInstance = 0x08, // If unset, plugins are not instanciated.
 		skipContainer      = 0x10,
 		skipModules        = 0x20,
+		deferSampleData    = 0x40, // If set along with loadSampleData, loaders that support it only keep a copy of the encoded sample data and decode it when the sample is first played
+		shareSampleData    = 0x80, // If set, sample data is shared with identical samples of other modules through the SamplePool. The sample data must not be edited afterwards.
+		onlyMetadata       = 0x100, // If set instead of any of the flags above, only the module header, sample / instrument headers and song message are read. The module is not prepared for playback.
 
 		// Shortcuts
 		loadCompleteModule = loadSampleData | loadPatternData | loadPluginData | loadPluginInstance,
@@ -719,6 +819,25 @@ public:
 
 	static ProbeResult Probe(ProbeFlags flags, mpt::span<const std::byte> data, const uint64 *pfilesize);
 
+	struct ProbeBatchItem
+	{
+		mpt::span<const std::byte> data;
+		const uint64 *pfilesize = nullptr;
+	};
+
+	struct ProbeBatchResult
+	{
+		ProbeResult result = ProbeFailure;
+		// Module type that the matching loader produces. May be MOD_TYPE_NONE if the result was not ProbeSuccess,
+		// if a container matched or if the final type can only be determined by loading the file (e.g. MO3 and GDM).
+		MODTYPE type = MOD_TYPE_NONE;
+		MODCONTAINERTYPE containerType = MOD_CONTAINERTYPE_NONE;
+	};
+
+	// Probes several file headers at once. Each result is identical to calling Probe() on the same item,
+	// but formats whose magic bytes do not match are not probed at all if enough data is provided.
+	static void ProbeBatch(ProbeFlags flags, mpt::span<const ProbeBatchItem> items, mpt::span<ProbeBatchResult> results);
+
 public:
 
 #ifdef MODPLUG_TRACKER
@@ -727,12 +846,33 @@ public:
 #endif  // MODPLUG_TRACKER
 
 	bool Create(FileReader file, ModLoadingFlags loadFlags = loadCompleteModule, CModDoc *pModDoc = nullptr);
+	// Loaders that support it decode independent samples on up to numThreads threads (0 = one per hardware thread).
+	void SetLoaderThreads(uint32 numThreads) { m_loaderThreads = numThreads; }
+	uint32 GetLoaderThreads() const { return m_loaderThreads; }
 private:
 	bool CreateInternal(FileReader file, ModLoadingFlags loadFlags);
 
 public:
 	bool Destroy();
 	Enum<MODTYPE> GetType() const noexcept { return m_nType; }
+	// Module type as seen by tick processing code that may be specialized for a format (see FormatSpecialization.h)
+	template <typename TFormat>
+	MPT_FORCEINLINE Enum<MODTYPE> GetType() const noexcept
+	{
+		if constexpr(TFormat::type != MOD_TYPE_NONE)
+			return Enum<MODTYPE>(TFormat::type);
+		else
+			return m_nType;
+	}
+	// Play behaviour as seen by tick processing code that may be specialized for a format. Behaviours that are impossible for the format are known to be disabled at compile time.
+	template <typename TFormat, PlayBehaviour behaviour>
+	MPT_FORCEINLINE bool PlayBehaviourEnabled() const noexcept
+	{
+		if constexpr(TFormat::type != MOD_TYPE_NONE && !IsPlayBehaviourPossible(TFormat::type, behaviour))
+			return false;
+		else
+			return m_playBehaviour[behaviour];
+	}
 
 	MODCONTAINERTYPE GetContainerType() const noexcept { return m_ContainerType; }
 
@@ -800,7 +940,13 @@ public:
 	constexpr bool IsFirstTick() const noexcept { return (m_PlayState.m_lTotalSampleCount == 0); }
 
 	// Get song duration in various cases: total length, length to specific order & row, etc.
-	std::vector<GetLengthType> GetLength(enmGetLengthResetMode adjustMode, GetLengthTarget target = GetLengthTarget());
+	// If checkpoints are provided, seeking in adjust mode records song state snapshots and resumes from them in subsequent calls.
+	std::vector<GetLengthType> GetLength(enmGetLengthResetMode adjustMode, GetLengthTarget target = GetLengthTarget(), GetLengthCheckpoints *checkpoints = nullptr);
+	// Get all sub songs of every sequence, as GetLength(eNoAdjust, GetLengthTarget(true).StartPos(seq, 0, 0)) would for each sequence, indexed by sequence.
+	// The sequences are walked concurrently on up to numThreads threads (0 = one per hardware thread). The results do not depend on the number of threads.
+	std::vector<std::vector<GetLengthType>> GetSubsongsOfAllSequences(uint32 numThreads) const;
+protected:
+	std::vector<GetLengthType> WalkSong(enmGetLengthResetMode adjustMode, GetLengthTarget target, GetLengthCheckpoints *checkpoints, GetLengthMemory &memory, RowVisitor &visitedRows) const;
 
 public:
 	void RecalculateSamplesPerTick();
@@ -990,12 +1136,17 @@ public:
 		);
 	samplecount_t ReadOneTick();
 private:
-	void CreateStereoMix(int count);
+	bool CreateStereoMix(int count);
+#ifdef MPT_ENABLE_MIXER_THREADS
+	bool CreateStereoMixParallel(int count, bool &silent);
+#endif // MPT_ENABLE_MIXER_THREADS
+	mixsample_t *PrepareChannelMixBuffer(CHANNELINDEX nChn, const ModChannel &chn, int count, mixsample_t *&pOfsR, mixsample_t *&pOfsL, PLUGINDEX &nMixPlugin);
+	bool MixChannel(ModChannel &chn, mixsample_t *pbuffer, mixsample_t &ofsR, mixsample_t &ofsL, int count, bool tooManyChannels);
 public:
 	bool FadeSong(uint32 msec);
 private:
-	void ProcessDSP(uint32 countChunk);
-	void ProcessPlugins(uint32 nCount);
+	void ProcessDSP(uint32 countChunk, bool mixBufferSilent);
+	void ProcessPlugins(uint32 nCount, bool &mixBufferSilent);
 	void ProcessInputChannels(IAudioSource &source, std::size_t countChunk);
 public:
 	samplecount_t GetTotalSampleCount() const { return m_PlayState.m_lTotalSampleCount; }
@@ -1008,6 +1159,9 @@ public:
 	// Mixer Config
 	void SetMixerSettings(const MixerSettings &mixersettings);
 	void SetResamplerSettings(const CResamplerSettings &resamplersettings);
+	// Mix sample channels on up to numThreads threads (0 = one per hardware thread). Output does not depend on the number of threads.
+	void SetMixerThreads(uint32 numThreads);
+	uint32 GetMixerThreads() const;
 	void InitPlayer(bool bReset=false);
 	void SetDspEffects(uint32 DSPMask);
 	uint32 GetSampleRate() const { return m_MixerSettings.gdwMixingFreq; }
@@ -1018,12 +1172,39 @@ public:
 	bool ReadNote();
 	bool ProcessRow();
 	bool ProcessEffects();
+protected:
+	void UpdateFormatSpecialization();
+
+	// Calls func with an instance of the most specific format type (see FormatSpecialization.h) that can be used for the current module
+	template <typename TFunc>
+	MPT_FORCEINLINE auto CallWithFormatSpecialization(TFunc &&func)
+	{
+		// Modules may change their type or behaviour flags at any time in the tracker, so this is checked on every call.
+		if(m_nType != m_specializationCheckedType || m_playBehaviour != m_specializationCheckedBehaviour)
+			UpdateFormatSpecialization();
+		switch(m_specializedType)
+		{
+		case MOD_TYPE_MOD: return func(SpecificFormat<MOD_TYPE_MOD>{});
+		case MOD_TYPE_S3M: return func(SpecificFormat<MOD_TYPE_S3M>{});
+		case MOD_TYPE_XM: return func(SpecificFormat<MOD_TYPE_XM>{});
+		case MOD_TYPE_IT: return func(SpecificFormat<MOD_TYPE_IT>{});
+		case MOD_TYPE_MPT: return func(SpecificFormat<MOD_TYPE_MPT>{});
+		default: return func(AnyFormat{});
+		}
+	}
+	template <typename TFormat>
+	bool ReadNoteImpl();
+	template <typename TFormat>
+	bool ProcessEffectsImpl();
+public:
 	std::pair<bool, bool> NextRow(PlayState &playState, const bool breakRow) const;
 	void SetupNextRow(PlayState &playState, const bool patternLoop) const;
 	CHANNELINDEX GetNNAChannel(CHANNELINDEX nChn) const;
 	CHANNELINDEX CheckNNA(CHANNELINDEX nChn, uint32 instr, int note, bool forceCut);
 	void NoteChange(ModChannel &chn, int note, bool bPorta = false, bool bResetEnv = true, bool bManual = false, CHANNELINDEX channelHint = CHANNELINDEX_INVALID) const;
 	void InstrumentChange(ModChannel &chn, uint32 instr, bool bPorta = false, bool bUpdVol = true, bool bResetEnv = true) const;
+	// Decode the sample data of a sample that is about to be played if it has been deferred
+	void PrepareSampleForPlayback(const ModSample &sample) const;
 	void ApplyInstrumentPanning(ModChannel &chn, const ModInstrument *instr, const ModSample *smp) const;
 	uint32 CalculateXParam(PATTERNINDEX pat, ROWINDEX row, CHANNELINDEX chn, uint32 *extendedRows = nullptr) const;
 
@@ -1034,6 +1215,7 @@ public:
 	void SetSpeed(PlayState &playState, uint32 param) const;
 	static TEMPO ConvertST2Tempo(uint8 tempo);
 
+	template <typename TFormat = AnyFormat>
 	void ProcessRamping(ModChannel &chn) const;
 
 protected:
@@ -1043,28 +1225,43 @@ protected:
 	void InitializeChannels();
 
 	// Channel effect processing
+	template <typename TFormat = AnyFormat>
 	int GetVibratoDelta(int type, int position) const;
 
+	template <typename TFormat = AnyFormat>
 	void ProcessVolumeSwing(ModChannel &chn, int &vol) const;
+	template <typename TFormat = AnyFormat>
 	void ProcessPanningSwing(ModChannel &chn) const;
+	template <typename TFormat = AnyFormat>
 	void ProcessTremolo(ModChannel &chn, int &vol) const;
+	template <typename TFormat = AnyFormat>
 	void ProcessTremor(CHANNELINDEX nChn, int &vol);
 
+	template <typename TFormat = AnyFormat>
 	bool IsEnvelopeProcessed(const ModChannel &chn, EnvelopeType env) const;
+	template <typename TFormat = AnyFormat>
 	void ProcessVolumeEnvelope(ModChannel &chn, int &vol) const;
+	template <typename TFormat = AnyFormat>
 	void ProcessPanningEnvelope(ModChannel &chn) const;
+	template <typename TFormat = AnyFormat>
 	int ProcessPitchFilterEnvelope(ModChannel &chn, int32 &period) const;
 
+	template <typename TFormat = AnyFormat>
 	void IncrementEnvelopePosition(ModChannel &chn, EnvelopeType envType) const;
+	template <typename TFormat = AnyFormat>
 	void IncrementEnvelopePositions(ModChannel &chn) const;
 
 	void ProcessInstrumentFade(ModChannel &chn, int &vol) const;
 
 	static void ProcessPitchPanSeparation(int32 &pan, int note, const ModInstrument &instr);
+	template <typename TFormat = AnyFormat>
 	void ProcessPanbrello(ModChannel &chn) const;
 
+	template <typename TFormat = AnyFormat>
 	void ProcessArpeggio(CHANNELINDEX nChn, int32 &period, Tuning::NOTEINDEXTYPE &arpeggioSteps);
+	template <typename TFormat = AnyFormat>
 	void ProcessVibrato(CHANNELINDEX nChn, int32 &period, Tuning::RATIOTYPE &vibratoFactor);
+	template <typename TFormat = AnyFormat>
 	void ProcessSampleAutoVibrato(ModChannel &chn, int32 &period, Tuning::RATIOTYPE &vibratoFactor, int &nPeriodFrac) const;
 
 	std::pair<SamplePosition, uint32> GetChannelIncrement(const ModChannel &chn, uint32 period, int periodFrac) const;
@@ -1125,12 +1322,19 @@ protected:
 
 	void ProcessMacroOnChannel(CHANNELINDEX nChn);
 	void ProcessMIDIMacro(PlayState &playState, CHANNELINDEX nChn, bool isSmooth, const MIDIMacroConfigData::Macro &macro, uint8 param = 0, PLUGINDEX plugin = 0);
+	void EvaluateMIDIMacro(PlayState &playState, CHANNELINDEX nChn, const MIDIMacroConfigData::Macro &macro, uint8 param) const;
 	void ParseMIDIMacro(PlayState &playState, CHANNELINDEX nChn, bool isSmooth, const mpt::span<const char> macro, mpt::span<uint8> &out, uint8 param = 0, PLUGINDEX plugin = 0) const;
 	static float CalculateSmoothParamChange(const PlayState &playState, float currentValue, float param);
 	void SendMIDIData(PlayState &playState, CHANNELINDEX nChn, bool isSmooth, const mpt::span<const uint8> macro, PLUGINDEX plugin);
+	void EvaluateMIDIData(PlayState &playState, CHANNELINDEX nChn, bool isSmooth, const mpt::span<const uint8> macro, PLUGINDEX plugin) const;
+	int ProcessChannelMIDIData(PlayState &playState, CHANNELINDEX nChn, bool isSmooth, const mpt::span<const uint8> macro) const;
+#ifndef NO_PLUGINS
+	PLUGINDEX GetMIDIDataPlugin(const PlayState &playState, CHANNELINDEX nChn, const mpt::span<const uint8> macro, PLUGINDEX plugin) const;
+#endif // NO_PLUGINS
 	void SendMIDINote(CHANNELINDEX chn, uint16 note, uint16 volume);
 
 	int SetupChannelFilter(ModChannel &chn, bool bReset, int envModifier = 256) const;
+	ResonantFilterCoefficients CalculateFilterCoefficients(int cutoff, int resonance, int envModifier) const;
 
 	// Low-Level effect processing
 	void DoFreqSlide(ModChannel &chn, int32 &period, int32 amount, bool isTonePorta = false) const;
@@ -1171,6 +1375,14 @@ public:
 	bool DestroySample(SAMPLEINDEX nSample);
 	bool DestroySampleThreadsafe(SAMPLEINDEX nSample);
 
+	// Check if the sample data of a sample has not been decoded yet because the module was loaded with deferSampleData.
+	bool IsSampleDeferred(SAMPLEINDEX smp) const { return m_deferredSamples.IsDeferred(smp); }
+	bool HasDeferredSamples() const { return !m_deferredSamples.empty(); }
+	// Decode the sample data of a deferred sample. Returns false if the sample was not deferred or could not be decoded.
+	bool DecodeDeferredSample(SAMPLEINDEX smp);
+	// Decode the sample data of all deferred samples, e.g. before the sample data is accessed directly.
+	void DecodeDeferredSamples();
+
 	// Find an unused sample slot. If it is going to be assigned to an instrument, targetInstrument should be specified.
 	// SAMPLEINDEX_INVLAID is returned if no free sample slot could be found.
 	SAMPLEINDEX GetNextFreeSample(INSTRUMENTINDEX targetInstrument = INSTRUMENTINDEX_INVALID, SAMPLEINDEX start = 1) const;
@@ -1259,7 +1471,7 @@ public:
 	void ProcessMidiOut(CHANNELINDEX nChn);
 #endif // NO_PLUGINS
 
-	void ProcessGlobalVolume(long countChunk);
+	void ProcessGlobalVolume(long countChunk, bool mixBufferSilent);
 	void ProcessStereoSeparation(long countChunk);
 
 private:
@@ -14,6 +14,7 @@
 #include "Sndfile.h"
 #include "MixerLoops.h"
 #include "MIDIEvents.h"
+#include "MixFuncTable.h"
 #include "Tables.h"
 #ifdef MODPLUG_TRACKER
 #include "../mptrack/TrackerSettings.h"
@@ -59,6 +60,7 @@ void CSoundFile::SetMixerSettings(const MixerSettings &mixersettings)
 		(mixersettings.MixerFlags != m_MixerSettings.MixerFlags))
 		reset = true;
 	m_MixerSettings = mixersettings;
+	m_filterCache.Reset();
 	InitPlayer(reset);
 }
 
@@ -80,6 +82,7 @@ void CSoundFile::InitPlayer(bool bReset)
 		m_surroundLOfsVol = m_surroundROfsVol = 0;
 		InitAmigaResampler();
 	}
+	m_MixFuncTable = MixFuncTable::GetFunctions();
 	m_Resampler.UpdateTables();
 #ifndef NO_REVERB
 	m_Reverb.Initialize(bReset, m_RvbROfsVol, m_RvbLOfsVol, m_MixerSettings.gdwMixingFreq);
@@ -228,6 +231,7 @@ CSoundFile::samplecount_t CSoundFile::Read(samplecount_t count, IAudioTarget &ta
 		// Update Channel Data
 		if(!m_PlayState.m_nBufferCount)
 		{
+			MPT_PROFILE_RENDER_STAGE(m_RenderProfiler, stageReadNote);
 			// Last tick or fade completely processed, find out what to do next
 
 			if(m_SongFlags[SONG_FADINGSONG])
@@ -307,42 +311,55 @@ CSoundFile::samplecount_t CSoundFile::Read(samplecount_t count, IAudioTarget &ta
 			inputMonitor->get().Process(mpt::audio_span_planar<const mixsample_t>(buffers, m_MixerSettings.NumInputChannels, countChunk));
 		}
 
-		CreateStereoMix(countChunk);
+		// As long as this is set, the front and rear mix buffers are known to contain only silence,
+		// so any processing that would not change them can be skipped.
+		bool mixBufferSilent;
+		{
+			MPT_PROFILE_RENDER_STAGE(m_RenderProfiler, stageCreateStereoMix);
+			mixBufferSilent = CreateStereoMix(countChunk);
+		}
 
 		if(m_opl)
 		{
+			MPT_PROFILE_RENDER_STAGE(m_RenderProfiler, stageOPL);
 			m_opl->Mix(MixSoundBuffer, countChunk, m_OPLVolumeFactor * m_nVSTiVolume / 48);
+			mixBufferSilent = false;
 		}
 
 #ifndef NO_REVERB
-		m_Reverb.Process(MixSoundBuffer, ReverbSendBuffer, m_RvbROfsVol, m_RvbLOfsVol, countChunk);
+		{
+			MPT_PROFILE_RENDER_STAGE(m_RenderProfiler, stageReverb);
+			m_Reverb.Process(MixSoundBuffer, ReverbSendBuffer, m_RvbROfsVol, m_RvbLOfsVol, countChunk, mixBufferSilent);
+		}
 #endif  // NO_REVERB
 
 #ifndef NO_PLUGINS
 		if(m_loadedPlugins)
 		{
-			ProcessPlugins(countChunk);
+			MPT_PROFILE_RENDER_STAGE(m_RenderProfiler, stagePlugins);
+			ProcessPlugins(countChunk, mixBufferSilent);
 		}
 #endif  // NO_PLUGINS
 
-		if(m_MixerSettings.gnChannels == 1)
+		if(m_MixerSettings.gnChannels == 1 && !mixBufferSilent)
 		{
 			MonoFromStereo(MixSoundBuffer, countChunk);
 		}
 
 		if(m_PlayConfig.getGlobalVolumeAppliesToMaster())
 		{
-			ProcessGlobalVolume(countChunk);
+			ProcessGlobalVolume(countChunk, mixBufferSilent);
 		}
 
-		if(m_MixerSettings.m_nStereoSeparation != MixerSettings::StereoSeparationScale)
+		if(m_MixerSettings.m_nStereoSeparation != MixerSettings::StereoSeparationScale && !mixBufferSilent)
 		{
 			ProcessStereoSeparation(countChunk);
 		}
 
 		if(m_MixerSettings.DSPMask)
 		{
-			ProcessDSP(countChunk);
+			MPT_PROFILE_RENDER_STAGE(m_RenderProfiler, stageDSP);
+			ProcessDSP(countChunk, mixBufferSilent);
 		}
 
 		if(m_MixerSettings.gnChannels == 4)
@@ -355,7 +372,10 @@ CSoundFile::samplecount_t CSoundFile::Read(samplecount_t count, IAudioTarget &ta
 			outputMonitor->get().Process(mpt::audio_span_interleaved<const mixsample_t>(MixSoundBuffer, m_MixerSettings.gnChannels, countChunk));
 		}
 
-		target.Process(mpt::audio_span_interleaved<mixsample_t>(MixSoundBuffer, m_MixerSettings.gnChannels, countChunk));
+		{
+			MPT_PROFILE_RENDER_STAGE(m_RenderProfiler, stageOutput);
+			target.Process(mpt::audio_span_interleaved<mixsample_t>(MixSoundBuffer, m_MixerSettings.gnChannels, countChunk));
+		}
 
 		// Buffer ready
 		countRendered += countChunk;
@@ -387,7 +407,8 @@ CSoundFile::samplecount_t CSoundFile::Read(samplecount_t count, IAudioTarget &ta
 }
 
 
-void CSoundFile::ProcessDSP(uint32 countChunk)
+// DSPs with internal state are also processed on silent input so that their decay is not cut off.
+void CSoundFile::ProcessDSP(uint32 countChunk, bool mixBufferSilent)
 {
 	#ifndef NO_DSP
 		if(m_MixerSettings.DSPMask & SNDDSP_SURROUND)
@@ -418,7 +439,7 @@ void CSoundFile::ProcessDSP(uint32 countChunk)
 	#endif // NO_AGC
 
 	#ifndef NO_DSP
-		if(m_MixerSettings.DSPMask & SNDDSP_BITCRUSH)
+		if((m_MixerSettings.DSPMask & SNDDSP_BITCRUSH) && !mixBufferSilent)
 		{
 			m_BitCrush.Process(MixSoundBuffer, MixRearBuffer, countChunk, m_MixerSettings.gnChannels);
 		}
@@ -427,6 +448,9 @@ void CSoundFile::ProcessDSP(uint32 countChunk)
 	#if defined(NO_DSP) && defined(NO_EQ) && defined(NO_AGC)
 		MPT_UNREFERENCED_PARAMETER(countChunk);
 	#endif
+	#if defined(NO_DSP)
+		MPT_UNREFERENCED_PARAMETER(mixBufferSilent);
+	#endif
 }
 
 
@@ -812,10 +836,11 @@ void CSoundFile::SetupNextRow(PlayState &playState, const bool patternLoop) cons
 
 
 // Calculate delta for Vibrato / Tremolo / Panbrello effect
+template <typename TFormat>
 int CSoundFile::GetVibratoDelta(int type, int position) const
 {
 	// IT compatibility: IT has its own, more precise tables
-	if(m_playBehaviour[kITVibratoTremoloPanbrello])
+	if(PlayBehaviourEnabled<TFormat, kITVibratoTremoloPanbrello>())
 	{
 		position &= 0xFF;
 		switch(type & 0x03)
@@ -830,7 +855,7 @@ int CSoundFile::GetVibratoDelta(int type, int position) const
 		case 3:	// Random
 			return mpt::random<int, 7>(AccessPRNG()) - 0x40;
 		}
-	} else if(GetType() & (MOD_TYPE_DIGI | MOD_TYPE_DBM))
+	} else if(GetType<TFormat>() & (MOD_TYPE_DIGI | MOD_TYPE_DBM))
 	{
 		// Other waveforms are not supported.
 		static constexpr int8 DBMSinus[] =
@@ -858,13 +883,14 @@ int CSoundFile::GetVibratoDelta(int type, int position) const
 }
 
 
+template <typename TFormat>
 void CSoundFile::ProcessVolumeSwing(ModChannel &chn, int &vol) const
 {
-	if(m_playBehaviour[kITSwingBehaviour])
+	if(PlayBehaviourEnabled<TFormat, kITSwingBehaviour>())
 	{
 		vol += chn.nVolSwing;
 		Limit(vol, 0, 64);
-	} else if(m_playBehaviour[kMPTOldSwingBehaviour])
+	} else if(PlayBehaviourEnabled<TFormat, kMPTOldSwingBehaviour>())
 	{
 		vol += chn.nVolSwing;
 		Limit(vol, 0, 256);
@@ -878,9 +904,10 @@ void CSoundFile::ProcessVolumeSwing(ModChannel &chn, int &vol) const
 }
 
 
+template <typename TFormat>
 void CSoundFile::ProcessPanningSwing(ModChannel &chn) const
 {
-	if(m_playBehaviour[kITSwingBehaviour] || m_playBehaviour[kMPTOldSwingBehaviour])
+	if(PlayBehaviourEnabled<TFormat, kITSwingBehaviour>() || PlayBehaviourEnabled<TFormat, kMPTOldSwingBehaviour>())
 	{
 		chn.nRealPan = chn.nPan + chn.nPanSwing;
 		Limit(chn.nRealPan, 0, 256);
@@ -894,6 +921,7 @@ void CSoundFile::ProcessPanningSwing(ModChannel &chn) const
 }
 
 
+template <typename TFormat>
 void CSoundFile::ProcessTremolo(ModChannel &chn, int &vol) const
 {
 	if (chn.dwFlags[CHN_TREMOLO])
@@ -906,13 +934,13 @@ void CSoundFile::ProcessTremolo(ModChannel &chn, int &vol) const
 		}
 
 		// IT compatibility: Why would you not want to execute tremolo at volume 0?
-		if(vol > 0 || m_playBehaviour[kITVibratoTremoloPanbrello])
+		if(vol > 0 || PlayBehaviourEnabled<TFormat, kITVibratoTremoloPanbrello>())
 		{
 			// IT compatibility: We don't need a different attenuation here because of the different tables we're going to use
-			const uint8 attenuation = ((GetType() & (MOD_TYPE_XM | MOD_TYPE_MOD)) || m_playBehaviour[kITVibratoTremoloPanbrello]) ? 5 : 6;
+			const uint8 attenuation = ((GetType<TFormat>() & (MOD_TYPE_XM | MOD_TYPE_MOD)) || PlayBehaviourEnabled<TFormat, kITVibratoTremoloPanbrello>()) ? 5 : 6;
 
-			int delta = GetVibratoDelta(chn.nTremoloType, chn.nTremoloPos);
-			if((chn.nTremoloType & 0x03) == 1 && m_playBehaviour[kFT2MODTremoloRampWaveform])
+			int delta = GetVibratoDelta<TFormat>(chn.nTremoloType, chn.nTremoloPos);
+			if((chn.nTremoloType & 0x03) == 1 && PlayBehaviourEnabled<TFormat, kFT2MODTremoloRampWaveform>())
 			{
 				// FT2 compatibility: Tremolo ramp down / triangle implementation is weird and affected by vibrato position (copypaste bug)
 				// Test case: TremoloWaveforms.xm, TremoloVibrato.xm
@@ -928,7 +956,7 @@ void CSoundFile::ProcessTremolo(ModChannel &chn, int &vol) const
 				else
 					delta = ramp;
 			}
-			if(GetType() != MOD_TYPE_DMF)
+			if(GetType<TFormat>() != MOD_TYPE_DMF)
 			{
 				vol += (delta * chn.nTremoloDepth) / (1 << attenuation);
 			} else
@@ -937,10 +965,10 @@ void CSoundFile::ProcessTremolo(ModChannel &chn, int &vol) const
 				vol -= (vol * chn.nTremoloDepth * (64 - delta)) / (128 * 64);
 			}
 		}
-		if(!m_SongFlags[SONG_FIRSTTICK] || ((GetType() & (MOD_TYPE_IT|MOD_TYPE_MPT)) && !m_SongFlags[SONG_ITOLDEFFECTS]))
+		if(!m_SongFlags[SONG_FIRSTTICK] || ((GetType<TFormat>() & (MOD_TYPE_IT|MOD_TYPE_MPT)) && !m_SongFlags[SONG_ITOLDEFFECTS]))
 		{
 			// IT compatibility: IT has its own, more precise tables
-			if(m_playBehaviour[kITVibratoTremoloPanbrello])
+			if(PlayBehaviourEnabled<TFormat, kITVibratoTremoloPanbrello>())
 				chn.nTremoloPos += 4 * chn.nTremoloSpeed;
 			else
 				chn.nTremoloPos += chn.nTremoloSpeed;
@@ -949,11 +977,12 @@ void CSoundFile::ProcessTremolo(ModChannel &chn, int &vol) const
 }
 
 
+template <typename TFormat>
 void CSoundFile::ProcessTremor(CHANNELINDEX nChn, int &vol)
 {
 	ModChannel &chn = m_PlayState.Chn[nChn];
 
-	if(m_playBehaviour[kFT2Tremor])
+	if(PlayBehaviourEnabled<TFormat, kFT2Tremor>())
 	{
 		// FT2 Compatibility: Weird XM tremor.
 		// Test case: Tremor.xm
@@ -986,7 +1015,7 @@ void CSoundFile::ProcessTremor(CHANNELINDEX nChn, int &vol)
 	} else if(chn.nCommand == CMD_TREMOR)
 	{
 		// IT compatibility 12. / 13.: Tremor
-		if(m_playBehaviour[kITTremor])
+		if(PlayBehaviourEnabled<TFormat, kITTremor>())
 		{
 			if((chn.nTremorCount & 0x80) && chn.nLength)
 			{
@@ -1004,13 +1033,13 @@ void CSoundFile::ProcessTremor(CHANNELINDEX nChn, int &vol)
 		{
 			uint8 ontime = chn.nTremorParam >> 4;
 			uint8 n = ontime + (chn.nTremorParam & 0x0F);	// Total tremor cycle time (On + Off)
-			if ((!(GetType() & (MOD_TYPE_IT | MOD_TYPE_MPT))) || m_SongFlags[SONG_ITOLDEFFECTS])
+			if ((!(GetType<TFormat>() & (MOD_TYPE_IT | MOD_TYPE_MPT))) || m_SongFlags[SONG_ITOLDEFFECTS])
 			{
 				n += 2;
 				ontime++;
 			}
 			uint8 tremcount = chn.nTremorCount;
-			if(!(GetType() & MOD_TYPE_XM))
+			if(!(GetType<TFormat>() & MOD_TYPE_XM))
 			{
 				if (tremcount >= n) tremcount = 0;
 				if (tremcount >= ontime) vol = 0;
@@ -1056,6 +1085,7 @@ void CSoundFile::ProcessTremor(CHANNELINDEX nChn, int &vol)
 }
 
 
+template <typename TFormat>
 bool CSoundFile::IsEnvelopeProcessed(const ModChannel &chn, EnvelopeType env) const
 {
 	if(chn.pModInstrument == nullptr)
@@ -1066,24 +1096,25 @@ bool CSoundFile::IsEnvelopeProcessed(const ModChannel &chn, EnvelopeType env) co
 
 	// IT Compatibility: S77/S79/S7B do not disable the envelope, they just pause the counter
 	// Test cases: s77.it, EnvLoops.xm, PanSustainRelease.xm
-	bool playIfPaused = m_playBehaviour[kITEnvelopePositionHandling] || m_playBehaviour[kFT2PanSustainRelease];
+	bool playIfPaused = PlayBehaviourEnabled<TFormat, kITEnvelopePositionHandling>() || PlayBehaviourEnabled<TFormat, kFT2PanSustainRelease>();
 	return ((chn.GetEnvelope(env).flags[ENV_ENABLED] || (insEnv.dwFlags[ENV_ENABLED] && playIfPaused))
 		&& !insEnv.empty());
 }
 
 
+template <typename TFormat>
 void CSoundFile::ProcessVolumeEnvelope(ModChannel &chn, int &vol) const
 {
-	if(IsEnvelopeProcessed(chn, ENV_VOLUME))
+	if(IsEnvelopeProcessed<TFormat>(chn, ENV_VOLUME))
 	{
 		const ModInstrument *pIns = chn.pModInstrument;
 
-		if(m_playBehaviour[kITEnvelopePositionHandling] && chn.VolEnv.nEnvPosition == 0)
+		if(PlayBehaviourEnabled<TFormat, kITEnvelopePositionHandling>() && chn.VolEnv.nEnvPosition == 0)
 		{
 			// If the envelope is disabled at the very same moment as it is triggered, we do not process anything.
 			return;
 		}
-		const int envpos = chn.VolEnv.nEnvPosition - (m_playBehaviour[kITEnvelopePositionHandling] ? 1 : 0);
+		const int envpos = chn.VolEnv.nEnvPosition - (PlayBehaviourEnabled<TFormat, kITEnvelopePositionHandling>() ? 1 : 0);
 		// Get values in [0, 256]
 		int envval = pIns->VolEnv.GetValueFromPosition(envpos, 256);
 
@@ -1102,7 +1133,7 @@ void CSoundFile::ProcessVolumeEnvelope(ModChannel &chn, int &vol) const
 			if(envpos == pIns->VolEnv[pIns->VolEnv.nReleaseNode].tick)
 				envval = envValueAtReleaseNode;
 
-			if(m_playBehaviour[kLegacyReleaseNode])
+			if(PlayBehaviourEnabled<TFormat, kLegacyReleaseNode>())
 			{
 				// Old, hard to grasp release node behaviour (additive)
 				int relativeVolumeChange = (envval - envValueAtReleaseNode) * 2;
@@ -1122,19 +1153,20 @@ void CSoundFile::ProcessVolumeEnvelope(ModChannel &chn, int &vol) const
 }
 
 
+template <typename TFormat>
 void CSoundFile::ProcessPanningEnvelope(ModChannel &chn) const
 {
-	if(IsEnvelopeProcessed(chn, ENV_PANNING))
+	if(IsEnvelopeProcessed<TFormat>(chn, ENV_PANNING))
 	{
 		const ModInstrument *pIns = chn.pModInstrument;
 
-		if(m_playBehaviour[kITEnvelopePositionHandling] && chn.PanEnv.nEnvPosition == 0)
+		if(PlayBehaviourEnabled<TFormat, kITEnvelopePositionHandling>() && chn.PanEnv.nEnvPosition == 0)
 		{
 			// If the envelope is disabled at the very same moment as it is triggered, we do not process anything.
 			return;
 		}
 
-		const int envpos = chn.PanEnv.nEnvPosition - (m_playBehaviour[kITEnvelopePositionHandling] ? 1 : 0);
+		const int envpos = chn.PanEnv.nEnvPosition - (PlayBehaviourEnabled<TFormat, kITEnvelopePositionHandling>() ? 1 : 0);
 		// Get values in [-32, 32]
 		const int envval = pIns->PanEnv.GetValueFromPosition(envpos, 64) - 32;
 
@@ -1152,19 +1184,20 @@ void CSoundFile::ProcessPanningEnvelope(ModChannel &chn) const
 }
 
 
+template <typename TFormat>
 int CSoundFile::ProcessPitchFilterEnvelope(ModChannel &chn, int32 &period) const
 {
-	if(IsEnvelopeProcessed(chn, ENV_PITCH))
+	if(IsEnvelopeProcessed<TFormat>(chn, ENV_PITCH))
 	{
 		const ModInstrument *pIns = chn.pModInstrument;
 
-		if(m_playBehaviour[kITEnvelopePositionHandling] && chn.PitchEnv.nEnvPosition == 0)
+		if(PlayBehaviourEnabled<TFormat, kITEnvelopePositionHandling>() && chn.PitchEnv.nEnvPosition == 0)
 		{
 			// If the envelope is disabled at the very same moment as it is triggered, we do not process anything.
 			return -1;
 		}
 
-		const int envpos = chn.PitchEnv.nEnvPosition - (m_playBehaviour[kITEnvelopePositionHandling] ? 1 : 0);
+		const int envpos = chn.PitchEnv.nEnvPosition - (PlayBehaviourEnabled<TFormat, kITEnvelopePositionHandling>() ? 1 : 0);
 		// Get values in [-256, 256]
 #ifdef MODPLUG_TRACKER
 		const int32 range = ENVELOPE_MAX;
@@ -1172,9 +1205,9 @@ int CSoundFile::ProcessPitchFilterEnvelope(ModChannel &chn, int32 &period) const
 #else
 		// TODO: AMS2 envelopes behave differently when linear slides are off - emulate with 15 * (-128...127) >> 6
 		// Copy over vibrato behaviour for that?
-		const int32 range = GetType() == MOD_TYPE_AMS ? uint8_max : uint8(ENVELOPE_MAX);
+		const int32 range = GetType<TFormat>() == MOD_TYPE_AMS ? uint8_max : uint8(ENVELOPE_MAX);
 		int32 amp;
-		switch(GetType())
+		switch(GetType<TFormat>())
 		{
 		case MOD_TYPE_AMS: amp = 64; break;
 		case MOD_TYPE_MDL: amp = 192; break;
@@ -1224,6 +1257,7 @@ int CSoundFile::ProcessPitchFilterEnvelope(ModChannel &chn, int32 &period) const
 }
 
 
+template <typename TFormat>
 void CSoundFile::IncrementEnvelopePosition(ModChannel &chn, EnvelopeType envType) const
 {
 	ModChannel::EnvInfo &chnEnv = chn.GetEnvelope(envType);
@@ -1234,7 +1268,7 @@ void CSoundFile::IncrementEnvelopePosition(ModChannel &chn, EnvelopeType envType
 	}
 
 	// Increase position
-	uint32 position = chnEnv.nEnvPosition + (m_playBehaviour[kITEnvelopePositionHandling] ? 0 : 1);
+	uint32 position = chnEnv.nEnvPosition + (PlayBehaviourEnabled<TFormat, kITEnvelopePositionHandling>() ? 0 : 1);
 
 	const InstrumentEnvelope &insEnv = chn.pModInstrument->GetEnvelope(envType);
 	if(insEnv.empty())
@@ -1244,18 +1278,18 @@ void CSoundFile::IncrementEnvelopePosition(ModChannel &chn, EnvelopeType envType
 
 	bool endReached = false;
 
-	if(!m_playBehaviour[kITEnvelopePositionHandling])
+	if(!PlayBehaviourEnabled<TFormat, kITEnvelopePositionHandling>())
 	{
 		// FT2-style envelope processing.
 		if(insEnv.dwFlags[ENV_LOOP])
 		{
 			// Normal loop active
 			uint32 end = insEnv[insEnv.nLoopEnd].tick;
-			if(!(GetType() & (MOD_TYPE_XM | MOD_TYPE_MT2))) end++;
+			if(!(GetType<TFormat>() & (MOD_TYPE_XM | MOD_TYPE_MT2))) end++;
 
 			// FT2 compatibility: If the sustain point is at the loop end and the sustain loop has been released, don't loop anymore.
 			// Test case: EnvLoops.xm
-			const bool escapeLoop = (insEnv.nLoopEnd == insEnv.nSustainEnd && insEnv.dwFlags[ENV_SUSTAIN] && chn.dwFlags[CHN_KEYOFF] && m_playBehaviour[kFT2EnvelopeEscape]);
+			const bool escapeLoop = (insEnv.nLoopEnd == insEnv.nSustainEnd && insEnv.dwFlags[ENV_SUSTAIN] && chn.dwFlags[CHN_KEYOFF] && PlayBehaviourEnabled<TFormat, kFT2EnvelopeEscape>());
 
 			if(position == end && !escapeLoop)
 			{
@@ -1271,7 +1305,7 @@ void CSoundFile::IncrementEnvelopePosition(ModChannel &chn, EnvelopeType envType
 				position = insEnv[insEnv.nSustainStart].tick;
 				// FT2 compatibility: If the panning envelope reaches its sustain point before key-off, it stays there forever.
 				// Test case: PanSustainRelease.xm
-				if(m_playBehaviour[kFT2PanSustainRelease] && envType == ENV_PANNING && !chn.dwFlags[CHN_KEYOFF])
+				if(PlayBehaviourEnabled<TFormat, kFT2PanSustainRelease>() && envType == ENV_PANNING && !chn.dwFlags[CHN_KEYOFF])
 				{
 					chnEnv.flags.reset(ENV_ENABLED);
 				}
@@ -1294,7 +1328,7 @@ void CSoundFile::IncrementEnvelopePosition(ModChannel &chn, EnvelopeType envType
 
 		// IT compatiblity: OpenMPT processes the key-off flag earlier than IT. Grab the flag from the previous tick instead.
 		// Test case: EnvOffLength.it
-		if(insEnv.dwFlags[ENV_SUSTAIN] && !chn.dwOldFlags[CHN_KEYOFF] && (chnEnv.nEnvValueAtReleaseJump == NOT_YET_RELEASED || m_playBehaviour[kReleaseNodePastSustainBug]))
+		if(insEnv.dwFlags[ENV_SUSTAIN] && !chn.dwOldFlags[CHN_KEYOFF] && (chnEnv.nEnvValueAtReleaseJump == NOT_YET_RELEASED || PlayBehaviourEnabled<TFormat, kReleaseNodePastSustainBug>()))
 		{
 			// Envelope sustained
 			start = insEnv[insEnv.nSustainStart].tick;
@@ -1324,12 +1358,12 @@ void CSoundFile::IncrementEnvelopePosition(ModChannel &chn, EnvelopeType envType
 	if(envType == ENV_VOLUME && endReached)
 	{
 		// Special handling for volume envelopes at end of envelope
-		if((GetType() & (MOD_TYPE_IT | MOD_TYPE_MPT)) || (chn.dwFlags[CHN_KEYOFF] && GetType() != MOD_TYPE_MDL))
+		if((GetType<TFormat>() & (MOD_TYPE_IT | MOD_TYPE_MPT)) || (chn.dwFlags[CHN_KEYOFF] && GetType<TFormat>() != MOD_TYPE_MDL))
 		{
 			chn.dwFlags.set(CHN_NOTEFADE);
 		}
 
-		if(insEnv.back().value == 0 && (chn.nMasterChn > 0 || (GetType() & (MOD_TYPE_IT | MOD_TYPE_MPT))))
+		if(insEnv.back().value == 0 && (chn.nMasterChn > 0 || (GetType<TFormat>() & (MOD_TYPE_IT | MOD_TYPE_MPT))))
 		{
 			// Stop channel if the last envelope node is silent anyway.
 			chn.dwFlags.set(CHN_NOTEFADE);
@@ -1339,18 +1373,19 @@ void CSoundFile::IncrementEnvelopePosition(ModChannel &chn, EnvelopeType envType
 		}
 	}
 
-	chnEnv.nEnvPosition = position + (m_playBehaviour[kITEnvelopePositionHandling] ? 1 : 0);
+	chnEnv.nEnvPosition = position + (PlayBehaviourEnabled<TFormat, kITEnvelopePositionHandling>() ? 1 : 0);
 
 }
 
 
+template <typename TFormat>
 void CSoundFile::IncrementEnvelopePositions(ModChannel &chn) const
 {
-	if (chn.isFirstTick && GetType() == MOD_TYPE_MED)
+	if (chn.isFirstTick && GetType<TFormat>() == MOD_TYPE_MED)
 		return;
-	IncrementEnvelopePosition(chn, ENV_VOLUME);
-	IncrementEnvelopePosition(chn, ENV_PANNING);
-	IncrementEnvelopePosition(chn, ENV_PITCH);
+	IncrementEnvelopePosition<TFormat>(chn, ENV_VOLUME);
+	IncrementEnvelopePosition<TFormat>(chn, ENV_PANNING);
+	IncrementEnvelopePosition<TFormat>(chn, ENV_PITCH);
 }
 
 
@@ -1385,6 +1420,7 @@ void CSoundFile::ProcessPitchPanSeparation(int32 &pan, int note, const ModInstru
 }
 
 
+template <typename TFormat>
 void CSoundFile::ProcessPanbrello(ModChannel &chn) const
 {
 	int pdelta = chn.nPanbrelloOffset;
@@ -1392,16 +1428,16 @@ void CSoundFile::ProcessPanbrello(ModChannel &chn) const
 	{
 		uint32 panpos;
 		// IT compatibility: IT has its own, more precise tables
-		if(m_playBehaviour[kITVibratoTremoloPanbrello])
+		if(PlayBehaviourEnabled<TFormat, kITVibratoTremoloPanbrello>())
 			panpos = chn.nPanbrelloPos;
 		else
 			panpos = ((chn.nPanbrelloPos + 0x10) >> 2);
 
-		pdelta = GetVibratoDelta(chn.nPanbrelloType, panpos);
+		pdelta = GetVibratoDelta<TFormat>(chn.nPanbrelloType, panpos);
 
 		// IT compatibility: Sample-and-hold style random panbrello (tremolo and vibrato don't use this mechanism in IT)
 		// Test case: RandomWaveform.it
-		if(m_playBehaviour[kITSampleAndHoldPanbrello] && chn.nPanbrelloType == 3)
+		if(PlayBehaviourEnabled<TFormat, kITSampleAndHoldPanbrello>() && chn.nPanbrelloType == 3)
 		{
 			if(chn.nPanbrelloPos == 0 || chn.nPanbrelloPos >= chn.nPanbrelloSpeed)
 			{
@@ -1416,7 +1452,7 @@ void CSoundFile::ProcessPanbrello(ModChannel &chn) const
 		}
 		// IT compatibility: Panbrello effect is active until next note or panning command.
 		// Test case: PanbrelloHold.it
-		if(m_playBehaviour[kITPanbrelloHold])
+		if(PlayBehaviourEnabled<TFormat, kITPanbrelloHold>())
 		{
 			chn.nPanbrelloOffset = static_cast<int8>(pdelta);
 		}
@@ -1430,6 +1466,7 @@ void CSoundFile::ProcessPanbrello(ModChannel &chn) const
 }
 
 
+template <typename TFormat>
 void CSoundFile::ProcessArpeggio(CHANNELINDEX nChn, int32 &period, Tuning::NOTEINDEXTYPE &arpeggioSteps)
 {
 	ModChannel &chn = m_PlayState.Chn[nChn];
@@ -1497,13 +1534,13 @@ void CSoundFile::ProcessArpeggio(CHANNELINDEX nChn, int32 &period, Tuning::NOTEI
 			chn.m_ReCalculateFreqOnFirstTick = true;
 		} else
 		{
-			if(GetType() == MOD_TYPE_MT2 && m_SongFlags[SONG_FIRSTTICK])
+			if(GetType<TFormat>() == MOD_TYPE_MT2 && m_SongFlags[SONG_FIRSTTICK])
 			{
 				// MT2 resets any previous portamento when an arpeggio occurs.
 				chn.nPeriod = period = GetPeriodFromNote(chn.nNote, chn.nFineTune, chn.nC5Speed);
 			}
 
-			if(m_playBehaviour[kITArpeggio])
+			if(PlayBehaviourEnabled<TFormat, kITArpeggio>())
 			{
 				//IT playback compatibility 01 & 02
 
@@ -1523,7 +1560,7 @@ void CSoundFile::ProcessArpeggio(CHANNELINDEX nChn, int32 &period, Tuning::NOTEI
 					else
 						period = Util::muldivr(period, 65536, arpRatio);
 				}
-			} else if(m_playBehaviour[kFT2Arpeggio])
+			} else if(PlayBehaviourEnabled<TFormat, kFT2Arpeggio>())
 			{
 				// FastTracker 2: Swedish tracker logic (TM) arpeggio
 				if(!m_SongFlags[SONG_FIRSTTICK])
@@ -1573,15 +1610,15 @@ void CSoundFile::ProcessArpeggio(CHANNELINDEX nChn, int32 &period, Tuning::NOTEI
 				uint32 tick = m_PlayState.m_nTickCount;
 
 				// TODO other likely formats for MOD case: MED, OKT, etc
-				uint8 note = (GetType() != MOD_TYPE_MOD) ? chn.nNote : static_cast<uint8>(GetNoteFromPeriod(period, chn.nFineTune, chn.nC5Speed));
-				if(GetType() & (MOD_TYPE_DBM | MOD_TYPE_DIGI))
+				uint8 note = (GetType<TFormat>() != MOD_TYPE_MOD) ? chn.nNote : static_cast<uint8>(GetNoteFromPeriod(period, chn.nFineTune, chn.nC5Speed));
+				if(GetType<TFormat>() & (MOD_TYPE_DBM | MOD_TYPE_DIGI))
 					tick += 2;
 				switch(tick % 3)
 				{
 				case 1: note += (chn.nArpeggio >> 4); break;
 				case 2: note += (chn.nArpeggio & 0x0F); break;
 				}
-				if(note != chn.nNote || (GetType() & (MOD_TYPE_DBM | MOD_TYPE_DIGI | MOD_TYPE_STM)) || m_playBehaviour[KST3PortaAfterArpeggio])
+				if(note != chn.nNote || (GetType<TFormat>() & (MOD_TYPE_DBM | MOD_TYPE_DIGI | MOD_TYPE_STM)) || PlayBehaviourEnabled<TFormat, KST3PortaAfterArpeggio>())
 				{
 					if(m_SongFlags[SONG_PT_MODE])
 					{
@@ -1598,14 +1635,14 @@ void CSoundFile::ProcessArpeggio(CHANNELINDEX nChn, int32 &period, Tuning::NOTEI
 					}
 					period = GetPeriodFromNote(note, chn.nFineTune, chn.nC5Speed);
 
-					if(GetType() & (MOD_TYPE_DBM | MOD_TYPE_DIGI | MOD_TYPE_PSM | MOD_TYPE_STM | MOD_TYPE_OKT))
+					if(GetType<TFormat>() & (MOD_TYPE_DBM | MOD_TYPE_DIGI | MOD_TYPE_PSM | MOD_TYPE_STM | MOD_TYPE_OKT))
 					{
 						// The arpeggio note offset remains effective after the end of the current row in ScreamTracker 2.
 						// This fixes the flute lead in MORPH.STM by Skaven, pattern 27.
 						// Note that ScreamTracker 2.24 handles arpeggio slightly differently: It only considers the lower
 						// nibble, and switches to that note halfway through the row.
 						chn.nPeriod = period;
-					} else if(m_playBehaviour[KST3PortaAfterArpeggio])
+					} else if(PlayBehaviourEnabled<TFormat, KST3PortaAfterArpeggio>())
 					{
 						chn.nArpeggioLastNote = note;
 					}
@@ -1616,15 +1653,16 @@ void CSoundFile::ProcessArpeggio(CHANNELINDEX nChn, int32 &period, Tuning::NOTEI
 }
 
 
+template <typename TFormat>
 void CSoundFile::ProcessVibrato(CHANNELINDEX nChn, int32 &period, Tuning::RATIOTYPE &vibratoFactor)
 {
 	ModChannel &chn = m_PlayState.Chn[nChn];
 
 	if(chn.dwFlags[CHN_VIBRATO])
 	{
-		const bool advancePosition = !m_SongFlags[SONG_FIRSTTICK] || ((GetType() & (MOD_TYPE_IT | MOD_TYPE_MPT)) && !(m_SongFlags[SONG_ITOLDEFFECTS]));
+		const bool advancePosition = !m_SongFlags[SONG_FIRSTTICK] || ((GetType<TFormat>() & (MOD_TYPE_IT | MOD_TYPE_MPT)) && !(m_SongFlags[SONG_ITOLDEFFECTS]));
 
-		if(GetType() == MOD_TYPE_669)
+		if(GetType<TFormat>() == MOD_TYPE_669)
 		{
 			if(chn.nVibratoPos % 2u)
 			{
@@ -1635,10 +1673,10 @@ void CSoundFile::ProcessVibrato(CHANNELINDEX nChn, int32 &period, Tuning::RATIOT
 		}
 
 		// IT compatibility: IT has its own, more precise tables and pre-increments the vibrato position
-		if(advancePosition && m_playBehaviour[kITVibratoTremoloPanbrello])
+		if(advancePosition && PlayBehaviourEnabled<TFormat, kITVibratoTremoloPanbrello>())
 			chn.nVibratoPos += 4 * chn.nVibratoSpeed;
 
-		int vdelta = GetVibratoDelta(chn.nVibratoType, chn.nVibratoPos);
+		int vdelta = GetVibratoDelta<TFormat>(chn.nVibratoType, chn.nVibratoPos);
 
 		if(chn.HasCustomTuning())
 		{
@@ -1653,12 +1691,12 @@ void CSoundFile::ProcessVibrato(CHANNELINDEX nChn, int32 &period, Tuning::RATIOT
 		} else
 		{
 			// Original behaviour
-			if(m_SongFlags.test_all(SONG_FIRSTTICK | SONG_PT_MODE) || ((GetType() & (MOD_TYPE_DIGI | MOD_TYPE_DBM)) && m_SongFlags[SONG_FIRSTTICK]))
+			if(m_SongFlags.test_all(SONG_FIRSTTICK | SONG_PT_MODE) || ((GetType<TFormat>() & (MOD_TYPE_DIGI | MOD_TYPE_DBM)) && m_SongFlags[SONG_FIRSTTICK]))
 			{
 				// ProTracker doesn't apply vibrato nor advance on the first tick.
 				// Test case: VibratoReset.mod
 				return;
-			} else if((GetType() & (MOD_TYPE_XM | MOD_TYPE_MOD)) && (chn.nVibratoType & 0x03) == 1)
+			} else if((GetType<TFormat>() & (MOD_TYPE_XM | MOD_TYPE_MOD)) && (chn.nVibratoType & 0x03) == 1)
 			{
 				// FT2 compatibility: Vibrato ramp down table is upside down.
 				// Test case: VibratoWaveforms.xm
@@ -1667,7 +1705,7 @@ void CSoundFile::ProcessVibrato(CHANNELINDEX nChn, int32 &period, Tuning::RATIOT
 
 			uint32 vdepth;
 			// IT compatibility: correct vibrato depth
-			if(m_playBehaviour[kITVibratoTremoloPanbrello])
+			if(PlayBehaviourEnabled<TFormat, kITVibratoTremoloPanbrello>())
 			{
 				// Yes, vibrato goes backwards with old effects enabled!
 				if(m_SongFlags[SONG_ITOLDEFFECTS])
@@ -1684,18 +1722,18 @@ void CSoundFile::ProcessVibrato(CHANNELINDEX nChn, int32 &period, Tuning::RATIOT
 			{
 				if(m_SongFlags[SONG_S3MOLDVIBRATO])
 					vdepth = 5;
-				else if(GetType() == MOD_TYPE_DTM)
+				else if(GetType<TFormat>() == MOD_TYPE_DTM)
 					vdepth = 8;
-				else if(GetType() & (MOD_TYPE_DBM | MOD_TYPE_MTM))
+				else if(GetType<TFormat>() & (MOD_TYPE_DBM | MOD_TYPE_MTM))
 					vdepth = 7;
-				else if((GetType() & (MOD_TYPE_IT | MOD_TYPE_MPT)) && !m_SongFlags[SONG_ITOLDEFFECTS])
+				else if((GetType<TFormat>() & (MOD_TYPE_IT | MOD_TYPE_MPT)) && !m_SongFlags[SONG_ITOLDEFFECTS])
 					vdepth = 7;
 				else
 					vdepth = 6;
 
 				// ST3 compatibility: Do not distinguish between vibrato types in effect memory
 				// Test case: VibratoTypeChange.s3m
-				if(m_playBehaviour[kST3VibratoMemory] && chn.rowCommand.command == CMD_FINEVIBRATO)
+				if(PlayBehaviourEnabled<TFormat, kST3VibratoMemory>() && chn.rowCommand.command == CMD_FINEVIBRATO)
 					vdepth += 2;
 			}
 
@@ -1722,7 +1760,7 @@ void CSoundFile::ProcessVibrato(CHANNELINDEX nChn, int32 &period, Tuning::RATIOT
 
 		// Advance vibrato position - IT updates on every tick, unless "old effects" are enabled (in this case it only updates on non-first ticks like other trackers)
 		// IT compatibility: IT has its own, more precise tables and pre-increments the vibrato position
-		if(advancePosition && !m_playBehaviour[kITVibratoTremoloPanbrello])
+		if(advancePosition && !PlayBehaviourEnabled<TFormat, kITVibratoTremoloPanbrello>())
 			chn.nVibratoPos += chn.nVibratoSpeed;
 	} else if(chn.dwOldFlags[CHN_VIBRATO])
 	{
@@ -1738,6 +1776,7 @@ void CSoundFile::ProcessVibrato(CHANNELINDEX nChn, int32 &period, Tuning::RATIOT
 }
 
 
+template <typename TFormat>
 void CSoundFile::ProcessSampleAutoVibrato(ModChannel &chn, int32 &period, Tuning::RATIOTYPE &vibratoFactor, int &nPeriodFrac) const
 {
 	// Sample Auto-Vibrato
@@ -1755,7 +1794,7 @@ void CSoundFile::ProcessSampleAutoVibrato(ModChannel &chn, int32 &period, Tuning
 		const uint32 (&fineDownTable)[16] = useFreq ? FineLinearSlideDownTable : FineLinearSlideUpTable;
 
 		// IT compatibility: Autovibrato is so much different in IT that I just put this in a separate code block, to get rid of a dozen IsCompatibilityMode() calls.
-		if(m_playBehaviour[kITVibratoTremoloPanbrello] && !hasTuning && GetType() != MOD_TYPE_MT2)
+		if(PlayBehaviourEnabled<TFormat, kITVibratoTremoloPanbrello>() && !hasTuning && GetType<TFormat>() != MOD_TYPE_MT2)
 		{
 			if(!pSmp->nVibRate)
 				return;
@@ -1824,13 +1863,13 @@ void CSoundFile::ProcessSampleAutoVibrato(ModChannel &chn, int32 &period, Tuning
 		} else
 		{
 			// MPT's autovibrato code
-			if (pSmp->nVibSweep == 0 && !(GetType() & (MOD_TYPE_IT | MOD_TYPE_MPT)))
+			if (pSmp->nVibSweep == 0 && !(GetType<TFormat>() & (MOD_TYPE_IT | MOD_TYPE_MPT)))
 			{
 				chn.nAutoVibDepth = pSmp->nVibDepth * 256;
 			} else
 			{
 				// Calculate current autovibrato depth using vibsweep
-				if (GetType() & (MOD_TYPE_IT | MOD_TYPE_MPT))
+				if (GetType<TFormat>() & (MOD_TYPE_IT | MOD_TYPE_MPT))
 				{
 					chn.nAutoVibDepth += pSmp->nVibSweep * 2u;
 				} else
@@ -1861,7 +1900,7 @@ void CSoundFile::ProcessSampleAutoVibrato(ModChannel &chn, int32 &period, Tuning
 				break;
 			case VIB_SINE:
 			default:
-				if(GetType() != MOD_TYPE_MT2)
+				if(GetType<TFormat>() != MOD_TYPE_MT2)
 				{
 					vdelta = -ITSinusTable[chn.nAutoVibPos & 0xFF];
 				} else
@@ -1889,7 +1928,7 @@ void CSoundFile::ProcessSampleAutoVibrato(ModChannel &chn, int32 &period, Tuning
 			}
 			else //Original behavior
 			{
-				if (GetType() != MOD_TYPE_XM)
+				if (GetType<TFormat>() != MOD_TYPE_XM)
 				{
 					int df1, df2;
 					if (n < 0)
@@ -1918,6 +1957,7 @@ void CSoundFile::ProcessSampleAutoVibrato(ModChannel &chn, int32 &period, Tuning
 }
 
 
+template <typename TFormat>
 void CSoundFile::ProcessRamping(ModChannel &chn) const
 {
 	chn.leftRamp = chn.rightRamp = 0;
@@ -1930,7 +1970,7 @@ void CSoundFile::ProcessRamping(ModChannel &chn) const
 		rampLength = globalRampLength = (rampUp ? m_MixerSettings.GetVolumeRampUpSamples() : m_MixerSettings.GetVolumeRampDownSamples());
 		//XXXih: add real support for bidi ramping here
 
-		if(m_playBehaviour[kFT2VolumeRamping] && (GetType() & MOD_TYPE_XM))
+		if(PlayBehaviourEnabled<TFormat, kFT2VolumeRamping>() && (GetType<TFormat>() & MOD_TYPE_XM))
 		{
 			// apply FT2-style super-soft volume ramping (5ms), overriding openmpt settings
 			rampLength = globalRampLength = Util::muldivr(5, m_MixerSettings.gdwMixingFreq, 1000);
@@ -2021,6 +2061,13 @@ std::pair<SamplePosition, uint32> CSoundFile::GetChannelIncrement(const ModChann
 // Handles envelopes & mixer setup
 
 bool CSoundFile::ReadNote()
+{
+	return CallWithFormatSpecialization([this](auto format) { return ReadNoteImpl<decltype(format)>(); });
+}
+
+
+template <typename TFormat>
+bool CSoundFile::ReadNoteImpl()
 {
 #ifdef MODPLUG_TRACKER
 	// Checking end of row ?
@@ -2087,7 +2134,7 @@ bool CSoundFile::ReadNote()
 		// FT2 Compatibility: Prevent notes to be stopped after a fadeout. This way, a portamento effect can pick up a faded instrument which is long enough.
 		// This occurs for example in the bassline (channel 11) of jt_burn.xm. I hope this won't break anything else...
 		// I also suppose this could decrease mixing performance a bit, but hey, which CPU can't handle 32 muted channels these days... :-)
-		if(chn.dwFlags[CHN_NOTEFADE] && (!(chn.nFadeOutVol|chn.leftVol|chn.rightVol)) && !m_playBehaviour[kFT2ProcessSilentChannels])
+		if(chn.dwFlags[CHN_NOTEFADE] && (!(chn.nFadeOutVol|chn.leftVol|chn.rightVol)) && !PlayBehaviourEnabled<TFormat, kFT2ProcessSilentChannels>())
 		{
 			chn.nLength = 0;
 			chn.nROfs = chn.nLOfs = 0;
@@ -2128,10 +2175,10 @@ bool CSoundFile::ReadNote()
 			int vol = chn.nVolume;
 			int insVol = chn.nInsVol;		// This is the "SV * IV" value in ITTECH.TXT
 
-			ProcessVolumeSwing(chn, m_playBehaviour[kITSwingBehaviour] ? insVol : vol);
-			ProcessPanningSwing(chn);
-			ProcessTremolo(chn, vol);
-			ProcessTremor(nChn, vol);
+			ProcessVolumeSwing<TFormat>(chn, PlayBehaviourEnabled<TFormat, kITSwingBehaviour>() ? insVol : vol);
+			ProcessPanningSwing<TFormat>(chn);
+			ProcessTremolo<TFormat>(chn, vol);
+			ProcessTremor<TFormat>(nChn, vol);
 
 			// Clip volume and multiply (extend to 14 bits)
 			Limit(vol, 0, 256);
@@ -2140,20 +2187,20 @@ bool CSoundFile::ReadNote()
 			// Process Envelopes
 			if (pIns)
 			{
-				if(m_playBehaviour[kITEnvelopePositionHandling])
+				if(PlayBehaviourEnabled<TFormat, kITEnvelopePositionHandling>())
 				{
 					// In IT compatible mode, envelope position indices are shifted by one for proper envelope pausing,
 					// so we have to update the position before we actually process the envelopes.
 					// When using MPT behaviour, we get the envelope position for the next tick while we are still calculating the current tick,
 					// which then results in wrong position information when the envelope is paused on the next row.
 					// Test cases: s77.it
-					IncrementEnvelopePositions(chn);
+					IncrementEnvelopePositions<TFormat>(chn);
 				}
-				ProcessVolumeEnvelope(chn, vol);
+				ProcessVolumeEnvelope<TFormat>(chn, vol);
 				ProcessInstrumentFade(chn, vol);
-				ProcessPanningEnvelope(chn);
+				ProcessPanningEnvelope<TFormat>(chn);
 
-				if(!m_playBehaviour[kITPitchPanSeparation] && chn.nNote != NOTE_NONE && chn.pModInstrument && chn.pModInstrument->nPPS != 0)
+				if(!PlayBehaviourEnabled<TFormat, kITPitchPanSeparation>() && chn.nNote != NOTE_NONE && chn.pModInstrument && chn.pModInstrument->nPPS != 0)
 					ProcessPitchPanSeparation(chn.nRealPan, chn.nNote, *chn.pModInstrument);
 			} else
 			{
@@ -2193,17 +2240,17 @@ bool CSoundFile::ReadNote()
 			// ST3 only clamps the final output period, but never the channel's internal period.
 			// Test case: PeriodLimit.s3m
 			if (chn.nPeriod < m_nMinPeriod
-				&& GetType() != MOD_TYPE_S3M
+				&& GetType<TFormat>() != MOD_TYPE_S3M
 				&& !PeriodsAreFrequencies())
 			{
 				chn.nPeriod = m_nMinPeriod;
-			} else if(chn.nPeriod >= m_nMaxPeriod && m_playBehaviour[kApplyUpperPeriodLimit] && !PeriodsAreFrequencies())
+			} else if(chn.nPeriod >= m_nMaxPeriod && PlayBehaviourEnabled<TFormat, kApplyUpperPeriodLimit>() && !PeriodsAreFrequencies())
 			{
 				// ...but on the other hand, ST3's SoundBlaster driver clamps the maximum channel period.
 				// Test case: PeriodLimitUpper.s3m
 				chn.nPeriod = m_nMaxPeriod;
 			}
-			if(m_playBehaviour[kFT2Periods]) Clamp(chn.nPeriod, 1, 31999);
+			if(PlayBehaviourEnabled<TFormat, kFT2Periods>()) Clamp(chn.nPeriod, 1, 31999);
 			period = chn.nPeriod;
 
 			// When glissando mode is set to semitones, clamp to the next halftone.
@@ -2219,17 +2266,17 @@ bool CSoundFile::ReadNote()
 				period = chn.glissandoPeriod;
 			}
 
-			ProcessArpeggio(nChn, period, arpeggioSteps);
+			ProcessArpeggio<TFormat>(nChn, period, arpeggioSteps);
 
 			// Preserve Amiga freq limits.
 			// In ST3, the frequency is always clamped to periods 113 to 856, while in ProTracker,
 			// the limit is variable, depending on the finetune of the sample.
-			// The int32_max test is for the arpeggio wrap-around in ProcessArpeggio().
+			// The int32_max test is for the arpeggio wrap-around in ProcessArpeggio<TFormat>().
 			// Test case: AmigaLimits.s3m, AmigaLimitsFinetune.mod
 			if(m_SongFlags[SONG_AMIGALIMITS | SONG_PT_MODE] && period != int32_max)
 			{
 				int limitLow = 113 * 4, limitHigh = 856 * 4;
-				if(GetType() != MOD_TYPE_S3M)
+				if(GetType<TFormat>() != MOD_TYPE_S3M)
 				{
 					const int tableOffset = XM2MODFineTune(chn.nFineTune) * 12;
 					limitLow = ProTrackerTunedPeriods[tableOffset +  11] / 2;
@@ -2241,12 +2288,12 @@ bool CSoundFile::ReadNote()
 				Limit(chn.nPeriod, limitLow, limitHigh);
 			}
 
-			ProcessPanbrello(chn);
+			ProcessPanbrello<TFormat>(chn);
 		}
 
 		// IT Compatibility: Ensure that there is no pan swing, panbrello, panning envelopes, etc. applied on surround channels.
 		// Test case: surround-pan.it
-		if(chn.dwFlags[CHN_SURROUND] && !m_SongFlags[SONG_SURROUNDPAN] && m_playBehaviour[kITNoSurroundPan])
+		if(chn.dwFlags[CHN_SURROUND] && !m_SongFlags[SONG_SURROUNDPAN] && PlayBehaviourEnabled<TFormat, kITNoSurroundPan>())
 		{
 			chn.nRealPan = 128;
 		}
@@ -2257,7 +2304,7 @@ bool CSoundFile::ReadNote()
 		// After MIDI macros have been processed, we can also process the pitch / filter envelope and other pitch-related things.
 		if(samplePlaying)
 		{
-			int cutoff = ProcessPitchFilterEnvelope(chn, period);
+			int cutoff = ProcessPitchFilterEnvelope<TFormat>(chn, period);
 			if(cutoff >= 0 && chn.dwFlags[CHN_ADLIB] && m_opl)
 			{
 				// Cutoff doubles as modulator intensity for FM instruments
@@ -2268,36 +2315,36 @@ bool CSoundFile::ReadNote()
 		if(chn.rowCommand.volcmd == VOLCMD_VIBRATODEPTH &&
 			(chn.rowCommand.command == CMD_VIBRATO || chn.rowCommand.command == CMD_VIBRATOVOL || chn.rowCommand.command == CMD_FINEVIBRATO))
 		{
-			if(GetType() == MOD_TYPE_XM)
+			if(GetType<TFormat>() == MOD_TYPE_XM)
 			{
 				// XM Compatibility: Vibrato should be advanced twice (but not added up) if both volume-column and effect column vibrato is present.
 				// Effect column vibrato parameter has precedence if non-zero.
 				// Test case: VibratoDouble.xm
 				if(!m_SongFlags[SONG_FIRSTTICK])
 					chn.nVibratoPos += chn.nVibratoSpeed;
-			} else if(GetType() & (MOD_TYPE_IT | MOD_TYPE_MPT))
+			} else if(GetType<TFormat>() & (MOD_TYPE_IT | MOD_TYPE_MPT))
 			{
 				// IT Compatibility: Vibrato should be applied twice if both volume-colum and effect column vibrato is present.
 				// Volume column vibrato parameter has precedence if non-zero.
 				// Test case: VibratoDouble.it
 				Vibrato(chn, chn.rowCommand.vol);
-				ProcessVibrato(nChn, period, vibratoFactor);
+				ProcessVibrato<TFormat>(nChn, period, vibratoFactor);
 			}
 		}
 		// Plugins may also receive vibrato
-		ProcessVibrato(nChn, period, vibratoFactor);
+		ProcessVibrato<TFormat>(nChn, period, vibratoFactor);
 
 		if(samplePlaying)
 		{
 			int nPeriodFrac = 0;
-			ProcessSampleAutoVibrato(chn, period, vibratoFactor, nPeriodFrac);
+			ProcessSampleAutoVibrato<TFormat>(chn, period, vibratoFactor, nPeriodFrac);
 
 			// Final Period
 			// ST3 only clamps the final output period, but never the channel's internal period.
 			// Test case: PeriodLimit.s3m
 			if (period <= m_nMinPeriod)
 			{
-				if(m_playBehaviour[kST3LimitPeriod]) chn.nLength = 0;	// Pattern 15 in watcha.s3m
+				if(PlayBehaviourEnabled<TFormat, kST3LimitPeriod>()) chn.nLength = 0;	// Pattern 15 in watcha.s3m
 				period = m_nMinPeriod;
 			}
 
@@ -2326,16 +2373,16 @@ bool CSoundFile::ReadNote()
 
 			if((chn.dwFlags & (CHN_ADLIB | CHN_MUTE | CHN_SYNCMUTE)) == CHN_ADLIB && m_opl)
 			{
-				const bool doProcess = m_playBehaviour[kOPLFlexibleNoteOff] || !chn.dwFlags[CHN_NOTEFADE] || GetType() == MOD_TYPE_S3M;
-				if(doProcess && !(GetType() == MOD_TYPE_S3M && chn.dwFlags[CHN_KEYOFF]))
+				const bool doProcess = PlayBehaviourEnabled<TFormat, kOPLFlexibleNoteOff>() || !chn.dwFlags[CHN_NOTEFADE] || GetType<TFormat>() == MOD_TYPE_S3M;
+				if(doProcess && !(GetType<TFormat>() == MOD_TYPE_S3M && chn.dwFlags[CHN_KEYOFF]))
 				{
 					// In ST3, a sample rate of 8363 Hz is mapped to middle-C, which is 261.625 Hz in a tempered scale at A4 = 440.
 					// Hence, we have to translate our "sample rate" into pitch.
 					auto milliHertz = Util::muldivr_unsigned(freq, 261625, 8363 << FREQ_FRACBITS);
 
 					const bool keyOff = chn.dwFlags[CHN_KEYOFF] || (chn.dwFlags[CHN_NOTEFADE] && chn.nFadeOutVol == 0);
-					if(!m_playBehaviour[kOPLNoteStopWith0Hz] || !keyOff)
-						m_opl->Frequency(nChn, milliHertz, keyOff, m_playBehaviour[kOPLBeatingOscillators]);
+					if(!PlayBehaviourEnabled<TFormat, kOPLNoteStopWith0Hz>() || !keyOff)
+						m_opl->Frequency(nChn, milliHertz, keyOff, PlayBehaviourEnabled<TFormat, kOPLBeatingOscillators>());
 				}
 				if(doProcess)
 				{
@@ -2352,11 +2399,11 @@ bool CSoundFile::ReadNote()
 					&& ins->VolEnv.back().value == 0)
 				{
 					m_opl->NoteCut(nChn);
-					if(!m_playBehaviour[kOPLNoResetAtEnvelopeEnd])
+					if(!PlayBehaviourEnabled<TFormat, kOPLNoResetAtEnvelopeEnd>())
 						chn.dwFlags.reset(CHN_ADLIB);
 					chn.dwFlags.set(CHN_NOTEFADE);
 					chn.nFadeOutVol = 0;
-				} else if(m_playBehaviour[kOPLFlexibleNoteOff] && chn.dwFlags[CHN_NOTEFADE] && chn.nFadeOutVol == 0)
+				} else if(PlayBehaviourEnabled<TFormat, kOPLFlexibleNoteOff>() && chn.dwFlags[CHN_NOTEFADE] && chn.nFadeOutVol == 0)
 				{
 					m_opl->NoteCut(nChn);
 					chn.dwFlags.reset(CHN_ADLIB);
@@ -2365,11 +2412,11 @@ bool CSoundFile::ReadNote()
 		}
 
 		// Increment envelope positions
-		if(pIns != nullptr && !m_playBehaviour[kITEnvelopePositionHandling])
+		if(pIns != nullptr && !PlayBehaviourEnabled<TFormat, kITEnvelopePositionHandling>())
 		{
 			// In IT and FT2 compatible mode, envelope positions are updated above.
 			// Test cases: s77.it, EnvLoops.xm
-			IncrementEnvelopePositions(chn);
+			IncrementEnvelopePositions<TFormat>(chn);
 		}
 
 		// Volume ramping
@@ -2493,7 +2540,7 @@ bool CSoundFile::ReadNote()
 			if(chn.dwFlags[CHN_PINGPONGFLAG]) chn.increment.Negate();
 
 			// Setting up volume ramp
-			ProcessRamping(chn);
+			ProcessRamping<TFormat>(chn);
 
 			// Adding the channel in the channel list
 			if(!chn.dwFlags[CHN_ADLIB])
@@ -2682,7 +2729,20 @@ MPT_FORCEINLINE void ApplyGlobalVolumeWithRamping(int32 *SoundBuffer, int32 *Rea
 }
 
 
-void CSoundFile::ProcessGlobalVolume(long lCount)
+// Same as ApplyGlobalVolumeWithRamping, but only updates the ramping state for a silent mix buffer.
+static void AdvanceGlobalVolumeRamping(int32 lCount, int32 m_nGlobalVolume, int32 step, int32 &m_nSamplesToGlobalVolRampDest, int32 &m_lHighResRampingGlobalVolume)
+{
+	const int32 rampSamples = std::clamp(m_nSamplesToGlobalVolRampDest, int32(0), lCount);
+	m_lHighResRampingGlobalVolume += step * rampSamples;
+	m_nSamplesToGlobalVolRampDest -= rampSamples;
+	if(rampSamples < lCount)
+	{
+		m_lHighResRampingGlobalVolume = m_nGlobalVolume << VOLUMERAMPPRECISION;
+	}
+}
+
+
+void CSoundFile::ProcessGlobalVolume(long lCount, bool mixBufferSilent)
 {
 
 	// should we ramp?
@@ -2731,7 +2791,11 @@ void CSoundFile::ProcessGlobalVolume(long lCount)
 	}
 
 	// apply volume and ramping
-	if(m_MixerSettings.gnChannels == 1)
+	if(mixBufferSilent)
+	{
+		if(m_MixerSettings.gnChannels == 1 || m_MixerSettings.gnChannels == 2 || m_MixerSettings.gnChannels == 4)
+			AdvanceGlobalVolumeRamping(lCount, m_PlayState.m_nGlobalVolume, step, m_PlayState.m_nSamplesToGlobalVolRampDest, m_PlayState.m_lHighResRampingGlobalVolume);
+	} else if(m_MixerSettings.gnChannels == 1)
 	{
 		ApplyGlobalVolumeWithRamping<1>(MixSoundBuffer, MixRearBuffer, lCount, m_PlayState.m_nGlobalVolume, step, m_PlayState.m_nSamplesToGlobalVolRampDest, m_PlayState.m_lHighResRampingGlobalVolume);
 	} else if(m_MixerSettings.gnChannels == 2)
@@ -2751,4 +2815,11 @@ void CSoundFile::ProcessStereoSeparation(long countChunk)
 }
 
 
+// Generic versions of the tick processing helpers that are also used outside of ReadNote
+template void CSoundFile::ProcessRamping<AnyFormat>(ModChannel &chn) const;
+template int CSoundFile::ProcessPitchFilterEnvelope<AnyFormat>(ModChannel &chn, int32 &period) const;
+template void CSoundFile::IncrementEnvelopePositions<AnyFormat>(ModChannel &chn) const;
+template void CSoundFile::ProcessPanbrello<AnyFormat>(ModChannel &chn) const;
+
+
 OPENMPT_NAMESPACE_END
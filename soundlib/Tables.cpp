@@ -15,6 +15,8 @@
 
 #include "Resampler.h"
 #include "WindowedFIR.h"
+#include "../common/version.h"
+#include "mpt/crc/crc.hpp"
 #include <cmath>
 
 
@@ -802,13 +804,165 @@ void CResampler::InitializeTablesFromScratch(bool force)
 
 #ifdef MPT_RESAMPLER_TABLES_CACHED
 
-static const CResampler & GetCachedResampler()
+namespace
+{
+
+// Tables blobs are only ever used by the same build that wrote them, so everything is stored in native byte order and layout.
+// The header records everything that the layout and contents of the tables depend on.
+struct ResamplerTablesBlobHeader
+{
+	char magic[16];
+	uint32 version;
+	uint32 byteOrder;
+	uint32 intMixer;
+	uint32 sincPhases;
+	uint32 sincTypeSize;
+	uint32 wfirLutSize;
+	uint32 wfirTypeSize;
+	uint32 blepTablesSize;
+	uint64 wfirCutoff;
+	uint32 wfirType;
+	uint32 payloadSize;
+	uint32 payloadCRC;
+	uint32 reserved;
+};
+
+constexpr char ResamplerTablesBlobMagic[16] = "OpenMPT ResTbl1";
+
+static_assert(std::is_trivially_copyable<ResamplerTablesBlobHeader>::value);
+static_assert(std::is_trivially_copyable<Paula::BlepTables>::value);
+
+constexpr std::size_t ResamplerTablesPayloadSize = sizeof(CResampler::gKaiserSinc) + sizeof(CResampler::gDownsample13x) + sizeof(CResampler::gDownsample2x) + sizeof(CWindowedFIR::lut) + sizeof(Paula::BlepTables);
+
+ResamplerTablesBlobHeader MakeResamplerTablesBlobHeader()
+{
+	const CResamplerSettings settings;
+	ResamplerTablesBlobHeader header{};
+	std::copy(std::begin(ResamplerTablesBlobMagic), std::end(ResamplerTablesBlobMagic), std::begin(header.magic));
+	header.version = Version::Current().GetRawVersion();
+	header.byteOrder = 0x01020304;
+#ifdef MPT_INTMIXER
+	header.intMixer = 1;
+#endif // MPT_INTMIXER
+	header.sincPhases = SINC_PHASES;
+	header.sincTypeSize = sizeof(SINC_TYPE);
+	header.wfirLutSize = WFIR_LUTLEN * WFIR_WIDTH;
+	header.wfirTypeSize = sizeof(WFIR_TYPE);
+	header.blepTablesSize = sizeof(Paula::BlepTables);
+	header.wfirCutoff = mpt::bit_cast<uint64>(settings.gdWFIRCutoff);
+	header.wfirType = settings.gbWFIRType;
+	header.payloadSize = static_cast<uint32>(ResamplerTablesPayloadSize);
+	return header;
+}
+
+uint32 ResamplerTablesPayloadCRC(mpt::const_byte_span payload)
+{
+	mpt::crc32 crc;
+	crc.process(payload.begin(), payload.end());
+	return crc.result();
+}
+
+template <typename T>
+std::byte *CopyToBlob(std::byte *dst, const T &table)
+{
+	std::memcpy(dst, &table, sizeof(T));
+	return dst + sizeof(T);
+}
+
+template <typename T>
+const std::byte *CopyFromBlob(const std::byte *src, T &table)
 {
-	static CResampler s_CachedResampler(true);
+	std::memcpy(&table, src, sizeof(T));
+	return src + sizeof(T);
+}
+
+}  // namespace
+
+
+static const CResampler & GetCachedResampler(mpt::const_byte_span tablesBlob = mpt::const_byte_span())
+{
+	// Only the blob passed to the very first call is used.
+	static const CResampler s_CachedResampler(tablesBlob);
 	return s_CachedResampler;
 }
 
 
+CResampler::CResampler(mpt::const_byte_span tablesBlob)
+{
+	if(!InitializeTablesFromBlob(tablesBlob))
+	{
+		InitializeTablesFromScratch(true);
+	}
+}
+
+
+std::vector<std::byte> CResampler::GetTablesCacheBlob()
+{
+	const CResampler &cachedResampler = GetCachedResampler();
+	std::vector<std::byte> blob(sizeof(ResamplerTablesBlobHeader) + ResamplerTablesPayloadSize);
+	std::byte *payload = blob.data() + sizeof(ResamplerTablesBlobHeader);
+	std::byte *dst = payload;
+	dst = CopyToBlob(dst, cachedResampler.gKaiserSinc);
+	dst = CopyToBlob(dst, cachedResampler.gDownsample13x);
+	dst = CopyToBlob(dst, cachedResampler.gDownsample2x);
+	dst = CopyToBlob(dst, cachedResampler.m_WindowedFIR.lut);
+	dst = CopyToBlob(dst, cachedResampler.blepTables);
+	MPT_ASSERT(dst == blob.data() + blob.size());
+	ResamplerTablesBlobHeader header = MakeResamplerTablesBlobHeader();
+	header.payloadCRC = ResamplerTablesPayloadCRC(mpt::const_byte_span(payload, ResamplerTablesPayloadSize));
+	CopyToBlob(blob.data(), header);
+	return blob;
+}
+
+
+bool CResampler::IsValidTablesBlob(mpt::const_byte_span tablesBlob)
+{
+	if(tablesBlob.size() != sizeof(ResamplerTablesBlobHeader) + ResamplerTablesPayloadSize)
+	{
+		return false;
+	}
+	ResamplerTablesBlobHeader header;
+	CopyFromBlob(tablesBlob.data(), header);
+	ResamplerTablesBlobHeader expectedHeader = MakeResamplerTablesBlobHeader();
+	expectedHeader.payloadCRC = header.payloadCRC;
+	if(std::memcmp(&header, &expectedHeader, sizeof(ResamplerTablesBlobHeader)))
+	{
+		return false;
+	}
+	return header.payloadCRC == ResamplerTablesPayloadCRC(tablesBlob.subspan(sizeof(ResamplerTablesBlobHeader)));
+}
+
+
+bool CResampler::InitializeTablesCache(mpt::const_byte_span tablesBlob)
+{
+	if(!IsValidTablesBlob(tablesBlob))
+	{
+		return false;
+	}
+	GetCachedResampler(tablesBlob);
+	return true;
+}
+
+
+bool CResampler::InitializeTablesFromBlob(mpt::const_byte_span tablesBlob)
+{
+	if(!IsValidTablesBlob(tablesBlob))
+	{
+		return false;
+	}
+	InitFloatmixerTables();
+	const std::byte *src = tablesBlob.data() + sizeof(ResamplerTablesBlobHeader);
+	src = CopyFromBlob(src, gKaiserSinc);
+	src = CopyFromBlob(src, gDownsample13x);
+	src = CopyFromBlob(src, gDownsample2x);
+	src = CopyFromBlob(src, m_WindowedFIR.lut);
+	src = CopyFromBlob(src, blepTables);
+	MPT_ASSERT(src == tablesBlob.data() + tablesBlob.size());
+	m_OldSettings = m_Settings;
+	return true;
+}
+
+
 void CResampler::InitializeTablesFromCache()
 {
 	const CResampler & s_CachedResampler = GetCachedResampler();
@@ -2,6 +2,8 @@
 // It was released by Shayde/Reality into the public domain.
 // Minor modifications to silence some warnings and fix a bug in the envelope generator have been applied.
 // Additional fixes by JP Cimalando.
+// Block rendering that skips silent channels has been added for OpenMPT.
+// Define OPAL_DECLARATION_ONLY before including this file to only get the class declaration (used by the unit tests).
 
 /*
 
@@ -21,6 +23,7 @@
 
 
 
+#include <cstddef>
 #include <cstdint>
 
 
@@ -52,6 +55,7 @@ class Opal {
                             Operator();
             void            SetMaster(Opal *opal) {  Master = opal;  }
             void            SetChannel(Channel *chan) {  Chan = chan;  }
+            bool            IsOff() const {  return EnvelopeStage == EnvOff;  }
 
             int16_t         Output(uint16_t keyscalenum, uint32_t phase_step, int16_t vibrato, int16_t mod = 0, int16_t fbshift = 0);
 
@@ -129,6 +133,7 @@ class Opal {
             }
 
             void            Output(int16_t &left, int16_t &right);
+            bool            IsSilent() const;
             void            SetEnable(bool on) {  Enable = on;  }
             void            SetChannelPair(Channel *pair) {  ChannelPair = pair;  }
 
@@ -175,10 +180,12 @@ class Opal {
         void                SetSampleRate(int sample_rate);
         void                Port(uint16_t reg_num, uint8_t val);
         void                Sample(int16_t *left, int16_t *right);
+        void                SampleBlock(int16_t *buffer, size_t count);
 
     protected:
         void                Init(int sample_rate);
         void                Output(int16_t &left, int16_t &right);
+        void                Output(int16_t &left, int16_t &right, const uint8_t *channels, int num_channels);
 
         int32_t             SampleRate;
         int32_t             SampleAccum;
@@ -200,6 +207,10 @@ class Opal {
         static const uint16_t   ExpTable[256];
         static const uint16_t   LogSinTable[256];
 };
+
+
+
+#ifndef OPAL_DECLARATION_ONLY
 //--------------------------------------------------------------------------------------------------
 const uint16_t Opal::RateTables[4][8] = {
     {   1, 0, 1, 0, 1, 0, 1, 0  },
@@ -577,18 +588,67 @@ void Opal::Sample(int16_t *left, int16_t *right) {
 
 
 
+//==================================================================================================
+// Generate a block of samples.  The buffer receives count interleaved stereo sample pairs, which
+// are identical to what count calls to Sample() would produce.
+//
+// Registers can't be written while the block is rendered, so no operator can be keyed on in the
+// meantime.  Channels that are silent at the start of the block therefore stay silent and are
+// skipped entirely.  The phase of an operator that is switched off doesn't need to be advanced
+// either, as it is reset when the operator is keyed on again.
+//==================================================================================================
+void Opal::SampleBlock(int16_t *buffer, size_t count) {
+
+    uint8_t channels[NumChannels];
+    int num_channels = 0;
+    for (int i = 0; i < NumChannels; i++) {
+        if (!Chan[i].IsSilent())
+            channels[num_channels++] = static_cast<uint8_t>(i);
+    }
+
+    while (count--) {
+
+        while (SampleAccum >= SampleRate) {
+
+            LastOutput[0] = CurrOutput[0];
+            LastOutput[1] = CurrOutput[1];
+
+            Output(CurrOutput[0], CurrOutput[1], channels, num_channels);
+
+            SampleAccum -= SampleRate;
+        }
+
+        int32_t omblend = SampleRate - SampleAccum;
+        buffer[0] = static_cast<uint16_t>((LastOutput[0] * omblend + CurrOutput[0] * SampleAccum) / SampleRate);
+        buffer[1] = static_cast<uint16_t>((LastOutput[1] * omblend + CurrOutput[1] * SampleAccum) / SampleRate);
+        buffer += 2;
+
+        SampleAccum += OPL3SampleRate;
+    }
+}
+
+
+
 //==================================================================================================
 // Produce final output from the chip.  This is at the OPL3 sample-rate.
 //==================================================================================================
 void Opal::Output(int16_t &left, int16_t &right) {
 
+    static constexpr uint8_t all_channels[NumChannels] = {
+        0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 17,
+    };
+    Output(left, right, all_channels, NumChannels);
+}
+//--------------------------------------------------------------------------------------------------
+void Opal::Output(int16_t &left, int16_t &right, const uint8_t *channels, int num_channels) {
+
     int32_t leftmix = 0, rightmix = 0;
 
     // Sum the output of each channel
-    for (int i = 0; i < NumChannels; i++) {
+    for (int i = 0; i < num_channels; i++) {
 
         int16_t chanleft, chanright;
-        Chan[i].Output(chanleft, chanright);
+        Chan[channels[i]].Output(chanleft, chanright);
 
         leftmix += chanleft;
         rightmix += chanright;
@@ -751,6 +811,25 @@ void Opal::Channel::Output(int16_t &left, int16_t &right) {
 
 
 
+//==================================================================================================
+// Check whether the channel currently produces any output.  A disabled channel doesn't touch its
+// operators at all, and operators that are switched off only advance their phase.
+//==================================================================================================
+bool Opal::Channel::IsSilent() const {
+
+    if (!Enable)
+        return true;
+
+    int num_ops = ChannelPair ? 4 : 2;
+    for (int i = 0; i < num_ops; i++) {
+        if (!Op[i]->IsOff())
+            return false;
+    }
+    return true;
+}
+
+
+
 //==================================================================================================
 // Set phase step for operators using this channel.
 //==================================================================================================
@@ -1343,3 +1422,5 @@ void Opal::Operator::ComputeKeyScaleLevel() {
     uint16_t i = (Chan->GetOctave() << 4) | (Chan->GetFreq() >> 6);
     KeyScaleLevel = levtab[i] >> KeyScaleShift;
 }
+
+#endif // !OPAL_DECLARATION_ONLY
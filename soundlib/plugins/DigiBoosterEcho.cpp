@@ -32,10 +32,10 @@ DigiBoosterEcho::DigiBoosterEcho(VSTPluginLib &factory, CSoundFile &sndFile, SND
 }
 
 
-void DigiBoosterEcho::Process(float *pOutL, float *pOutR, uint32 numFrames)
+bool DigiBoosterEcho::RenderOutput(uint32 numFrames)
 {
 	if(!m_bufferSize)
-		return;
+		return false;
 	const float *srcL = m_mixBuffer.GetInputBuffer(0), *srcR = m_mixBuffer.GetInputBuffer(1);
 	float *outL = m_mixBuffer.GetOutputBuffer(0), *outR = m_mixBuffer.GetOutputBuffer(1);
 
@@ -76,7 +76,7 @@ void DigiBoosterEcho::Process(float *pOutL, float *pOutR, uint32 numFrames)
 		*outR++ = (r * m_NMix + rDelay * m_PMix);
 	}
 
-	ProcessMixOps(pOutL, pOutR, m_mixBuffer.GetOutputBuffer(0), m_mixBuffer.GetOutputBuffer(1), numFrames);
+	return true;
 }
 
 
@@ -228,6 +228,13 @@ double IMixPlugin::GetOutputLatency() const
 }
 
 
+void IMixPlugin::Process(float *pOutL, float *pOutR, uint32 numFrames)
+{
+	if(RenderOutput(numFrames))
+		MixOutput(pOutL, pOutR, numFrames);
+}
+
+
 void IMixPlugin::ProcessMixOps(float * MPT_RESTRICT pOutL, float * MPT_RESTRICT pOutR, float * MPT_RESTRICT leftPlugOutput, float * MPT_RESTRICT rightPlugOutput, uint32 numFrames)
 {
 /*	float *leftPlugOutput;
@@ -135,7 +135,14 @@ public:
 	virtual void SaveAllParameters();
 	// Restore parameters from module file
 	virtual void RestoreAllParameters(int32 program);
-	virtual void Process(float *pOutL, float *pOutR, uint32 numFrames) = 0;
+	// Render the plugin and mix its output into pOutL / pOutR. The default implementation uses RenderOutput() and MixOutput().
+	virtual void Process(float *pOutL, float *pOutR, uint32 numFrames);
+	// Render the plugin into its own output buffers without mixing them into the output yet. Returns false if there is nothing to mix.
+	virtual bool RenderOutput(uint32 /*numFrames*/) { return false; }
+	// Mix the output buffers filled by RenderOutput() into pOutL / pOutR.
+	void MixOutput(float *pOutL, float *pOutR, uint32 numFrames) { ProcessMixOps(pOutL, pOutR, m_mixBuffer.GetOutputBuffer(0), m_mixBuffer.GetOutputBuffer(1), numFrames); }
+	// If true, RenderOutput() only accesses this plugin's own state and buffers and may run concurrently with other plugins.
+	virtual bool CanRenderConcurrently() const { return false; }
 	void ProcessMixOps(float *pOutL, float *pOutR, float *leftPlugOutput, float *rightPlugOutput, uint32 numFrames);
 	// Render silence and return the highest resulting output level
 	virtual float RenderSilence(uint32 numSamples);
@@ -0,0 +1,99 @@
+/*
+ * PluginGraph.cpp
+ * ---------------
+ * Purpose: Cached plugin routing and per-chunk processing schedule for CSoundFile::ProcessPlugins.
+ * Notes  : (currently none)
+ * Authors: OpenMPT Devs
+ * The OpenMPT source code is released under the BSD license. Read LICENSE for more details.
+ */
+
+
+#include "stdafx.h"
+
+#ifndef NO_PLUGINS
+#include "PluginGraph.h"
+#include "PlugInterface.h"
+
+OPENMPT_NAMESPACE_BEGIN
+
+
+PluginGraph::SlotKey PluginGraph::GetSlotKey(const SNDMIXPLUGIN &plugin)
+{
+	SlotKey key;
+	key.plugin = plugin.pMixPlugin;
+	key.outputRouting = plugin.Info.dwOutputRouting;
+	key.masterEffect = plugin.IsMasterEffect();
+	if(plugin.pMixPlugin != nullptr)
+	{
+		key.active = plugin.pMixPlugin->m_MixState.pMixBuffer != nullptr && plugin.pMixPlugin->m_mixBuffer.Ok();
+		key.concurrent = plugin.pMixPlugin->CanRenderConcurrently();
+	}
+	return key;
+}
+
+
+void PluginGraph::Update(const std::array<SNDMIXPLUGIN, MAX_MIXPLUGINS> &plugins)
+{
+	bool changed = !m_compiled;
+	for(PLUGINDEX plug = 0; plug < MAX_MIXPLUGINS; plug++)
+	{
+		const SlotKey key = GetSlotKey(plugins[plug]);
+		if(key != m_slots[plug])
+		{
+			m_slots[plug] = key;
+			changed = true;
+		}
+	}
+	if(changed)
+		Compile(plugins);
+}
+
+
+void PluginGraph::Compile(const std::array<SNDMIXPLUGIN, MAX_MIXPLUGINS> &plugins)
+{
+	m_nodes.clear();
+	m_renderConcurrently = true;
+	std::array<bool, MAX_MIXPLUGINS> hasInputPlugins{};
+	for(PLUGINDEX plug = 0; plug < MAX_MIXPLUGINS; plug++)
+	{
+		const SNDMIXPLUGIN &plugin = plugins[plug];
+		const PLUGINDEX output = plugin.GetOutputPlugin();
+		if(output > plug && output < MAX_MIXPLUGINS)
+			hasInputPlugins[output] = true;
+
+		if(!m_slots[plug].active)
+			continue;
+
+		Node node;
+		node.plug = plug;
+		node.hasInputPlugins = hasInputPlugins[plug];
+		if(!plugin.IsOutputToMaster() && output > plug && output < MAX_MIXPLUGINS && plugins[output].pMixPlugin != nullptr)
+			node.outputPlugin = output;
+		if(plugin.IsMasterEffect())
+		{
+			PLUGINDEX out = output, prevOut = plug;
+			while(out > prevOut && out < MAX_MIXPLUGINS)
+			{
+				prevOut = out;
+				if(plugins[out].pMixPlugin != nullptr)
+					node.masterChain.push_back(plugins[out].pMixPlugin);
+				out = plugins[out].GetOutputPlugin();
+			}
+		}
+		if(!m_slots[plug].concurrent)
+			m_renderConcurrently = false;
+		m_nodes.push_back(std::move(node));
+	}
+	if(m_nodes.size() < 2)
+		m_renderConcurrently = false;
+
+	steps.reserve(m_nodes.size());
+	batch.reserve(m_nodes.size());
+	lastWriter.resize(MAX_MIXPLUGINS + 1);
+	m_compiled = true;
+}
+
+
+OPENMPT_NAMESPACE_END
+
+#endif // NO_PLUGINS
@@ -0,0 +1,94 @@
+/*
+ * PluginGraph.h
+ * -------------
+ * Purpose: Cached plugin routing and per-chunk processing schedule for CSoundFile::ProcessPlugins.
+ * Notes  : The routing is only compiled again when the plugin configuration changes, not for every mix chunk.
+ * Authors: OpenMPT Devs
+ * The OpenMPT source code is released under the BSD license. Read LICENSE for more details.
+ */
+
+
+#pragma once
+
+#include "openmpt/all/BuildSettings.hpp"
+
+#include "PluginStructs.h"
+
+#include <array>
+#include <vector>
+
+
+OPENMPT_NAMESPACE_BEGIN
+
+
+#ifndef NO_PLUGINS
+
+
+class PluginGraph
+{
+public:
+	// A plugin slot that can be processed, in processing order
+	struct Node
+	{
+		PLUGINDEX plug = 0;
+		PLUGINDEX outputPlugin = PLUGINDEX_INVALID;  // Loaded plugin that receives this plugin's output, if any
+		bool hasInputPlugins = false;               // Any previous slot is routed to this plugin
+		std::vector<IMixPlugin *> masterChain;      // Plugins further down the output chain, woken up along with a master effect
+	};
+
+	// A plugin that is processed in the current mix chunk
+	struct Step
+	{
+		SNDMIXPLUGIN *mixPlugin = nullptr;
+		float *inL = nullptr, *inR = nullptr;
+		float *outL = nullptr, *outR = nullptr;
+		float *masterL = nullptr, *masterR = nullptr;  // Master mix that has to be moved into the plugin input before processing
+		int32 lastInputWriter = -1;                    // Last previous step that writes to this plugin's input
+		bool bypass = false;
+		bool renderPending = false;
+		bool hasOutput = false;
+	};
+
+	// Compile the graph again if the plugin configuration has changed since the last call.
+	void Update(const std::array<SNDMIXPLUGIN, MAX_MIXPLUGINS> &plugins);
+
+	const std::vector<Node> &GetNodes() const { return m_nodes; }
+	// True if more than one plugin is loaded and all of them can be rendered concurrently
+	bool CanRenderConcurrently() const { return m_renderConcurrently; }
+
+	// Scratch space for CSoundFile::ProcessPlugins, reused to avoid allocations while rendering
+	std::vector<Step> steps;
+	std::vector<int32> lastWriter;  // Last step writing to a plugin's input buffer, or to the master mix at index MAX_MIXPLUGINS
+	std::vector<uint32> batch;
+
+protected:
+	// Everything about a plugin slot that the compiled graph depends on
+	struct SlotKey
+	{
+		const IMixPlugin *plugin = nullptr;
+		uint32 outputRouting = 0;
+		bool masterEffect = false;
+		bool active = false;
+		bool concurrent = false;
+
+		bool operator==(const SlotKey &other) const
+		{
+			return plugin == other.plugin && outputRouting == other.outputRouting && masterEffect == other.masterEffect && active == other.active && concurrent == other.concurrent;
+		}
+		bool operator!=(const SlotKey &other) const { return !(*this == other); }
+	};
+
+	static SlotKey GetSlotKey(const SNDMIXPLUGIN &plugin);
+	void Compile(const std::array<SNDMIXPLUGIN, MAX_MIXPLUGINS> &plugins);
+
+	std::array<SlotKey, MAX_MIXPLUGINS> m_slots;
+	std::vector<Node> m_nodes;
+	bool m_compiled = false;
+	bool m_renderConcurrently = false;
+};
+
+
+#endif // NO_PLUGINS
+
+
+OPENMPT_NAMESPACE_END
@@ -32,7 +32,7 @@ SymMODEcho::SymMODEcho(VSTPluginLib &factory, CSoundFile &sndFile, SNDMIXPLUGIN
 }
 
 
-void SymMODEcho::Process(float* pOutL, float* pOutR, uint32 numFrames)
+bool SymMODEcho::RenderOutput(uint32 numFrames)
 {
 	const float *srcL = m_mixBuffer.GetInputBuffer(0), *srcR = m_mixBuffer.GetInputBuffer(1);
 	float *outL = m_mixBuffer.GetOutputBuffer(0), *outR = m_mixBuffer.GetOutputBuffer(1);
@@ -100,7 +100,7 @@ void SymMODEcho::Process(float* pOutL, float* pOutR, uint32 numFrames)
 		}
 	}
 
-	ProcessMixOps(pOutL, pOutR, m_mixBuffer.GetOutputBuffer(0), m_mixBuffer.GetOutputBuffer(1), numFrames);
+	return true;
 }
 
 
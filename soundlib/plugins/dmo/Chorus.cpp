@@ -56,10 +56,10 @@ int32 Chorus::GetBufferIntOffset(int32 fpOffset) const
 }
 
 
-void Chorus::Process(float *pOutL, float *pOutR, uint32 numFrames)
+bool Chorus::RenderOutput(uint32 numFrames)
 {
 	if(!m_bufSize || !m_mixBuffer.Ok())
-		return;
+		return false;
 
 	const float *in[2] = { m_mixBuffer.GetInputBuffer(0), m_mixBuffer.GetInputBuffer(1) };
 	float *out[2] = { m_mixBuffer.GetOutputBuffer(0), m_mixBuffer.GetOutputBuffer(1) };
@@ -136,7 +136,7 @@ void Chorus::Process(float *pOutL, float *pOutR, uint32 numFrames)
 		m_bufPos -= 4096;
 	}
 
-	ProcessMixOps(pOutL, pOutR, m_mixBuffer.GetOutputBuffer(0), m_mixBuffer.GetOutputBuffer(1), numFrames);
+	return true;
 }
 
 
@@ -48,14 +48,17 @@ Compressor::Compressor(VSTPluginLib &factory, CSoundFile &sndFile, SNDMIXPLUGIN
 }
 
 
-void Compressor::Process(float *pOutL, float *pOutR, uint32 numFrames)
+bool Compressor::RenderOutput(uint32 numFrames)
 {
 	if(!m_bufSize || !m_mixBuffer.Ok())
-		return;
+		return false;
 
 	const float *in[2] = { m_mixBuffer.GetInputBuffer(0), m_mixBuffer.GetInputBuffer(1) };
 	float *out[2] = { m_mixBuffer.GetOutputBuffer(0), m_mixBuffer.GetOutputBuffer(1) };
 
+	// The read position is ((m_predelay + m_bufPos * 4096 + m_bufSize - 1) / 4096) % m_bufSize, without dividing for every frame
+	const int32 readDelay = ((m_predelay + m_bufSize - 1) / 4096) % m_bufSize;
+
 	for(uint32 i = numFrames; i != 0; i--)
 	{
 		float leftIn  = *(in[0])++;
@@ -89,9 +92,9 @@ void Compressor::Process(float *pOutL, float *pOutR, uint32 numFrames)
 		}
 		compGainPow >>= (31 - compGainInt);
 		
-		int32 readOffset = m_predelay + m_bufPos * 4096 + m_bufSize - 1;
-		readOffset /= 4096;
-		readOffset %= m_bufSize;
+		int32 readOffset = m_bufPos + readDelay;
+		if(readOffset >= m_bufSize)
+			readOffset -= m_bufSize;
 		
 		float outGain = (compGainPow * (1.0f / 2147483648.0f)) * m_gain;
 		*(out[0])++ = m_buffer[readOffset * 2] * outGain;
@@ -101,7 +104,7 @@ void Compressor::Process(float *pOutL, float *pOutR, uint32 numFrames)
 			m_bufPos += m_bufSize;
 	}
 
-	ProcessMixOps(pOutL, pOutR, m_mixBuffer.GetOutputBuffer(0), m_mixBuffer.GetOutputBuffer(1), numFrames);
+	return true;
 }
 
 
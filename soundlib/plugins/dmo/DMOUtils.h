@@ -8,6 +8,15 @@
  */
 
 
+#pragma once
+
+#include "openmpt/all/BuildSettings.hpp"
+
+#include "mpt/base/bit.hpp"
+
+#include <algorithm>
+
+
 OPENMPT_NAMESPACE_BEGIN
 
 #ifndef NO_PLUGINS
@@ -16,7 +25,35 @@ namespace DMO
 {
 
 // Computes (log2(x) + 1) * 2 ^ (shiftL - shiftR) (x = -2^31...2^31)
-float logGain(float x, int32 shiftL, int32 shiftR);
+// Called for every sample by some plugins, hence inline.
+inline float logGain(float x, int32 shiftL, int32 shiftR)
+{
+	uint32 intSample = static_cast<uint32>(static_cast<int64>(x));
+	const uint32 sign = intSample & 0x80000000;
+	if(sign)
+		intSample = (~intSample) + 1;
+
+	// Multiply until overflow (or edge shift factor is reached)
+	if(intSample == 0)
+	{
+		shiftL = std::min(shiftL, int32(0));
+	} else if(shiftL > 0)
+	{
+		const int32 shift = std::min(shiftL, static_cast<int32>(mpt::countl_zero(intSample)));
+		intSample <<= shift;
+		shiftL -= shift;
+	}
+	// Unsign clipped sample
+	if(intSample >= 0x80000000)
+	{
+		intSample &= 0x7FFFFFFF;
+		shiftL++;
+	}
+	intSample = (shiftL << (31 - shiftR)) | (intSample >> shiftR);
+	if(sign)
+		intSample = ~intSample | sign;
+	return static_cast<float>(static_cast<int32>(intSample));
+}
 
 }
 
@@ -46,10 +46,10 @@ Distortion::Distortion(VSTPluginLib &factory, CSoundFile &sndFile, SNDMIXPLUGIN
 }
 
 
-void Distortion::Process(float *pOutL, float *pOutR, uint32 numFrames)
+bool Distortion::RenderOutput(uint32 numFrames)
 {
 	if(!m_mixBuffer.Ok())
-		return;
+		return false;
 
 	const float *in[2] = { m_mixBuffer.GetInputBuffer(0), m_mixBuffer.GetInputBuffer(1) };
 	float *out[2] = { m_mixBuffer.GetOutputBuffer(0), m_mixBuffer.GetOutputBuffer(1) };
@@ -79,7 +79,7 @@ void Distortion::Process(float *pOutL, float *pOutR, uint32 numFrames)
 		}
 	}
 
-	ProcessMixOps(pOutL, pOutR, m_mixBuffer.GetOutputBuffer(0), m_mixBuffer.GetOutputBuffer(1), numFrames);
+	return true;
 }
 
 
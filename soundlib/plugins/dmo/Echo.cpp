@@ -46,10 +46,10 @@ Echo::Echo(VSTPluginLib &factory, CSoundFile &sndFile, SNDMIXPLUGIN *mixStruct)
 }
 
 
-void Echo::Process(float *pOutL, float *pOutR, uint32 numFrames)
+bool Echo::RenderOutput(uint32 numFrames)
 {
 	if(!m_bufferSize || !m_mixBuffer.Ok())
-		return;
+		return false;
 	const float wetMix = m_param[kEchoWetDry], dryMix = 1 - wetMix;
 	const float *in[2] = { m_mixBuffer.GetInputBuffer(0), m_mixBuffer.GetInputBuffer(1) };
 	float *out[2] = { m_mixBuffer.GetOutputBuffer(0), m_mixBuffer.GetOutputBuffer(1) };
@@ -83,7 +83,7 @@ void Echo::Process(float *pOutL, float *pOutR, uint32 numFrames)
 			m_writePos = 0;
 	}
 
-	ProcessMixOps(pOutL, pOutR, m_mixBuffer.GetOutputBuffer(0), m_mixBuffer.GetOutputBuffer(1), numFrames);
+	return true;
 }
 
 
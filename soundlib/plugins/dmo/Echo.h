@@ -51,7 +51,8 @@ public:
 	void Idle() override { }
 	uint32 GetLatency() const override { return 0; }
 
-	void Process(float *pOutL, float *pOutR, uint32 numFrames)override;
+	bool RenderOutput(uint32 numFrames) override;
+	bool CanRenderConcurrently() const override { return true; }
 
 	float RenderSilence(uint32) override { return 0.0f; }
 
@@ -39,10 +39,10 @@ Gargle::Gargle(VSTPluginLib &factory, CSoundFile &sndFile, SNDMIXPLUGIN *mixStru
 }
 
 
-void Gargle::Process(float *pOutL, float *pOutR, uint32 numFrames)
+bool Gargle::RenderOutput(uint32 numFrames)
 {
 	if(!m_mixBuffer.Ok())
-		return;
+		return false;
 
 	const float *inL = m_mixBuffer.GetInputBuffer(0), *inR = m_mixBuffer.GetInputBuffer(1);
 	float *outL = m_mixBuffer.GetOutputBuffer(0), *outR = m_mixBuffer.GetOutputBuffer(1);
@@ -103,7 +103,7 @@ void Gargle::Process(float *pOutL, float *pOutR, uint32 numFrames)
 		}
 	}
 
-	ProcessMixOps(pOutL, pOutR, m_mixBuffer.GetOutputBuffer(0), m_mixBuffer.GetOutputBuffer(1), numFrames);
+	return true;
 }
 
 
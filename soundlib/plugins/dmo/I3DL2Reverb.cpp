@@ -102,7 +102,7 @@ I3DL2Reverb::I3DL2Reverb(VSTPluginLib &factory, CSoundFile &sndFile, SNDMIXPLUGI
 }
 
 
-void I3DL2Reverb::Process(float *pOutL, float *pOutR, uint32 numFrames)
+bool I3DL2Reverb::RenderOutput(uint32 numFrames)
 {
 	if(m_recalcParams)
 	{
@@ -114,7 +114,7 @@ void I3DL2Reverb::Process(float *pOutL, float *pOutR, uint32 numFrames)
 	}
 
 	if(!m_ok || !m_mixBuffer.Ok())
-		return;
+		return false;
 
 	const float *in[2] = { m_mixBuffer.GetInputBuffer(0), m_mixBuffer.GetInputBuffer(1) };
 	float *out[2] = { m_mixBuffer.GetOutputBuffer(0), m_mixBuffer.GetOutputBuffer(1) };
@@ -293,7 +293,7 @@ void I3DL2Reverb::Process(float *pOutL, float *pOutR, uint32 numFrames)
 		frames--;
 	}
 
-	ProcessMixOps(pOutL, pOutR, m_mixBuffer.GetOutputBuffer(0), m_mixBuffer.GetOutputBuffer(1), numFrames);
+	return true;
 }
 
 
@@ -14,6 +14,10 @@
 #include "../../Sndfile.h"
 #include "ParamEq.h"
 #include "mpt/base/numbers.hpp"
+#if defined(MPT_ENABLE_ARCH_INTRINSICS_SSE2)
+#include "../../../misc/mptCPU.h"
+#include <emmintrin.h>
+#endif
 #endif // !NO_PLUGINS
 
 OPENMPT_NAMESPACE_BEGIN
@@ -42,10 +46,10 @@ ParamEq::ParamEq(VSTPluginLib &factory, CSoundFile &sndFile, SNDMIXPLUGIN *mixSt
 }
 
 
-void ParamEq::Process(float *pOutL, float *pOutR, uint32 numFrames)
+bool ParamEq::RenderOutput(uint32 numFrames)
 {
 	if(!m_mixBuffer.Ok())
-		return;
+		return false;
 
 	const float *in[2] = { m_mixBuffer.GetInputBuffer(0), m_mixBuffer.GetInputBuffer(1) };
 	float *out[2] = { m_mixBuffer.GetOutputBuffer(0), m_mixBuffer.GetOutputBuffer(1) };
@@ -56,6 +60,37 @@ void ParamEq::Process(float *pOutL, float *pOutR, uint32 numFrames)
 		memcpy(out[1], in[1], numFrames * sizeof(float));
 	} else
 	{
+#if defined(MPT_ENABLE_ARCH_INTRINSICS_SSE2)
+		if(CPU::HasFeatureSet(CPU::feature::sse2))
+		{
+			// Both channels are processed in the lower two lanes, in the same order of operations as the scalar code below.
+			const __m128 b0 = _mm_set1_ps(b0DIVa0), b1 = _mm_set1_ps(b1DIVa0), b2 = _mm_set1_ps(b2DIVa0);
+			const __m128 a1 = _mm_set1_ps(a1DIVa0), a2 = _mm_set1_ps(a2DIVa0);
+			__m128 vx1 = _mm_loadl_pi(_mm_setzero_ps(), reinterpret_cast<const __m64 *>(x1));
+			__m128 vx2 = _mm_loadl_pi(_mm_setzero_ps(), reinterpret_cast<const __m64 *>(x2));
+			__m128 vy1 = _mm_loadl_pi(_mm_setzero_ps(), reinterpret_cast<const __m64 *>(y1));
+			__m128 vy2 = _mm_loadl_pi(_mm_setzero_ps(), reinterpret_cast<const __m64 *>(y2));
+			for(uint32 i = numFrames; i != 0; i--)
+			{
+				const __m128 x = _mm_unpacklo_ps(_mm_load_ss(in[0]++), _mm_load_ss(in[1]++));
+				__m128 y = _mm_add_ps(_mm_add_ps(_mm_mul_ps(b0, x), _mm_mul_ps(b1, vx1)), _mm_mul_ps(b2, vx2));
+				y = _mm_sub_ps(_mm_sub_ps(y, _mm_mul_ps(a1, vy1)), _mm_mul_ps(a2, vy2));
+
+				vx2 = vx1;
+				vx1 = x;
+				vy2 = vy1;
+				vy1 = y;
+
+				_mm_store_ss(out[0]++, y);
+				_mm_store_ss(out[1]++, _mm_shuffle_ps(y, y, _MM_SHUFFLE(1, 1, 1, 1)));
+			}
+			_mm_storel_pi(reinterpret_cast<__m64 *>(x1), vx1);
+			_mm_storel_pi(reinterpret_cast<__m64 *>(x2), vx2);
+			_mm_storel_pi(reinterpret_cast<__m64 *>(y1), vy1);
+			_mm_storel_pi(reinterpret_cast<__m64 *>(y2), vy2);
+			return true;
+		}
+#endif // MPT_ENABLE_ARCH_INTRINSICS_SSE2
 		for(uint32 i = numFrames; i != 0; i--)
 		{
 			for(uint8 channel = 0; channel < 2; channel++)
@@ -73,7 +108,7 @@ void ParamEq::Process(float *pOutL, float *pOutR, uint32 numFrames)
 		}
 	}
 
-	ProcessMixOps(pOutL, pOutR, m_mixBuffer.GetOutputBuffer(0), m_mixBuffer.GetOutputBuffer(1), numFrames);
+	return true;
 }
 
 
@@ -13,6 +13,10 @@
 #ifndef NO_PLUGINS
 #include "../../Sndfile.h"
 #include "WavesReverb.h"
+#if defined(MPT_ENABLE_ARCH_INTRINSICS_SSE2)
+#include "../../../misc/mptCPU.h"
+#include <emmintrin.h>
+#endif
 #endif // !NO_PLUGINS
 
 OPENMPT_NAMESPACE_BEGIN
@@ -41,10 +45,10 @@ WavesReverb::WavesReverb(VSTPluginLib &factory, CSoundFile &sndFile, SNDMIXPLUGI
 }
 
 
-void WavesReverb::Process(float *pOutL, float *pOutR, uint32 numFrames)
+bool WavesReverb::RenderOutput(uint32 numFrames)
 {
 	if(!m_mixBuffer.Ok())
-		return;
+		return false;
 
 	const float *in[2] = { m_mixBuffer.GetInputBuffer(0), m_mixBuffer.GetInputBuffer(1) };
 	float *out[2] = { m_mixBuffer.GetOutputBuffer(0), m_mixBuffer.GetOutputBuffer(1) };
@@ -61,6 +65,76 @@ void WavesReverb::Process(float *pOutL, float *pOutR, uint32 numFrames)
 	float delay2old = m_state.comb[delay2][2];
 	float delay3old = m_state.comb[delay3][3];
 
+#if defined(MPT_ENABLE_ARCH_INTRINSICS_SSE2)
+	if(CPU::HasFeatureSet(CPU::feature::sse2))
+	{
+		// Same as below, but the four comb filters and the two all-pass filter pairs are each processed as one vector.
+		// The operations are done in the same order as in the scalar code, so the output is identical.
+		const __m128 allpassGain = _mm_set1_ps(0.61803401f);
+		const __m128 allpassCoeffs = _mm_setr_ps(m_coeffs[0], m_coeffs[0], m_coeffs[1], m_coeffs[1]);
+		const __m128 combNewCoeffs = _mm_setr_ps(m_coeffs[2], m_coeffs[4], m_coeffs[6], m_coeffs[8]);
+		const __m128 combOldCoeffs = _mm_setr_ps(m_coeffs[3], m_coeffs[5], m_coeffs[7], m_coeffs[9]);
+		const __m128 dryFactor = _mm_set1_ps(m_dryFactor);
+		const __m128 wetFactor = _mm_set1_ps(m_wetFactor);
+		const __m128 negateOdd = _mm_castsi128_ps(_mm_setr_epi32(0, int32_min, 0, int32_min));
+		const __m128 negateThird = _mm_castsi128_ps(_mm_setr_epi32(0, 0, int32_min, 0));
+		__m128 delayOld = _mm_setr_ps(delay0old, delay1old, delay2old, delay3old);
+		alignas(16) float delayNew[4];
+
+		for(uint32 i = numFrames; i != 0; i--)
+		{
+			// [leftIn, rightIn, leftIn, rightIn]
+			__m128 input = _mm_unpacklo_ps(_mm_load_ss(in[0]++), _mm_load_ss(in[1]++));
+			input = _mm_add_ps(_mm_movelh_ps(input, input), _mm_set1_ps(1e-30f));	// Prevent denormals
+
+			// Advance buffer index for the four comb filters
+			delay0 = (delay0 - 1) & 0xFFF;
+			delay1 = (delay1 - 1) & 0xFFF;
+			delay2 = (delay2 - 1) & 0xFFF;
+			delay3 = (delay3 - 1) & 0xFFF;
+			const __m128 combOut = _mm_setr_ps(m_state.comb[delay0][0], m_state.comb[delay1][1], m_state.comb[delay2][2], m_state.comb[delay3][3]);
+
+			// [r1, r2] of both all-pass filters
+			__m128 allpassIn = _mm_loadl_pi(_mm_setzero_ps(), reinterpret_cast<const __m64 *>(m_state.allpass1[delay4]));
+			allpassIn = _mm_loadh_pi(allpassIn, reinterpret_cast<const __m64 *>(m_state.allpass2[delay5]));
+			const __m128 combSwapped = _mm_xor_ps(_mm_shuffle_ps(combOut, combOut, _MM_SHUFFLE(2, 3, 0, 1)), negateOdd);
+			const __m128 r = _mm_add_ps(_mm_mul_ps(combSwapped, allpassGain), _mm_mul_ps(allpassIn, allpassCoeffs));
+			const __m128 rSwapped = _mm_xor_ps(_mm_shuffle_ps(r, r, _MM_SHUFFLE(2, 3, 0, 1)), negateOdd);
+			const __m128 allpassOut = _mm_add_ps(_mm_mul_ps(rSwapped, allpassGain), combOut);
+			_mm_storel_pi(reinterpret_cast<__m64 *>(m_state.allpass1[allpassPos]), allpassOut);
+			_mm_storeh_pi(reinterpret_cast<__m64 *>(m_state.allpass2[allpassPos]), allpassOut);
+
+			_mm_store_ps(delayNew, r);
+			m_state.comb[delay0][0] = delayNew[0];
+			m_state.comb[delay1][1] = delayNew[1];
+			m_state.comb[delay2][2] = delayNew[2];
+			m_state.comb[delay3][3] = delayNew[3];
+
+			// [leftOut, rightOut] = (input * dryFactor + [delay0new, delay1new]) + [delay2new, delay3new]
+			__m128 output = _mm_add_ps(_mm_mul_ps(input, dryFactor), r);
+			output = _mm_add_ps(output, _mm_movehl_ps(r, r));
+			_mm_store_ss(out[0]++, output);
+			_mm_store_ss(out[1]++, _mm_shuffle_ps(output, output, _MM_SHUFFLE(1, 1, 1, 1)));
+
+			// [leftWet, rightWet, -rightWet, leftWet]
+			const __m128 wet = _mm_mul_ps(_mm_xor_ps(_mm_shuffle_ps(input, input, _MM_SHUFFLE(0, 1, 1, 0)), negateThird), wetFactor);
+			const __m128 combIn = _mm_add_ps(_mm_add_ps(_mm_mul_ps(r, combNewCoeffs), _mm_mul_ps(delayOld, combOldCoeffs)), wet);
+			_mm_storeu_ps(m_state.comb[combPos], combIn);
+			delayOld = r;
+
+			// Advance buffer index
+			combPos = (combPos - 1) & 0xFFF;
+			allpassPos = (allpassPos - 1) & 0x3FF;
+			delay4 = (delay4 - 1) & 0x3FF;
+			delay5 = (delay5 - 1) & 0x3FF;
+		}
+		m_state.combPos = combPos;
+		m_state.allpassPos = allpassPos;
+
+		return true;
+	}
+#endif // MPT_ENABLE_ARCH_INTRINSICS_SSE2
+
 	for(uint32 i = numFrames; i != 0; i--)
 	{
 		const float leftIn  = *(in[0])++ + 1e-30f;	// Prevent denormals
@@ -116,7 +190,7 @@ void WavesReverb::Process(float *pOutL, float *pOutR, uint32 numFrames)
 	m_state.combPos = combPos;
 	m_state.allpassPos = allpassPos;
 
-	ProcessMixOps(pOutL, pOutR, m_mixBuffer.GetOutputBuffer(0), m_mixBuffer.GetOutputBuffer(1), numFrames);
+	return true;
 }
 
 
@@ -0,0 +1,159 @@
+/* SPDX-License-Identifier: BSL-1.0 OR BSD-3-Clause */
+
+#ifndef MPT_IO_READ_FILEDATA_MMAP_HPP
+#define MPT_IO_READ_FILEDATA_MMAP_HPP
+
+
+
+#include "mpt/base/detect_os.hpp"
+#include "mpt/base/memory.hpp"
+#include "mpt/base/namespace.hpp"
+#include "mpt/io_read/filedata.hpp"
+
+#include <algorithm>
+#include <memory>
+
+#include <cstddef>
+
+#if MPT_OS_LINUX || MPT_OS_ANDROID || MPT_OS_MACOSX_OR_IOS || MPT_OS_FREEBSD || MPT_OS_DRAGONFLYBSD || MPT_OS_NETBSD || MPT_OS_OPENBSD || MPT_OS_HAIKU || MPT_OS_GENERIC_UNIX
+#define MPT_IO_READ_FILEDATA_MMAP 1
+#else
+#define MPT_IO_READ_FILEDATA_MMAP 0
+#endif
+
+#if MPT_IO_READ_FILEDATA_MMAP
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#endif // MPT_IO_READ_FILEDATA_MMAP
+
+
+
+namespace mpt {
+inline namespace MPT_INLINE_NS {
+
+
+
+namespace IO {
+
+
+
+#if MPT_IO_READ_FILEDATA_MMAP
+
+
+
+// Read-only private mapping of a whole regular file.
+// The mapping stays valid after the file descriptor it was created from has been closed.
+// Note that, as with any mmap, truncating the file on disk while it is mapped results in SIGBUS on access.
+class FileDataMapped
+	: public IFileData {
+
+private:
+	void * mapping;
+	const std::byte * streamData;
+	pos_type streamLength;
+
+private:
+	FileDataMapped(void * mapping_, pos_type length)
+		: mapping(mapping_), streamData(static_cast<const std::byte *>(mapping_)), streamLength(length) { }
+
+public:
+	FileDataMapped(const FileDataMapped &) = delete;
+	FileDataMapped & operator=(const FileDataMapped &) = delete;
+
+	~FileDataMapped() {
+		::munmap(mapping, streamLength);
+	}
+
+public:
+	// Returns nullptr if fd does not refer to a non-empty regular file (pipes, sockets, terminals, ...) or if mapping fails.
+	// Callers are expected to fall back to a stream-based FileData in that case.
+	static std::shared_ptr<const FileDataMapped> Map(int fd) {
+		struct stat st = {};
+		if (::fstat(fd, &st) != 0) {
+			return nullptr;
+		}
+		if (!S_ISREG(st.st_mode)) {
+			return nullptr;
+		}
+		if (st.st_size <= 0) {
+			return nullptr;
+		}
+		if (static_cast<unsigned long long>(st.st_size) > static_cast<unsigned long long>(static_cast<std::size_t>(-1))) {
+			return nullptr;
+		}
+		const std::size_t length = static_cast<std::size_t>(st.st_size);
+		void * mapping = ::mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+		if (mapping == MAP_FAILED) {
+			return nullptr;
+		}
+#if defined(MADV_WILLNEED)
+		::madvise(mapping, length, MADV_WILLNEED);
+#endif
+		return std::shared_ptr<const FileDataMapped>(new FileDataMapped(mapping, length));
+	}
+
+public:
+	bool IsValid() const override {
+		return streamData != nullptr;
+	}
+
+	bool HasFastGetLength() const override {
+		return true;
+	}
+
+	bool HasPinnedView() const override {
+		return true;
+	}
+
+	const std::byte * GetRawData() const override {
+		return streamData;
+	}
+
+	pos_type GetLength() const override {
+		return streamLength;
+	}
+
+	mpt::byte_span Read(pos_type pos, mpt::byte_span dst) const override {
+		if (pos >= streamLength) {
+			return dst.first(0);
+		}
+		pos_type avail = std::min(streamLength - pos, dst.size());
+		std::copy(streamData + pos, streamData + pos + avail, dst.data());
+		return dst.first(avail);
+	}
+
+	bool CanRead(pos_type pos, std::size_t length) const override {
+		if ((pos == streamLength) && (length == 0)) {
+			return true;
+		}
+		if (pos >= streamLength) {
+			return false;
+		}
+		return (length <= streamLength - pos);
+	}
+
+	std::size_t GetReadableLength(pos_type pos, std::size_t length) const override {
+		if (pos >= streamLength) {
+			return 0;
+		}
+		return std::min(length, streamLength - pos);
+	}
+};
+
+
+
+#endif // MPT_IO_READ_FILEDATA_MMAP
+
+
+
+} // namespace IO
+
+
+
+} // namespace MPT_INLINE_NS
+} // namespace mpt
+
+
+
+#endif // MPT_IO_READ_FILEDATA_MMAP_HPP
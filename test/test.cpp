@@ -21,6 +21,7 @@
 #include "mpt/io/io.hpp"
 #include "mpt/io/io_stdstream.hpp"
 #include "mpt/io_read/filecursor_stdstream.hpp"
+#include "mpt/io_read/filedata_mmap.hpp"
 #include "mpt/test/test.hpp"
 #include "mpt/test/test_macros.hpp"
 #include "mpt/uuid/uuid.hpp"
@@ -43,6 +44,15 @@
 #include "../soundlib/SampleNormalize.h"
 #include "../soundlib/ModSampleCopy.h"
 #include "../soundlib/ITCompression.h"
+#include "../soundlib/ITTools.h"
+#include "../soundlib/SampleDecodeQueue.h"
+#include "../soundlib/SamplePool.h"
+#include "../soundlib/MixFuncTable.h"
+#include "../soundlib/AudioReadTarget.h"
+#define OPAL_DECLARATION_ONLY
+#include "../soundlib/opal.h"
+#undef OPAL_DECLARATION_ONLY
+#include "../misc/mptCPU.h"
 #include "../soundlib/tuningcollection.h"
 #include "../soundlib/tuning.h"
 #include "openmpt/soundbase/Dither.hpp"
@@ -63,9 +73,13 @@
 #endif // MODPLUG_TRACKER
 #ifdef LIBOPENMPT_BUILD
 #include "../libopenmpt/libopenmpt_version.h"
+#include "../libopenmpt/libopenmpt_impl.hpp"
+#include "../libopenmpt/libopenmpt_ext.hpp"
 #endif // LIBOPENMPT_BUILD
 #ifndef NO_PLUGINS
 #include "../soundlib/plugins/PlugInterface.h"
+#include "../soundlib/plugins/PluginManager.h"
+#include "../soundlib/plugins/dmo/DMOUtils.h"
 #endif
 #include <sstream>
 #include <limits>
@@ -122,8 +136,24 @@ static MPT_NOINLINE void TestStringIO();
 static MPT_NOINLINE void TestMIDIEvents();
 static MPT_NOINLINE void TestSampleConversion();
 static MPT_NOINLINE void TestITCompression();
+static MPT_NOINLINE void TestMixFunctions();
+static MPT_NOINLINE void TestMixerThreads();
+static MPT_NOINLINE void TestPluginGraph();
+static MPT_NOINLINE void TestDMOPlugins();
+static MPT_NOINLINE void TestResonantFilterCache();
+static MPT_NOINLINE void TestOPLBlockRendering();
+static MPT_NOINLINE void TestSilentMixBuffer();
+static MPT_NOINLINE void TestAudioTargetPlanarFloat();
+static MPT_NOINLINE void TestResamplerTablesBlob();
 static MPT_NOINLINE void TestPCnoteSerialization();
 static MPT_NOINLINE void TestLoadSaveFile();
+static MPT_NOINLINE void TestProbeBatch();
+static MPT_NOINLINE void TestSubsongsCache();
+static MPT_NOINLINE void TestModuleInfo();
+static MPT_NOINLINE void TestRenderProfiling();
+static MPT_NOINLINE void TestDeferredSamples();
+static MPT_NOINLINE void TestSampleDecodeQueue();
+static MPT_NOINLINE void TestSamplePool();
 static MPT_NOINLINE void TestEditing();
 
 
@@ -222,10 +252,26 @@ void DoTests()
 	DO_TEST(TestMIDIEvents);
 	DO_TEST(TestSampleConversion);
 	DO_TEST(TestITCompression);
+	DO_TEST(TestMixFunctions);
+	DO_TEST(TestMixerThreads);
+	DO_TEST(TestPluginGraph);
+	DO_TEST(TestDMOPlugins);
+	DO_TEST(TestResonantFilterCache);
+	DO_TEST(TestOPLBlockRendering);
+	DO_TEST(TestSilentMixBuffer);
+	DO_TEST(TestAudioTargetPlanarFloat);
+	DO_TEST(TestResamplerTablesBlob);
 
 	// slower tests, require opening a CModDoc
 	DO_TEST(TestPCnoteSerialization);
 	DO_TEST(TestLoadSaveFile);
+	DO_TEST(TestProbeBatch);
+	DO_TEST(TestSubsongsCache);
+	DO_TEST(TestModuleInfo);
+	DO_TEST(TestRenderProfiling);
+	DO_TEST(TestDeferredSamples);
+	DO_TEST(TestSampleDecodeQueue);
+	DO_TEST(TestSamplePool);
 	DO_TEST(TestEditing);
 
 	delete s_PRNG;
@@ -2293,6 +2339,25 @@ static void TestLoadMPTMFile(const CSoundFile &sndFile)
 	VERIFY_EQUAL_NONCONT(sndFile.Order(1)[2], 3);
 	VERIFY_EQUAL_NONCONT(sndFile.Order(1).GetRestartPos(), 2);
 
+	// Sub songs found in all sequences must not depend on the number of threads
+	{
+		const auto subSongs = sndFile.GetSubsongsOfAllSequences(1);
+		const auto subSongsThreaded = sndFile.GetSubsongsOfAllSequences(4);
+		VERIFY_EQUAL_NONCONT(subSongs.size(), 2);
+		VERIFY_EQUAL_NONCONT(subSongsThreaded.size(), 2);
+		for(std::size_t seq = 0; seq < std::min(subSongs.size(), subSongsThreaded.size()); seq++)
+		{
+			VERIFY_EQUAL_NONCONT(subSongs[seq].empty(), false);
+			VERIFY_EQUAL_NONCONT(subSongsThreaded[seq].size(), subSongs[seq].size());
+			for(std::size_t i = 0; i < std::min(subSongs[seq].size(), subSongsThreaded[seq].size()); i++)
+			{
+				VERIFY_EQUAL_NONCONT(subSongsThreaded[seq][i].duration, subSongs[seq][i].duration);
+				VERIFY_EQUAL_NONCONT(subSongsThreaded[seq][i].startOrder, subSongs[seq][i].startOrder);
+				VERIFY_EQUAL_NONCONT(subSongsThreaded[seq][i].startRow, subSongs[seq][i].startRow);
+			}
+		}
+	}
+
 	// Patterns
 	VERIFY_EQUAL_NONCONT(sndFile.Patterns.GetNumPatterns(), 2);
 
@@ -2862,6 +2927,47 @@ static MPT_NOINLINE void TestLoadSaveFile()
 
 		TestLoadMODFile(sndFile);
 
+		// Seeking with recorded snapshots (or only continuing from the previous seek, if the interval is 0) must result in the same state as seeking from the song start
+		for(const auto &[interval, memoryLimit] : {std::pair{0.5, std::size_t(64 * 1024 * 1024)}, std::pair{0.5, std::size_t(1)}, std::pair{0.0, std::size_t(64 * 1024 * 1024)}})
+		{
+			GetLengthCheckpoints checkpoints;
+			checkpoints.SetInterval(interval);
+			checkpoints.SetMemoryLimit(memoryLimit);
+			auto expectedState = std::make_unique<CSoundFile::PlayState>();
+			for(const double seconds : {60.0, 3.0, 97.25, 96.0, 25.5, 118.0})
+			{
+				const auto expected = sndFile.GetLength(eAdjustSamplePositions, GetLengthTarget(seconds).StartPos(0, 2, 0)).back();
+				*expectedState = sndFile.m_PlayState;
+				const auto actual = sndFile.GetLength(eAdjustSamplePositions, GetLengthTarget(seconds).StartPos(0, 2, 0), &checkpoints).back();
+				VERIFY_EQUAL_NONCONT(actual.duration, expected.duration);
+				VERIFY_EQUAL_NONCONT(actual.lastOrder, expected.lastOrder);
+				VERIFY_EQUAL_NONCONT(actual.lastRow, expected.lastRow);
+				VERIFY_EQUAL_NONCONT(sndFile.m_PlayState.m_nMusicSpeed, expectedState->m_nMusicSpeed);
+				VERIFY_EQUAL_NONCONT(sndFile.m_PlayState.m_nMusicTempo, expectedState->m_nMusicTempo);
+				VERIFY_EQUAL_NONCONT(sndFile.m_PlayState.m_nGlobalVolume, expectedState->m_nGlobalVolume);
+				VERIFY_EQUAL_NONCONT(sndFile.m_PlayState.m_lTotalSampleCount, expectedState->m_lTotalSampleCount);
+				for(CHANNELINDEX chn = 0; chn < sndFile.GetNumChannels(); chn++)
+				{
+					const ModChannel &actualChn = sndFile.m_PlayState.Chn[chn], &expectedChn = expectedState->Chn[chn];
+					VERIFY_EQUAL_NONCONT(actualChn.position.GetRaw(), expectedChn.position.GetRaw());
+					VERIFY_EQUAL_NONCONT(actualChn.increment.GetRaw(), expectedChn.increment.GetRaw());
+					VERIFY_EQUAL_NONCONT(actualChn.nPeriod, expectedChn.nPeriod);
+					VERIFY_EQUAL_NONCONT(actualChn.nVolume, expectedChn.nVolume);
+					VERIFY_EQUAL_NONCONT(actualChn.pModSample, expectedChn.pModSample);
+				}
+
+				const auto expectedPos = sndFile.GetLength(eAdjustSamplePositions, GetLengthTarget(ORDERINDEX(2), ROWINDEX(50)).StartPos(0, 2, 0)).back();
+				const auto actualPos = sndFile.GetLength(eAdjustSamplePositions, GetLengthTarget(ORDERINDEX(2), ROWINDEX(50)).StartPos(0, 2, 0), &checkpoints).back();
+				VERIFY_EQUAL_NONCONT(actualPos.duration, expectedPos.duration);
+				VERIFY_EQUAL_NONCONT(actualPos.targetReached, expectedPos.targetReached);
+			}
+			if(interval > 0.0 && memoryLimit > 1)
+				VERIFY_EQUAL_NONCONT(checkpoints.GetNumCheckpoints() > 0, true);
+			else
+				VERIFY_EQUAL_NONCONT(checkpoints.GetNumCheckpoints(), 0u);
+			VERIFY_EQUAL_NONCONT(checkpoints.GetMemoryUsage() <= memoryLimit, true);
+		}
+
 #ifndef MODPLUG_NO_FILESAVE
 		// Test file saving
 		SaveMOD(sndFileContainer, filenameBase + P_("saved.mod"));
@@ -2880,6 +2986,20 @@ static MPT_NOINLINE void TestLoadSaveFile()
 	}
 #endif
 
+	// Loading through InputFile, which memory-maps regular files where supported, must yield the same module.
+	{
+		InputFile inputFile(filenameBaseSrc + P_("mod"));
+		VERIFY_EQUAL_NONCONT(inputFile.IsValid(), true);
+#if MPT_IO_READ_FILEDATA_MMAP
+		VERIFY_EQUAL_NONCONT(inputFile.IsMapped(), true);
+#endif
+		FileReader file = GetFileReader(inputFile);
+		VERIFY_EQUAL_NONCONT(file.GetOptionalFileName().has_value(), true);
+		auto sndFile = std::make_unique<CSoundFile>();
+		VERIFY_EQUAL_NONCONT(sndFile->Create(file, CSoundFile::loadCompleteModule), true);
+		TestLoadMODFile(*sndFile);
+	}
+
 	// General file I/O tests
 	{
 		std::ostringstream f;
@@ -2909,6 +3029,368 @@ static MPT_NOINLINE void TestLoadSaveFile()
 }
 
 
+// Batch probing must return the same results as probing each file separately.
+static MPT_NOINLINE void TestProbeBatch()
+{
+	if(!ShouldRunTests())
+	{
+		return;
+	}
+
+	struct TestFile
+	{
+		std::vector<std::byte> data;
+		MODTYPE type;
+	};
+	std::vector<TestFile> files;
+	const std::pair<mpt::PathString, MODTYPE> testFiles[] = { { P_("mptm"), MOD_TYPE_IT }, { P_("xm"), MOD_TYPE_XM }, { P_("s3m"), MOD_TYPE_S3M }, { P_("mod"), MOD_TYPE_MOD } };
+	for(const auto &[extension, type] : testFiles)
+	{
+		InputFile inputFile(GetTestFilenameBase() + extension);
+		FileReader file = GetFileReader(inputFile);
+		std::vector<std::byte> data(file.GetLength());
+		file.ReadRaw(mpt::as_span(data));
+		files.push_back({ std::move(data), type });
+	}
+
+	// Random data with some magic bytes planted in, at various sizes
+	const std::pair<std::size_t, std::string> magics[] = { { 0, "Extended Module: " }, { 0, "IMPM" }, { 44, "SCRM" }, { 60, "SCRM" }, { 0, "RIFF" }, { 0, "MO3" }, { 0, "GDM\xFE" }, { 0, "MMD" }, { 0, "ziRCONia" } };
+	uint32 lcg = 1;
+	for(const auto &[offset, magic] : magics)
+	{
+		for(std::size_t size : { std::size_t(3), std::size_t(64), std::size_t(1100), std::size_t(4096) })
+		{
+			std::vector<std::byte> data(size);
+			for(auto &b : data)
+			{
+				lcg = lcg * 1103515245u + 12345u;
+				b = mpt::byte_cast<std::byte>(static_cast<uint8>(lcg >> 24));
+			}
+			for(std::size_t i = 0; i < magic.size() && offset + i < size; i++)
+			{
+				data[offset + i] = mpt::byte_cast<std::byte>(magic[i]);
+			}
+			files.push_back({ std::move(data), MOD_TYPE_NONE });
+		}
+	}
+
+	// Every file is probed with various prefixes, with and without the file size
+	std::vector<uint64> fileSizes;
+	std::vector<CSoundFile::ProbeBatchItem> items;
+	fileSizes.reserve(files.size());
+	for(const auto &file : files)
+	{
+		fileSizes.push_back(file.data.size());
+	}
+	const std::size_t prefixSizes[] = { 0, 1, 4, 17, 48, 64, 100, 600, 1084, CSoundFile::ProbeRecommendedSize };
+	for(std::size_t i = 0; i < files.size(); i++)
+	{
+		const mpt::const_byte_span data = mpt::as_span(files[i].data);
+		for(std::size_t prefixSize : prefixSizes)
+		{
+			if(prefixSize > data.size())
+				continue;
+			items.push_back({ data.first(prefixSize), nullptr });
+			items.push_back({ data.first(prefixSize), &fileSizes[i] });
+		}
+		items.push_back({ data, nullptr });
+		items.push_back({ data, &fileSizes[i] });
+	}
+
+	std::vector<CSoundFile::ProbeBatchResult> results(items.size());
+	CSoundFile::ProbeBatch(CSoundFile::ProbeFlagsDefault, mpt::as_span(items), mpt::as_span(results));
+	for(std::size_t i = 0; i < items.size(); i++)
+	{
+		VERIFY_EQUAL_NONCONT(results[i].result, CSoundFile::Probe(CSoundFile::ProbeFlagsDefault, items[i].data, items[i].pfilesize));
+	}
+
+	// Whole test modules are detected with the correct type
+	for(std::size_t i = 0; i < std::size(testFiles); i++)
+	{
+		const CSoundFile::ProbeBatchItem item{ mpt::as_span(files[i].data), &fileSizes[i] };
+		CSoundFile::ProbeBatchResult result;
+		CSoundFile::ProbeBatch(CSoundFile::ProbeFlagsDefault, mpt::span(&item, 1), mpt::span(&result, 1));
+		VERIFY_EQUAL_NONCONT(result.result, CSoundFile::ProbeSuccess);
+		VERIFY_EQUAL_NONCONT(result.type, files[i].type);
+		VERIFY_EQUAL_NONCONT(result.containerType, MOD_CONTAINERTYPE_NONE);
+	}
+}
+
+
+#ifdef LIBOPENMPT_BUILD
+// Exposes the key under which libopenmpt stores the sub-song record of a module
+struct SubsongsCacheKey : public openmpt::module_impl
+{
+	using openmpt::module_impl::get_subsongs_cache_key;
+};
+#endif // LIBOPENMPT_BUILD
+
+static MPT_NOINLINE void TestSubsongsCache()
+{
+#ifdef LIBOPENMPT_BUILD
+	if(!ShouldRunTests())
+	{
+		return;
+	}
+
+	const std::string key = (GetTempFilenameBase() + P_("subsongs_cache")).ToUTF8();
+	const std::string filename = key + ".subsongs";
+	RemoveFile(mpt::PathString::FromUTF8(filename));
+
+	openmpt::subsongs_cache_directory cache("");
+	std::string record = "unchanged";
+	VERIFY_EQUAL_NONCONT(cache.lookup(key, record), false);
+	VERIFY_EQUAL_NONCONT(record, "unchanged");
+
+	const std::string first = std::string("first record\n") + std::string(1, '\0') + "with binary data";
+	cache.store(key, first);
+	VERIFY_EQUAL_NONCONT(cache.lookup(key, record), true);
+	VERIFY_EQUAL_NONCONT(record, first);
+
+	// Storing a record for an existing key replaces it completely
+	cache.store(key, "second");
+	VERIFY_EQUAL_NONCONT(cache.lookup(key, record), true);
+	VERIFY_EQUAL_NONCONT(record, "second");
+
+	RemoveFile(mpt::PathString::FromUTF8(filename));
+	VERIFY_EQUAL_NONCONT(cache.lookup(key, record), false);
+
+	// Loading modules with the cache must report the same sub-songs as loading them without the cache,
+	// both when the record is created and when it is read. Invalid records must be recomputed.
+	std::string cacheDirectory = GetTempFilenameBase().ToUTF8();
+	cacheDirectory.erase(cacheDirectory.find_last_of("/\\") + 1);
+	if(cacheDirectory.empty())
+		cacheDirectory = "./";
+	const std::map<std::string, std::string> ctls = { { "load.subsongs_cache_directory", cacheDirectory } };
+	const auto getSubsongs = [](openmpt::module &mod)
+	{
+		std::vector<std::tuple<double, std::int32_t, std::int32_t>> subsongs;
+		for(std::int32_t i = 0; i < mod.get_num_subsongs(); i++)
+		{
+			mod.select_subsong(i);
+			subsongs.emplace_back(mod.get_duration_seconds(), mod.get_current_order(), mod.get_current_row());
+		}
+		return subsongs;
+	};
+	const auto readRecord = [](const mpt::PathString &recordFile)
+	{
+		mpt::ifstream f(recordFile, std::ios::binary);
+		std::ostringstream data;
+		data << f.rdbuf();
+		return data.str();
+	};
+	const auto writeRecord = [](const mpt::PathString &recordFile, const std::string &data)
+	{
+		mpt::ofstream f(recordFile, std::ios::binary | std::ios::trunc);
+		f.write(data.data(), data.size());
+	};
+
+	for(const auto &extension : {P_("mptm"), P_("mod"), P_("s3m")})
+	{
+		std::vector<std::byte> data;
+		{
+			InputFile inputFile(GetTestFilenameBase() + extension);
+			FileReader file = GetFileReader(inputFile);
+			data.resize(file.GetLength());
+			file.ReadRaw(mpt::as_span(data));
+		}
+		const mpt::PathString recordFile = mpt::PathString::FromUTF8(cacheDirectory + SubsongsCacheKey::get_subsongs_cache_key(FileReader(mpt::as_span(data)), CSoundFile::loadCompleteModule) + ".subsongs");
+		RemoveFile(recordFile);
+
+		std::ostringstream log;
+		openmpt::module uncached(data, log);
+		const auto expected = getSubsongs(uncached);
+		VERIFY_EQUAL_NONCONT(expected.size() > 1, true);
+
+		// Creating the record, then reading it
+		for(int pass = 0; pass < 2; pass++)
+		{
+			openmpt::module cached(data, log, ctls);
+			VERIFY_EQUAL_NONCONT(getSubsongs(cached) == expected, true);
+		}
+		const std::string validRecord = readRecord(recordFile);
+		VERIFY_EQUAL_NONCONT(validRecord.substr(0, 22), "libopenmpt subsongs 1\n");
+
+		// The cached durations are actually used
+		{
+			std::vector<std::string> lines;
+			std::istringstream str(validRecord);
+			for(std::string line; std::getline(str, line);)
+				lines.push_back(line);
+			VERIFY_EQUAL_NONCONT(lines.size(), expected.size() + 3);
+			const std::string fakeDuration = mpt::format<std::string>::hex0<16>(mpt::bit_cast<std::uint64_t>(1234.5));
+			std::string modifiedRecord = validRecord;
+			modifiedRecord.replace(lines[0].size() + lines[1].size() + lines[2].size() + 3, 16, fakeDuration);
+			writeRecord(recordFile, modifiedRecord);
+			openmpt::module cached(data, log, ctls);
+			cached.select_subsong(0);
+			VERIFY_EQUAL_NONCONT(cached.get_duration_seconds(), 1234.5);
+			VERIFY_EQUAL_NONCONT(readRecord(recordFile), modifiedRecord);
+		}
+
+		// Corrupted records and records written by a different version are rejected, recomputed and replaced
+		const std::string versionLine = std::string(openmpt::string::get("core_version")) + "\n";
+		const std::size_t versionPos = validRecord.find(versionLine);
+		VERIFY_EQUAL_NONCONT(versionPos, std::size_t(22));
+		std::string otherVersion = validRecord;
+		otherVersion.replace(versionPos, versionLine.size(), "0.0.0-other\n");
+		const std::string invalidRecords[] =
+		{
+			otherVersion,
+			validRecord.substr(0, validRecord.size() - 8),
+			validRecord.substr(0, versionPos + versionLine.size()) + "x\n",
+			"libopenmpt subsongs 2\n" + validRecord.substr(22),
+			std::string(),
+		};
+		for(const auto &invalidRecord : invalidRecords)
+		{
+			writeRecord(recordFile, invalidRecord);
+			openmpt::module cached(data, log, ctls);
+			VERIFY_EQUAL_NONCONT(getSubsongs(cached) == expected, true);
+			VERIFY_EQUAL_NONCONT(readRecord(recordFile), validRecord);
+		}
+
+		RemoveFile(recordFile);
+	}
+#endif // LIBOPENMPT_BUILD
+}
+
+
+static MPT_NOINLINE void TestModuleInfo()
+{
+#ifdef LIBOPENMPT_BUILD
+	if(!ShouldRunTests())
+	{
+		return;
+	}
+
+	// module_info must report the same metadata as a fully loaded module.
+	// Reading each file twice also reads modules with CSoundFile objects that have been used for a different module before.
+	for(int pass = 0; pass < 2; pass++)
+	{
+		for(const auto &extension : {P_("mptm"), P_("mod"), P_("xm"), P_("s3m")})
+		{
+			std::vector<std::byte> data;
+			{
+				InputFile inputFile(GetTestFilenameBase() + extension);
+				FileReader file = GetFileReader(inputFile);
+				data.resize(file.GetLength());
+				file.ReadRaw(mpt::as_span(data));
+			}
+			std::ostringstream log;
+			const openmpt::module mod(data, log);
+			const openmpt::module_info info(data, log);
+			const std::vector<std::string> keys = info.get_metadata_keys();
+			VERIFY_EQUAL_NONCONT(keys == mod.get_metadata_keys(), true);
+			for(const auto &key : keys)
+			{
+				VERIFY_EQUAL_NONCONT(info.get_metadata(key), mod.get_metadata(key));
+			}
+		}
+	}
+#endif // LIBOPENMPT_BUILD
+}
+
+
+static MPT_NOINLINE void TestRenderProfiling()
+{
+#ifdef LIBOPENMPT_BUILD
+	if(!ShouldRunTests())
+	{
+		return;
+	}
+
+	std::vector<std::byte> data;
+	{
+		InputFile inputFile(GetTestFilenameBase() + P_("mod"));
+		FileReader file = GetFileReader(inputFile);
+		data.resize(file.GetLength());
+		file.ReadRaw(mpt::as_span(data));
+	}
+	std::ostringstream log;
+
+#ifndef NO_RENDER_PROFILING
+	using profiling = openmpt::ext::profiling;
+	const auto isZero = [](const profiling::snapshot &snapshot)
+	{
+		for(std::size_t i = 0; i < profiling::num_stages; i++)
+		{
+			if(snapshot.stage_calls[i] != 0 || snapshot.stage_seconds[i] != 0.0)
+				return false;
+		}
+		for(std::size_t i = 0; i < profiling::num_resamplers; i++)
+		{
+			if(snapshot.resampler_frames[i] != 0)
+				return false;
+		}
+		return true;
+	};
+
+	static constexpr struct
+	{
+		std::int32_t filterLength;
+		profiling::resampler resampler;
+	} filters[] =
+	{
+		{ 1, profiling::resampler_nearest },
+		{ 2, profiling::resampler_linear },
+		{ 4, profiling::resampler_cubic },
+		{ 8, profiling::resampler_sinc8_lowpass },
+	};
+	// Renders about one second of audio
+	const auto render = [](openmpt::module &mod)
+	{
+		std::vector<float> buffer(4096 * 2);
+		std::size_t frames = 0;
+		for(int i = 0; i < 12; i++)
+			frames += mod.read_interleaved_stereo(48000, 4096, buffer.data());
+		return frames;
+	};
+	for(const auto &filter : filters)
+	{
+		openmpt::module_ext mod(data, log);
+		profiling *profiler = static_cast<profiling *>(mod.get_interface(openmpt::ext::profiling_id));
+		VERIFY_EQUAL_NONCONT(profiler != nullptr, true);
+		if(!profiler)
+			continue;
+		mod.set_render_param(openmpt::module::RENDER_INTERPOLATIONFILTER_LENGTH, filter.filterLength);
+
+		// Nothing is counted while profiling is disabled
+		VERIFY_EQUAL_NONCONT(profiler->get_profiling_enabled(), false);
+		VERIFY_EQUAL_NONCONT(render(mod) > 0, true);
+		VERIFY_EQUAL_NONCONT(isZero(profiler->get_profiling_snapshot()), true);
+
+		profiler->set_profiling_enabled(true);
+		VERIFY_EQUAL_NONCONT(profiler->get_profiling_enabled(), true);
+		VERIFY_EQUAL_NONCONT(render(mod) > 0, true);
+		const profiling::snapshot snapshot = profiler->get_profiling_snapshot();
+		VERIFY_EQUAL_NONCONT(snapshot.stage_calls[profiling::stage_read_note] > 0, true);
+		VERIFY_EQUAL_NONCONT(snapshot.stage_calls[profiling::stage_create_stereo_mix] > 0, true);
+		VERIFY_EQUAL_NONCONT(snapshot.stage_calls[profiling::stage_output] > 0, true);
+		VERIFY_EQUAL_NONCONT(snapshot.stage_calls[profiling::stage_opl], 0u);
+		// All sample frames are rendered with the selected interpolation filter
+		for(std::size_t i = 0; i < profiling::num_resamplers; i++)
+		{
+			VERIFY_EQUAL_NONCONT(snapshot.resampler_frames[i] > 0, i == static_cast<std::size_t>(filter.resampler));
+		}
+
+		profiler->reset_profiling();
+		VERIFY_EQUAL_NONCONT(isZero(profiler->get_profiling_snapshot()), true);
+		VERIFY_EQUAL_NONCONT(profiler->get_profiling_enabled(), true);
+
+		profiler->set_profiling_enabled(false);
+		VERIFY_EQUAL_NONCONT(render(mod) > 0, true);
+		VERIFY_EQUAL_NONCONT(isZero(profiler->get_profiling_snapshot()), true);
+	}
+#else
+	// The interface is not available if the profiler has been compiled out
+	openmpt::module_ext mod(data, log);
+	VERIFY_EQUAL_NONCONT(mod.get_interface(openmpt::ext::profiling_id) == nullptr, true);
+#endif // NO_RENDER_PROFILING
+#endif // LIBOPENMPT_BUILD
+}
+
+
 // Test various editing features
 static MPT_NOINLINE void TestEditing()
 {
@@ -3034,6 +3516,1209 @@ static MPT_NOINLINE void TestITCompression()
 }
 
 
+static MPT_NOINLINE void TestMixFunctions()
+{
+#if defined(MPT_INTMIXER) && defined(MPT_ENABLE_ARCH_INTRINSICS_SSE2)
+	// Vectorized mixer functions must produce exactly the same output as the scalar reference implementation.
+	if(!CPU::HasFeatureSet(CPU::feature::sse2))
+		return;
+	VERIFY_EQUAL(MixFuncTable::GetFunctions(), &MixFuncTable::FunctionsSSE2[0]);
+
+	constexpr uint32 numFrames = 300;
+	constexpr uint32 padding = InterpolationLookaheadBufferSize * MaxSamplingPointSize;
+	std::vector<int8> sampleData(4096 * MaxSamplingPointSize + 2 * padding);
+	for(auto &s : sampleData)
+	{
+		s = mpt::random<int8>(*s_PRNG);
+	}
+	// Include some full-scale values to check overflow behaviour
+	for(std::size_t i = 0; i < 64; i++)
+	{
+		sampleData[padding + i] = (i & 2) ? int8_min : int8_max;
+	}
+
+	auto resampler = std::make_unique<CResampler>();
+	const int64 increments[] = { 0x40000000ll, 0x100000000ll, 0x15555555ll * 11, 0x1C0000000ll, 0x280000000ll };
+	for(uint32 ndx = 0; ndx < 6 * 16; ndx++)
+	{
+		for(const int64 increment : increments)
+		{
+			ModChannel chn{};
+			chn.pCurrentSample = sampleData.data() + padding;
+			chn.position = SamplePosition(0x12345678ll);
+			chn.increment = SamplePosition(increment);
+			chn.leftVol = 4096;
+			chn.rightVol = 1234;
+			chn.rampLeftVol = 100 << VOLUMERAMPPRECISION;
+			chn.rampRightVol = 4000 << VOLUMERAMPPRECISION;
+			chn.leftRamp = 3 << VOLUMERAMPPRECISION;
+			chn.rightRamp = -(5 << VOLUMERAMPPRECISION);
+			chn.nFilter_A0 = 1 << 22;
+			chn.nFilter_B0 = 1 << 23;
+			chn.nFilter_B1 = -(1 << 21);
+			chn.nFilter_HP = 0;
+			ModChannel chnSSE2 = chn;
+
+			std::vector<mixsample_t> outScalar(numFrames * 2, 0), outSSE2(numFrames * 2, 0);
+			MixFuncTable::Functions[ndx](chn, *resampler, outScalar.data(), numFrames);
+			MixFuncTable::FunctionsSSE2[ndx](chnSSE2, *resampler, outSSE2.data(), numFrames);
+
+			VERIFY_EQUAL_NONCONT(outScalar == outSSE2, true);
+			VERIFY_EQUAL_NONCONT(chn.position.GetRaw(), chnSSE2.position.GetRaw());
+			VERIFY_EQUAL_NONCONT(chn.nFilter_Y[0][0], chnSSE2.nFilter_Y[0][0]);
+			VERIFY_EQUAL_NONCONT(chn.nFilter_Y[1][0], chnSSE2.nFilter_Y[1][0]);
+		}
+	}
+#endif // MPT_INTMIXER && MPT_ENABLE_ARCH_INTRINSICS_SSE2
+}
+
+
+class TestAudioTarget
+	: public IAudioTarget
+{
+public:
+	std::vector<MixSampleInt> data;
+	void Process(mpt::audio_span_interleaved<MixSampleInt> buffer) override
+	{
+		data.insert(data.end(), buffer.data(), buffer.data() + buffer.size_frames() * buffer.size_channels());
+	}
+	void Process(mpt::audio_span_interleaved<MixSampleFloat>) override
+	{
+		MPT_ASSERT_NOTREACHED();
+	}
+};
+
+
+// Fills a sample with deterministic noise whose amplitude changes every 1024 sample points, so that compressed sample formats have to use varying bit widths.
+static void FillTestSampleData(ModSample &sample, uint32 seed)
+{
+	uint32 lcg = seed;
+	const SmpLength numValues = sample.nLength * sample.GetNumChannels();
+	for(SmpLength i = 0; i < numValues; i++)
+	{
+		lcg = lcg * 1103515245u + 12345u;
+		const int shift = static_cast<int>((i / 1024u) % 8u);
+		if(sample.uFlags[CHN_16BIT])
+			sample.sample16()[i] = static_cast<int16>(static_cast<int16>(lcg >> 16) >> shift);
+		else
+			sample.sample8()[i] = static_cast<int8>(static_cast<int8>(lcg >> 24) >> shift);
+	}
+}
+
+
+// Creates an empty IT module for rendering tests, with a single 64-row pattern in the order list.
+static std::unique_ptr<CSoundFile> CreateRenderTestModule(CHANNELINDEX numChannels, uint32 mixingFreq, uint32 mixChannels)
+{
+	auto sndFile = std::make_unique<CSoundFile>();
+	sndFile->Create(FileReader(), CSoundFile::loadCompleteModule);
+	sndFile->m_nType = MOD_TYPE_IT;
+	sndFile->SetDefaultPlaybackBehaviour(MOD_TYPE_IT);
+	sndFile->m_nChannels = numChannels;
+
+	sndFile->Order().assign(1, 0);
+	sndFile->Patterns.Insert(0, 64);
+
+	MixerSettings mixerSettings = sndFile->m_MixerSettings;
+	mixerSettings.gdwMixingFreq = mixingFreq;
+	mixerSettings.gnChannels = mixChannels;
+	sndFile->SetMixerSettings(mixerSettings);
+	return sndFile;
+}
+
+
+// Adds a looping 16-bit sample to a module for rendering tests. The sample is filled with noise, or silent if noiseSeed is 0.
+static void AddRenderTestSample(CSoundFile &sndFile, SAMPLEINDEX smp, SmpLength length, SmpLength loopStart, FlagSet<ChannelFlags> loopFlags, uint32 noiseSeed)
+{
+	sndFile.m_nSamples = std::max(sndFile.GetNumSamples(), smp);
+	ModSample &sample = sndFile.GetSample(smp);
+	sample.Initialize(MOD_TYPE_IT);
+	sample.nLength = length;
+	sample.nLoopStart = loopStart;
+	sample.nLoopEnd = length;
+	sample.uFlags.set(CHN_16BIT | loopFlags);
+	VERIFY_EQUAL(sample.AllocateSample() != 0, true);
+	if(noiseSeed)
+		FillTestSampleData(sample, noiseSeed);
+	sample.PrecomputeLoops(sndFile, false);
+}
+
+
+// Renders numChunks * chunkSize frames of a module.
+static std::vector<MixSampleInt> RenderFrames(CSoundFile &sndFile, int numChunks, CSoundFile::samplecount_t chunkSize)
+{
+	TestAudioTarget target;
+	for(int chunk = 0; chunk < numChunks; chunk++)
+	{
+		sndFile.Read(chunkSize, target);
+	}
+	return std::move(target.data);
+}
+
+
+// Verifies that two renderings of the expected size are identical and not silent.
+static void VerifyRenderedOutputEqual(const std::vector<MixSampleInt> &expected, const std::vector<MixSampleInt> &actual, std::size_t expectedSize)
+{
+	VERIFY_EQUAL(expected.size(), expectedSize);
+	VERIFY_EQUAL(expected == actual, true);
+	VERIFY_EQUAL(std::any_of(actual.begin(), actual.end(), [](MixSampleInt s) { return s != 0; }), true);
+}
+
+
+static MPT_NOINLINE void TestMixerThreads()
+{
+	// Mixing channels on several threads must produce exactly the same output as mixing them on one thread.
+	std::vector<MixSampleInt> output[2];
+	const uint32 numThreads[2] = { 1, 4 };
+	for(std::size_t pass = 0; pass < 2; pass++)
+	{
+		auto sndFile = CreateRenderTestModule(32, 48000, 4);
+		AddRenderTestSample(*sndFile, 1, 3000, 1000, CHN_LOOP | CHN_PINGPONGLOOP, 12345);
+		for(CHANNELINDEX chn = 0; chn < sndFile->GetNumChannels(); chn++)
+		{
+			ModCommand &m = *sndFile->Patterns[0].GetpModCommand(0, chn);
+			m.note = static_cast<ModCommand::NOTE>(NOTE_MIDDLEC - 12 + chn);
+			m.instr = 1;
+			m.volcmd = VOLCMD_PANNING;
+			m.vol = static_cast<ModCommand::VOL>((chn * 7) % 65);
+			if(chn % 3 == 1)
+			{
+				// Surround, goes into the rear buffer
+				m.command = CMD_S3MCMDEX;
+				m.param = 0x91;
+			} else if(chn % 3 == 2)
+			{
+				// Reverb send
+				m.command = CMD_S3MCMDEX;
+				m.param = 0x99;
+			}
+			// Stop some channels early so that the number of active channels changes
+			if(chn % 4 == 3)
+				sndFile->Patterns[0].GetpModCommand(8 + chn, chn)->note = NOTE_NOTECUT;
+		}
+
+		CResamplerSettings resamplerSettings = sndFile->m_Resampler.m_Settings;
+		resamplerSettings.SrcMode = SRCMODE_SINC8LP;
+		sndFile->SetResamplerSettings(resamplerSettings);
+		sndFile->SetMixerThreads(numThreads[pass]);
+#ifdef MPT_ENABLE_MIXER_THREADS
+		VERIFY_EQUAL(sndFile->GetMixerThreads(), numThreads[pass]);
+#else
+		VERIFY_EQUAL(sndFile->GetMixerThreads(), 1u);
+#endif
+
+		output[pass] = RenderFrames(*sndFile, 40, 1000);
+		VERIFY_EQUAL(sndFile->GetMixStat() >= 16, true);
+	}
+	VerifyRenderedOutputEqual(output[0], output[1], 40 * 1000 * 4);
+}
+
+static MPT_NOINLINE void TestPluginGraph()
+{
+#ifndef NO_PLUGINS
+	// Rendering independent plugin branches concurrently must produce exactly the same output as processing the plugins one after another.
+	static constexpr struct
+	{
+		uint32 id;
+		uint32 outputRouting;
+		uint8 routingFlags;
+		uint8 mixMode;
+	} plugins[] =
+	{
+		{ 0xEF3E932C, 0x80 + 3, 0, 0 },                                // Echo -> ParamEq
+		{ 0xEFE6629C, 0, SNDMIXPLUGININFO::irWetMix, 0 },               // Chorus -> master, dry signal is added separately
+		{ 0xEF114C90, 0x80 + 3, 0, 4 },                                // Distortion -> ParamEq, middle subtract reads the output buffer
+		{ 0x120CED89, 0, 0, 0 },                                       // ParamEq -> master
+		{ 0x87FC0268, 0, SNDMIXPLUGININFO::irApplyToMaster, 0 },        // WavesReverb on the master mix
+		{ 0xEF011F79, 0, SNDMIXPLUGININFO::irBypass, 0 },               // Bypassed Compressor -> master
+		{ 0xDAFD8210, 0x80 + 7, SNDMIXPLUGININFO::irApplyToMaster, 0 }, // Gargle on the master mix -> Flanger
+		{ 0xEFCA3D92, 0, 0, 1 },                                       // Flanger -> master
+	};
+	// Channels 0-9 go into the non-master plugins (including the bypassed one), the others into the master mix
+	static constexpr PLUGINDEX channelPlugins[] = { 1, 2, 3, 6, 8 };
+
+	std::vector<MixSampleInt> output[2];
+	const uint32 numThreads[2] = { 1, 4 };
+	for(std::size_t pass = 0; pass < 2; pass++)
+	{
+		auto sndFile = CreateRenderTestModule(12, 44100, 2);
+		AddRenderTestSample(*sndFile, 1, 3000, 1000, CHN_LOOP, 12345);
+
+		for(PLUGINDEX plug = 0; plug < std::size(plugins); plug++)
+		{
+			SNDMIXPLUGIN &plugin = sndFile->m_MixPlugins[plug];
+			plugin.Info.dwPluginId1 = kDmoMagic;
+			plugin.Info.dwPluginId2 = plugins[plug].id;
+			plugin.Info.dwOutputRouting = plugins[plug].outputRouting;
+			plugin.Info.routingFlags = plugins[plug].routingFlags;
+			plugin.Info.mixMode = plugins[plug].mixMode;
+			plugin.Info.gain = 10;
+			plugin.fDryRatio = 0.25f;
+			VERIFY_EQUAL(CreateMixPluginProc(plugin, *sndFile), true);
+			VERIFY_EQUAL(plugin.pMixPlugin != nullptr, true);
+		}
+
+		for(CHANNELINDEX chn = 0; chn < sndFile->GetNumChannels(); chn++)
+		{
+			if(chn < 10)
+				sndFile->ChnSettings[chn].nMixPlugin = channelPlugins[chn % std::size(channelPlugins)];
+			ModCommand &m = *sndFile->Patterns[0].GetpModCommand(0, chn);
+			m.note = static_cast<ModCommand::NOTE>(NOTE_MIDDLEC - 12 + chn * 2);
+			m.instr = 1;
+			m.volcmd = VOLCMD_PANNING;
+			m.vol = static_cast<ModCommand::VOL>((chn * 11) % 65);
+			if(chn % 3 == 2)
+				sndFile->Patterns[0].GetpModCommand(16 + chn, chn)->note = NOTE_NOTECUT;
+		}
+
+		sndFile->SetMixerThreads(numThreads[pass]);
+		output[pass] = RenderFrames(*sndFile, 40, 1000);
+	}
+	VerifyRenderedOutputEqual(output[0], output[1], 40 * 1000 * 2);
+#endif // NO_PLUGINS
+}
+
+#ifndef NO_PLUGINS
+
+// Original bit-by-bit implementation of DMO::logGain
+static float DMOLogGainReference(float x, int32 shiftL, int32 shiftR)
+{
+	uint32 intSample = static_cast<uint32>(static_cast<int64>(x));
+	const uint32 sign = intSample & 0x80000000;
+	if(sign)
+		intSample = (~intSample) + 1;
+	while(shiftL > 0 && intSample < 0x80000000)
+	{
+		intSample += intSample;
+		shiftL--;
+	}
+	if(intSample >= 0x80000000)
+	{
+		intSample &= 0x7FFFFFFF;
+		shiftL++;
+	}
+	intSample = (shiftL << (31 - shiftR)) | (intSample >> shiftR);
+	if(sign)
+		intSample = ~intSample | sign;
+	return static_cast<float>(static_cast<int32>(intSample));
+}
+
+
+// Creates a DMO plugin in the first plugin slot and feeds it with a deterministic noise signal.
+// Returns the rendered output of both channels, interleaved.
+static std::vector<float> RenderDMOPlugin(uint32 pluginID, std::initializer_list<std::pair<PlugParamIndex, PlugParamValue>> params, uint32 numBlocks)
+{
+	auto sndFile = CreateRenderTestModule(1, 44100, 2);
+	SNDMIXPLUGIN &plugin = sndFile->m_MixPlugins[0];
+	plugin.Info.dwPluginId1 = kDmoMagic;
+	plugin.Info.dwPluginId2 = pluginID;
+	VERIFY_EQUAL(CreateMixPluginProc(plugin, *sndFile), true);
+	std::vector<float> output;
+	IMixPlugin *mixPlugin = plugin.pMixPlugin;
+	if(!mixPlugin)
+		return output;
+	for(const auto &[index, value] : params)
+		mixPlugin->SetParameter(index, value);
+	mixPlugin->Resume();
+
+	uint32 seed = 1;
+	for(uint32 block = 0; block < numBlocks; block++)
+	{
+		for(uint8 channel = 0; channel < 2; channel++)
+		{
+			float *in = mixPlugin->m_mixBuffer.GetInputBuffer(channel);
+			for(uint32 i = 0; i < MIXBUFFERSIZE; i++)
+			{
+				seed = seed * 1103515245u + 12345u;
+				// Include some silent stretches so that the denormal handling is covered as well
+				in[i] = ((block % 8u) == 7) ? 0.0f : static_cast<float>(static_cast<int32>(seed) >> 8) * (1.0f / 8388608.0f);
+			}
+		}
+		VERIFY_EQUAL(mixPlugin->RenderOutput(MIXBUFFERSIZE), true);
+		const float *out[2] = { mixPlugin->m_mixBuffer.GetOutputBuffer(0), mixPlugin->m_mixBuffer.GetOutputBuffer(1) };
+		for(uint32 i = 0; i < MIXBUFFERSIZE; i++)
+		{
+			output.push_back(out[0][i]);
+			output.push_back(out[1][i]);
+		}
+	}
+	return output;
+}
+
+#endif // NO_PLUGINS
+
+static MPT_NOINLINE void TestDMOPlugins()
+{
+#ifndef NO_PLUGINS
+	// DMO::logGain must match the original bit-by-bit implementation, including zero, the most negative value and shift factors that are smaller or larger than the number of leading zeros
+	{
+		std::vector<float> values = { 0.0f, 1.0f, -1.0f, 0.5f, -0.5f, 3.0f, -3.0f, 12345.0f, -12345.0f, 2147483520.0f, -2147483520.0f, 2147483648.0f, -2147483648.0f };
+		for(int bit = 1; bit < 31; bit++)
+		{
+			const float pow2 = static_cast<float>(1u << bit);
+			values.insert(values.end(), { pow2, -pow2, pow2 + 1.0f, -(pow2 + 1.0f), pow2 - 1.0f, -(pow2 - 1.0f) });
+		}
+		uint32 seed = 42;
+		for(int i = 0; i < 1000; i++)
+		{
+			seed = seed * 1103515245u + 12345u;
+			values.push_back(static_cast<float>(static_cast<int32>(seed) >> (seed % 31u)));
+		}
+		static constexpr int32 shiftLs[] = { -2, -1, 0, 1, 2, 5, 16, 30, 31 };
+		static constexpr int32 shiftRs[] = { 1, 2, 3, 4, 5, 16, 31 };
+		uint32 mismatches = 0;
+		for(float x : values)
+		{
+			for(int32 shiftL : shiftLs)
+			{
+				for(int32 shiftR : shiftRs)
+				{
+					if(DMO::logGain(x, shiftL, shiftR) != DMOLogGainReference(x, shiftL, shiftR))
+						mismatches++;
+				}
+			}
+		}
+		VERIFY_EQUAL(mismatches, 0u);
+		VERIFY_EQUAL(DMO::logGain(0.0f, 31, 5), DMOLogGainReference(0.0f, 31, 5));
+		VERIFY_EQUAL(DMO::logGain(-2147483648.0f, 31, 5), DMOLogGainReference(-2147483648.0f, 31, 5));
+	}
+
+	// The compressor's read offset is computed once per block. It must still delay the signal exactly like the original formula ((predelay + bufPos * 4096 + bufSize - 1) / 4096) % bufSize, also across the wrap-around of the delay buffer.
+	for(uint32 sampleRate : { 8000u, 44100u, 48000u, 96000u })
+	{
+		for(PlugParamValue preDelayParam : { 0.0f, 0.5f, 1.0f })
+		{
+			auto sndFile = CreateRenderTestModule(1, sampleRate, 2);
+			SNDMIXPLUGIN &plugin = sndFile->m_MixPlugins[0];
+			plugin.Info.dwPluginId1 = kDmoMagic;
+			plugin.Info.dwPluginId2 = 0xEF011F79;
+			VERIFY_EQUAL(CreateMixPluginProc(plugin, *sndFile), true);
+			IMixPlugin *compressor = plugin.pMixPlugin;
+			if(!compressor)
+				continue;
+			compressor->SetParameter(0, 0.5f);  // 0 dB gain
+			compressor->SetParameter(3, 1.0f);  // 0 dB threshold
+			compressor->SetParameter(4, 0.0f);  // 1:1 ratio
+			compressor->SetParameter(5, preDelayParam);
+			compressor->Resume();
+
+			const int32 bufSize = static_cast<int32>(sampleRate * 200 / 1000);
+			const int32 preDelay = static_cast<int32>((preDelayParam * 4.0f * (sampleRate / 1000.0f)) + 2.0f);
+			std::vector<bool> buffer(bufSize, false);
+			int32 bufPos = 0;
+			uint32 frame = 0, mismatches = 0;
+			while(frame < static_cast<uint32>(bufSize) * 2 + 1000)
+			{
+				float *in[2] = { compressor->m_mixBuffer.GetInputBuffer(0), compressor->m_mixBuffer.GetInputBuffer(1) };
+				for(uint32 i = 0; i < MIXBUFFERSIZE; i++)
+				{
+					const bool impulse = ((frame + i) % 389u) == 0;
+					in[0][i] = impulse ? 0.5f : 0.0f;
+					in[1][i] = impulse ? -0.25f : 0.0f;
+				}
+				VERIFY_EQUAL(compressor->RenderOutput(MIXBUFFERSIZE), true);
+				const float *out[2] = { compressor->m_mixBuffer.GetOutputBuffer(0), compressor->m_mixBuffer.GetOutputBuffer(1) };
+				for(uint32 i = 0; i < MIXBUFFERSIZE; i++, frame++)
+				{
+					buffer[bufPos] = (frame % 389u) == 0;
+					const bool expected = buffer[((preDelay + bufPos * 4096 + bufSize - 1) / 4096) % bufSize];
+					if((out[0][i] > 0.0f) != expected || (out[1][i] < 0.0f) != expected)
+						mismatches++;
+					if(bufPos-- == 0)
+						bufPos += bufSize;
+				}
+			}
+			VERIFY_EQUAL(mismatches, 0u);
+		}
+	}
+
+#if defined(MPT_ENABLE_ARCH_INTRINSICS_SSE2)
+	// The SSE2 kernels must produce the same output as the scalar reference code, which is used when SSE2 is masked out of the enabled CPU features.
+	// The allowed difference is given relative to full scale. It is zero because the kernels perform the same floating-point operations in the same order as the scalar code.
+	{
+		static constexpr float tolerance = 0.0f;
+		static constexpr struct
+		{
+			uint32 id;
+			PlugParamIndex gainParam;
+			PlugParamValue gain;
+		} plugins[] =
+		{
+			{ 0x120CED89, 2, 0.8f },  // ParamEq with a gain that is not 0 dB, so that the filter is actually applied
+			{ 0x87FC0268, 0, 0.5f },  // WavesReverb
+		};
+		const uint32 enabledFeatures = CPU::EnabledFeatures;
+		for(const auto &plug : plugins)
+		{
+			CPU::EnabledFeatures = enabledFeatures & ~CPU::feature::sse2;
+			const std::vector<float> reference = RenderDMOPlugin(plug.id, { { plug.gainParam, plug.gain } }, 100);
+			CPU::EnabledFeatures = enabledFeatures;
+			const std::vector<float> vectorized = RenderDMOPlugin(plug.id, { { plug.gainParam, plug.gain } }, 100);
+			VERIFY_EQUAL(reference.size(), std::size_t(100 * MIXBUFFERSIZE * 2));
+			VERIFY_EQUAL(vectorized.size(), reference.size());
+			float maxDiff = 0.0f, peak = 0.0f;
+			for(std::size_t i = 0; i < std::min(reference.size(), vectorized.size()); i++)
+			{
+				maxDiff = std::max(maxDiff, std::abs(reference[i] - vectorized[i]));
+				peak = std::max(peak, std::abs(reference[i]));
+			}
+			VERIFY_EQUAL(maxDiff <= tolerance, true);
+			VERIFY_EQUAL(peak > 0.01f, true);
+		}
+	}
+#endif // MPT_ENABLE_ARCH_INTRINSICS_SSE2
+#endif // NO_PLUGINS
+}
+
+static MPT_NOINLINE void TestResonantFilterCache()
+{
+	auto cache = std::make_unique<ResonantFilterCache>();
+	cache->Reset();
+	const ResonantFilterCache::Config config{48000, false, false, true};
+	ResonantFilterCoefficients coefficients;
+	coefficients.gain = 0.25f;
+	coefficients.feedback0 = 1.5f;
+	coefficients.feedback1 = -0.75f;
+
+	VERIFY_EQUAL(cache->Find(config, 100, 20, -37) == nullptr, true);
+	cache->Store(100, 20, -37, coefficients);
+	const ResonantFilterCoefficients *cached = cache->Find(config, 100, 20, -37);
+	VERIFY_EQUAL(cached != nullptr, true);
+	if(cached)
+	{
+		VERIFY_EQUAL(cached->gain, coefficients.gain);
+		VERIFY_EQUAL(cached->feedback0, coefficients.feedback0);
+		VERIFY_EQUAL(cached->feedback1, coefficients.feedback1);
+	}
+	// Neighbouring parameters must not be confused with each other
+	VERIFY_EQUAL(cache->Find(config, 101, 20, -37) == nullptr, true);
+	VERIFY_EQUAL(cache->Find(config, 100, 21, -37) == nullptr, true);
+	VERIFY_EQUAL(cache->Find(config, 100, 20, -36) == nullptr, true);
+	// Out-of-range parameters are never cached
+	cache->Store(100, 20, 300, coefficients);
+	VERIFY_EQUAL(cache->Find(config, 100, 20, 300) == nullptr, true);
+
+	// A different mixing rate or song setup discards everything
+	ResonantFilterCache::Config otherConfig = config;
+	otherConfig.extendedRange = true;
+	VERIFY_EQUAL(cache->Find(otherConfig, 100, 20, -37) == nullptr, true);
+	VERIFY_EQUAL(cache->Find(config, 100, 20, -37) == nullptr, true);
+}
+
+
+static MPT_NOINLINE void TestOPLBlockRendering()
+{
+	// Rendering blocks of frames while skipping silent channels must produce exactly the same output as rendering every frame with all channels.
+	// This relies on operators that are switched off producing no output, and on key-on resetting their phase.
+	for(int sampleRate : { 44100, 48000, 8000, 96000 })
+	{
+		Opal reference(sampleRate), block(sampleRate);
+		const auto port = [&](uint16 reg, uint8 value)
+		{
+			reference.Port(reg, value);
+			block.Port(reg, value);
+		};
+		const auto setOperator = [&](uint8 chn, bool carrier, uint8 flagsMulti, uint8 level, uint8 attackDecay, uint8 sustainRelease, uint8 waveform)
+		{
+			const uint16 op = static_cast<uint16>((chn % 9u) % 3u + ((chn % 9u) / 3u) * 8u + (carrier ? 3u : 0u) + (chn >= 9 ? 0x100u : 0u));
+			port(0x20 + op, flagsMulti);
+			port(0x40 + op, level);
+			port(0x60 + op, attackDecay);
+			port(0x80 + op, sustainRelease);
+			port(0xE0 + op, waveform);
+		};
+		const auto setChannel = [&](uint8 chn, uint8 panFeedbackConnection)
+		{
+			port(static_cast<uint16>(0xC0 + (chn % 9u) + (chn >= 9 ? 0x100u : 0u)), panFeedbackConnection);
+		};
+		const auto key = [&](uint8 chn, uint16 fnum, uint8 octave, bool on)
+		{
+			const uint16 reg = static_cast<uint16>((chn % 9u) + (chn >= 9 ? 0x100u : 0u));
+			port(0xA0 + reg, static_cast<uint8>(fnum & 0xFF));
+			port(0xB0 + reg, static_cast<uint8>((on ? 0x20 : 0x00) | (octave << 2) | (fnum >> 8)));
+		};
+
+		port(0x01, 0x20);   // Waveform select
+		port(0x105, 0x01);  // OPL3 mode
+		port(0x104, 0x01);  // Channels 0 and 3 form a 4-operator pair
+		port(0xBD, 0xC0);   // Deep tremolo and vibrato
+
+		// 4-operator voice on channels 0 + 3
+		setChannel(0, 0x30 | 0x0A);
+		setChannel(3, 0x30 | 0x01);
+		setOperator(0, false, 0x21, 0x1A, 0xF4, 0x56, 0x00);
+		setOperator(0, true, 0x01, 0x10, 0xE3, 0x45, 0x01);
+		setOperator(3, false, 0x02, 0x20, 0xD2, 0x34, 0x02);
+		setOperator(3, true, 0x01, 0x00, 0xF1, 0x2F, 0x00);
+		// 2-operator voice with a fast release, left only
+		setChannel(1, 0x10 | 0x06);
+		setOperator(1, false, 0x03, 0x18, 0xF8, 0x0F, 0x03);
+		setOperator(1, true, 0x01, 0x04, 0xF6, 0x0F, 0x00);
+		// 2-operator voice with tremolo and vibrato, additive synthesis
+		setChannel(2, 0x30 | 0x01);
+		setOperator(2, false, 0xC2, 0x10, 0x85, 0x24, 0x04);
+		setOperator(2, true, 0xC1, 0x08, 0x76, 0x13, 0x05);
+		// 2-operator voice in the second register set, right only
+		setChannel(10, 0x20 | 0x0E);
+		setOperator(10, false, 0x24, 0x14, 0xFA, 0x07, 0x06);
+		setOperator(10, true, 0x22, 0x02, 0xF9, 0x08, 0x07);
+		// Same patch as channel 1, but not keyed on until later
+		setChannel(4, 0x30 | 0x06);
+		setOperator(4, false, 0x03, 0x18, 0xF8, 0x0F, 0x03);
+		setOperator(4, true, 0x01, 0x04, 0xF6, 0x0F, 0x00);
+
+		std::vector<int16> referenceOutput, blockOutput;
+		std::size_t chunk = 0;
+		const auto render = [&](std::size_t frames)
+		{
+			for(std::size_t i = 0; i < frames; i++)
+			{
+				int16 left, right;
+				reference.Sample(&left, &right);
+				referenceOutput.push_back(left);
+				referenceOutput.push_back(right);
+			}
+			// Odd block sizes so that the block boundaries never line up with the OPL3 sample clock
+			static constexpr std::size_t chunkSizes[] = { 1, 17, 256, 999 };
+			while(frames)
+			{
+				const std::size_t count = std::min(frames, chunkSizes[chunk++ % std::size(chunkSizes)]);
+				const std::size_t offset = blockOutput.size();
+				blockOutput.resize(offset + count * 2);
+				block.SampleBlock(blockOutput.data() + offset, count);
+				frames -= count;
+			}
+		};
+
+		key(0, 0x2AE, 4, true);
+		key(1, 0x158, 5, true);
+		key(2, 0x1CA, 3, true);
+		key(10, 0x241, 4, true);
+		render(3000);
+		key(1, 0x158, 5, false);  // Goes silent quickly
+		render(6000);
+		key(0, 0x2AE, 4, false);
+		key(4, 0x1CA, 5, true);
+		render(2500);
+		key(1, 0x204, 4, true);  // Key on again after going silent, with a different frequency
+		render(4000);
+		for(uint8 chn : { 1, 2, 4, 10 })
+			key(chn, 0x100, 4, false);
+		render(sampleRate);
+		key(0, 0x181, 3, true);  // Key on the 4-operator voice again
+		render(3000);
+
+		VERIFY_EQUAL(blockOutput.size(), referenceOutput.size());
+		std::size_t mismatches = 0;
+		int peak = 0;
+		for(std::size_t i = 0; i < std::min(blockOutput.size(), referenceOutput.size()); i++)
+		{
+			if(blockOutput[i] != referenceOutput[i])
+				mismatches++;
+			peak = std::max(peak, std::abs(int(referenceOutput[i])));
+		}
+		VERIFY_EQUAL(mismatches, 0u);
+		VERIFY_EQUAL(peak > 1000, true);
+	}
+}
+
+
+static MPT_NOINLINE void TestSilentMixBuffer()
+{
+	// Skipping the processing of silent mix buffers must not change the output.
+	// In the first pass, an additional channel plays an all-zero sample so that the mix buffer is never known to be silent.
+	std::vector<MixSampleInt> output[2];
+	for(std::size_t pass = 0; pass < 2; pass++)
+	{
+		auto sndFile = CreateRenderTestModule(4, 48000, 4);
+		sndFile->SetMixLevels(MixLevels::v1_17RC3);
+		AddRenderTestSample(*sndFile, 1, 2000, 0, CHN_LOOP, 4321);
+		AddRenderTestSample(*sndFile, 2, 2000, 0, CHN_LOOP, 0);
+
+		CPattern &pat = sndFile->Patterns[0];
+		const auto setNote = [&pat](ROWINDEX row, CHANNELINDEX chn, ModCommand::NOTE note, ModCommand::COMMAND command = CMD_NONE, ModCommand::PARAM param = 0)
+		{
+			ModCommand &m = *pat.GetpModCommand(row, chn);
+			m.note = note;
+			m.instr = (note == NOTE_NOTECUT) ? 0 : 1;
+			m.command = command;
+			m.param = param;
+		};
+		const auto setGlobalVolume = [&pat](ROWINDEX row, ModCommand::PARAM param)
+		{
+			ModCommand &m = *pat.GetpModCommand(row, 3);
+			m.command = CMD_GLOBALVOLUME;
+			m.param = param;
+		};
+		// Surround note, goes into the rear buffer
+		setNote(0, 0, NOTE_MIDDLEC, CMD_S3MCMDEX, 0x91);
+		setNote(3, 0, NOTE_NOTECUT);
+		// Global volume ramps starting during silence and ending in the next note
+		setGlobalVolume(6, 0x20);
+		setNote(6, 0, NOTE_MIDDLEC + 5, CMD_S3MCMDEX, 0xD2);
+		setNote(8, 0, NOTE_NOTECUT);
+		setGlobalVolume(10, 0x80);
+		// Reverb send, the reverb tail must not be cut off
+		setNote(12, 1, NOTE_MIDDLEC - 7, CMD_S3MCMDEX, 0x99);
+		setNote(13, 1, NOTE_NOTECUT);
+		setNote(20, 0, NOTE_MIDDLEC, CMD_S3MCMDEX, 0x90);
+		setNote(22, 0, NOTE_NOTECUT);
+		if(pass == 0)
+		{
+			ModCommand &m = *pat.GetpModCommand(0, 2);
+			m.note = NOTE_MIDDLEC;
+			m.instr = 2;
+		}
+
+		MixerSettings mixerSettings = sndFile->m_MixerSettings;
+		mixerSettings.m_nStereoSeparation = MixerSettings::StereoSeparationScale / 2;
+		// Longer than a tick
+		mixerSettings.SetVolumeRampUpSamples(1500);
+		mixerSettings.SetVolumeRampDownSamples(1500);
+		sndFile->SetMixerSettings(mixerSettings);
+
+		output[pass] = RenderFrames(*sndFile, 40, 4000);
+	}
+	VerifyRenderedOutputEqual(output[0], output[1], 40 * 4000 * 4);
+	// There must be some silence between the notes
+	VERIFY_EQUAL(std::all_of(output[1].begin() + 4 * 5760 * 5, output[1].begin() + 4 * 5760 * 6, [](MixSampleInt s) { return s == 0; }), true);
+}
+
+
+// Creates an IT file in sample mode with IT 2.14 and IT 2.15 compressed samples of all sample formats.
+// The sample data of the last sample is truncated.
+static std::vector<std::byte> CreateCompressedITModule()
+{
+	static const struct
+	{
+		FlagSet<ChannelFlags> flags;
+		SmpLength length;
+	} sampleFormats[] =
+	{
+		{ ChannelFlags(0), 70000 },         // Three compression blocks
+		{ CHN_16BIT, 40000 },               // Three compression blocks
+		{ CHN_STEREO, 33000 },              // Two compression blocks per channel
+		{ CHN_16BIT | CHN_STEREO, 20000 },  // Two compression blocks per channel
+	};
+	const SAMPLEINDEX numSamples = static_cast<SAMPLEINDEX>(std::size(sampleFormats) * 2);
+
+	std::vector<ITSample> sampleHeaders(numSamples);
+	std::vector<std::string> sampleData(numSamples);
+	for(SAMPLEINDEX smp = 0; smp < numSamples; smp++)
+	{
+		const bool it215 = (smp % 2) != 0;
+		ModSample sample;
+		sample.Initialize(MOD_TYPE_IT);
+		sample.uFlags.set(sampleFormats[smp / 2].flags);
+		sample.nLength = sampleFormats[smp / 2].length;
+		VERIFY_EQUAL(sample.AllocateSample() != 0, true);
+		FillTestSampleData(sample, 1000 + smp);
+		sampleHeaders[smp].ConvertToIT(sample, MOD_TYPE_IT, true, it215, false);
+		std::ostringstream f;
+		ITCompression compression(sample, it215, &f);
+		sampleData[smp] = f.str();
+		sample.FreeSample();
+	}
+	sampleData.back().resize(sampleData.back().size() / 2);
+
+	ITFileHeader fileHeader;
+	MemsetZero(fileHeader);
+	memcpy(fileHeader.id, "IMPM", 4);
+	fileHeader.ordnum = 1;
+	fileHeader.smpnum = numSamples;
+	fileHeader.cwtv = 0x0214;
+	fileHeader.cmwt = 0x0214;
+	fileHeader.flags = ITFileHeader::useStereoPlayback;
+	fileHeader.globalvol = 128;
+	fileHeader.mv = 48;
+	fileHeader.speed = 6;
+	fileHeader.tempo = 125;
+	fileHeader.sep = 128;
+	for(CHANNELINDEX chn = 0; chn < 64; chn++)
+	{
+		fileHeader.chnpan[chn] = 32;
+		fileHeader.chnvol[chn] = 64;
+	}
+
+	std::ostringstream f;
+	mpt::IO::Write(f, fileHeader);
+	mpt::IO::WriteIntLE<uint8>(f, 0xFF);
+	uint32 offset = static_cast<uint32>(sizeof(ITFileHeader) + 1 + numSamples * 4);
+	for(SAMPLEINDEX smp = 0; smp < numSamples; smp++)
+	{
+		mpt::IO::WriteIntLE<uint32>(f, offset + smp * static_cast<uint32>(sizeof(ITSample)));
+	}
+	offset += numSamples * static_cast<uint32>(sizeof(ITSample));
+	for(SAMPLEINDEX smp = 0; smp < numSamples; smp++)
+	{
+		sampleHeaders[smp].samplepointer = offset;
+		mpt::IO::Write(f, sampleHeaders[smp]);
+		offset += static_cast<uint32>(sampleData[smp].size());
+	}
+	for(const auto &data : sampleData)
+	{
+		mpt::IO::WriteRaw(f, data.data(), data.size());
+	}
+	const std::string file = f.str();
+	return mpt::make_vector(mpt::byte_cast<mpt::const_byte_span>(mpt::as_span(file)));
+}
+
+
+// Creates an MO3 file in IT sample mode with uncompressed, delta-compressed, delta-prediction-compressed and duplicated samples.
+// Delta-compressed samples are made up of random data, which is just as valid as actual compressed data.
+static std::vector<std::byte> CreateMO3Module()
+{
+	static constexpr uint16 smp16Bit = 0x01, smpStereo = 0x400, smpDeltaCompression = 0x2000, smpDeltaPrediction = 0x4000;
+	static constexpr struct
+	{
+		uint16 flags;
+		uint32 length;
+		int32 compressedSize;
+	} samples[] =
+	{
+		{ 0, 3000, 0 },
+		{ smp16Bit | smpStereo, 2000, 0 },
+		{ smpDeltaCompression, 6000, 4000 },
+		{ smpDeltaCompression | smp16Bit | smpStereo, 3000, 5000 },
+		{ smpDeltaPrediction | smpStereo, 4000, 3000 },
+		{ smpDeltaPrediction | smp16Bit, 5000, 6000 },
+		{ smpDeltaCompression, 6000, -4 },  // Duplicate of sample 3
+		{ smpDeltaPrediction | smp16Bit, 5000, -2 },  // Duplicate of sample 6
+	};
+
+	// Music data
+	std::ostringstream music;
+	mpt::IO::WriteIntLE<uint8>(music, 0);  // Song name
+	mpt::IO::WriteIntLE<uint8>(music, 0);  // Song message
+	mpt::IO::WriteIntLE<uint8>(music, 4);  // Channels
+	mpt::IO::WriteIntLE<uint16>(music, 1);  // Orders
+	mpt::IO::WriteIntLE<uint16>(music, 0);  // Restart position
+	mpt::IO::WriteIntLE<uint16>(music, 0);  // Patterns
+	mpt::IO::WriteIntLE<uint16>(music, 0);  // Tracks
+	mpt::IO::WriteIntLE<uint16>(music, 0);  // Instruments
+	mpt::IO::WriteIntLE<uint16>(music, static_cast<uint16>(std::size(samples)));
+	mpt::IO::WriteIntLE<uint8>(music, 6);  // Speed
+	mpt::IO::WriteIntLE<uint8>(music, 125);  // Tempo
+	mpt::IO::WriteIntLE<uint32>(music, 0x100 | 0x20000);  // IT in sample mode
+	mpt::IO::WriteIntLE<uint8>(music, 128);  // Global volume
+	mpt::IO::WriteIntLE<uint8>(music, 128);  // Pan separation
+	mpt::IO::WriteIntLE<int8>(music, 0);  // Sample volume
+	for(int chn = 0; chn < 64; chn++)
+		mpt::IO::WriteIntLE<uint8>(music, 64);
+	for(int chn = 0; chn < 64; chn++)
+		mpt::IO::WriteIntLE<uint8>(music, 128);
+	for(int i = 0; i < 16 + 128 * 2; i++)
+		mpt::IO::WriteIntLE<uint8>(music, 0);  // MIDI macros
+	mpt::IO::WriteIntLE<uint8>(music, 0xFF);  // Order list
+	std::ostringstream sampleData;
+	uint32 lcg = 42;
+	for(const auto &smp : samples)
+	{
+		mpt::IO::WriteIntLE<uint8>(music, 0);  // Sample name
+		mpt::IO::WriteIntLE<uint8>(music, 0);  // Sample filename
+		mpt::IO::WriteIntLE<uint32>(music, 8363);
+		mpt::IO::WriteIntLE<int8>(music, 0);  // Transpose
+		mpt::IO::WriteIntLE<uint8>(music, 64);  // Volume
+		mpt::IO::WriteIntLE<uint16>(music, 0xFFFF);  // Panning
+		mpt::IO::WriteIntLE<uint32>(music, smp.length);
+		mpt::IO::WriteIntLE<uint32>(music, 0);  // Loop start
+		mpt::IO::WriteIntLE<uint32>(music, 0);  // Loop end
+		mpt::IO::WriteIntLE<uint16>(music, smp.flags);
+		for(int i = 0; i < 4; i++)
+			mpt::IO::WriteIntLE<uint8>(music, 0);  // Auto vibrato
+		mpt::IO::WriteIntLE<uint8>(music, 64);  // Global volume
+		mpt::IO::WriteIntLE<uint32>(music, 0);  // Sustain loop start
+		mpt::IO::WriteIntLE<uint32>(music, 0);  // Sustain loop end
+		mpt::IO::WriteIntLE<int32>(music, smp.compressedSize);
+		mpt::IO::WriteIntLE<uint16>(music, 0);  // Encoder delay
+
+		uint32 dataSize = 0;
+		if(smp.compressedSize > 0)
+			dataSize = static_cast<uint32>(smp.compressedSize);
+		else if(smp.compressedSize == 0)
+			dataSize = smp.length * ((smp.flags & smp16Bit) ? 2 : 1) * ((smp.flags & smpStereo) ? 2 : 1);
+		for(uint32 i = 0; i < dataSize; i++)
+		{
+			lcg = lcg * 1103515245u + 12345u;
+			mpt::IO::WriteIntLE<uint8>(sampleData, static_cast<uint8>(lcg >> 24));
+		}
+	}
+	const std::string musicData = music.str();
+
+	// The music data is "compressed" using literal bytes only: After the first byte, each control byte (with eight zero bits) is followed by up to eight bytes.
+	std::ostringstream compressed;
+	for(std::size_t i = 0; i < musicData.size(); i++)
+	{
+		if(i % 8 == 1)
+			mpt::IO::WriteIntLE<uint8>(compressed, 0);
+		mpt::IO::WriteIntLE<uint8>(compressed, static_cast<uint8>(musicData[i]));
+	}
+	const std::string compressedData = compressed.str();
+
+	std::ostringstream f;
+	mpt::IO::WriteRaw(f, "MO3", 3);
+	mpt::IO::WriteIntLE<uint8>(f, 5);
+	mpt::IO::WriteIntLE<uint32>(f, static_cast<uint32>(musicData.size()));
+	mpt::IO::WriteIntLE<uint32>(f, static_cast<uint32>(compressedData.size()));
+	mpt::IO::WriteRaw(f, compressedData.data(), compressedData.size());
+	const std::string samplesData = sampleData.str();
+	mpt::IO::WriteRaw(f, samplesData.data(), samplesData.size());
+	const std::string file = f.str();
+	return mpt::make_vector(mpt::byte_cast<mpt::const_byte_span>(mpt::as_span(file)));
+}
+
+
+// Loads a module from memory, decoding samples with the given number of threads.
+static std::unique_ptr<CSoundFile> LoadTestModule(mpt::const_byte_span data, CSoundFile::ModLoadingFlags loadFlags, uint32 loaderThreads = 1)
+{
+	auto sndFile = std::make_unique<CSoundFile>();
+	sndFile->SetLoaderThreads(loaderThreads);
+	VERIFY_EQUAL(sndFile->Create(FileReader(data), loadFlags), true);
+	return sndFile;
+}
+
+
+// Verifies that two modules contain exactly the same sample data.
+static void VerifySampleDataEqual(const CSoundFile &expected, const CSoundFile &actual)
+{
+	VERIFY_EQUAL(actual.GetNumSamples(), expected.GetNumSamples());
+	for(SAMPLEINDEX smp = 1; smp <= std::min(expected.GetNumSamples(), actual.GetNumSamples()); smp++)
+	{
+		const ModSample &expectedSample = expected.GetSample(smp), &actualSample = actual.GetSample(smp);
+		VERIFY_EQUAL_NONCONT(actualSample.nLength, expectedSample.nLength);
+		VERIFY_EQUAL_NONCONT(actualSample.uFlags, expectedSample.uFlags);
+		VERIFY_EQUAL_NONCONT(actualSample.HasSampleData(), expectedSample.HasSampleData());
+		if(expectedSample.HasSampleData() && actualSample.HasSampleData() && actualSample.nLength == expectedSample.nLength && actualSample.uFlags == expectedSample.uFlags)
+		{
+			VERIFY_EQUAL_NONCONT(std::memcmp(actualSample.samplev(), expectedSample.samplev(), expectedSample.GetSampleSizeInBytes()), 0);
+		}
+	}
+}
+
+
+// Test decoding sample data when it is first needed
+static MPT_NOINLINE void TestDeferredSamples()
+{
+	// Compressed IT samples and MO3 samples must decode to the same sample data as when decoding them while loading.
+	// The deferred samples must not depend on the original file data.
+	for(const bool mo3 : {false, true})
+	{
+		std::vector<std::byte> data = mo3 ? CreateMO3Module() : CreateCompressedITModule();
+		const auto eager = LoadTestModule(mpt::as_span(data), CSoundFile::loadCompleteModule);
+		const auto deferred = LoadTestModule(mpt::as_span(data), static_cast<CSoundFile::ModLoadingFlags>(CSoundFile::loadCompleteModule | CSoundFile::deferSampleData));
+		data = {};
+		VERIFY_EQUAL(eager->GetType(), MOD_TYPE_IT);
+		VERIFY_EQUAL(eager->GetNumSamples(), SAMPLEINDEX(8));
+		VERIFY_EQUAL(eager->HasDeferredSamples(), false);
+		SAMPLEINDEX numDeferred = 0;
+		for(SAMPLEINDEX smp = 1; smp <= deferred->GetNumSamples(); smp++)
+		{
+			VERIFY_EQUAL_NONCONT(eager->GetSample(smp).HasSampleData(), true);
+			if(deferred->IsSampleDeferred(smp))
+				numDeferred++;
+		}
+		// Truncated IT samples and the sources of duplicated MO3 samples are decoded while loading
+		VERIFY_EQUAL(numDeferred, SAMPLEINDEX(mo3 ? 4 : 7));
+		deferred->DecodeDeferredSamples();
+		VERIFY_EQUAL(deferred->HasDeferredSamples(), false);
+		VerifySampleDataEqual(*eager, *deferred);
+	}
+
+	if(!ShouldRunTests())
+	{
+		return;
+	}
+
+	std::vector<MixSampleInt> output[2];
+	std::unique_ptr<CSoundFile> sndFiles[2];
+	SAMPLEINDEX numDeferred = 0;
+	for(std::size_t pass = 0; pass < 2; pass++)
+	{
+		const bool deferred = (pass == 1);
+		std::vector<std::byte> data;
+		{
+			InputFile inputFile(GetTestFilenameBase() + P_("mptm"));
+			FileReader file = GetFileReader(inputFile);
+			data.resize(file.GetLength());
+			file.ReadRaw(mpt::as_span(data));
+		}
+		auto &sndFile = sndFiles[pass];
+		sndFile = std::make_unique<CSoundFile>();
+		VERIFY_EQUAL(sndFile->Create(FileReader(mpt::as_span(data)), deferred ? static_cast<CSoundFile::ModLoadingFlags>(CSoundFile::loadCompleteModule | CSoundFile::deferSampleData) : CSoundFile::loadCompleteModule), true);
+		// The deferred samples must not depend on the original file data
+		data = {};
+
+		for(SAMPLEINDEX smp = 1; smp <= sndFile->GetNumSamples(); smp++)
+		{
+			if(sndFile->IsSampleDeferred(smp))
+			{
+				VERIFY_EQUAL_NONCONT(sndFile->GetSample(smp).HasSampleData(), false);
+				numDeferred++;
+			}
+		}
+		VERIFY_EQUAL(sndFile->HasDeferredSamples(), deferred);
+
+		// Nothing audible happens at the start of the test module, so trigger a note ourselves
+		const PATTERNINDEX pat = sndFile->Order()[sndFile->Order().GetNextOrderIgnoringSkips(0)];
+		VERIFY_EQUAL(sndFile->Patterns.IsValidPat(pat), true);
+		ModCommand &m = *sndFile->Patterns[pat].GetpModCommand(0, 2);
+		m.note = NOTE_MIDDLEC + 12;
+		m.instr = 1;
+		// Both passes must render the same output, so get rid of random variations
+		ModInstrument &ins = *sndFile->Instruments[1];
+		ins.nVolSwing = ins.nPanSwing = ins.nCutSwing = ins.nResSwing = 0;
+
+		MixerSettings mixerSettings = sndFile->m_MixerSettings;
+		mixerSettings.gdwMixingFreq = 48000;
+		mixerSettings.gnChannels = 2;
+		sndFile->SetMixerSettings(mixerSettings);
+		output[pass] = RenderFrames(*sndFile, 50, 1000);
+	}
+	VERIFY_EQUAL(numDeferred > 0, true);
+	VerifyRenderedOutputEqual(output[0], output[1], 50 * 1000 * 2);
+
+	// Samples that have been played are decoded, and all remaining samples can be decoded explicitly
+	SAMPLEINDEX numStillDeferred = 0;
+	for(SAMPLEINDEX smp = 1; smp <= sndFiles[1]->GetNumSamples(); smp++)
+	{
+		if(sndFiles[1]->IsSampleDeferred(smp))
+			numStillDeferred++;
+	}
+	VERIFY_EQUAL(numStillDeferred < numDeferred, true);
+	sndFiles[1]->DecodeDeferredSamples();
+	VERIFY_EQUAL(sndFiles[1]->HasDeferredSamples(), false);
+	VerifySampleDataEqual(*sndFiles[0], *sndFiles[1]);
+}
+
+
+static MPT_NOINLINE void TestSampleDecodeQueue()
+{
+	class CollectingLog : public ILog
+	{
+	public:
+		void AddToLog(LogLevel, const mpt::ustring &text) const override { messages.push_back(text); }
+		mutable std::vector<mpt::ustring> messages;
+	};
+
+	const std::array<std::byte, 16> data{};
+	for(uint32 numThreads : {1u, 4u})
+	{
+		auto sndFile = std::make_unique<CSoundFile>();
+		CollectingLog log;
+		sndFile->SetCustomLog(&log);
+		sndFile->SetLoaderThreads(numThreads);
+		SampleDecodeQueue queue(*sndFile, FileReader(mpt::as_span(data)));
+
+		// Log messages must arrive in the order in which the jobs were added, no matter on which thread they ran
+		constexpr uint32 numJobs = 32;
+		std::vector<uint32> results(numJobs, 0);
+		std::vector<mpt::ustring> expectedMessages;
+		for(uint32 i = 0; i < numJobs; i++)
+		{
+			queue.Add([i, &result = results[i]](const ILog &jobLog)
+			{
+				result = i + 1;
+				jobLog.AddToLog(LogInformation, mpt::ufmt::val(i));
+			});
+			expectedMessages.push_back(mpt::ufmt::val(i));
+		}
+		queue.Run();
+		VERIFY_EQUAL(log.messages == expectedMessages, true);
+		for(uint32 i = 0; i < numJobs; i++)
+		{
+			VERIFY_EQUAL_NONCONT(results[i], i + 1);
+		}
+
+		// The exception of the first failing job is propagated, either when adding it or when running the queue
+		uint32 failedJob = 0;
+		try
+		{
+			for(uint32 i = 0; i < 4; i++)
+			{
+				queue.Add([i](const ILog &)
+				{
+					if(i == 1 || i == 3)
+						throw i;
+				});
+			}
+			queue.Run();
+		} catch(uint32 i)
+		{
+			failedJob = i;
+		}
+		VERIFY_EQUAL(failedJob, 1u);
+		sndFile->SetCustomLog(nullptr);
+	}
+
+	// Samples decoded on several threads must be identical to samples decoded on one thread.
+	// This covers IT-compressed samples as well as delta-compressed and duplicated MO3 samples.
+	for(const bool mo3 : {false, true})
+	{
+		const std::vector<std::byte> data = mo3 ? CreateMO3Module() : CreateCompressedITModule();
+		const auto singleThreaded = LoadTestModule(mpt::as_span(data), CSoundFile::loadCompleteModule, 1);
+		const auto multiThreaded = LoadTestModule(mpt::as_span(data), CSoundFile::loadCompleteModule, 4);
+		VERIFY_EQUAL(singleThreaded->GetNumSamples(), SAMPLEINDEX(8));
+		VerifySampleDataEqual(*singleThreaded, *multiThreaded);
+	}
+}
+
+
+static MPT_NOINLINE void TestSamplePool()
+{
+	if(!ShouldRunTests())
+	{
+		return;
+	}
+
+	std::vector<std::byte> data;
+	{
+		InputFile inputFile(GetTestFilenameBase() + P_("mptm"));
+		FileReader file = GetFileReader(inputFile);
+		data.resize(file.GetLength());
+		file.ReadRaw(mpt::as_span(data));
+	}
+	const auto initialStats = SamplePool::GetStatistics();
+
+	std::unique_ptr<CSoundFile> sndFiles[3];
+	for(auto &sndFile : sndFiles)
+	{
+		sndFile = std::make_unique<CSoundFile>();
+	}
+	VERIFY_EQUAL(sndFiles[0]->Create(FileReader(mpt::as_span(data)), CSoundFile::loadCompleteModule), true);
+	VERIFY_EQUAL(SamplePool::GetStatistics().numBuffers, initialStats.numBuffers);
+	for(std::size_t i = 1; i < 3; i++)
+	{
+		VERIFY_EQUAL(sndFiles[i]->Create(FileReader(mpt::as_span(data)), static_cast<CSoundFile::ModLoadingFlags>(CSoundFile::loadCompleteModule | CSoundFile::shareSampleData)), true);
+	}
+
+	// Both shared modules reference the same sample data, which is identical to the unshared module's sample data
+	SAMPLEINDEX numSamples = 0;
+	for(SAMPLEINDEX smp = 1; smp <= sndFiles[0]->GetNumSamples(); smp++)
+	{
+		const ModSample &expected = sndFiles[0]->GetSample(smp), &shared1 = sndFiles[1]->GetSample(smp), &shared2 = sndFiles[2]->GetSample(smp);
+		VERIFY_EQUAL_NONCONT(shared1.HasSampleData(), expected.HasSampleData());
+		if(!expected.HasSampleData())
+			continue;
+		numSamples++;
+		VERIFY_EQUAL_NONCONT(shared1.samplev() == shared2.samplev(), true);
+		VERIFY_EQUAL_NONCONT(shared1.samplev() != expected.samplev(), true);
+		VERIFY_EQUAL_NONCONT(SamplePool::Contains(shared1.samplev()), true);
+		VERIFY_EQUAL_NONCONT(SamplePool::Contains(expected.samplev()), false);
+		VERIFY_EQUAL_NONCONT(std::memcmp(shared1.samplev(), expected.samplev(), expected.GetSampleSizeInBytes()), 0);
+	}
+	VERIFY_EQUAL(numSamples > 0, true);
+	auto stats = SamplePool::GetStatistics();
+	VERIFY_EQUAL(stats.numReferences - initialStats.numReferences, 2 * (stats.numBuffers - initialStats.numBuffers));
+	VERIFY_EQUAL(stats.numBuffers - initialStats.numBuffers <= numSamples, true);
+
+	// Modifying a shared sample gives it its own copy of the sample data
+	SAMPLEINDEX modifiedSample = 0;
+	for(SAMPLEINDEX smp = 1; smp <= sndFiles[1]->GetNumSamples() && !modifiedSample; smp++)
+	{
+		if(sndFiles[1]->GetSample(smp).HasSampleData())
+			modifiedSample = smp;
+	}
+	ModSample &modified = sndFiles[1]->GetSample(modifiedSample);
+	const void *sharedData = sndFiles[2]->GetSample(modifiedSample).samplev();
+	modified.SetLoop(0, modified.nLength, true, !modified.uFlags[CHN_PINGPONGLOOP], *sndFiles[1]);
+	VERIFY_EQUAL(modified.samplev() != sharedData, true);
+	VERIFY_EQUAL(SamplePool::Contains(modified.samplev()), false);
+	VERIFY_EQUAL(SamplePool::Contains(sharedData), true);
+	VERIFY_EQUAL(std::memcmp(modified.samplev(), sharedData, modified.GetSampleSizeInBytes()), 0);
+
+	// The pool only keeps the sample data alive as long as there are modules using it
+	sndFiles[2].reset();
+	for(SAMPLEINDEX smp = 1; smp <= sndFiles[0]->GetNumSamples(); smp++)
+	{
+		const ModSample &expected = sndFiles[0]->GetSample(smp), &shared = sndFiles[1]->GetSample(smp);
+		if(expected.HasSampleData())
+			VERIFY_EQUAL_NONCONT(std::memcmp(shared.samplev(), expected.samplev(), expected.GetSampleSizeInBytes()), 0);
+	}
+	sndFiles[1].reset();
+	stats = SamplePool::GetStatistics();
+	VERIFY_EQUAL(stats.numBuffers, initialStats.numBuffers);
+	VERIFY_EQUAL(stats.numReferences, initialStats.numReferences);
+}
+
+
+static MPT_NOINLINE void TestAudioTargetPlanarFloat()
+{
+	// The direct planar float target must produce exactly the same output as the generic dithering target.
+	constexpr std::size_t channels = 4, frames = 700;
+	std::vector<MixSampleInt> input(channels * frames);
+	uint32 lcg = 1;
+	for(auto &s : input)
+	{
+		lcg = lcg * 1103515245u + 12345u;
+		s = static_cast<MixSampleInt>(lcg) >> 3;
+	}
+
+	DithersWrapperOpenMPT dithers(*s_PRNG, DithersOpenMPT::DefaultDither, channels);
+	for(float gain : { 1.0f, 0.5f, 0.316f, 2.7f })
+	{
+		std::vector<float> expected[channels], actual[channels];
+		float *expectedBuffers[channels], *actualBuffers[channels];
+		for(std::size_t channel = 0; channel < channels; channel++)
+		{
+			expected[channel].assign(frames, 0.0f);
+			actual[channel].assign(frames, 1.0f);
+			expectedBuffers[channel] = expected[channel].data();
+			actualBuffers[channel] = actual[channel].data();
+		}
+		AudioTargetBufferWithGain<mpt::audio_span_planar<float>> expectedTarget(mpt::audio_span_planar<float>(expectedBuffers, channels, frames), dithers, gain);
+		AudioTargetPlanarFloat actualTarget(mpt::audio_span_planar<float>(actualBuffers, channels, frames), gain);
+		// Process in two differently-sized chunks, like CSoundFile::Read does
+		std::vector<MixSampleInt> chunk;
+		for(auto [offset, count] : { std::pair<std::size_t, std::size_t>{ 0, 300 }, std::pair<std::size_t, std::size_t>{ 300, 400 } })
+		{
+			chunk.assign(input.begin() + offset * channels, input.begin() + (offset + count) * channels);
+			expectedTarget.Process(mpt::audio_span_interleaved<MixSampleInt>(chunk.data(), channels, count));
+			chunk.assign(input.begin() + offset * channels, input.begin() + (offset + count) * channels);
+			actualTarget.Process(mpt::audio_span_interleaved<MixSampleInt>(chunk.data(), channels, count));
+		}
+		VERIFY_EQUAL(actualTarget.GetRenderedCount(), frames);
+		for(std::size_t channel = 0; channel < channels; channel++)
+		{
+			VERIFY_EQUAL_NONCONT(std::memcmp(expected[channel].data(), actual[channel].data(), frames * sizeof(float)), 0);
+		}
+	}
+}
+
+
+static MPT_NOINLINE void TestResamplerTablesBlob()
+{
+#ifdef MPT_RESAMPLER_TABLES_CACHED
+	// Tables restored from a blob must be identical to freshly computed ones, and damaged blobs must be rejected.
+	const std::vector<std::byte> blob = CResampler::GetTablesCacheBlob();
+	VERIFY_EQUAL(CResampler::IsValidTablesBlob(mpt::as_span(blob)), true);
+	VERIFY_EQUAL(CResampler::InitializeTablesCache(mpt::as_span(blob)), true);
+
+	auto fresh = std::make_unique<CResampler>(true);
+	auto restored = std::make_unique<CResampler>(mpt::as_span(blob));
+	VERIFY_EQUAL(std::equal(std::begin(fresh->gKaiserSinc), std::end(fresh->gKaiserSinc), std::begin(restored->gKaiserSinc)), true);
+	VERIFY_EQUAL(std::equal(std::begin(fresh->gDownsample13x), std::end(fresh->gDownsample13x), std::begin(restored->gDownsample13x)), true);
+	VERIFY_EQUAL(std::equal(std::begin(fresh->gDownsample2x), std::end(fresh->gDownsample2x), std::begin(restored->gDownsample2x)), true);
+	VERIFY_EQUAL(std::equal(std::begin(fresh->m_WindowedFIR.lut), std::end(fresh->m_WindowedFIR.lut), std::begin(restored->m_WindowedFIR.lut)), true);
+	for(auto amigaType : { Resampling::AmigaFilter::A500, Resampling::AmigaFilter::A1200, Resampling::AmigaFilter::Unfiltered })
+	{
+		for(bool enableFilter : { false, true })
+		{
+			VERIFY_EQUAL_NONCONT(fresh->blepTables.GetAmigaTable(amigaType, enableFilter) == restored->blepTables.GetAmigaTable(amigaType, enableFilter), true);
+		}
+	}
+
+	std::vector<std::byte> damaged = blob;
+	damaged.back() ^= std::byte{1};
+	VERIFY_EQUAL(CResampler::IsValidTablesBlob(mpt::as_span(damaged)), false);
+	damaged = blob;
+	damaged[0] ^= std::byte{1};
+	VERIFY_EQUAL(CResampler::IsValidTablesBlob(mpt::as_span(damaged)), false);
+	VERIFY_EQUAL(CResampler::IsValidTablesBlob(mpt::as_span(blob).first(blob.size() - 1)), false);
+	VERIFY_EQUAL(CResampler::IsValidTablesBlob(mpt::const_byte_span()), false);
+	VERIFY_EQUAL(CResampler::InitializeTablesCache(mpt::const_byte_span()), false);
+#endif // MPT_RESAMPLER_TABLES_CACHED
+}
+
+
 
 #if 0
 